@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "crisp/core/aggregator.h"
+#include "crisp/crypto/magma_backend.h"
+}
+
+#include "bench_util.h"
+
+namespace {
+
+struct Receiver {
+  crisp_session_t* session;
+  size_t messages;
+};
+
+/** RX side of the aggregated run: unprotect in place and split, as a receiver would. */
+crisp_error_t receive(void* user_ctx, crisp_const_byte_span_t packet, uint64_t) {
+  auto* receiver = static_cast<Receiver*>(user_ctx);
+  std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> copy{};
+  std::copy(packet.data, packet.data + packet.size, copy.data());
+  crisp_const_byte_span_t plaintext{};
+  crisp_unprotect_result_t result{};
+  crisp_error_t err = crisp_session_unprotect_in_place(
+      receiver->session, {copy.data(), packet.size}, &plaintext, &result);
+  std::array<crisp_const_byte_span_t, 128> messages{};
+  size_t count = 0U;
+  if (err == CRISP_OK) {
+    err = crisp_aggregate_split(plaintext, messages.data(), messages.size(), &count);
+  }
+  receiver->messages += count;
+  return err;
+}
+
+/**
+ * Magma CS1 TX+RX of `message_size`-byte messages: one packet per message
+ * (crisp_session_protect/unprotect) vs the aggregator filling packets up to `mtu`.
+ */
+void bench_aggregate(bool aggregate, size_t message_size, size_t mtu, size_t iters) {
+  crisp_crypto_iface_t iface{};
+  crisp_magma_crypto_iface_init(&iface);
+  std::array<uint8_t, 32> kenc{};
+  std::array<uint8_t, 32> kmac{};
+  for (size_t i = 0; i < kenc.size(); ++i) {
+    kenc[i] = static_cast<uint8_t>(i);
+    kmac[i] = static_cast<uint8_t>(0xFFU - i);
+  }
+  const std::array<uint8_t, 2> key_id{0x81U, 0x42U};
+  crisp_session_config_t config{};
+  config.cs = CRISP_SUITE_CS1;
+  config.key_id_present = true;
+  config.key_id = {key_id.data(), key_id.size()};
+  config.kenc = {kenc.data(), kenc.size()};
+  config.kmac = {kmac.data(), kmac.size()};
+  config.crypto = &iface;
+  config.replay_window_size = 64U;
+  crisp_session_t tx{};
+  crisp_session_t rx{};
+  (void)crisp_session_init(&tx, &config);
+  (void)crisp_session_init(&rx, &config);
+
+  const std::vector<uint8_t> message(message_size, 0x5AU);
+  Receiver receiver{&rx, 0U};
+  crisp_aggregator_t aggregator{};
+  crisp_aggregator_config_t aggregator_config{};
+  aggregator_config.session = &tx;
+  aggregator_config.emit = receive;
+  aggregator_config.user_ctx = &receiver;
+  aggregator_config.max_packet_size = mtu;
+  (void)crisp_aggregator_init(&aggregator, &aggregator_config);
+  std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> packet{};
+  std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> plaintext{};
+
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    if (aggregate) {
+      (void)crisp_aggregator_push(&aggregator, {message.data(), message.size()}, i);
+      return;
+    }
+    size_t size = 0U;
+    crisp_unprotect_result_t result{};
+    (void)crisp_session_protect(&tx, {message.data(), message.size()},
+                                {packet.data(), packet.size()}, &size, nullptr);
+    if (crisp_session_unprotect(&rx, {packet.data(), size}, {plaintext.data(), plaintext.size()},
+                                &result) == CRISP_OK) {
+      ++receiver.messages;
+    }
+  });
+  (void)crisp_aggregator_flush(&aggregator);
+  crisp_bench::do_not_optimize(receiver.messages);
+  crisp_aggregator_clear(&aggregator);
+  crisp_session_clear(&tx);
+  crisp_session_clear(&rx);
+
+  const std::string name = std::string(aggregate ? "aggregated  " : "one per pkt ") +
+                           "msg=" + std::to_string(message_size) + " mtu=" + std::to_string(mtu);
+  crisp_bench::report_rate(name, iters, seconds, "msg");
+}
+
+}  // namespace
+
+int main() {
+  const size_t iters = crisp_bench::iterations(200000U);
+  std::printf("Magma CS1 small messages, protect+unprotect (%zu messages)\n", iters);
+  for (const size_t message_size : {20U, 40U, 60U}) {
+    bench_aggregate(false, message_size, CRISP_MAX_MESSAGE_SIZE, iters);
+    for (const size_t mtu : {512U, 1400U}) {
+      bench_aggregate(true, message_size, mtu, iters);
+    }
+  }
+  return 0;
+}
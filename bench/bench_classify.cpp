@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "crisp/core/classify.h"
+#include "crisp/core/message.h"
+}
+
+#include "bench_util.h"
+
+namespace {
+
+constexpr size_t kBatch = 64U;
+constexpr size_t kPool = 4096U;
+
+/** `long_key_id_percent` of the packets carry a 16-byte KeyId, the rest a one-byte one. */
+std::vector<std::vector<uint8_t>> make_packets(unsigned long_key_id_percent) {
+  std::mt19937 rng(long_key_id_percent);
+  std::vector<std::vector<uint8_t>> packets(kPool);
+  for (std::vector<uint8_t>& packet : packets) {
+    packet = {0x00U, 0x00U, static_cast<uint8_t>(1U + rng() % 4U)};
+    if (rng() % 100U < long_key_id_percent) {
+      packet.push_back(0x8FU);
+      packet.resize(packet.size() + 15U, 0x5AU);
+    } else {
+      packet.push_back(static_cast<uint8_t>(rng() % 0x80U));
+    }
+    for (int i = 0; i < 6; ++i) {
+      packet.push_back(static_cast<uint8_t>(rng()));
+    }
+    packet.resize(packet.size() + 64U + rng() % 1024U, 0xA5U);
+  }
+  return packets;
+}
+
+/** Header parsing of 64-packet batches: crisp_parse_message() per packet vs the classifier. */
+void bench_classify(unsigned long_key_id_percent, size_t iters) {
+  const std::vector<std::vector<uint8_t>> storage = make_packets(long_key_id_percent);
+  std::vector<crisp_const_byte_span_t> packets;
+  for (const std::vector<uint8_t>& packet : storage) {
+    packets.push_back({packet.data(), packet.size()});
+  }
+  const size_t batches = iters / kBatch + 1U;
+  const std::string label = "long KeyId " + std::to_string(long_key_id_percent) + "%";
+
+  std::vector<crisp_message_view_t> views(kBatch);
+  double seconds = crisp_bench::time_seconds(batches, [&](size_t b) {
+    const crisp_const_byte_span_t* batch = &packets[(b * kBatch) % kPool];
+    for (size_t i = 0; i < kBatch; ++i) {
+      (void)crisp_parse_message(batch[i], &views[i]);
+    }
+    crisp_bench::do_not_optimize(views.data());
+  });
+  crisp_bench::report_rate("parse_message loop  " + label, batches * kBatch, seconds, "pkt");
+
+  std::vector<crisp_error_t> status(kBatch);
+  std::vector<uint8_t> cs(kBatch);
+  std::vector<uint8_t> flags(kBatch);
+  std::vector<uint64_t> seqnum(kBatch);
+  std::vector<uint16_t> key_id_offset(kBatch);
+  std::vector<uint16_t> key_id_size(kBatch);
+  std::vector<uint16_t> payload_offset(kBatch);
+  std::vector<uint16_t> payload_size(kBatch);
+  const crisp_classify_batch_out_t out = {
+      status.data(),        cs.data(),          flags.data(),
+      seqnum.data(),        key_id_offset.data(), key_id_size.data(),
+      payload_offset.data(), payload_size.data()};
+  seconds = crisp_bench::time_seconds(batches, [&](size_t b) {
+    (void)crisp_classify_batch(&packets[(b * kBatch) % kPool], kBatch, &out);
+    crisp_bench::do_not_optimize(status.data());
+  });
+  crisp_bench::report_rate("classify_batch      " + label, batches * kBatch, seconds, "pkt");
+}
+
+}  // namespace
+
+int main() {
+  const size_t iters = crisp_bench::iterations(20000000U);
+  std::printf("Header classification, batches of %zu (%zu packets)\n", kBatch, iters);
+  for (const unsigned long_key_id_percent : {0U, 10U, 100U}) {
+    bench_classify(long_key_id_percent, iters);
+  }
+  return 0;
+}
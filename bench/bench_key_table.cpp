@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "crisp/core/key_table.h"
+}
+
+#include "bench_util.h"
+
+namespace {
+
+struct alignas(CRISP_KEY_TABLE_STORAGE_ALIGN) StorageLine {
+  uint8_t bytes[CRISP_KEY_TABLE_STORAGE_ALIGN];
+};
+
+std::vector<std::string> make_key_ids(size_t count, size_t size, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::string> key_ids(count, std::string(size, '\0'));
+  for (std::string& key_id : key_ids) {
+    for (char& byte : key_id) {
+      byte = static_cast<char>(rng());
+    }
+  }
+  return key_ids;
+}
+
+crisp_const_byte_span_t span_of(const std::string& key_id) {
+  return {reinterpret_cast<const uint8_t*>(key_id.data()), key_id.size()};
+}
+
+/**
+ * Random-order lookups over `sessions` KeyIds: the built-in table (hits, and misses answered
+ * by the negative cache) against a mutex-protected std::unordered_map, the usual resolver.
+ */
+void bench_lookup(size_t sessions, size_t key_id_size, size_t iters) {
+  const std::vector<std::string> key_ids = make_key_ids(sessions, key_id_size, sessions);
+  const std::vector<std::string> garbage = make_key_ids(4096U, key_id_size, ~sessions);
+  // Queries are copied out in lookup order, as KeyIds arrive in packet buffers, so only the
+  // table itself is accessed at random.
+  std::vector<std::string> queries(iters);
+  std::mt19937 rng(7U);
+  for (std::string& query : queries) {
+    query = key_ids[rng() % sessions];
+  }
+
+  crisp_key_table_reader_t reader{};
+  crisp_key_table_config_t config{};
+  config.capacity = sessions;
+  config.negative_cache_slots = 8192U;
+  config.seed = 0x9E3779B97F4A7C15ULL;
+  config.readers = &reader;
+  config.reader_count = 1U;
+  const size_t storage_size = crisp_key_table_storage_size(&config);
+  std::vector<StorageLine> storage(storage_size / sizeof(StorageLine) + 1U);
+  crisp_key_table_t table{};
+  if (crisp_key_table_init(&table, &config, storage.data(), storage_size) != CRISP_OK) {
+    std::fprintf(stderr, "key table init failed\n");
+    std::exit(1);
+  }
+  std::unordered_map<std::string, const void*> map;
+  std::mutex mutex;
+  for (const std::string& key_id : key_ids) {
+    (void)crisp_key_table_insert(&table, span_of(key_id), &key_id);
+    map.emplace(key_id, &key_id);
+  }
+  for (const std::string& key_id : garbage) {
+    crisp_key_table_negative_insert(&table, span_of(key_id));
+  }
+
+  const std::string label = "sessions=" + std::to_string(sessions) +
+                            " keyid=" + std::to_string(key_id_size) + " (" +
+                            std::to_string(storage_size >> 20U) + " MiB)";
+  double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    crisp_key_table_read_begin(&table, &reader);
+    const void* value = crisp_key_table_lookup(&table, span_of(queries[i]));
+    crisp_key_table_read_end(&reader);
+    crisp_bench::do_not_optimize(value);
+  });
+  crisp_bench::report_rate("table hit     " + label, iters, seconds, "op");
+
+  seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    const std::string& key_id = garbage[i % garbage.size()];
+    crisp_key_table_read_begin(&table, &reader);
+    const void* value = crisp_key_table_lookup(&table, span_of(key_id));
+    crisp_key_table_read_end(&reader);
+    const bool unknown =
+        value == nullptr && crisp_key_table_negative_contains(&table, span_of(key_id));
+    crisp_bench::do_not_optimize(unknown);
+  });
+  crisp_bench::report_rate("table miss    " + label, iters, seconds, "op");
+
+  seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const auto it = map.find(queries[i]);
+    const void* value = it == map.end() ? nullptr : it->second;
+    crisp_bench::do_not_optimize(value);
+  });
+  crisp_bench::report_rate("mutex+map hit " + label, iters, seconds, "op");
+}
+
+}  // namespace
+
+int main() {
+  const size_t iters = crisp_bench::iterations(2000000U);
+  std::printf("KeyId lookup, random order (%zu lookups)\n", iters);
+  for (const size_t sessions : {1024U, 65536U, 1048576U}) {
+    for (const size_t key_id_size : {8U, 32U}) {
+      bench_lookup(sessions, key_id_size, iters);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include <array>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "crisp/core/cpu.h"
+#include "crisp/crypto/magma_backend.h"
+}
+
+#include "bench_util.h"
+
+namespace {
+
+struct Fixture {
+  crisp_crypto_iface_t iface{};
+  crisp_crypto_keys_t keys{};
+  std::array<uint8_t, CRISP_MAGMA_KEY_SIZE> key{};
+
+  explicit Fixture(crisp_magma_engine_t engine = CRISP_MAGMA_ENGINE_AUTO) {
+    (void)crisp_magma_crypto_iface_init_engine(&iface, engine);
+    for (size_t i = 0; i < key.size(); ++i) {
+      key[i] = static_cast<uint8_t>(0xA5U ^ i);
+    }
+    (void)crisp_crypto_keys_init(&keys, &iface, {key.data(), key.size()}, {key.data(), key.size()});
+  }
+  ~Fixture() { crisp_crypto_keys_release(&keys); }
+  Fixture(const Fixture&) = delete;
+  Fixture& operator=(const Fixture&) = delete;
+};
+
+template <typename Body>
+void run(const std::string& name, size_t size, size_t iters, Body&& body) {
+  const uint64_t c0 = crisp_bench::cycles_now();
+  const double seconds = crisp_bench::time_seconds(iters, body);
+  const uint64_t c1 = crisp_bench::cycles_now();
+  crisp_bench::report_bytes(name, size * iters, seconds, c1 - c0);
+}
+
+void bench_size(Fixture& fx, size_t size, size_t iters) {
+  std::vector<uint8_t> in(size, 0x3CU);
+  std::vector<uint8_t> out(size);
+  std::array<uint8_t, 8> icv{};
+
+  run("ctr  keyed  " + std::to_string(size) + "B", size, iters, [&](size_t i) {
+    (void)crisp_crypto_ctr_xcrypt(&fx.keys, static_cast<uint32_t>(i), {in.data(), in.size()},
+                                  {out.data(), out.size()});
+    crisp_bench::do_not_optimize(out[0]);
+  });
+  run("ctr  raw    " + std::to_string(size) + "B", size, iters, [&](size_t i) {
+    (void)fx.iface.magma_ctr_xcrypt(fx.iface.user_ctx, {fx.key.data(), fx.key.size()},
+                                    static_cast<uint32_t>(i), {in.data(), in.size()},
+                                    {out.data(), out.size()});
+    crisp_bench::do_not_optimize(out[0]);
+  });
+  run("cmac keyed  " + std::to_string(size) + "B", size, iters, [&](size_t) {
+    (void)crisp_crypto_cmac(&fx.keys, {in.data(), in.size()}, {icv.data(), icv.size()});
+    crisp_bench::do_not_optimize(icv);
+  });
+  run("cmac raw    " + std::to_string(size) + "B", size, iters, [&](size_t) {
+    (void)fx.iface.magma_cmac(fx.iface.user_ctx, {fx.key.data(), fx.key.size()},
+                              {in.data(), in.size()}, {icv.data(), icv.size()});
+    crisp_bench::do_not_optimize(icv);
+  });
+}
+
+/** 64 independent packets per call, as fed by the batch protect/unprotect paths. */
+void bench_batch(const char* engine_name, Fixture& fx, size_t size, size_t iters) {
+  constexpr size_t kBatch = 64U;
+  std::vector<std::vector<uint8_t>> in(kBatch, std::vector<uint8_t>(size, 0x3CU));
+  std::vector<std::vector<uint8_t>> out(kBatch, std::vector<uint8_t>(size));
+  std::vector<std::array<uint8_t, 8>> icvs(kBatch);
+  std::vector<crisp_magma_ctr_job_t> ctr_jobs(kBatch);
+  std::vector<crisp_magma_cmac_job_t> cmac_jobs(kBatch);
+  for (size_t j = 0U; j < kBatch; ++j) {
+    ctr_jobs[j] = {static_cast<uint32_t>(j), {in[j].data(), size}, {out[j].data(), size}};
+    cmac_jobs[j] = {{in[j].data(), size}, {icvs[j].data(), icvs[j].size()}};
+  }
+
+  const std::string suffix = std::string(engine_name) + " x64 " + std::to_string(size) + "B";
+  run("ctr  batch " + suffix, size * kBatch, iters, [&](size_t) {
+    (void)crisp_crypto_ctr_xcrypt_batch(&fx.keys, ctr_jobs.data(), kBatch);
+    crisp_bench::do_not_optimize(out[0][0]);
+  });
+  run("cmac batch " + suffix, size * kBatch, iters, [&](size_t) {
+    (void)crisp_crypto_cmac_batch(&fx.keys, cmac_jobs.data(), kBatch);
+    crisp_bench::do_not_optimize(icvs[0]);
+  });
+}
+
+}  // namespace
+
+int main() {
+  const size_t bytes_budget = crisp_bench::iterations(64U << 20U);
+  Fixture fx;
+  std::printf("Magma backend throughput (%zu bytes per case, cpu level %s)\n", bytes_budget,
+              crisp_cpu_level_name(crisp_cpu_active_level()));
+  for (const size_t size : {16U, 64U, 256U, 1500U, 8192U}) {
+    bench_size(fx, size, bytes_budget / size + 1U);
+  }
+
+  const std::array<std::pair<crisp_magma_engine_t, const char*>, 3> engines{{
+      {CRISP_MAGMA_ENGINE_SCALAR, "scalar"},
+      {CRISP_MAGMA_ENGINE_AVX2, "avx2"},
+      {CRISP_MAGMA_ENGINE_AVX512, "avx512"},
+  }};
+  for (const auto& [engine, engine_name] : engines) {
+    if (!crisp_magma_engine_supported(engine)) {
+      std::printf("engine %s: not supported on this CPU\n", engine_name);
+      continue;
+    }
+    Fixture batch_fx(engine);
+    for (const size_t size : {64U, 256U, 1500U}) {
+      bench_batch(engine_name, batch_fx, size, bytes_budget / (size * 64U) + 1U);
+    }
+  }
+  return 0;
+}
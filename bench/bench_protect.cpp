@@ -0,0 +1,504 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "crisp/core/message.h"
+#include "crisp/core/session.h"
+#include "crisp/crypto/dummy_backend.h"
+#include "crisp/crypto/magma_backend.h"
+}
+
+#include "bench_util.h"
+
+namespace {
+
+constexpr size_t kBatchSize = 32U;
+
+struct Fixture {
+  crisp_dummy_crypto_state_t state{0x0123456789ABCDEFULL};
+  crisp_crypto_iface_t iface{};
+  std::array<uint8_t, 32> kenc{};
+  std::array<uint8_t, 32> kmac{};
+  std::array<uint8_t, 2> key_id{0x81U, 0x42U};
+  std::vector<uint8_t> payload;
+  std::vector<std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE>> packets;
+
+  explicit Fixture(size_t payload_size) : payload(payload_size, 0x5AU), packets(kBatchSize) {
+    crisp_dummy_crypto_iface_init(&iface, &state);
+    for (size_t i = 0; i < kenc.size(); ++i) {
+      kenc[i] = static_cast<uint8_t>(i);
+      kmac[i] = static_cast<uint8_t>(0xFFU - i);
+    }
+  }
+};
+
+void bench_single(uint8_t cs, size_t payload_size, size_t iters) {
+  Fixture fx(payload_size);
+  crisp_protect_params_t params{};
+  params.cs = cs;
+  params.key_id_present = true;
+  params.key_id = {fx.key_id.data(), fx.key_id.size()};
+  params.payload = {fx.payload.data(), fx.payload.size()};
+  params.kenc = {fx.kenc.data(), fx.kenc.size()};
+  params.kmac = {fx.kmac.data(), fx.kmac.size()};
+  params.crypto = &fx.iface;
+
+  size_t written = 0U;
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    params.seqnum = i;
+    auto& packet = fx.packets[i % kBatchSize];
+    (void)crisp_protect(&params, {packet.data(), packet.size()}, &written);
+    crisp_bench::do_not_optimize(written);
+  });
+
+  const std::string name = "protect single  cs=" + std::to_string(cs) +
+                           " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, iters, seconds, "pkt");
+}
+
+/** Same packets as bench_single(), with header, keys and SeqNum prepared once in a session. */
+void bench_session(uint8_t cs, size_t payload_size, size_t iters) {
+  Fixture fx(payload_size);
+  crisp_session_config_t config{};
+  config.cs = cs;
+  config.key_id_present = true;
+  config.key_id = {fx.key_id.data(), fx.key_id.size()};
+  config.kenc = {fx.kenc.data(), fx.kenc.size()};
+  config.kmac = {fx.kmac.data(), fx.kmac.size()};
+  config.crypto = &fx.iface;
+  crisp_session_t session{};
+  (void)crisp_session_init(&session, &config);
+
+  size_t written = 0U;
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    auto& packet = fx.packets[i % kBatchSize];
+    (void)crisp_session_protect(&session, {fx.payload.data(), fx.payload.size()},
+                                {packet.data(), packet.size()}, &written, nullptr);
+    crisp_bench::do_not_optimize(written);
+  });
+  crisp_session_clear(&session);
+
+  const std::string name = "protect session cs=" + std::to_string(cs) +
+                           " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, iters, seconds, "pkt");
+}
+
+/** bench_session() with the payload already in the packet buffers, protected in place. */
+void bench_session_in_place(uint8_t cs, size_t payload_size, size_t iters) {
+  Fixture fx(payload_size);
+  crisp_session_config_t config{};
+  config.cs = cs;
+  config.key_id_present = true;
+  config.key_id = {fx.key_id.data(), fx.key_id.size()};
+  config.kenc = {fx.kenc.data(), fx.kenc.size()};
+  config.kmac = {fx.kmac.data(), fx.kmac.size()};
+  config.crypto = &fx.iface;
+  crisp_session_t session{};
+  (void)crisp_session_init(&session, &config);
+  const size_t payload_offset = crisp_session_headroom(&session);
+  for (auto& packet : fx.packets) {
+    std::copy(fx.payload.begin(), fx.payload.end(), packet.begin() + payload_offset);
+  }
+
+  crisp_mutable_byte_span_t out{};
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    auto& packet = fx.packets[i % kBatchSize];
+    (void)crisp_session_protect_in_place(&session, i, {packet.data(), packet.size()},
+                                         payload_offset, payload_size, &out);
+    crisp_bench::do_not_optimize(out);
+  });
+  crisp_session_clear(&session);
+
+  const std::string name = "protect in-place cs=" + std::to_string(cs) +
+                           " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, iters, seconds, "pkt");
+}
+
+/**
+ * Session protect+unprotect roundtrip, through separate plaintext/packet buffers or entirely
+ * inside one packet buffer.
+ */
+void bench_session_roundtrip(bool in_place, uint8_t cs, size_t payload_size, size_t iters) {
+  Fixture fx(payload_size);
+  crisp_session_config_t config{};
+  config.cs = cs;
+  config.key_id_present = true;
+  config.key_id = {fx.key_id.data(), fx.key_id.size()};
+  config.kenc = {fx.kenc.data(), fx.kenc.size()};
+  config.kmac = {fx.kmac.data(), fx.kmac.size()};
+  config.crypto = &fx.iface;
+  crisp_session_t session{};
+  (void)crisp_session_init(&session, &config);
+  const size_t payload_offset = crisp_session_headroom(&session);
+  auto& buffer = fx.packets[0];
+  std::copy(fx.payload.begin(), fx.payload.end(), buffer.begin() + payload_offset);
+  std::vector<uint8_t> plaintext(payload_size);
+  crisp_unprotect_result_t result{};
+
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    if (in_place) {
+      crisp_mutable_byte_span_t packet{};
+      crisp_const_byte_span_t opened{};
+      (void)crisp_session_protect_in_place(&session, i, {buffer.data(), buffer.size()},
+                                           payload_offset, payload_size, &packet);
+      (void)crisp_session_unprotect_in_place(&session, packet, &opened, &result);
+    } else {
+      size_t written = 0U;
+      (void)crisp_session_protect_seqnum(&session, i, {fx.payload.data(), fx.payload.size()},
+                                         {buffer.data(), buffer.size()}, &written);
+      (void)crisp_session_unprotect(&session, {buffer.data(), written},
+                                    {plaintext.data(), plaintext.size()}, &result);
+    }
+    crisp_bench::do_not_optimize(result);
+  });
+  crisp_session_clear(&session);
+
+  const std::string name = std::string("roundtrip ") + (in_place ? "in-place" : "copy    ") +
+                           " cs=" + std::to_string(cs) + " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, iters, seconds, "pkt");
+}
+
+void bench_batch(uint8_t cs, size_t payload_size, size_t iters) {
+  Fixture fx(payload_size);
+  crisp_protect_batch_params_t params{};
+  params.cs = cs;
+  params.key_id_present = true;
+  params.key_id = {fx.key_id.data(), fx.key_id.size()};
+  params.kenc = {fx.kenc.data(), fx.kenc.size()};
+  params.kmac = {fx.kmac.data(), fx.kmac.size()};
+  params.crypto = &fx.iface;
+
+  std::array<uint64_t, kBatchSize> seqnums{};
+  std::array<crisp_const_byte_span_t, kBatchSize> payloads{};
+  std::array<crisp_mutable_byte_span_t, kBatchSize> out_packets{};
+  std::array<size_t, kBatchSize> sizes{};
+  std::array<crisp_error_t, kBatchSize> status{};
+  for (size_t i = 0; i < kBatchSize; ++i) {
+    payloads[i] = {fx.payload.data(), fx.payload.size()};
+    out_packets[i] = {fx.packets[i].data(), fx.packets[i].size()};
+  }
+
+  const size_t batches = iters / kBatchSize;
+  const double seconds = crisp_bench::time_seconds(batches, [&](size_t b) {
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      seqnums[i] = b * kBatchSize + i;
+    }
+    (void)crisp_protect_batch(&params, seqnums.data(), payloads.data(), out_packets.data(),
+                              sizes.data(), status.data(), kBatchSize);
+    crisp_bench::do_not_optimize(sizes);
+  });
+
+  const std::string name = "protect batch32 cs=" + std::to_string(cs) +
+                           " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, batches * kBatchSize, seconds, "pkt");
+}
+
+crisp_error_t bench_resolve_prepared_keys(void* user_ctx,
+                                          const crisp_key_resolve_request_t* request,
+                                          const crisp_crypto_keys_t** out_keys) {
+  crisp_bench::do_not_optimize(request->seqnum);
+  *out_keys = static_cast<const crisp_crypto_keys_t*>(user_ctx);
+  return CRISP_OK;
+}
+
+/**
+ * RX with key lookup by KeyId (dummy backend, prepared keys): parsing for the resolver and
+ * again inside crisp_unprotect(), the pre-staged flow, vs crisp_unprotect_resolve(), which
+ * parses once and hands the view to crisp_unprotect_view().
+ */
+void bench_resolve(bool staged, size_t payload_size, size_t iters) {
+  Fixture fx(payload_size);
+  crisp_crypto_keys_t keys{};
+  (void)crisp_crypto_keys_init(&keys, &fx.iface, {fx.kenc.data(), fx.kenc.size()},
+                               {fx.kmac.data(), fx.kmac.size()});
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.key_id_present = true;
+  protect.key_id = {fx.key_id.data(), fx.key_id.size()};
+  protect.payload = {fx.payload.data(), fx.payload.size()};
+  protect.keys = &keys;
+  std::array<size_t, kBatchSize> sizes{};
+  for (size_t i = 0; i < kBatchSize; ++i) {
+    protect.seqnum = i;
+    (void)crisp_protect(&protect, {fx.packets[i].data(), fx.packets[i].size()}, &sizes[i]);
+  }
+
+  crisp_key_resolver_t resolver{};
+  resolver.user_ctx = &keys;
+  resolver.resolve_prepared_keys = bench_resolve_prepared_keys;
+  crisp_bench::do_not_optimize(resolver);
+  std::vector<uint8_t> plaintext(payload_size);
+  crisp_unprotect_result_t result{};
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    const crisp_const_byte_span_t packet = {fx.packets[i % kBatchSize].data(),
+                                            sizes[i % kBatchSize]};
+    const crisp_mutable_byte_span_t out = {plaintext.data(), plaintext.size()};
+    if (staged) {
+      (void)crisp_unprotect_resolve(packet, &resolver, &fx.iface, nullptr, out, &result);
+    } else {
+      crisp_message_view_t view{};
+      (void)crisp_parse_message(packet, &view);
+      const crisp_key_resolve_request_t request = {view.external_key_id_flag, view.cs,
+                                                   view.key_id_present, view.key_id, view.seqnum};
+      const crisp_crypto_keys_t* resolved = nullptr;
+      (void)resolver.resolve_prepared_keys(resolver.user_ctx, &request, &resolved);
+      crisp_unprotect_params_t params{};
+      params.packet = packet;
+      params.keys = resolved;
+      (void)crisp_unprotect(&params, out, &result);
+    }
+    crisp_bench::do_not_optimize(result);
+  });
+  crisp_crypto_keys_release(&keys);
+
+  const std::string name = std::string(staged ? "resolve parse-once " : "resolve parse-twice") +
+                           " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, iters, seconds, "pkt");
+}
+
+/** crisp_unprotect_parse() alone: the per-packet work the parse-once flow no longer repeats. */
+void bench_parse(size_t payload_size, size_t iters) {
+  Fixture fx(payload_size);
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.key_id_present = true;
+  protect.key_id = {fx.key_id.data(), fx.key_id.size()};
+  protect.payload = {fx.payload.data(), fx.payload.size()};
+  protect.kenc = {fx.kenc.data(), fx.kenc.size()};
+  protect.kmac = {fx.kmac.data(), fx.kmac.size()};
+  protect.crypto = &fx.iface;
+  size_t size = 0U;
+  (void)crisp_protect(&protect, {fx.packets[0].data(), fx.packets[0].size()}, &size);
+
+  crisp_parsed_message_t message{};
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t) {
+    (void)crisp_unprotect_parse({fx.packets[0].data(), size}, &message);
+    crisp_bench::do_not_optimize(message);
+  });
+  crisp_bench::report_rate("parse only          payload=" + std::to_string(payload_size), iters,
+                           seconds, "pkt");
+}
+
+/** Magma protect+unprotect roundtrip with and without the fused CTR/CMAC ops. */
+void bench_magma_roundtrip(bool fused, size_t payload_size, size_t iters) {
+  crisp_crypto_iface_t iface{};
+  crisp_magma_crypto_iface_init(&iface);
+  if (!fused) {
+    iface.magma_ctr_then_cmac = nullptr;
+    iface.magma_cmac_then_ctr = nullptr;
+  }
+  Fixture fx(payload_size);
+  crisp_crypto_keys_t keys{};
+  (void)crisp_crypto_keys_init(&keys, &iface, {fx.kenc.data(), fx.kenc.size()},
+                               {fx.kmac.data(), fx.kmac.size()});
+
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.key_id_present = true;
+  protect.key_id = {fx.key_id.data(), fx.key_id.size()};
+  protect.payload = {fx.payload.data(), fx.payload.size()};
+  protect.keys = &keys;
+  crisp_unprotect_params_t unprotect{};
+  unprotect.keys = &keys;
+  std::vector<uint8_t> plaintext(payload_size);
+  crisp_unprotect_result_t result{};
+
+  size_t written = 0U;
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    protect.seqnum = i;
+    auto& packet = fx.packets[i % kBatchSize];
+    (void)crisp_protect(&protect, {packet.data(), packet.size()}, &written);
+    unprotect.packet = {packet.data(), written};
+    (void)crisp_unprotect(&unprotect, {plaintext.data(), plaintext.size()}, &result);
+    crisp_bench::do_not_optimize(result);
+  });
+  crisp_crypto_keys_release(&keys);
+
+  const std::string name = std::string("magma roundtrip ") + (fused ? "fused" : "split") +
+                           " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, iters, seconds, "pkt");
+}
+
+/**
+ * Magma CS1 roundtrip of a payload in three segments (28-byte inner header, two fragments) that
+ * arrives as a packet wrapped across two ring slots: linearize with memcpy and use the
+ * contiguous calls, or hand the segments to crisp_protect_iov()/crisp_unprotect_iov().
+ */
+void bench_magma_scattered(bool iov, size_t payload_size, size_t iters) {
+  crisp_crypto_iface_t iface{};
+  crisp_magma_crypto_iface_init(&iface);
+  Fixture fx(payload_size);
+  crisp_crypto_keys_t keys{};
+  (void)crisp_crypto_keys_init(&keys, &iface, {fx.kenc.data(), fx.kenc.size()},
+                               {fx.kmac.data(), fx.kmac.size()});
+
+  const size_t split = 28U + (payload_size - 28U) / 2U + 3U;
+  const std::array<crisp_const_byte_span_t, 3> payload_iov{
+      {{fx.payload.data(), 28U},
+       {fx.payload.data() + 28U, split - 28U},
+       {fx.payload.data() + split, payload_size - split}}};
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.key_id_present = true;
+  protect.key_id = {fx.key_id.data(), fx.key_id.size()};
+  protect.keys = &keys;
+  crisp_unprotect_params_t unprotect{};
+  unprotect.keys = &keys;
+  std::vector<uint8_t> linear(CRISP_MAX_MESSAGE_SIZE);
+  std::vector<uint8_t> plaintext(payload_size);
+  crisp_unprotect_result_t result{};
+
+  size_t written = 0U;
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t i) {
+    protect.seqnum = i;
+    auto& packet = fx.packets[i % kBatchSize];
+    if (iov) {
+      (void)crisp_protect_iov(&protect, payload_iov.data(), payload_iov.size(),
+                              {packet.data(), packet.size()}, &written);
+      const size_t wrap = written / 2U;
+      const std::array<crisp_const_byte_span_t, 2> packet_iov{
+          {{packet.data(), wrap}, {packet.data() + wrap, written - wrap}}};
+      (void)crisp_unprotect_iov(&unprotect, packet_iov.data(), packet_iov.size(),
+                                {plaintext.data(), plaintext.size()}, &result);
+    } else {
+      size_t offset = 0U;
+      for (const crisp_const_byte_span_t& segment : payload_iov) {
+        std::copy(segment.data, segment.data + segment.size, linear.data() + offset);
+        offset += segment.size;
+      }
+      protect.payload = {linear.data(), offset};
+      (void)crisp_protect(&protect, {packet.data(), packet.size()}, &written);
+      const size_t wrap = written / 2U;
+      std::copy(packet.data(), packet.data() + wrap, linear.data());
+      std::copy(packet.data() + wrap, packet.data() + written, linear.data() + wrap);
+      unprotect.packet = {linear.data(), written};
+      (void)crisp_unprotect(&unprotect, {plaintext.data(), plaintext.size()}, &result);
+    }
+    crisp_bench::do_not_optimize(result);
+  });
+  crisp_crypto_keys_release(&keys);
+
+  const std::string name = std::string("magma scattered ") + (iov ? "iov      " : "linearize") +
+                           " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, iters, seconds, "pkt");
+}
+
+/**
+ * Ships one `kStreamSize` buffer per iteration at `mtu`: slice it and call
+ * crisp_session_protect() per packet, or hand it to crisp_session_protect_stream().
+ */
+void bench_stream(bool magma, bool stream, size_t mtu, size_t iters) {
+  constexpr size_t kStreamSize = size_t{1} << 20U;
+  crisp_dummy_crypto_state_t state{0x0123456789ABCDEFULL};
+  crisp_crypto_iface_t iface{};
+  if (magma) {
+    crisp_magma_crypto_iface_init(&iface);
+  } else {
+    crisp_dummy_crypto_iface_init(&iface, &state);
+  }
+  Fixture fx(kStreamSize);
+  crisp_session_config_t config{};
+  config.cs = CRISP_SUITE_CS1;
+  config.key_id_present = true;
+  config.key_id = {fx.key_id.data(), fx.key_id.size()};
+  config.kenc = {fx.kenc.data(), fx.kenc.size()};
+  config.kmac = {fx.kmac.data(), fx.kmac.size()};
+  config.crypto = &iface;
+  crisp_session_t session{};
+  (void)crisp_session_init(&session, &config);
+
+  crisp_stream_layout_t layout{};
+  (void)crisp_session_stream_layout(&session, kStreamSize, mtu, &layout);
+  std::vector<uint8_t> arena(layout.arena_size);
+  std::vector<crisp_mutable_byte_span_t> packets(layout.packet_count);
+  const size_t overhead = crisp_session_headroom(&session) + session.suite_params.icv_size;
+
+  const uint64_t start_cycles = crisp_bench::cycles_now();
+  const double seconds = crisp_bench::time_seconds(iters, [&](size_t) {
+    size_t count = 0U;
+    if (stream) {
+      (void)crisp_session_protect_stream(&session, {fx.payload.data(), fx.payload.size()}, mtu,
+                                         {arena.data(), arena.size()}, packets.data(),
+                                         packets.size(), &count, nullptr);
+    } else {
+      uint8_t* out = arena.data();
+      for (size_t offset = 0U; offset < kStreamSize; offset += layout.segment_size) {
+        const size_t segment = std::min(layout.segment_size, kStreamSize - offset);
+        size_t written = 0U;
+        (void)crisp_session_protect(&session, {fx.payload.data() + offset, segment},
+                                    {out, segment + overhead}, &written, nullptr);
+        out += written;
+        ++count;
+      }
+    }
+    crisp_bench::do_not_optimize(count);
+  });
+  const uint64_t cycles = crisp_bench::cycles_now() - start_cycles;
+  crisp_session_clear(&session);
+
+  const std::string name = std::string(magma ? "magma " : "dummy ") +
+                           (stream ? "protect_stream" : "protect loop  ") +
+                           " mtu=" + std::to_string(mtu);
+  crisp_bench::report_bytes(name, iters * kStreamSize, seconds, cycles);
+}
+
+}  // namespace
+
+int main() {
+  const size_t iters = crisp_bench::iterations(200000U);
+  std::printf(
+      "crisp_protect vs session (copy, in place) vs crisp_protect_batch (dummy backend, %zu "
+      "packets)\n",
+      iters);
+  for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1), static_cast<uint8_t>(CRISP_SUITE_CS2)}) {
+    for (const size_t payload_size : {16U, 64U, 256U, 1200U}) {
+      bench_single(cs, payload_size, iters);
+      bench_session(cs, payload_size, iters);
+      bench_session_in_place(cs, payload_size, iters);
+      bench_batch(cs, payload_size, iters);
+    }
+  }
+
+  std::printf("Session protect+unprotect, copy vs in place (dummy backend, %zu packets)\n", iters);
+  for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1), static_cast<uint8_t>(CRISP_SUITE_CS2)}) {
+    for (const size_t payload_size : {64U, 1200U}) {
+      bench_session_roundtrip(false, cs, payload_size, iters);
+      bench_session_roundtrip(true, cs, payload_size, iters);
+    }
+  }
+
+  std::printf("Unprotect with KeyId resolution, CS1 (dummy backend, %zu packets)\n", iters);
+  for (const size_t payload_size : {16U, 64U, 256U}) {
+    bench_parse(payload_size, iters);
+    bench_resolve(false, payload_size, iters);
+    bench_resolve(true, payload_size, iters);
+  }
+
+  const size_t magma_iters = iters / 16U + 1U;
+  std::printf("Magma CS1 protect+unprotect, fused vs split CTR/CMAC (%zu packets)\n", magma_iters);
+  for (const size_t payload_size : {64U, 256U, 1200U}) {
+    bench_magma_roundtrip(false, payload_size, magma_iters);
+    bench_magma_roundtrip(true, payload_size, magma_iters);
+  }
+
+  std::printf("Magma CS1 scattered roundtrip, linearize vs iovec (%zu packets)\n", magma_iters);
+  for (const size_t payload_size : {64U, 256U, 1200U}) {
+    bench_magma_scattered(false, payload_size, magma_iters);
+    bench_magma_scattered(true, payload_size, magma_iters);
+  }
+
+  const size_t stream_iters = iters / 200U + 1U;
+  std::printf("1 MiB buffer to CS1 packets, loop vs stream (%zu buffers, magma %zu)\n",
+              stream_iters, stream_iters / 16U + 1U);
+  for (const size_t mtu : {1400U, 2048U}) {
+    for (const bool magma : {false, true}) {
+      const size_t buffers = magma ? stream_iters / 16U + 1U : stream_iters;
+      bench_stream(magma, false, mtu, buffers);
+      bench_stream(magma, true, mtu, buffers);
+    }
+  }
+  return 0;
+}
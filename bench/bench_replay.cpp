@@ -0,0 +1,137 @@
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "crisp/core/replay_window.h"
+}
+
+#include "bench_util.h"
+
+namespace {
+
+/** In-order: every packet advances max_seq by one. */
+std::vector<uint64_t> make_in_order(size_t count) {
+  std::vector<uint64_t> seqnums(count);
+  for (size_t i = 0U; i < count; ++i) {
+    seqnums[i] = i + 1U;
+  }
+  return seqnums;
+}
+
+/** Reordered: in-order stream shuffled within blocks of `span` packets (all inside the window). */
+std::vector<uint64_t> make_reordered(size_t count, size_t span) {
+  std::vector<uint64_t> seqnums = make_in_order(count);
+  std::mt19937_64 rng(42U);
+  for (size_t start = 0U; start < count; start += span) {
+    const size_t end = start + span < count ? start + span : count;
+    for (size_t i = end - 1U; i > start; --i) {
+      const size_t j = start + static_cast<size_t>(rng() % (i - start + 1U));
+      std::swap(seqnums[i], seqnums[j]);
+    }
+  }
+  return seqnums;
+}
+
+/** Jump: max_seq advances by `stride` (more than the window) on every packet. */
+std::vector<uint64_t> make_jumps(size_t count, uint64_t stride) {
+  std::vector<uint64_t> seqnums(count);
+  for (size_t i = 0U; i < count; ++i) {
+    seqnums[i] = (i + 1U) * stride;
+  }
+  return seqnums;
+}
+
+void bench_pattern(const std::string& pattern, size_t window_size, const std::vector<uint64_t>& seqnums) {
+  crisp_replay_window_t window{};
+  std::vector<uint64_t> storage;
+  if (window_size <= CRISP_REPLAY_WINDOW_MAX_SIZE) {
+    (void)crisp_replay_window_init(&window, window_size);
+  } else {
+    storage.resize(crisp_replay_window_storage_words(window_size));
+    (void)crisp_replay_window_init_with_storage(&window, window_size, storage.data(),
+                                                storage.size());
+  }
+  bool accepted = false;
+  const double seconds = crisp_bench::time_seconds(seqnums.size(), [&](size_t i) {
+    (void)crisp_replay_window_check_and_update(&window, seqnums[i], &accepted);
+    crisp_bench::do_not_optimize(accepted);
+  });
+
+  const std::string name = "replay " + pattern + " window=" + std::to_string(window_size);
+  crisp_bench::report_rate(name, seqnums.size(), seconds, "pkt");
+}
+
+/**
+ * `threads` RX threads share one session: thread t checks SeqNums t, t + threads, ... in order,
+ * so the threads interleave like packets spread over NIC queues.
+ */
+template <typename Check>
+double run_threads(size_t threads, size_t per_thread, Check&& check) {
+  std::vector<std::thread> workers;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0U; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      for (size_t k = 0U; k < per_thread; ++k) {
+        crisp_bench::do_not_optimize(check(static_cast<uint64_t>(k * threads + t + 1U)));
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+void bench_shared(size_t threads, size_t per_thread) {
+  constexpr size_t kWindow = 4096U;
+  {
+    std::vector<uint64_t> storage(crisp_replay_window_storage_words(kWindow));
+    crisp_replay_window_t window{};
+    (void)crisp_replay_window_init_with_storage(&window, kWindow, storage.data(), storage.size());
+    std::mutex lock;
+    const double seconds = run_threads(threads, per_thread, [&](uint64_t seqnum) {
+      const std::lock_guard<std::mutex> guard(lock);
+      bool accepted = false;
+      (void)crisp_replay_window_check_and_update(&window, seqnum, &accepted);
+      return accepted;
+    });
+    crisp_bench::report_rate("replay mutex      threads=" + std::to_string(threads),
+                             threads * per_thread, seconds, "pkt");
+  }
+  {
+    std::vector<uint64_t> storage(crisp_concurrent_replay_window_storage_words(kWindow));
+    crisp_concurrent_replay_window_t window{};
+    (void)crisp_concurrent_replay_window_init(&window, kWindow, storage.data(), storage.size());
+    const double seconds = run_threads(threads, per_thread, [&](uint64_t seqnum) {
+      bool accepted = false;
+      (void)crisp_concurrent_replay_window_check_and_update(&window, seqnum, &accepted);
+      return accepted;
+    });
+    crisp_bench::report_rate("replay lock-free  threads=" + std::to_string(threads),
+                             threads * per_thread, seconds, "pkt");
+  }
+}
+
+}  // namespace
+
+int main() {
+  const size_t iters = crisp_bench::iterations(2000000U);
+  std::printf("crisp_replay_window_check_and_update per-packet cost (%zu packets)\n", iters);
+  const std::vector<uint64_t> in_order = make_in_order(iters);
+  for (const size_t window_size : {64U, 256U, 4096U, 65536U}) {
+    bench_pattern("in-order ", window_size, in_order);
+    bench_pattern("reordered", window_size, make_reordered(iters, window_size / 2U));
+    bench_pattern("jump     ", window_size, make_jumps(iters, 2U * window_size));
+  }
+
+  std::printf("Shared 4096-entry window: mutex + crisp_replay_window_t vs concurrent window\n");
+  for (const size_t threads : {1U, 2U, 4U, 8U, 16U, 32U}) {
+    bench_shared(threads, iters / threads + 1U);
+  }
+  return 0;
+}
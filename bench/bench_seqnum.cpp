@@ -0,0 +1,113 @@
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "crisp/core/seqnum_allocator.h"
+#include "crisp/core/session.h"
+#include "crisp/crypto/dummy_backend.h"
+}
+
+#include "bench_util.h"
+
+namespace {
+
+/** Runs `body(thread_index)` on `threads` threads and returns elapsed seconds. */
+template <typename Body>
+double run_threads(size_t threads, Body&& body) {
+  std::vector<std::thread> workers;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0U; t < threads; ++t) {
+    workers.emplace_back([&body, t]() { body(t); });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+/** SeqNum allocation alone: one fetch-add per packet vs one per block. */
+void bench_allocator(size_t threads, size_t per_thread, uint64_t block_size) {
+  crisp_seqnum_allocator_t allocator{};
+  (void)crisp_seqnum_allocator_init(&allocator, 0U, 0U);
+  const double seconds = run_threads(threads, [&](size_t) {
+    crisp_seqnum_block_t block{};
+    uint64_t seqnum = 0U;
+    for (size_t k = 0U; k < per_thread; ++k) {
+      if (!crisp_seqnum_block_take(&block, &seqnum)) {
+        (void)crisp_seqnum_allocator_reserve(&allocator, block_size, &block);
+        (void)crisp_seqnum_block_take(&block, &seqnum);
+      }
+      crisp_bench::do_not_optimize(seqnum);
+    }
+  });
+  crisp_bench::report_rate("alloc   block=" + std::to_string(block_size) +
+                               " threads=" + std::to_string(threads),
+                           threads * per_thread, seconds, "seq");
+}
+
+/** Session TX with 64-byte payloads (dummy backend), per-packet vs block reservation. */
+void bench_session_tx(size_t threads, size_t per_thread, uint64_t block_size) {
+  crisp_dummy_crypto_state_t state{0x0123456789ABCDEFULL};
+  crisp_crypto_iface_t iface{};
+  crisp_dummy_crypto_iface_init(&iface, &state);
+  std::array<uint8_t, 32> kenc{};
+  std::array<uint8_t, 32> kmac{};
+  kenc.fill(0x11U);
+  kmac.fill(0x22U);
+  crisp_session_config_t config{};
+  config.cs = CRISP_SUITE_CS1;
+  config.kenc = {kenc.data(), kenc.size()};
+  config.kmac = {kmac.data(), kmac.size()};
+  config.crypto = &iface;
+  crisp_session_t session{};
+  (void)crisp_session_init(&session, &config);
+
+  const double seconds = run_threads(threads, [&](size_t) {
+    std::array<uint8_t, 64> payload{};
+    std::array<uint8_t, 128> packet{};
+    crisp_seqnum_block_t block{};
+    uint64_t seqnum = 0U;
+    size_t written = 0U;
+    for (size_t k = 0U; k < per_thread; ++k) {
+      if (!crisp_seqnum_block_take(&block, &seqnum)) {
+        (void)crisp_session_reserve_seqnums(&session, block_size, &block);
+        (void)crisp_seqnum_block_take(&block, &seqnum);
+      }
+      (void)crisp_session_protect_seqnum(&session, seqnum, {payload.data(), payload.size()},
+                                         {packet.data(), packet.size()}, &written);
+      crisp_bench::do_not_optimize(written);
+    }
+  });
+  crisp_session_clear(&session);
+  crisp_bench::report_rate("protect block=" + std::to_string(block_size) +
+                               " threads=" + std::to_string(threads),
+                           threads * per_thread, seconds, "pkt");
+}
+
+}  // namespace
+
+int main() {
+  const size_t iters = crisp_bench::iterations(2000000U);
+  const size_t hw = std::thread::hardware_concurrency();
+  std::printf("TX SeqNum allocation, per-packet vs block reservation (%zu per thread, %zu cpus)\n",
+              iters, hw);
+  for (const size_t threads : {1U, 2U, 4U, 8U, 16U}) {
+    for (const uint64_t block_size : {1U, 64U}) {
+      bench_allocator(threads, iters, block_size);
+    }
+  }
+
+  const size_t tx_iters = iters / 8U + 1U;
+  std::printf("Session TX, 64-byte payloads (%zu per thread)\n", tx_iters);
+  for (const size_t threads : {1U, 2U, 4U, 8U, 16U}) {
+    for (const uint64_t block_size : {1U, 64U}) {
+      bench_session_tx(threads, tx_iters, block_size);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <time.h>
+
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "crisp/crypto/dummy_backend.h"
+#include "crisp/crypto/magma_backend.h"
+#include "crisp/driver/udp.h"
+}
+
+#include "bench_util.h"
+
+namespace {
+
+struct alignas(CRISP_UDP_STORAGE_ALIGN) StorageLine {
+  uint8_t bytes[CRISP_UDP_STORAGE_ALIGN];
+};
+
+double cpu_seconds() {
+  timespec now{};
+  (void)clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+}
+
+double ns_per_packet(const crisp_udp_stage_stats_t& stage) {
+  return stage.packets > 0U ? static_cast<double>(stage.ns) / static_cast<double>(stage.packets)
+                            : 0.0;
+}
+
+/** One bound loopback driver; `ok` is false if the backend is unavailable. */
+struct Endpoint {
+  Endpoint(crisp_udp_backend_t backend, size_t batch_size) {
+    config.backend = backend;
+    auto* addr = reinterpret_cast<sockaddr_in*>(&config.local_addr);
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    config.local_addr_len = sizeof(sockaddr_in);
+    config.batch_size = batch_size;
+    config.rcvbuf_size = 4 << 20;
+    config.sndbuf_size = 4 << 20;
+    config.rx_timeout_ms = 100;
+    storage.resize(crisp_udp_driver_storage_size(&config) / sizeof(StorageLine) + 1U);
+    ok = crisp_udp_driver_init(&driver, &config,
+                               {reinterpret_cast<uint8_t*>(storage.data()),
+                                storage.size() * sizeof(StorageLine)}) == CRISP_OK &&
+         crisp_udp_driver_local_addr(&driver, &addr_out, &addr_len) == CRISP_OK;
+  }
+  ~Endpoint() { crisp_udp_driver_close(&driver); }
+  Endpoint(const Endpoint&) = delete;
+  Endpoint& operator=(const Endpoint&) = delete;
+
+  crisp_udp_config_t config{};
+  std::vector<StorageLine> storage;
+  crisp_udp_driver_t driver{};
+  sockaddr_storage addr_out{};
+  socklen_t addr_len = 0;
+  bool ok = false;
+};
+
+/**
+ * CS1 over loopback on one thread: TX bursts of `batch_size` payloads, then RX bursts until
+ * they are all back. Reports packets/s, CPU time per packet (user + system, both sides) and
+ * the driver's per-stage breakdown. The dummy backend leaves mostly socket cost.
+ */
+void bench_udp(crisp_udp_backend_t backend,
+               const char* backend_name,
+               bool magma,
+               size_t batch_size,
+               size_t payload_size,
+               size_t iters) {
+  Endpoint sender(backend, batch_size);
+  Endpoint receiver(backend, batch_size);
+  if (!sender.ok || !receiver.ok) {
+    std::printf("%s: backend unavailable, skipped\n", backend_name);
+    return;
+  }
+  (void)crisp_udp_driver_connect(&sender.driver,
+                                 reinterpret_cast<const sockaddr*>(&receiver.addr_out),
+                                 receiver.addr_len);
+  (void)crisp_udp_driver_connect(&receiver.driver,
+                                 reinterpret_cast<const sockaddr*>(&sender.addr_out),
+                                 sender.addr_len);
+
+  crisp_crypto_iface_t iface{};
+  crisp_dummy_crypto_state_t dummy_state{};
+  if (magma) {
+    crisp_magma_crypto_iface_init(&iface);
+  } else {
+    crisp_dummy_crypto_iface_init(&iface, &dummy_state);
+  }
+  std::array<uint8_t, 32> kenc{};
+  std::array<uint8_t, 32> kmac{};
+  for (size_t i = 0; i < kenc.size(); ++i) {
+    kenc[i] = static_cast<uint8_t>(i);
+    kmac[i] = static_cast<uint8_t>(0xFFU - i);
+  }
+  crisp_session_config_t config{};
+  config.cs = CRISP_SUITE_CS1;
+  config.kenc = {kenc.data(), kenc.size()};
+  config.kmac = {kmac.data(), kmac.size()};
+  config.crypto = &iface;
+  config.replay_window_size = 64U;
+  crisp_session_t tx{};
+  crisp_session_t rx{};
+  (void)crisp_session_init(&tx, &config);
+  (void)crisp_session_init(&rx, &config);
+
+  const std::vector<uint8_t> payload(payload_size, 0xA5U);
+  const std::vector<crisp_const_byte_span_t> payloads(batch_size,
+                                                      {payload.data(), payload.size()});
+  std::vector<crisp_udp_rx_packet_t> received(batch_size);
+  const size_t bursts = iters / batch_size + 1U;
+  size_t delivered = 0U;
+
+  const double cpu_start = cpu_seconds();
+  const double seconds = crisp_bench::time_seconds(bursts, [&](size_t) {
+    size_t sent = 0U;
+    (void)crisp_udp_driver_tx_burst(&sender.driver, &tx, payloads.data(), payloads.size(),
+                                    nullptr, &sent);
+    for (size_t pending = sent; pending > 0U;) {
+      size_t count = 0U;
+      if (crisp_udp_driver_rx_burst(&receiver.driver, &rx, received.data(), received.size(),
+                                    &count) != CRISP_OK ||
+          count == 0U) {
+        break;
+      }
+      pending -= count < pending ? count : pending;
+      delivered += count;
+    }
+  });
+  const double cpu = cpu_seconds() - cpu_start;
+  crisp_session_clear(&tx);
+  crisp_session_clear(&rx);
+
+  const std::string name = std::string(backend_name) + (magma ? " magma" : " dummy") +
+                           " batch=" + std::to_string(batch_size) +
+                           " payload=" + std::to_string(payload_size);
+  crisp_bench::report_rate(name, delivered, seconds, "pkt");
+  const crisp_udp_stats_t& tx_stats = sender.driver.stats;
+  const crisp_udp_stats_t& rx_stats = receiver.driver.stats;
+  std::printf("    cpu %.1f ns/pkt | protect %.1f  send %.1f  recv %.1f  unprotect %.1f ns/pkt\n",
+              delivered > 0U ? cpu * 1e9 / static_cast<double>(delivered) : 0.0,
+              ns_per_packet(tx_stats.tx_protect), ns_per_packet(tx_stats.tx_send),
+              ns_per_packet(rx_stats.rx_recv), ns_per_packet(rx_stats.rx_unprotect));
+}
+
+}  // namespace
+
+int main() {
+  const size_t iters = crisp_bench::iterations(200000U);
+  std::printf("CS1 UDP loopback, one thread TX+RX (~%zu packets per run)\n", iters);
+  for (const bool magma : {false, true}) {
+    for (const size_t payload_size : {64U, 1024U}) {
+      for (const size_t batch_size : {1U, 8U, 32U, 64U}) {
+        bench_udp(CRISP_UDP_BACKEND_MMSG, "mmsg    ", magma, batch_size, payload_size, iters);
+        bench_udp(CRISP_UDP_BACKEND_IO_URING, "io_uring", magma, batch_size, payload_size, iters);
+      }
+    }
+  }
+  return 0;
+}
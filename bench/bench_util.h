@@ -0,0 +1,79 @@
+#ifndef CRISP_BENCH_BENCH_UTIL_H_
+#define CRISP_BENCH_BENCH_UTIL_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CRISP_BENCH_HAVE_RDTSC 1
+#else
+#define CRISP_BENCH_HAVE_RDTSC 0
+#endif
+
+namespace crisp_bench {
+
+/** Prevents the optimizer from discarding a computed value. */
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const T* sink = nullptr;
+  sink = &value;
+#endif
+}
+
+/** Iteration count, overridable with CRISP_BENCH_ITERATIONS for quick CI smoke runs. */
+inline size_t iterations(size_t fallback) {
+  const char* env = std::getenv("CRISP_BENCH_ITERATIONS");
+  if (env == nullptr) {
+    return fallback;
+  }
+  const unsigned long long value = std::strtoull(env, nullptr, 10);
+  return value == 0ULL ? fallback : static_cast<size_t>(value);
+}
+
+/** Runs `body` `iters` times and returns elapsed seconds. */
+template <typename Body>
+double time_seconds(size_t iters, Body&& body) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iters; ++i) {
+    body(i);
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+/** Reference cycle counter (TSC) where available, 0 otherwise. */
+inline uint64_t cycles_now() {
+#if CRISP_BENCH_HAVE_RDTSC
+  return static_cast<uint64_t>(__rdtsc());
+#else
+  return 0U;
+#endif
+}
+
+inline void report_rate(std::string_view name, size_t items, double seconds, std::string_view unit) {
+  const double rate = seconds > 0.0 ? static_cast<double>(items) / seconds : 0.0;
+  std::printf("%-48.*s %14.0f %.*s/s  (%.1f ns/%.*s)\n", static_cast<int>(name.size()), name.data(),
+              rate, static_cast<int>(unit.size()), unit.data(),
+              items > 0U ? seconds * 1e9 / static_cast<double>(items) : 0.0,
+              static_cast<int>(unit.size()), unit.data());
+}
+
+/** Prints throughput plus cycles/byte (TSC reference cycles; 0 when no TSC is available). */
+inline void report_bytes(std::string_view name, size_t bytes, double seconds, uint64_t cycles) {
+  const double gbps = seconds > 0.0 ? static_cast<double>(bytes) / seconds / 1e9 : 0.0;
+  const double cpb = bytes > 0U ? static_cast<double>(cycles) / static_cast<double>(bytes) : 0.0;
+  std::printf("%-48.*s %8.3f GB/s  %7.2f cycles/byte\n", static_cast<int>(name.size()), name.data(),
+              gbps, cpb);
+}
+
+}  // namespace crisp_bench
+
+#endif  // CRISP_BENCH_BENCH_UTIL_H_
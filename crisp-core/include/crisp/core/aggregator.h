@@ -0,0 +1,108 @@
+#ifndef CRISP_CORE_AGGREGATOR_H_
+#define CRISP_CORE_AGGREGATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crisp/core/session.h"
+#include "crisp/core/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest length prefix of one aggregated message: 1 byte below 128, 2 bytes otherwise. */
+#define CRISP_AGGREGATE_MAX_FRAME_HEADER ((size_t)2U)
+
+/**
+ * Receives one protected packet of aggregated messages. `packet` is only valid during the
+ * call; a non-OK return is passed back to the caller of push/poll/flush.
+ */
+typedef crisp_error_t (*crisp_aggregator_emit_fn)(void* user_ctx,
+                                                  crisp_const_byte_span_t packet,
+                                                  uint64_t seqnum);
+
+/** Parameters of crisp_aggregator_init(). Times are in caller-chosen units (e.g. ns). */
+typedef struct crisp_aggregator_config {
+  crisp_session_t* session;
+  crisp_aggregator_emit_fn emit;
+  void* user_ctx;
+  /** Largest packet to emit, header and ICV included; 0 for CRISP_MAX_MESSAGE_SIZE. */
+  size_t max_packet_size;
+  /** Pending payload bytes at which a packet is sent at once; 0 (or too large) when full. */
+  size_t flush_threshold;
+  /** Age of the oldest pending message at which push/poll send the packet; 0 disables it. */
+  uint64_t flush_timeout;
+} crisp_aggregator_config_t;
+
+/**
+ * Packs small application messages into one CRISP payload per packet so they share a header,
+ * a CMAC finalization and a replay-window slot. Each message is framed by a compact length
+ * prefix (see crisp_aggregate_frame_size()) written straight into the packet buffer, which
+ * is then protected in place with crisp_session_protect_in_place().
+ * Owned by one TX thread; other threads may keep protecting on the same session unless it has
+ * a keystream pool attached (see crisp_session_config_t::keystream_pool).
+ */
+typedef struct crisp_aggregator {
+  crisp_session_t* session;
+  crisp_aggregator_emit_fn emit;
+  void* user_ctx;
+  /** Payload starts after the session header and SeqNum. */
+  size_t payload_offset;
+  /** Payload bytes one packet can carry. */
+  size_t capacity;
+  size_t flush_threshold;
+  uint64_t flush_timeout;
+  size_t pending_size;
+  size_t pending_count;
+  /** Time of the first push into the pending packet. */
+  uint64_t pending_since;
+  uint8_t packet[CRISP_MAX_MESSAGE_SIZE];
+} crisp_aggregator_t;
+
+/** Returns the framed size of a `message_size`-byte message in an aggregated payload. */
+size_t crisp_aggregate_frame_size(size_t message_size);
+
+/**
+ * Validates `config` and starts with nothing pending. The session must outlive the
+ * aggregator. CRISP_ERR_INVALID_SIZE if the packet size leaves no room for one framed byte.
+ */
+crisp_error_t crisp_aggregator_init(crisp_aggregator_t* aggregator,
+                                    const crisp_aggregator_config_t* config);
+
+/**
+ * Appends `message` to the pending packet at time `now`. The pending packet is sent first if
+ * its timeout has passed or the message does not fit, and after the append if the flush
+ * threshold is reached. CRISP_ERR_INVALID_SIZE (nothing sent) if the framed message exceeds
+ * the packet capacity. An error from protect or `emit` is returned as-is; the messages of
+ * that packet are dropped and its SeqNum is consumed.
+ */
+crisp_error_t crisp_aggregator_push(crisp_aggregator_t* aggregator,
+                                    crisp_const_byte_span_t message,
+                                    uint64_t now);
+
+/** Sends the pending packet if its oldest message is at least `flush_timeout` old at `now`. */
+crisp_error_t crisp_aggregator_poll(crisp_aggregator_t* aggregator, uint64_t now);
+
+/** Sends the pending packet, if any, regardless of timeout and threshold. */
+crisp_error_t crisp_aggregator_flush(crisp_aggregator_t* aggregator);
+
+/** Zeroizes pending plaintext and the aggregator state without sending. */
+void crisp_aggregator_clear(crisp_aggregator_t* aggregator);
+
+/**
+ * Splits an unprotected aggregated payload into its messages without copying: `out_messages`
+ * spans point into `payload`. CRISP_ERR_INVALID_FORMAT if a length prefix is truncated or runs
+ * past the payload; CRISP_ERR_BUFFER_TOO_SMALL if there are more than `max_messages`.
+ * On error `*out_count` is 0 and `out_messages` contents are unspecified.
+ */
+crisp_error_t crisp_aggregate_split(crisp_const_byte_span_t payload,
+                                    crisp_const_byte_span_t* out_messages,
+                                    size_t max_messages,
+                                    size_t* out_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_AGGREGATOR_H_
@@ -0,0 +1,59 @@
+#ifndef CRISP_CORE_CLASSIFY_H_
+#define CRISP_CORE_CLASSIFY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crisp/core/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Packets whose headers crisp_classify_batch() checks with one vector pass. */
+#define CRISP_CLASSIFY_GROUP_SIZE ((size_t)4U)
+
+/** Bits of crisp_classify_batch_out_t.flags. */
+#define CRISP_CLASSIFY_FLAG_EXTERNAL_KEY_ID ((uint8_t)0x01U)
+#define CRISP_CLASSIFY_FLAG_KEY_ID_PRESENT ((uint8_t)0x02U)
+
+/**
+ * Structure-of-arrays output of crisp_classify_batch(), one entry per packet in each array.
+ * Offsets and sizes are in bytes from the start of the packet; the ICV follows the payload and
+ * its size is given by the suite. `status` is required, every other array may be NULL when the
+ * caller does not need that field. Entries whose status is not CRISP_OK are zeroed.
+ */
+typedef struct crisp_classify_batch_out {
+  crisp_error_t* status;
+  uint8_t* cs;
+  uint8_t* flags;
+  uint64_t* seqnum;
+  /** Offset of the KeyId field (its length byte included); 0 when the KeyId is unused. */
+  uint16_t* key_id_offset;
+  /** Encoded KeyId size as in crisp_message_view_t.key_id; 0 when the KeyId is unused. */
+  uint16_t* key_id_size;
+  uint16_t* payload_offset;
+  uint16_t* payload_size;
+} crisp_classify_batch_out_t;
+
+/**
+ * Parses the headers of `count` packets without touching payloads. Results match
+ * crisp_parse_message() on each packet: the same status, and on success the same suite, flags,
+ * SeqNum, KeyId and payload bounds.
+ *
+ * Headers with a one-byte or unused KeyId, the common layouts, are validated a group of
+ * CRISP_CLASSIFY_GROUP_SIZE at a time with SIMD compares and SeqNums are read with one
+ * byte-swapped load; other packets take the scalar parser.
+ *
+ * Returns CRISP_ERR_INVALID_ARGUMENT if `packets`, `out` or `out->status` is NULL while
+ * `count` is non-zero; per-packet errors are reported only through `out->status`.
+ */
+crisp_error_t crisp_classify_batch(const crisp_const_byte_span_t* packets,
+                                   size_t count,
+                                   const crisp_classify_batch_out_t* out);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_CLASSIFY_H_
@@ -0,0 +1,54 @@
+#ifndef CRISP_CORE_CPU_H_
+#define CRISP_CORE_CPU_H_
+
+#include <stdbool.h>
+
+#include "crisp/core/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Environment variable capping the kernel level ("scalar", "sse42", "avx2", "avx512"). */
+#define CRISP_CPU_LEVEL_ENV "CRISP_CPU_LEVEL"
+
+/** Kernel levels, ordered from baseline to widest. Each level implies the previous ones. */
+typedef enum crisp_cpu_level {
+  CRISP_CPU_LEVEL_SCALAR = 0,
+  CRISP_CPU_LEVEL_SSE42,
+  CRISP_CPU_LEVEL_AVX2,
+  CRISP_CPU_LEVEL_AVX512,
+} crisp_cpu_level_t;
+
+/** Highest level supported by the running CPU and OS (x86-64 GCC/Clang builds; else scalar). */
+crisp_cpu_level_t crisp_cpu_detected_level(void);
+
+/**
+ * Level used when kernels are selected: the detected level, capped by
+ * crisp_cpu_force_level() or, when no level is forced, by CRISP_CPU_LEVEL_ENV.
+ * Unknown environment values are ignored.
+ */
+crisp_cpu_level_t crisp_cpu_active_level(void);
+
+/**
+ * Caps kernel selection at `level` for the whole process (benchmark A/B, debugging).
+ * Takes effect for core helpers immediately and for backends at their next iface init.
+ * Returns CRISP_ERR_NOT_SUPPORTED when `level` exceeds the detected level.
+ * Not thread-safe with respect to concurrent packet processing; call it during setup.
+ */
+crisp_error_t crisp_cpu_force_level(crisp_cpu_level_t level);
+
+/** Drops a level set by crisp_cpu_force_level(); CRISP_CPU_LEVEL_ENV applies again. */
+void crisp_cpu_reset_level(void);
+
+/** Parses a level name as accepted in CRISP_CPU_LEVEL_ENV. */
+bool crisp_cpu_parse_level(const char* name, crisp_cpu_level_t* out_level);
+
+/** Returns the canonical name of `level` ("unknown" for out-of-range values). */
+const char* crisp_cpu_level_name(crisp_cpu_level_t level);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_CPU_H_
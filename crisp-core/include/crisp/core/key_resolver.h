@@ -4,7 +4,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "crisp/core/key_table.h"
 #include "crisp/core/types.h"
+#include "crisp/crypto/iface.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,12 +30,33 @@ typedef crisp_error_t (*crisp_resolve_keys_fn)(void* user_ctx,
                                                crisp_const_byte_span_t* out_kenc,
                                                crisp_const_byte_span_t* out_kmac);
 
-/** Key resolver configuration for unprotect wrapper. */
+/**
+ * Resolves prepared session keys (see crisp_crypto_keys_init()) for packet metadata.
+ * The returned object must stay valid until caller finishes unprotect call.
+ */
+typedef crisp_error_t (*crisp_resolve_prepared_keys_fn)(void* user_ctx,
+                                                        const crisp_key_resolve_request_t* request,
+                                                        const crisp_crypto_keys_t** out_keys);
+
+/**
+ * Key resolver configuration for unprotect wrapper.
+ * At least one callback or a key table must be set; resolve_prepared_keys takes precedence
+ * over resolve_keys.
+ */
 typedef struct crisp_key_resolver {
   void* user_ctx;
   crisp_resolve_keys_fn resolve_keys;
+  crisp_resolve_prepared_keys_fn resolve_prepared_keys;
   /** Whether packets with unused KeyId marker (0x80) are allowed. */
   bool allow_key_id_unused;
+  /**
+   * Optional KeyId cache consulted before the callbacks; values are
+   * `const crisp_crypto_keys_t*`. KeyIds the callbacks reject with CRISP_ERR_INVALID_FORMAT
+   * are recorded in its negative cache.
+   */
+  crisp_key_table_t* key_table;
+  /** Reader record of the calling thread in `key_table`; use one resolver per RX thread. */
+  crisp_key_table_reader_t* key_table_reader;
 } crisp_key_resolver_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,166 @@
+#ifndef CRISP_CORE_KEY_TABLE_H_
+#define CRISP_CORE_KEY_TABLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crisp/core/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Slots per probe group; one group of tags is compared with a single 16-byte vector op. */
+#define CRISP_KEY_TABLE_GROUP_SIZE 16U
+
+/** Alignment required for the storage passed to crisp_key_table_init(). */
+#define CRISP_KEY_TABLE_STORAGE_ALIGN CRISP_CACHE_LINE_SIZE
+
+/**
+ * Read-side record of one reader thread. Each thread that looks up keys owns one record for
+ * the table's lifetime; records sit on their own cache line so readers never share a line.
+ * `epoch` is accessed atomically; do not touch it after init.
+ */
+typedef struct crisp_key_table_reader {
+  /** Table epoch observed at crisp_key_table_read_begin(); 0 while outside a read section. */
+  CRISP_CACHE_ALIGNED uint64_t epoch;
+} crisp_key_table_reader_t;
+
+struct crisp_key_table_entry;
+
+/**
+ * KeyId -> value map for RX key lookup with lock-free readers and a single writer.
+ *
+ * Open addressing over groups of CRISP_KEY_TABLE_GROUP_SIZE slots: a dense array of one-byte
+ * tags (7 bits of the KeyId hash, or empty/deleted) is probed a group at a time with SIMD
+ * compares, and only slots whose tag matches touch their entry, which holds the KeyId inline
+ * (up to CRISP_MAX_KEY_ID_SIZE bytes) and the value. The tag array takes one byte per slot
+ * and stays cache-resident even for millions of entries, so a hit normally costs a single
+ * miss, on the entry itself.
+ *
+ * Readers never lock or write shared lines: they bracket lookups with
+ * crisp_key_table_read_begin()/crisp_key_table_read_end() on their own reader record. The
+ * writer retires removed entries with an epoch and reuses a slot, and may free the value it
+ * pointed to, only once every reader has left the read sections that could still see it
+ * (see crisp_key_table_grace_elapsed()).
+ *
+ * An optional negative cache remembers hashes of KeyIds the slow path rejected, so floods of
+ * garbage KeyIds are dropped after one table probe instead of reaching the resolver.
+ *
+ * All storage is caller-provided; the table performs no allocation.
+ */
+typedef struct crisp_key_table {
+  uint8_t* tags;
+  struct crisp_key_table_entry* entries;
+  uint64_t* negative;
+  size_t group_mask;
+  size_t negative_mask;
+  /** Live entries plus tombstones allowed before inserts need a reusable tombstone. */
+  size_t max_used;
+  size_t used;
+  size_t live;
+  uint64_t seed;
+  crisp_key_table_reader_t* readers;
+  size_t reader_count;
+  /** Retirement epoch counter, starting at 1; accessed atomically. */
+  uint64_t epoch;
+} crisp_key_table_t;
+
+/** Sizing and reader registration, consumed by crisp_key_table_init(). */
+typedef struct crisp_key_table_config {
+  /** Number of KeyIds the table must hold at once (tombstones awaiting reuse count too). */
+  size_t capacity;
+  /** Negative cache entries, rounded up to a power of two; 0 disables the negative cache. */
+  size_t negative_cache_slots;
+  /** Hash seed; use a random value so remote peers cannot aim KeyIds at one probe chain. */
+  uint64_t seed;
+  /** One record per reader thread, in caller storage that outlives the table. */
+  crisp_key_table_reader_t* readers;
+  size_t reader_count;
+} crisp_key_table_config_t;
+
+/** Returns the storage size in bytes needed for `config`, or 0 if it is invalid. */
+size_t crisp_key_table_storage_size(const crisp_key_table_config_t* config);
+
+/**
+ * Initializes an empty table over `storage` (aligned to CRISP_KEY_TABLE_STORAGE_ALIGN and at
+ * least crisp_key_table_storage_size() bytes) and resets the reader records.
+ * Not thread-safe: publish the table to readers only after it returns.
+ */
+crisp_error_t crisp_key_table_init(crisp_key_table_t* table,
+                                   const crisp_key_table_config_t* config,
+                                   void* storage,
+                                   size_t storage_size);
+
+/**
+ * Enters a read section on `reader`, one of the records registered at init. Pointers returned
+ * by crisp_key_table_lookup() stay valid until the matching crisp_key_table_read_end().
+ * Sections must not nest; keep them short, as they hold back slot and value reuse.
+ */
+void crisp_key_table_read_begin(crisp_key_table_t* table, crisp_key_table_reader_t* reader);
+
+/** Leaves the read section entered on `reader`. */
+void crisp_key_table_read_end(crisp_key_table_reader_t* reader);
+
+/**
+ * Returns the value stored for `key_id`, or NULL if it is absent. Lock-free; call inside a
+ * read section, concurrently with the writer.
+ */
+const void* crisp_key_table_lookup(const crisp_key_table_t* table, crisp_const_byte_span_t key_id);
+
+/**
+ * Maps `key_id` (1..CRISP_MAX_KEY_ID_SIZE bytes) to `value` (non-NULL) and drops it from the
+ * negative cache. Writer only.
+ * CRISP_ERR_INVALID_ARGUMENT if the KeyId is already present; CRISP_ERR_BUFFER_TOO_SMALL if
+ * the table is at capacity and no tombstone on the probe path has passed its grace period.
+ */
+crisp_error_t crisp_key_table_insert(crisp_key_table_t* table,
+                                     crisp_const_byte_span_t key_id,
+                                     const void* value);
+
+/**
+ * Removes `key_id` and returns its value through `out_value` and the epoch it was retired at
+ * through `out_retire_epoch` (both optional). Readers may keep using the value until
+ * crisp_key_table_grace_elapsed() returns true for that epoch. Writer only.
+ * CRISP_ERR_INVALID_ARGUMENT if the KeyId is absent.
+ */
+crisp_error_t crisp_key_table_remove(crisp_key_table_t* table,
+                                     crisp_const_byte_span_t key_id,
+                                     const void** out_value,
+                                     uint64_t* out_retire_epoch);
+
+/**
+ * Returns true once no reader can still observe anything retired at `retire_epoch`, i.e. every
+ * reader is outside a read section or entered one after the retirement. Writer only.
+ */
+bool crisp_key_table_grace_elapsed(const crisp_key_table_t* table, uint64_t retire_epoch);
+
+/** Returns true if `key_id` was recorded as unknown. Lock-free; any thread. */
+bool crisp_key_table_negative_contains(const crisp_key_table_t* table,
+                                       crisp_const_byte_span_t key_id);
+
+/**
+ * Records `key_id` as unknown, evicting whichever KeyId shared its cache slot. Lock-free; any
+ * thread. A no-op without a negative cache.
+ */
+void crisp_key_table_negative_insert(crisp_key_table_t* table, crisp_const_byte_span_t key_id);
+
+/**
+ * Records `key_id` as unknown unless the table holds it by the time the record is visible.
+ * An insert racing with the slow path may clear the cache before the record lands; this looks
+ * the KeyId up again on `reader` afterwards and takes the record back on a hit, so a KeyId the
+ * writer has inserted is never left cached as unknown. Lock-free; reader threads.
+ */
+void crisp_key_table_negative_record(crisp_key_table_t* table,
+                                     crisp_key_table_reader_t* reader,
+                                     crisp_const_byte_span_t key_id);
+
+/** Forgets every negative cache entry. Any thread; concurrent records may survive. */
+void crisp_key_table_negative_clear(crisp_key_table_t* table);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_KEY_TABLE_H_
@@ -0,0 +1,90 @@
+#ifndef CRISP_CORE_KEYSTREAM_POOL_H_
+#define CRISP_CORE_KEYSTREAM_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crisp/core/types.h"
+#include "crisp/crypto/iface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of precomputed slots in one keystream pool. */
+#define CRISP_KEYSTREAM_POOL_MAX_SLOTS ((size_t)64U)
+
+/**
+ * Ring of precomputed CTR keystream for upcoming TX SeqNums of one session.
+ * Keystream depends only on Kenc and IV32 = LSB32(SeqNum), so it can be generated ahead of
+ * time (during idle polls) and consumed by protect with a single XOR.
+ * Memory is bounded by caller-provided storage: slot_count slots of slot_size bytes each.
+ * Slots are zeroized when consumed, skipped, reset or cleared.
+ * Not thread-safe: a background filler must serialize refill and protect calls (for example,
+ * with a lock held around each bounded crisp_keystream_pool_refill()).
+ */
+typedef struct crisp_keystream_pool {
+  /** Prepared keys the keystream is generated under (kenc_ctx required). */
+  const crisp_crypto_keys_t* keys;
+  /** crisp_crypto_keys_t::generation the filled slots were generated under. */
+  uint64_t generation;
+  uint8_t* storage;
+  size_t slot_size;
+  size_t slot_count;
+  /** Ring index of the oldest filled slot and number of filled slots. */
+  size_t head;
+  size_t filled;
+  /** SeqNum of the oldest filled slot; filled slots cover consecutive SeqNums. */
+  uint64_t first_seqnum;
+} crisp_keystream_pool_t;
+
+/**
+ * Initializes an empty pool that will produce keystream from `next_seqnum` onwards.
+ * storage.size / slot_size slots are used (capped at CRISP_KEYSTREAM_POOL_MAX_SLOTS);
+ * slot_size is the largest payload served from the pool, larger payloads use regular CTR.
+ * `keys` must carry a prepared Kenc context and, like `storage`, outlive the pool.
+ * Returns CRISP_ERR_INVALID_SIZE when storage cannot hold a single slot.
+ */
+crisp_error_t crisp_keystream_pool_init(crisp_keystream_pool_t* pool,
+                                        const crisp_crypto_keys_t* keys,
+                                        crisp_mutable_byte_span_t storage,
+                                        size_t slot_size,
+                                        uint64_t next_seqnum);
+
+/**
+ * Generates keystream for up to `max_slots` free slots (one CTR batch call) for the SeqNums
+ * following the newest filled one. Bounded work per call suits idle polls and lock holders.
+ * If `keys` were re-initialized in place since the last refill, every filled slot is dropped
+ * first.
+ * `out_filled` (optional) receives the number of slots generated.
+ */
+crisp_error_t crisp_keystream_pool_refill(crisp_keystream_pool_t* pool,
+                                          size_t max_slots,
+                                          size_t* out_filled);
+
+/**
+ * CTR-transforms `in` into `out` (equal sizes, may alias exactly) with the pooled keystream
+ * for `seqnum` and zeroizes the used slot. Slots for older SeqNums are zeroized and dropped
+ * first, so a monotonic TX sequence never stalls the pool.
+ * Returns false without writing `out` on a miss: `keys` differ from the pool's Kenc context,
+ * `seqnum` is not pooled yet, or in.size exceeds slot_size. A `keys` generation other than the
+ * one the slots were generated under (a rekey in place) drops every slot and misses.
+ */
+bool crisp_keystream_pool_xcrypt(crisp_keystream_pool_t* pool,
+                                 const crisp_crypto_keys_t* keys,
+                                 uint64_t seqnum,
+                                 crisp_const_byte_span_t in,
+                                 crisp_mutable_byte_span_t out);
+
+/** Zeroizes every slot and restarts generation at `next_seqnum` (e.g. after a SeqNum jump). */
+void crisp_keystream_pool_reset(crisp_keystream_pool_t* pool, uint64_t next_seqnum);
+
+/** Zeroizes the storage and the pool state; call before releasing the keys or the storage. */
+void crisp_keystream_pool_clear(crisp_keystream_pool_t* pool);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_KEYSTREAM_POOL_H_
@@ -6,6 +6,7 @@
 #include <stdint.h>
 
 #include "crisp/core/key_resolver.h"
+#include "crisp/core/keystream_pool.h"
 #include "crisp/core/replay_window.h"
 #include "crisp/core/suites.h"
 #include "crisp/core/types.h"
@@ -26,6 +27,15 @@ extern "C" {
 #define CRISP_KEY_ID_UNUSED_MARKER ((uint8_t)0x80U)
 /** CRISP version mandated by GOST R 71252-2024. */
 #define CRISP_VERSION_2024 ((uint16_t)0U)
+/** Headroom that fits any header before an in-place payload: prefix, longest KeyId, SeqNum. */
+#define CRISP_PROTECT_MAX_HEADROOM \
+  (CRISP_MESSAGE_HEADER_PREFIX_SIZE + CRISP_MAX_KEY_ID_SIZE + CRISP_MESSAGE_SEQNUM_SIZE)
+/** Tailroom that fits any ICV after an in-place payload. */
+#define CRISP_PROTECT_MAX_TAILROOM ((size_t)8U)
+/** Packets processed per stage by crisp_protect_batch() (larger batches are chunked). */
+#define CRISP_PROTECT_BATCH_CHUNK ((size_t)64U)
+/** Packets processed per stage by crisp_unprotect_batch() (larger batches are chunked). */
+#define CRISP_UNPROTECT_BATCH_CHUNK ((size_t)64U)
 
 /** Parsed CRISP message view referencing original packet memory. */
 typedef struct crisp_message_view {
@@ -51,6 +61,12 @@ typedef struct crisp_build_params {
   crisp_const_byte_span_t kenc;
   crisp_const_byte_span_t kmac;
   const crisp_crypto_iface_t* crypto;
+  /** Optional prepared keys; when set, kenc/kmac/crypto are ignored. */
+  const crisp_crypto_keys_t* keys;
+  /** Optional CMAC header cache from crisp_session_cmac_prefix_init() (used with `keys`). */
+  const crisp_cmac_prefix_t* cmac_prefix;
+  /** Optional precomputed keystream; a pool hit replaces CTR with a XOR (used with `keys`). */
+  crisp_keystream_pool_t* keystream_pool;
 } crisp_build_params_t;
 
 /** Input parameters for CRISP protect operation (plaintext -> wire packet). */
@@ -64,8 +80,30 @@ typedef struct crisp_protect_params {
   crisp_const_byte_span_t kenc;
   crisp_const_byte_span_t kmac;
   const crisp_crypto_iface_t* crypto;
+  /** Optional prepared keys; when set, kenc/kmac/crypto are ignored. */
+  const crisp_crypto_keys_t* keys;
+  /** Optional CMAC header cache from crisp_session_cmac_prefix_init() (used with `keys`). */
+  const crisp_cmac_prefix_t* cmac_prefix;
+  /** Optional precomputed keystream; a pool hit replaces CTR with a XOR (used with `keys`). */
+  crisp_keystream_pool_t* keystream_pool;
 } crisp_protect_params_t;
 
+/**
+ * Session-level parameters shared by every packet of a crisp_protect_batch() call.
+ * Suite, KeyId and crypto backend are validated once per batch.
+ */
+typedef struct crisp_protect_batch_params {
+  bool external_key_id_flag;
+  uint8_t cs;
+  bool key_id_present;
+  crisp_const_byte_span_t key_id;
+  crisp_const_byte_span_t kenc;
+  crisp_const_byte_span_t kmac;
+  const crisp_crypto_iface_t* crypto;
+  /** Optional prepared keys; when set, kenc/kmac/crypto are ignored. */
+  const crisp_crypto_keys_t* keys;
+} crisp_protect_batch_params_t;
+
 /** Input parameters for CRISP unprotect operation (wire packet -> plaintext). */
 typedef struct crisp_unprotect_params {
   crisp_const_byte_span_t packet;
@@ -73,8 +111,38 @@ typedef struct crisp_unprotect_params {
   crisp_const_byte_span_t kmac;
   const crisp_crypto_iface_t* crypto;
   crisp_replay_window_t* replay_window;
+  /** Thread-safe alternative to replay_window for multi-core RX (set at most one of them). */
+  crisp_concurrent_replay_window_t* concurrent_replay_window;
+  /** Optional prepared keys; when set, kenc/kmac/crypto are ignored. */
+  const crisp_crypto_keys_t* keys;
+  /** Optional CMAC header cache from crisp_session_cmac_prefix_init() (used with `keys`). */
+  const crisp_cmac_prefix_t* cmac_prefix;
 } crisp_unprotect_params_t;
 
+/** Session-level parameters shared by every packet of a crisp_unprotect_batch() call. */
+typedef struct crisp_unprotect_batch_params {
+  crisp_const_byte_span_t kenc;
+  crisp_const_byte_span_t kmac;
+  const crisp_crypto_iface_t* crypto;
+  crisp_replay_window_t* replay_window;
+  /** Thread-safe alternative to replay_window for multi-core RX (set at most one of them). */
+  crisp_concurrent_replay_window_t* concurrent_replay_window;
+  /** Optional prepared keys; when set, kenc/kmac/crypto are ignored. */
+  const crisp_crypto_keys_t* keys;
+} crisp_unprotect_batch_params_t;
+
+/**
+ * A packet parsed once for the staged unprotect pipeline:
+ * crisp_unprotect_parse() -> key lookup by `view.key_id` -> crisp_unprotect_view() (or
+ * crisp_unprotect_resolve_parsed() / crisp_unprotect_batch_parsed()).
+ * All spans reference `packet`, which must stay valid and unmodified between the stages.
+ */
+typedef struct crisp_parsed_message {
+  crisp_const_byte_span_t packet;
+  crisp_message_view_t view;
+  crisp_suite_params_t suite_params;
+} crisp_parsed_message_t;
+
 /** Metadata returned by CRISP unprotect operation. */
 typedef struct crisp_unprotect_result {
   bool external_key_id_flag;
@@ -102,6 +170,20 @@ crisp_error_t crisp_validate_key_id(crisp_const_byte_span_t key_id);
  */
 crisp_error_t crisp_parse_message(crisp_const_byte_span_t packet, crisp_message_view_t* out_message);
 
+/**
+ * Caches the CMAC midstate over the session-constant header bytes
+ * (ExternalKeyIdFlag|Version=0, CS, encoded KeyId) under the prepared Kmac context of `keys`.
+ * Only whole 8-byte blocks are cached, so short headers leave `out_prefix` empty.
+ * Passing the cache as `cmac_prefix` to protect/unprotect yields bit-identical ICVs; packets
+ * whose header does not match the cached bytes silently take the full CMAC path.
+ */
+crisp_error_t crisp_session_cmac_prefix_init(crisp_cmac_prefix_t* out_prefix,
+                                             const crisp_crypto_keys_t* keys,
+                                             bool external_key_id_flag,
+                                             uint8_t cs,
+                                             bool key_id_present,
+                                             crisp_const_byte_span_t key_id);
+
 /**
  * Builds a CRISP packet into caller-provided buffer.
  * Uses crypto backend interface for CTR transform (suite-dependent, IV32=LSB32(SeqNum))
@@ -119,9 +201,64 @@ crisp_error_t crisp_protect(const crisp_protect_params_t* params,
                             crisp_mutable_byte_span_t out_packet,
                             size_t* out_size);
 
+/**
+ * Protects a payload that already sits in the packet buffer, without copying it.
+ * `buffer[payload_offset, payload_offset + payload_size)` holds the plaintext, and
+ * `params->payload` is not read. The header is written into the headroom directly before the
+ * payload, which must be at least CRISP_MESSAGE_HEADER_PREFIX_SIZE + encoded KeyId size (1 when
+ * the KeyId is unused) + CRISP_MESSAGE_SEQNUM_SIZE bytes; CRISP_PROTECT_MAX_HEADROOM always
+ * suffices. The payload is encrypted in place (left as is for NULL-encryption suites) and the
+ * ICV is appended into the tailroom after it. On success `out_packet` spans the packet inside
+ * `buffer`.
+ * Errors as for crisp_protect(); CRISP_ERR_BUFFER_TOO_SMALL when headroom or tailroom is
+ * short, CRISP_ERR_INVALID_ARGUMENT when the payload does not fit `buffer`. Validation errors
+ * leave `buffer` untouched; after a backend error its contents are unspecified.
+ */
+crisp_error_t crisp_protect_in_place(const crisp_protect_params_t* params,
+                                     crisp_mutable_byte_span_t buffer,
+                                     size_t payload_offset,
+                                     size_t payload_size,
+                                     crisp_mutable_byte_span_t* out_packet);
+
+/**
+ * crisp_protect() for a payload scattered over `payload_iovcnt` segments, e.g. an inner header
+ * plus a payload fragment or ring slots that wrap around; `params->payload` is not read.
+ * Segments may have any size (empty ones included) and must not overlap `out_packet`. They
+ * are gathered straight into their place in `out_packet` and protected there, so no separate
+ * linearization copy is needed. Same errors as crisp_protect().
+ */
+crisp_error_t crisp_protect_iov(const crisp_protect_params_t* params,
+                                const crisp_const_byte_span_t* payload_iov,
+                                size_t payload_iovcnt,
+                                crisp_mutable_byte_span_t out_packet,
+                                size_t* out_size);
+
+/**
+ * Protects `count` payloads of one session into CRISP wire packets in a single pass.
+ * Session-level validation (suite, KeyId, backend) and header encoding are done once per batch;
+ * packet i is built from seqnums[i]/payloads[i] into out_packets[i].
+ * Per chunk of CRISP_PROTECT_BATCH_CHUNK packets, CTR and CMAC are issued as one backend
+ * batch call each (see crisp_crypto_ctr_xcrypt_batch()/crisp_crypto_cmac_batch()).
+ * Per-packet results:
+ * - out_status[i] holds the crisp_protect() error code for packet i;
+ * - out_sizes[i] holds the packet length on CRISP_OK and 0 otherwise.
+ * Returns a non-OK code (and leaves all outputs untouched) only when the shared parameters
+ * or array pointers are invalid; otherwise returns CRISP_OK even if some packets failed.
+ */
+crisp_error_t crisp_protect_batch(const crisp_protect_batch_params_t* params,
+                                  const uint64_t* seqnums,
+                                  const crisp_const_byte_span_t* payloads,
+                                  const crisp_mutable_byte_span_t* out_packets,
+                                  size_t* out_sizes,
+                                  crisp_error_t* out_status,
+                                  size_t count);
+
 /**
  * Verifies/authenticates and decrypts CRISP wire packet.
  * Validates ICV in constant time and applies replay check (if replay_window provided).
+ * The replay check is two-phase: a read-only probe runs before the ICV is computed, so stale
+ * or duplicate SeqNums are rejected without a CMAC, and the window is updated only after the
+ * ICV matches.
  * Error mapping:
  * - parse/format/size issues: CRISP_ERR_INVALID_*
  * - ICV mismatch: CRISP_ERR_CRYPTO
@@ -135,12 +272,67 @@ crisp_error_t crisp_unprotect(const crisp_unprotect_params_t* params,
                               crisp_mutable_byte_span_t out_plaintext,
                               crisp_unprotect_result_t* out_result);
 
+/**
+ * crisp_unprotect() that decrypts the payload inside `packet` instead of into a separate
+ * buffer; `params->packet` is not read. CS1/CS3 payloads are CTR-decrypted in place, CS2/CS4
+ * payloads are left untouched. On success `out_plaintext` (and `out_result->plaintext`) spans
+ * the plaintext inside `packet`; the header and ICV bytes around it are unchanged.
+ * Same error mapping as crisp_unprotect(). On every error, including CRISP_ERR_CRYPTO and
+ * CRISP_ERR_REPLAY, `packet` is not modified.
+ */
+crisp_error_t crisp_unprotect_in_place(const crisp_unprotect_params_t* params,
+                                       crisp_mutable_byte_span_t packet,
+                                       crisp_const_byte_span_t* out_plaintext,
+                                       crisp_unprotect_result_t* out_result);
+
+/**
+ * crisp_unprotect() for a packet scattered over `packet_iovcnt` segments; `params->packet` is
+ * not read. The header through the SeqNum must lie in the first segment
+ * (CRISP_PROTECT_MAX_HEADROOM bytes always suffice, CRISP_ERR_INVALID_ARGUMENT otherwise) and
+ * `out_result->key_id` points into it. Other segment boundaries are arbitrary, including inside
+ * CMAC blocks and the ICV. With prepared keys on a backend with segmented ops (see
+ * crisp_crypto_keys_have_segmented()) the CMAC is chained and the payload decrypted across
+ * segments without copying the packet; otherwise it is linearized on the stack first.
+ * Same error mapping and output contract as crisp_unprotect().
+ */
+crisp_error_t crisp_unprotect_iov(const crisp_unprotect_params_t* params,
+                                  const crisp_const_byte_span_t* packet_iov,
+                                  size_t packet_iovcnt,
+                                  crisp_mutable_byte_span_t out_plaintext,
+                                  crisp_unprotect_result_t* out_result);
+
+/**
+ * Unprotects a burst of `count` packets of one session with per-packet verdicts.
+ * Work is staged per chunk of CRISP_UNPROTECT_BATCH_CHUNK packets:
+ * 1. parse every packet and probe the replay window (read-only);
+ * 2. verify every ICV (one CMAC batch call) and check output capacity;
+ * 3. update the replay window in ascending SeqNum order (ties keep arrival order);
+ * 4. decrypt/copy accepted payloads (one CTR batch call).
+ * out_status[i] uses the same error mapping as crisp_unprotect(); out_results[i] is written
+ * only on CRISP_OK. A packet rejected by parsing, ICV, output capacity or replay checks leaves
+ * out_plaintexts[i] unmodified and never updates the replay window. The exception is a backend
+ * error from the stage 4 CTR call: the window is already updated by then, so those packets
+ * report the backend's code with their SeqNum consumed and the first payload.size bytes of
+ * out_plaintexts[i] zeroed.
+ * Returns a non-OK code (and writes no outputs) only when shared parameters or array
+ * pointers are invalid.
+ */
+crisp_error_t crisp_unprotect_batch(const crisp_unprotect_batch_params_t* params,
+                                    const crisp_const_byte_span_t* packets,
+                                    const crisp_mutable_byte_span_t* out_plaintexts,
+                                    crisp_unprotect_result_t* out_results,
+                                    crisp_error_t* out_status,
+                                    size_t count);
+
 /**
  * Resolves keys by packet metadata and then performs crisp_unprotect().
- * Wrapper parses packet first, calls resolver synchronously, and forwards resolved keys.
+ * Wrapper parses packet once, calls resolver synchronously, and forwards resolved keys
+ * (prepared keys from resolve_prepared_keys when set, raw spans from resolve_keys otherwise).
  * Policy:
  * - if KeyId is unused (0x80) and resolver.allow_key_id_unused == false -> CRISP_ERR_INVALID_FORMAT
  * - if resolver cannot find keys, resolver should return CRISP_ERR_INVALID_FORMAT
+ * - with resolver.key_table set, a KeyId found in the table is served without callbacks, and
+ *   a KeyId in its negative cache fails with CRISP_ERR_INVALID_FORMAT without callbacks
  */
 crisp_error_t crisp_unprotect_resolve(crisp_const_byte_span_t packet,
                                       const crisp_key_resolver_t* resolver,
@@ -149,6 +341,45 @@ crisp_error_t crisp_unprotect_resolve(crisp_const_byte_span_t packet,
                                       crisp_mutable_byte_span_t out_plaintext,
                                       crisp_unprotect_result_t* out_result);
 
+/**
+ * Stage 1 of the staged unprotect pipeline: parses `packet` with the crisp_parse_message()
+ * rules and keeps the suite parameters, so later stages neither re-parse nor look them up.
+ */
+crisp_error_t crisp_unprotect_parse(crisp_const_byte_span_t packet,
+                                    crisp_parsed_message_t* out_message);
+
+/**
+ * crisp_unprotect() on a packet already parsed by crisp_unprotect_parse(); `params->packet`
+ * is not read. Same checks, error mapping and output contract as crisp_unprotect().
+ */
+crisp_error_t crisp_unprotect_view(const crisp_unprotect_params_t* params,
+                                   const crisp_parsed_message_t* message,
+                                   crisp_mutable_byte_span_t out_plaintext,
+                                   crisp_unprotect_result_t* out_result);
+
+/**
+ * crisp_unprotect_batch() on packets already parsed by crisp_unprotect_parse(), for callers
+ * that parse first to steer packets to sessions. Starts at the replay probe (stage 1 without
+ * parsing); per-packet verdicts as for crisp_unprotect_batch().
+ */
+crisp_error_t crisp_unprotect_batch_parsed(const crisp_unprotect_batch_params_t* params,
+                                           const crisp_parsed_message_t* messages,
+                                           const crisp_mutable_byte_span_t* out_plaintexts,
+                                           crisp_unprotect_result_t* out_results,
+                                           crisp_error_t* out_status,
+                                           size_t count);
+
+/**
+ * crisp_unprotect_resolve() on a packet already parsed by crisp_unprotect_parse(). The
+ * resolver request and the unprotect stage both read the same parsed message.
+ */
+crisp_error_t crisp_unprotect_resolve_parsed(const crisp_parsed_message_t* message,
+                                             const crisp_key_resolver_t* resolver,
+                                             const crisp_crypto_iface_t* crypto,
+                                             crisp_replay_window_t* replay_window,
+                                             crisp_mutable_byte_span_t out_plaintext,
+                                             crisp_unprotect_result_t* out_result);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -11,15 +11,32 @@
 extern "C" {
 #endif
 
-/** Maximum anti-replay window size (in sequence numbers). */
+/** Maximum anti-replay window size with inline storage (in sequence numbers). */
 #define CRISP_REPLAY_WINDOW_MAX_SIZE ((size_t)256U)
+/** Maximum anti-replay window size with caller-provided storage (in sequence numbers). */
+#define CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE ((size_t)65536U)
+/**
+ * Inline bitmap ring length in 64-bit words: CRISP_REPLAY_WINDOW_MAX_SIZE bits plus one spare
+ * word (so the word holding max_seq never aliases the oldest in-window word), rounded up to a
+ * power of two.
+ */
+#define CRISP_REPLAY_WINDOW_RING_WORDS ((size_t)8U)
 
-/** Sliding anti-replay window with fixed storage for up to 256 entries. */
+/**
+ * Sliding anti-replay window.
+ * SeqNum s is tracked by bit (s mod 64 * ring_words) of the ring; advancing max_seq clears the
+ * whole words it moves into instead of shifting the bitmap. Windows up to
+ * CRISP_REPLAY_WINDOW_MAX_SIZE use the inline ring; larger ones use caller storage.
+ */
 typedef struct crisp_replay_window {
   size_t size;
   uint64_t max_seq;
   bool initialized;
-  uint8_t bits[CRISP_REPLAY_WINDOW_MAX_SIZE / 8U];
+  /** Ring length in words (power of two). */
+  size_t ring_words;
+  /** Caller storage from crisp_replay_window_init_with_storage(), NULL for the inline ring. */
+  uint64_t* external_ring;
+  uint64_t ring[CRISP_REPLAY_WINDOW_RING_WORDS];
 } crisp_replay_window_t;
 
 /**
@@ -27,6 +44,35 @@ typedef struct crisp_replay_window {
  */
 crisp_error_t crisp_replay_window_init(crisp_replay_window_t* window, size_t size);
 
+/**
+ * Returns the number of 64-bit words of storage a window of `size` entries needs
+ * (ceil(size / 64) + 1 rounded up to a power of two), or 0 if `size` is out of range
+ * [1..CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE]. A 65536-entry window needs 2048 words (16 KiB).
+ */
+size_t crisp_replay_window_storage_words(size_t size);
+
+/**
+ * Initializes a replay window of `size` entries in range [1..CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE]
+ * over caller-provided `storage` of at least crisp_replay_window_storage_words(size) words.
+ * The storage must outlive the window and not be shared with another window.
+ * Per-packet cost does not depend on `size`; only a jump of max_seq past the whole ring clears
+ * all of it.
+ */
+crisp_error_t crisp_replay_window_init_with_storage(crisp_replay_window_t* window,
+                                                    size_t size,
+                                                    uint64_t* storage,
+                                                    size_t storage_words);
+
+/**
+ * Read-only probe: sets `would_accept` to what crisp_replay_window_check_and_update() would
+ * decide for `seqnum` now, without changing the window. A rejection is final (the window only
+ * moves forward), so RX can drop stale or duplicate SeqNums before verifying the ICV and
+ * commit the update once the ICV matches.
+ */
+crisp_error_t crisp_replay_window_check(const crisp_replay_window_t* window,
+                                        uint64_t seqnum,
+                                        bool* would_accept);
+
 /**
  * Checks SeqNum against replay window and updates state.
  * Returns CRISP_OK and sets `accepted=false` if packet is too old or replayed.
@@ -36,6 +82,59 @@ crisp_error_t crisp_replay_window_check_and_update(crisp_replay_window_t* window
                                                    uint64_t seqnum,
                                                    bool* accepted);
 
+/**
+ * Replay window that several threads may check concurrently without a lock.
+ * Each 64-bit slot holds SeqNum >> 4 in bits 63..16 and a seen-bitmap for those 16 SeqNums in
+ * bits 15..0; slots are updated with CAS, and max_seq with a CAS max loop. A slot that holds
+ * an older SeqNum group is taken over, never cleared, so advances cost O(1) and cannot race
+ * with concurrent bit updates. Fields are accessed atomically; do not touch them directly.
+ */
+typedef struct crisp_concurrent_replay_window {
+  size_t size;
+  size_t slot_count;
+  /** Newest accepted SeqNum + 1, or 0 before the first accept. */
+  uint64_t max_seq_plus1;
+  /** Caller storage of slot_count words. */
+  uint64_t* slots;
+} crisp_concurrent_replay_window_t;
+
+/**
+ * Returns the number of 64-bit slots a concurrent window of `size` entries needs
+ * (ceil(size / 16) + 1 rounded up to a power of two), or 0 if `size` is out of range
+ * [1..CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE]. A 4096-entry window needs 512 slots (4 KiB).
+ */
+size_t crisp_concurrent_replay_window_storage_words(size_t size);
+
+/**
+ * Initializes a concurrent window of `size` entries over caller `storage` of at least
+ * crisp_concurrent_replay_window_storage_words(size) words. Not thread-safe itself: publish
+ * the window to other threads only after it returns.
+ */
+crisp_error_t crisp_concurrent_replay_window_init(crisp_concurrent_replay_window_t* window,
+                                                  size_t size,
+                                                  uint64_t* storage,
+                                                  size_t storage_words);
+
+/**
+ * Thread-safe, lock-free counterpart of crisp_replay_window_check_and_update() with the same
+ * accept/reject rules. Each call is linearizable: it behaves as if it took effect atomically at
+ * one point between invocation and return, so every SeqNum is accepted at most once across all
+ * threads, and a SeqNum is rejected as too old only if a SeqNum at least `size` newer had been
+ * accepted before that point.
+ */
+crisp_error_t crisp_concurrent_replay_window_check_and_update(
+    crisp_concurrent_replay_window_t* window,
+    uint64_t seqnum,
+    bool* accepted);
+
+/**
+ * Lock-free read-only probe, the concurrent counterpart of crisp_replay_window_check().
+ * A rejection is final; an acceptance may still lose to another thread at update time.
+ */
+crisp_error_t crisp_concurrent_replay_window_check(const crisp_concurrent_replay_window_t* window,
+                                                   uint64_t seqnum,
+                                                   bool* would_accept);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -0,0 +1,69 @@
+#ifndef CRISP_CORE_SEQNUM_ALLOCATOR_H_
+#define CRISP_CORE_SEQNUM_ALLOCATOR_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crisp/core/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest block one crisp_seqnum_allocator_reserve() call hands out. */
+#define CRISP_SEQNUM_BLOCK_MAX ((uint64_t)1U << 20U)
+
+/**
+ * Shared 48-bit TX SeqNum counter of one session.
+ * Threads reserve blocks of consecutive SeqNums with one atomic fetch-add each and then number
+ * packets from their block without touching the shared cache line; a block of N costs one
+ * line transfer per N packets instead of one per packet.
+ * `next` is accessed atomically; do not touch it directly after init.
+ */
+typedef struct crisp_seqnum_allocator {
+  /** First unreserved SeqNum; may run past CRISP_SEQNUM_MAX + 1 once exhausted. */
+  uint64_t next;
+  /** First SeqNum at which a rekey is due (CRISP_SEQNUM_MAX + 1 when unset). */
+  uint64_t rekey_threshold;
+} crisp_seqnum_allocator_t;
+
+/** Consecutive SeqNums [next, end) owned by one thread. */
+typedef struct crisp_seqnum_block {
+  uint64_t next;
+  uint64_t end;
+  /** True when the block reaches the rekey threshold. */
+  bool rekey_due;
+} crisp_seqnum_block_t;
+
+/**
+ * Initializes the allocator to hand out SeqNums from `first_seqnum`.
+ * `rekey_threshold` is the SeqNum from which reservations report rekey_due; 0 disables it.
+ * Not thread-safe: publish the allocator to other threads only after it returns.
+ */
+crisp_error_t crisp_seqnum_allocator_init(crisp_seqnum_allocator_t* allocator,
+                                          uint64_t first_seqnum,
+                                          uint64_t rekey_threshold);
+
+/**
+ * Reserves up to `count` (1..CRISP_SEQNUM_BLOCK_MAX) consecutive SeqNums with one atomic op.
+ * Thread-safe and lock-free; blocks of different calls never overlap.
+ * The block is shorter than `count` only at the end of the 48-bit space; once it is
+ * exhausted, returns CRISP_ERR_OUT_OF_RANGE and an empty block. SeqNums are never reused,
+ * even when the caller does not send all of them.
+ */
+crisp_error_t crisp_seqnum_allocator_reserve(crisp_seqnum_allocator_t* allocator,
+                                             uint64_t count,
+                                             crisp_seqnum_block_t* out_block);
+
+/** Takes the next SeqNum of a reserved block; returns false when the block is used up. */
+bool crisp_seqnum_block_take(crisp_seqnum_block_t* block, uint64_t* out_seqnum);
+
+/** Returns true once SeqNums at or past the rekey threshold have been reserved. */
+bool crisp_seqnum_allocator_rekey_due(const crisp_seqnum_allocator_t* allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_SEQNUM_ALLOCATOR_H_
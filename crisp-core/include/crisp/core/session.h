@@ -0,0 +1,230 @@
+#ifndef CRISP_CORE_SESSION_H_
+#define CRISP_CORE_SESSION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crisp/core/keystream_pool.h"
+#include "crisp/core/message.h"
+#include "crisp/core/replay_window.h"
+#include "crisp/core/seqnum_allocator.h"
+#include "crisp/core/suites.h"
+#include "crisp/core/types.h"
+#include "crisp/crypto/iface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Parameters fixed for the lifetime of a session, consumed by crisp_session_init(). */
+typedef struct crisp_session_config {
+  bool external_key_id_flag;
+  uint8_t cs;
+  bool key_id_present;
+  crisp_const_byte_span_t key_id;
+  crisp_const_byte_span_t kenc;
+  crisp_const_byte_span_t kmac;
+  const crisp_crypto_iface_t* crypto;
+  /** SeqNum of the first protected packet. */
+  uint64_t tx_seqnum;
+  /** SeqNum from which TX reservations report a rekey as due; 0 disables the report. */
+  uint64_t tx_rekey_threshold;
+  /** RX anti-replay window size; 0 disables the replay check. */
+  size_t replay_window_size;
+  /** Caller storage for windows above CRISP_REPLAY_WINDOW_MAX_SIZE (NULL for inline). */
+  uint64_t* replay_window_storage;
+  size_t replay_window_storage_words;
+  /**
+   * Optional TX keystream pool (NULL disables it): crisp_session_init() builds it over the
+   * session keys from `tx_seqnum` with `keystream_pool_storage` and
+   * `keystream_pool_slot_size` (see crisp_keystream_pool_init()), so the backend needs a keyed
+   * API. The pool and its storage are caller-owned and must outlive the session, which must not
+   * be moved while the pool is attached. crisp_session_clear() clears the pool.
+   */
+  crisp_keystream_pool_t* keystream_pool;
+  crisp_mutable_byte_span_t keystream_pool_storage;
+  size_t keystream_pool_slot_size;
+} crisp_session_config_t;
+
+/**
+ * One CRISP association with everything that does not change per packet set up once:
+ * prepared keys, suite parameters, the encoded header (ExternalKeyIdFlag|Version, CS, KeyId),
+ * its CMAC midstate, the TX SeqNum counter and the RX replay window.
+ * TX and RX state each start on their own cache line, so senders and one receiver thread can
+ * share a session without false sharing; heap-allocated sessions therefore need
+ * aligned_alloc(CRISP_CACHE_LINE_SIZE, ...). Any number of threads may protect concurrently
+ * (the SeqNum allocator is atomic) unless a keystream pool is attached: every single-packet
+ * protect call then consumes pool slots, so they must be serialized with each other and with
+ * crisp_keystream_pool_refill(). RX is single-threaded.
+ */
+typedef struct crisp_session {
+  /* Read-only after crisp_session_init(). */
+  crisp_crypto_keys_t keys;
+  crisp_suite_params_t suite_params;
+  size_t header_size;
+  uint8_t header[CRISP_MESSAGE_HEADER_PREFIX_SIZE + CRISP_MAX_KEY_ID_SIZE];
+  crisp_cmac_prefix_t cmac_prefix;
+  /**
+   * Keystream pool built over `keys` from the config (NULL when unused). The pointer is fixed
+   * at init; the pool itself is written by protect calls that consume it.
+   */
+  crisp_keystream_pool_t* keystream_pool;
+
+  /* TX side: the only session field written by protect. */
+  CRISP_CACHE_ALIGNED crisp_seqnum_allocator_t tx_seqnums;
+
+  /* RX side: written by every accepted unprotect. */
+  CRISP_CACHE_ALIGNED crisp_replay_window_t replay_window;
+  bool replay_enabled;
+} crisp_session_t;
+
+/**
+ * Validates `config`, prepares the keys, pre-encodes the header and builds the optional
+ * keystream pool. Raw key spans are kept as-is by backends without a keyed API and must then
+ * outlive the session. On error `session` is left zeroed and nothing needs to be cleared.
+ */
+crisp_error_t crisp_session_init(crisp_session_t* session, const crisp_session_config_t* config);
+
+/**
+ * Protects `payload` with the next TX SeqNum, touching only per-packet data.
+ * Reserves one SeqNum per call (one atomic op on the shared TX line); busy TX threads should
+ * reserve blocks with crisp_session_reserve_seqnums() and use crisp_session_protect_seqnum().
+ * The SeqNum is reported via `out_seqnum` (optional) and consumed even when protect fails;
+ * CRISP_ERR_OUT_OF_RANGE once the 48-bit SeqNum space is exhausted.
+ */
+crisp_error_t crisp_session_protect(crisp_session_t* session,
+                                    crisp_const_byte_span_t payload,
+                                    crisp_mutable_byte_span_t out_packet,
+                                    size_t* out_size,
+                                    uint64_t* out_seqnum);
+
+/**
+ * Reserves a block of up to `count` TX SeqNums for the calling thread (see
+ * crisp_seqnum_allocator_reserve()); `out_block->rekey_due` reports the rekey threshold.
+ */
+crisp_error_t crisp_session_reserve_seqnums(crisp_session_t* session,
+                                            uint64_t count,
+                                            crisp_seqnum_block_t* out_block);
+
+/**
+ * Protects `payload` with a SeqNum the caller took from a reserved block. Without a keystream
+ * pool the session is only read, so TX threads with their own blocks never write shared state
+ * per packet. With a pool attached this call consumes pool slots and is not thread-safe.
+ */
+crisp_error_t crisp_session_protect_seqnum(const crisp_session_t* session,
+                                           uint64_t seqnum,
+                                           crisp_const_byte_span_t payload,
+                                           crisp_mutable_byte_span_t out_packet,
+                                           size_t* out_size);
+
+/** Returns the headroom crisp_session_protect_in_place() needs before the payload. */
+size_t crisp_session_headroom(const crisp_session_t* session);
+
+/**
+ * crisp_protect_in_place() for this session with a SeqNum the caller took from a reserved
+ * block: the header is written into the crisp_session_headroom() bytes before the payload, the
+ * payload is encrypted in place and the ICV is appended after it. Without a keystream pool the
+ * session is only read; with a pool attached this call consumes pool slots and is not
+ * thread-safe.
+ */
+crisp_error_t crisp_session_protect_in_place(const crisp_session_t* session,
+                                             uint64_t seqnum,
+                                             crisp_mutable_byte_span_t buffer,
+                                             size_t payload_offset,
+                                             size_t payload_size,
+                                             crisp_mutable_byte_span_t* out_packet);
+
+/**
+ * crisp_protect_iov() for this session with a SeqNum the caller took from a reserved block.
+ * Without a keystream pool the session is only read; with a pool attached this call consumes
+ * pool slots and is not thread-safe.
+ */
+crisp_error_t crisp_session_protect_iov(const crisp_session_t* session,
+                                        uint64_t seqnum,
+                                        const crisp_const_byte_span_t* payload_iov,
+                                        size_t payload_iovcnt,
+                                        crisp_mutable_byte_span_t out_packet,
+                                        size_t* out_size);
+
+/** How crisp_session_protect_stream() splits one payload for a given MTU. */
+typedef struct crisp_stream_layout {
+  /** Payload bytes in every packet but the last (which carries the remainder). */
+  size_t segment_size;
+  size_t packet_count;
+  /** Arena bytes the packets take when stored back to back. */
+  size_t arena_size;
+} crisp_stream_layout_t;
+
+/**
+ * Computes the crisp_session_protect_stream() layout of `payload_size` bytes. Packets are at
+ * most min(`mtu`, CRISP_MAX_MESSAGE_SIZE) bytes long; an empty payload needs no packets.
+ * CRISP_ERR_INVALID_SIZE if `mtu` leaves no room for payload after header and ICV, or if the
+ * payload needs more than CRISP_SEQNUM_BLOCK_MAX packets.
+ */
+crisp_error_t crisp_session_stream_layout(const crisp_session_t* session,
+                                          size_t payload_size,
+                                          size_t mtu,
+                                          crisp_stream_layout_t* out_layout);
+
+/**
+ * Splits `payload` into maximally sized packets (see crisp_session_stream_layout()) with
+ * consecutive SeqNums, reserved as one block, and protects them with the batch path: one
+ * backend CTR and one CMAC batch call per CRISP_PROTECT_BATCH_CHUNK packets.
+ * Packets are written back to back into `arena` and `out_packets[i]` spans packet i; the
+ * count and first SeqNum are reported via `out_count` and `out_first_seqnum` (optional).
+ * Capacity is checked before any SeqNum is reserved (CRISP_ERR_BUFFER_TOO_SMALL when `arena`
+ * or `max_packets` is short). Once reserved, SeqNums are consumed even on failure:
+ * CRISP_ERR_OUT_OF_RANGE if the SeqNum space cannot supply the whole block, or the first
+ * backend error, in which case `*out_count` is 0 and the arena contents are unspecified.
+ * The keystream pool is not consumed, so this may run alongside any other protect call.
+ */
+crisp_error_t crisp_session_protect_stream(crisp_session_t* session,
+                                           crisp_const_byte_span_t payload,
+                                           size_t mtu,
+                                           crisp_mutable_byte_span_t arena,
+                                           crisp_mutable_byte_span_t* out_packets,
+                                           size_t max_packets,
+                                           size_t* out_count,
+                                           uint64_t* out_first_seqnum);
+
+/**
+ * Unprotects a packet of this session with the crisp_unprotect() error mapping and output
+ * contract. The header is matched byte for byte against the session's instead of being
+ * decoded; a packet with another CS, KeyId or flag is rejected as CRISP_ERR_INVALID_FORMAT.
+ */
+crisp_error_t crisp_session_unprotect(crisp_session_t* session,
+                                      crisp_const_byte_span_t packet,
+                                      crisp_mutable_byte_span_t out_plaintext,
+                                      crisp_unprotect_result_t* out_result);
+
+/**
+ * crisp_unprotect_in_place() for a packet of this session: the payload is decrypted inside
+ * `packet` and `out_plaintext` spans it there. `packet` is not modified on any error.
+ */
+crisp_error_t crisp_session_unprotect_in_place(crisp_session_t* session,
+                                               crisp_mutable_byte_span_t packet,
+                                               crisp_const_byte_span_t* out_plaintext,
+                                               crisp_unprotect_result_t* out_result);
+
+/**
+ * crisp_unprotect_iov() for a packet of this session. The header is parsed from the first
+ * segment and must then equal the session's; otherwise CRISP_ERR_INVALID_FORMAT.
+ */
+crisp_error_t crisp_session_unprotect_iov(crisp_session_t* session,
+                                          const crisp_const_byte_span_t* packet_iov,
+                                          size_t packet_iovcnt,
+                                          crisp_mutable_byte_span_t out_plaintext,
+                                          crisp_unprotect_result_t* out_result);
+
+/**
+ * Clears the attached keystream pool, releases the prepared keys and zeroizes the session.
+ * Safe on a zeroed session.
+ */
+void crisp_session_clear(crisp_session_t* session);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_SESSION_H_
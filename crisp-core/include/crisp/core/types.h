@@ -18,6 +18,15 @@ extern "C" {
 /** Max value for 48-bit SeqNum. */
 #define CRISP_SEQNUM_MAX ((uint64_t)0x0000FFFFFFFFFFFFULL)
 
+/** Cache line size assumed when separating fields written by different threads. */
+#define CRISP_CACHE_LINE_SIZE 64
+/** Aligns a struct member to its own cache line (C11 _Alignas / C++ alignas). */
+#ifdef __cplusplus
+#define CRISP_CACHE_ALIGNED alignas(CRISP_CACHE_LINE_SIZE)
+#else
+#define CRISP_CACHE_ALIGNED _Alignas(CRISP_CACHE_LINE_SIZE)
+#endif
+
 /** Error/status codes returned by CRISP APIs. */
 typedef enum crisp_error {
   CRISP_OK = 0,
@@ -29,6 +38,9 @@ typedef enum crisp_error {
   CRISP_ERR_REPLAY,
   CRISP_ERR_OUT_OF_RANGE,
   CRISP_ERR_CRYPTO,
+  CRISP_ERR_NOT_SUPPORTED,
+  /** OS-level I/O failure such as a failed socket call. */
+  CRISP_ERR_IO,
 } crisp_error_t;
 
 /** Immutable byte range. */
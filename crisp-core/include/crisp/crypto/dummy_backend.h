@@ -15,7 +15,7 @@ typedef struct crisp_dummy_crypto_state {
 } crisp_dummy_crypto_state_t;
 
 /**
- * Initializes deterministic non-cryptographic backend.
+ * Initializes deterministic non-cryptographic backend (raw-key and keyed-context callbacks).
  * WARNING: this backend is only for tests and must not be used in production.
  */
 void crisp_dummy_crypto_iface_init(crisp_crypto_iface_t* iface, crisp_dummy_crypto_state_t* state);
@@ -1,6 +1,8 @@
 #ifndef CRISP_CRYPTO_IFACE_H_
 #define CRISP_CRYPTO_IFACE_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "crisp/core/types.h"
@@ -15,7 +17,10 @@ typedef crisp_error_t (*crisp_magma_cmac_fn)(void* user_ctx,
                                              crisp_const_byte_span_t data,
                                              crisp_mutable_byte_span_t out_icv);
 
-/** Backend callback for Magma-CTR encrypt/decrypt operation. */
+/**
+ * Backend callback for Magma-CTR encrypt/decrypt operation.
+ * `in` and `out` have equal size and may alias exactly (in-place protect/unprotect).
+ */
 typedef crisp_error_t (*crisp_magma_ctr_xcrypt_fn)(void* user_ctx,
                                                    crisp_const_byte_span_t key,
                                                    uint32_t iv32,
@@ -29,17 +34,224 @@ typedef crisp_error_t (*crisp_derive_kenc_kmac_fn)(void* user_ctx,
                                                    crisp_mutable_byte_span_t out_kenc,
                                                    crisp_mutable_byte_span_t out_kmac);
 
+/**
+ * Backend callback preparing a key context (expanded key schedule, CMAC subkeys, ...).
+ * The returned context is used with the *_keyed callbacks until released.
+ */
+typedef crisp_error_t (*crisp_magma_key_init_fn)(void* user_ctx,
+                                                 crisp_const_byte_span_t key,
+                                                 void** out_key_ctx);
+
+/** Backend callback releasing (and zeroizing) a key context from crisp_magma_key_init_fn. */
+typedef void (*crisp_magma_key_release_fn)(void* user_ctx, void* key_ctx);
+
+/** Keyed-context variant of crisp_magma_cmac_fn. */
+typedef crisp_error_t (*crisp_magma_cmac_keyed_fn)(void* user_ctx,
+                                                   const void* key_ctx,
+                                                   crisp_const_byte_span_t data,
+                                                   crisp_mutable_byte_span_t out_icv);
+
+/** Keyed-context variant of crisp_magma_ctr_xcrypt_fn; `in` and `out` may alias exactly. */
+typedef crisp_error_t (*crisp_magma_ctr_xcrypt_keyed_fn)(void* user_ctx,
+                                                         const void* key_ctx,
+                                                         uint32_t iv32,
+                                                         crisp_const_byte_span_t in,
+                                                         crisp_mutable_byte_span_t out);
+
+/** One CMAC computation of a batch call. */
+typedef struct crisp_magma_cmac_job {
+  crisp_const_byte_span_t data;
+  crisp_mutable_byte_span_t out_icv;
+} crisp_magma_cmac_job_t;
+
+/** One CTR transform of a batch call; `in` and `out` have equal size and may alias exactly. */
+typedef struct crisp_magma_ctr_job {
+  uint32_t iv32;
+  crisp_const_byte_span_t in;
+  crisp_mutable_byte_span_t out;
+} crisp_magma_ctr_job_t;
+
+/**
+ * Keyed batch CMAC: computes all jobs under one key context.
+ * Lets multi-buffer backends run independent CMAC chains in parallel lanes.
+ */
+typedef crisp_error_t (*crisp_magma_cmac_batch_fn)(void* user_ctx,
+                                                   const void* key_ctx,
+                                                   const crisp_magma_cmac_job_t* jobs,
+                                                   size_t count);
+
+/** Keyed batch CTR: transforms all jobs under one key context. */
+typedef crisp_error_t (*crisp_magma_ctr_xcrypt_batch_fn)(void* user_ctx,
+                                                         const void* key_ctx,
+                                                         const crisp_magma_ctr_job_t* jobs,
+                                                         size_t count);
+
+/**
+ * CMAC chaining state after `absorbed` bytes (a whole number of blocks).
+ * `state` is backend-defined; core only copies it.
+ */
+typedef struct crisp_cmac_midstate {
+  size_t absorbed;
+  uint64_t state[2];
+} crisp_cmac_midstate_t;
+
+/**
+ * Keyed CMAC over whole blocks of `prefix` (size must be a multiple of the 8-byte block),
+ * stopping before finalization. The resulting midstate is resumed by crisp_magma_cmac_resume_fn.
+ */
+typedef crisp_error_t (*crisp_magma_cmac_absorb_fn)(void* user_ctx,
+                                                    const void* key_ctx,
+                                                    crisp_const_byte_span_t prefix,
+                                                    crisp_cmac_midstate_t* out_midstate);
+
+/**
+ * Keyed CMAC of `data` resuming from `midstate`: the first midstate->absorbed bytes of `data`
+ * are assumed to be the absorbed prefix and are not read. Requires data.size > absorbed.
+ */
+typedef crisp_error_t (*crisp_magma_cmac_resume_fn)(void* user_ctx,
+                                                    const void* key_ctx,
+                                                    const crisp_cmac_midstate_t* midstate,
+                                                    crisp_const_byte_span_t data,
+                                                    crisp_mutable_byte_span_t out_icv);
+
+/**
+ * Fused TX op (keyed): CTR-encrypts `in` into `auth` at `payload_offset` and computes CMAC
+ * over the whole of `auth` (header || ciphertext), touching each payload block once.
+ * Requires in.size == auth.size - payload_offset; `in` may alias the payload region exactly.
+ * `midstate` (optional) resumes CMAC after a cached prefix with absorbed <= payload_offset.
+ */
+typedef crisp_error_t (*crisp_magma_ctr_then_cmac_fn)(void* user_ctx,
+                                                      const void* kenc_ctx,
+                                                      const void* kmac_ctx,
+                                                      const crisp_cmac_midstate_t* midstate,
+                                                      uint32_t iv32,
+                                                      crisp_const_byte_span_t in,
+                                                      crisp_mutable_byte_span_t auth,
+                                                      size_t payload_offset,
+                                                      crisp_mutable_byte_span_t out_icv);
+
+/**
+ * Fused RX op (keyed): computes CMAC over `auth` (header || ciphertext) and CTR-decrypts the
+ * ciphertext at `payload_offset` into `out` in the same pass.
+ * Requires out.size == auth.size - payload_offset and `out` must not overlap `auth`.
+ * `out` is written before the caller can
+ * compare ICVs, so callers that must not expose unauthenticated plaintext pass scratch memory.
+ * `midstate` is optional, as for crisp_magma_ctr_then_cmac_fn.
+ */
+typedef crisp_error_t (*crisp_magma_cmac_then_ctr_fn)(void* user_ctx,
+                                                      const void* kenc_ctx,
+                                                      const void* kmac_ctx,
+                                                      const crisp_cmac_midstate_t* midstate,
+                                                      uint32_t iv32,
+                                                      crisp_const_byte_span_t auth,
+                                                      size_t payload_offset,
+                                                      crisp_mutable_byte_span_t out,
+                                                      crisp_mutable_byte_span_t out_icv);
+
+/**
+ * Keyed CMAC continuation for messages that arrive in pieces: absorbs `blocks` (a whole number
+ * of 8-byte blocks) after the midstate->absorbed bytes already chained into `midstate` and
+ * advances it. A midstate with absorbed == 0 is the initial state whatever `state` holds; one
+ * from crisp_magma_cmac_absorb_fn may be continued. The final block of a message is never
+ * passed here; see crisp_magma_cmac_final_fn.
+ */
+typedef crisp_error_t (*crisp_magma_cmac_update_fn)(void* user_ctx,
+                                                    const void* key_ctx,
+                                                    crisp_cmac_midstate_t* midstate,
+                                                    crisp_const_byte_span_t blocks);
+
+/**
+ * Keyed CMAC finalization after crisp_magma_cmac_update_fn: `last` is the final 1..8 bytes of
+ * the message (empty only for an empty message), MACed with K1 when it is a full block and
+ * padded with K2 otherwise.
+ */
+typedef crisp_error_t (*crisp_magma_cmac_final_fn)(void* user_ctx,
+                                                   const void* key_ctx,
+                                                   const crisp_cmac_midstate_t* midstate,
+                                                   crisp_const_byte_span_t last,
+                                                   crisp_mutable_byte_span_t out_icv);
+
+/**
+ * Keyed CTR starting `offset` bytes into the keystream of `iv32` (any offset, not only block
+ * multiples), so a payload split at arbitrary byte boundaries is transformed segment by
+ * segment exactly as if it were contiguous. `in` and `out` may alias exactly.
+ */
+typedef crisp_error_t (*crisp_magma_ctr_xcrypt_at_fn)(void* user_ctx,
+                                                      const void* key_ctx,
+                                                      uint32_t iv32,
+                                                      size_t offset,
+                                                      crisp_const_byte_span_t in,
+                                                      crisp_mutable_byte_span_t out);
+
 /**
  * Crypto backend vtable.
  * All cryptographic operations in CRISP core must be routed through this interface.
+ * The keyed-context callbacks are optional; a backend either provides all four of
+ * magma_key_init/magma_key_release/magma_cmac_keyed/magma_ctr_xcrypt_keyed or none of them.
+ * Raw-key callbacks remain mandatory and are used whenever no prepared context is available.
+ * Batch, fused, CMAC absorb/resume and segmented (update/final/ctr_at) callbacks are optional
+ * on top of the keyed API; without them core loops per job, makes separate CTR and CMAC passes,
+ * MACs from the first byte, or linearizes scattered packets on the stack.
  */
 typedef struct crisp_crypto_iface {
   void* user_ctx;
   crisp_magma_cmac_fn magma_cmac;
   crisp_magma_ctr_xcrypt_fn magma_ctr_xcrypt;
   crisp_derive_kenc_kmac_fn derive_kenc_kmac;
+  crisp_magma_key_init_fn magma_key_init;
+  crisp_magma_key_release_fn magma_key_release;
+  crisp_magma_cmac_keyed_fn magma_cmac_keyed;
+  crisp_magma_ctr_xcrypt_keyed_fn magma_ctr_xcrypt_keyed;
+  crisp_magma_cmac_batch_fn magma_cmac_batch;
+  crisp_magma_ctr_xcrypt_batch_fn magma_ctr_xcrypt_batch;
+  crisp_magma_ctr_then_cmac_fn magma_ctr_then_cmac;
+  crisp_magma_cmac_then_ctr_fn magma_cmac_then_ctr;
+  crisp_magma_cmac_absorb_fn magma_cmac_absorb;
+  crisp_magma_cmac_resume_fn magma_cmac_resume;
+  crisp_magma_cmac_update_fn magma_cmac_update;
+  crisp_magma_cmac_final_fn magma_cmac_final;
+  crisp_magma_ctr_xcrypt_at_fn magma_ctr_xcrypt_at;
 } crisp_crypto_iface_t;
 
+/**
+ * Kenc/Kmac pair bound to a backend, optionally holding prepared key contexts.
+ * Built by crisp_crypto_keys_init(); sessions keep one per direction/SA and reuse it per packet.
+ */
+typedef struct crisp_crypto_keys {
+  const crisp_crypto_iface_t* crypto;
+  /** Raw keys; used only when the corresponding context is NULL. */
+  crisp_const_byte_span_t kenc;
+  crisp_const_byte_span_t kmac;
+  void* kenc_ctx;
+  void* kmac_ctx;
+  /**
+   * Process-unique identity of this key binding, assigned by crisp_crypto_keys_init() and kept
+   * by copies. A backend may reuse a released context address; the generation never repeats.
+   */
+  uint64_t generation;
+} crisp_crypto_keys_t;
+
+/** CMAC block size of the Magma-based suites. */
+#define CRISP_CMAC_BLOCK_SIZE ((size_t)8U)
+/** Largest cached CMAC prefix: the 3-byte header prefix plus a 128-byte KeyId, whole blocks. */
+#define CRISP_CMAC_PREFIX_MAX_SIZE ((size_t)128U)
+
+/**
+ * CMAC midstate over bytes that start every message of a session (header up to KeyId).
+ * Built by crisp_cmac_prefix_init(); `size == 0` means nothing is cached and callers fall back
+ * to a full CMAC. Users compare `bytes`, the Kmac context and the key generation against each
+ * message, so a stale or mismatched cache (including one outliving its keys) never changes an
+ * ICV.
+ */
+typedef struct crisp_cmac_prefix {
+  /** Kmac context and key generation the midstate was computed under. */
+  const void* kmac_ctx;
+  uint64_t generation;
+  crisp_cmac_midstate_t midstate;
+  size_t size;
+  uint8_t bytes[CRISP_CMAC_PREFIX_MAX_SIZE];
+} crisp_cmac_prefix_t;
+
 /**
  * Calls backend Kenc/Kmac derivation routine.
  * Returns CRISP_ERR_INVALID_ARGUMENT if the backend or callback is missing.
@@ -50,6 +262,157 @@ crisp_error_t crisp_derive_kenc_kmac(const crisp_crypto_iface_t* iface,
                                      crisp_mutable_byte_span_t out_kenc,
                                      crisp_mutable_byte_span_t out_kmac);
 
+/**
+ * Returns true if the backend implements the full keyed-context API.
+ */
+bool crisp_crypto_iface_has_keyed_api(const crisp_crypto_iface_t* iface);
+
+/**
+ * Binds Kenc/Kmac to a backend.
+ * If the backend implements the keyed-context API, key schedules are prepared once here and the
+ * raw spans are not referenced afterwards (they are cleared in `out_keys`). Otherwise the raw
+ * spans are stored as-is and must stay valid until crisp_crypto_keys_release().
+ * On error `out_keys` is left zeroed and nothing needs to be released.
+ */
+crisp_error_t crisp_crypto_keys_init(crisp_crypto_keys_t* out_keys,
+                                     const crisp_crypto_iface_t* iface,
+                                     crisp_const_byte_span_t kenc,
+                                     crisp_const_byte_span_t kmac);
+
+/** Releases prepared contexts (if any) and zeroes `keys`. Safe on a zeroed object. */
+void crisp_crypto_keys_release(crisp_crypto_keys_t* keys);
+
+/** Magma-CMAC with prepared Kmac context, falling back to the raw-key callback. */
+crisp_error_t crisp_crypto_cmac(const crisp_crypto_keys_t* keys,
+                                crisp_const_byte_span_t data,
+                                crisp_mutable_byte_span_t out_icv);
+
+/** Magma-CTR with prepared Kenc context, falling back to the raw-key callback. */
+crisp_error_t crisp_crypto_ctr_xcrypt(const crisp_crypto_keys_t* keys,
+                                      uint32_t iv32,
+                                      crisp_const_byte_span_t in,
+                                      crisp_mutable_byte_span_t out);
+
+/**
+ * Runs `count` CMAC jobs with the same Kmac.
+ * Uses the backend batch callback when available, otherwise crisp_crypto_cmac() per job.
+ * A non-OK result applies to the whole call; outputs of other jobs are then unspecified.
+ */
+crisp_error_t crisp_crypto_cmac_batch(const crisp_crypto_keys_t* keys,
+                                      const crisp_magma_cmac_job_t* jobs,
+                                      size_t count);
+
+/**
+ * Runs `count` CTR jobs with the same Kenc.
+ * Uses the backend batch callback when available, otherwise crisp_crypto_ctr_xcrypt() per job.
+ * A non-OK result applies to the whole call; outputs of other jobs are then unspecified.
+ */
+crisp_error_t crisp_crypto_ctr_xcrypt_batch(const crisp_crypto_keys_t* keys,
+                                            const crisp_magma_ctr_job_t* jobs,
+                                            size_t count);
+
+/**
+ * Caches the CMAC midstate over the whole blocks of `constant_bytes` (capped at
+ * CRISP_CMAC_PREFIX_MAX_SIZE) under the prepared Kmac context of `keys`.
+ * When the backend has no absorb/resume ops or `keys` carry no Kmac context, `out_prefix` is
+ * left empty (size 0) and CRISP_OK is returned. The cache is tied to the Kmac context and
+ * generation of `keys`; used with keys that do not match both, it falls back to a full CMAC.
+ */
+crisp_error_t crisp_cmac_prefix_init(crisp_cmac_prefix_t* out_prefix,
+                                     const crisp_crypto_keys_t* keys,
+                                     crisp_const_byte_span_t constant_bytes);
+
+/** Zeroes a cached prefix. */
+void crisp_cmac_prefix_clear(crisp_cmac_prefix_t* prefix);
+
+/**
+ * crisp_crypto_cmac() that resumes from `prefix` when it is non-empty, shorter than `data` and
+ * matches the start of `data`; otherwise (or with prefix == NULL) it computes a full CMAC.
+ */
+crisp_error_t crisp_crypto_cmac_prefixed(const crisp_crypto_keys_t* keys,
+                                         const crisp_cmac_prefix_t* prefix,
+                                         crisp_const_byte_span_t data,
+                                         crisp_mutable_byte_span_t out_icv);
+
+/** Returns true if `keys` hold both prepared contexts and the backend has both fused ops. */
+bool crisp_crypto_keys_have_fused(const crisp_crypto_keys_t* keys);
+
+/**
+ * Encrypts `in` into `auth` at `payload_offset` and MACs all of `auth` (see
+ * crisp_magma_ctr_then_cmac_fn), resuming from `prefix` like crisp_crypto_cmac_prefixed().
+ * Falls back to a CTR pass followed by a CMAC pass.
+ */
+crisp_error_t crisp_crypto_ctr_then_cmac(const crisp_crypto_keys_t* keys,
+                                         const crisp_cmac_prefix_t* prefix,
+                                         uint32_t iv32,
+                                         crisp_const_byte_span_t in,
+                                         crisp_mutable_byte_span_t auth,
+                                         size_t payload_offset,
+                                         crisp_mutable_byte_span_t out_icv);
+
+/**
+ * MACs `auth` and decrypts its payload into `out` (see crisp_magma_cmac_then_ctr_fn),
+ * resuming from `prefix` like crisp_crypto_cmac_prefixed().
+ * Falls back to a CMAC pass followed by a CTR pass.
+ */
+crisp_error_t crisp_crypto_cmac_then_ctr(const crisp_crypto_keys_t* keys,
+                                         const crisp_cmac_prefix_t* prefix,
+                                         uint32_t iv32,
+                                         crisp_const_byte_span_t auth,
+                                         size_t payload_offset,
+                                         crisp_mutable_byte_span_t out,
+                                         crisp_mutable_byte_span_t out_icv);
+
+/**
+ * Incremental keyed CMAC over a message fed in pieces of any size (crisp_crypto_cmac_stream_*).
+ * Up to one block is held back in `pending` because only the final block takes K1/K2.
+ */
+typedef struct crisp_cmac_stream {
+  crisp_cmac_midstate_t midstate;
+  /** Leading message bytes still to be dropped because a cached prefix already covers them. */
+  size_t skip;
+  size_t pending_size;
+  uint8_t pending[CRISP_CMAC_BLOCK_SIZE];
+} crisp_cmac_stream_t;
+
+/**
+ * Returns true if `keys` hold both prepared contexts and the backend has the segmented ops
+ * (magma_cmac_update, magma_cmac_final, magma_ctr_xcrypt_at).
+ */
+bool crisp_crypto_keys_have_segmented(const crisp_crypto_keys_t* keys);
+
+/**
+ * Starts a streamed CMAC. `head` is any contiguous start of the message (may be empty); when
+ * `prefix` matches it like in crisp_crypto_cmac_prefixed(), the stream resumes from the cached
+ * midstate and drops the covered bytes as they are fed. Requires
+ * crisp_crypto_keys_have_segmented(keys).
+ */
+crisp_error_t crisp_crypto_cmac_stream_init(const crisp_crypto_keys_t* keys,
+                                            const crisp_cmac_prefix_t* prefix,
+                                            crisp_const_byte_span_t head,
+                                            crisp_cmac_stream_t* out_stream);
+
+/** Feeds the next `data` bytes of the message; pieces may have any size. */
+crisp_error_t crisp_crypto_cmac_stream_update(const crisp_crypto_keys_t* keys,
+                                              crisp_cmac_stream_t* stream,
+                                              crisp_const_byte_span_t data);
+
+/** Finalizes the streamed CMAC and writes the tag; the ICV equals crisp_crypto_cmac(). */
+crisp_error_t crisp_crypto_cmac_stream_final(const crisp_crypto_keys_t* keys,
+                                             const crisp_cmac_stream_t* stream,
+                                             crisp_mutable_byte_span_t out_icv);
+
+/**
+ * CTR from keystream byte `offset` on (see crisp_magma_ctr_xcrypt_at_fn). Uses the backend
+ * callback with a prepared Kenc context; otherwise only offset 0 is supported and maps to
+ * crisp_crypto_ctr_xcrypt().
+ */
+crisp_error_t crisp_crypto_ctr_xcrypt_at(const crisp_crypto_keys_t* keys,
+                                         uint32_t iv32,
+                                         size_t offset,
+                                         crisp_const_byte_span_t in,
+                                         crisp_mutable_byte_span_t out);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
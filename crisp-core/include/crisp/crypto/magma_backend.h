@@ -0,0 +1,57 @@
+#ifndef CRISP_CRYPTO_MAGMA_BACKEND_H_
+#define CRISP_CRYPTO_MAGMA_BACKEND_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "crisp/crypto/iface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Magma key size in bytes (256-bit key). */
+#define CRISP_MAGMA_KEY_SIZE ((size_t)32U)
+/** Magma block size in bytes. */
+#define CRISP_MAGMA_BLOCK_SIZE ((size_t)8U)
+
+/** Multi-buffer engine used by the batch callbacks. */
+typedef enum crisp_magma_engine {
+  /** Engine for crisp_cpu_active_level(): AVX-512F, AVX2, otherwise scalar. */
+  CRISP_MAGMA_ENGINE_AUTO = 0,
+  /** Portable table-driven engine, 4 interleaved blocks. */
+  CRISP_MAGMA_ENGINE_SCALAR,
+  /** x86-64 AVX2, 8 lanes. */
+  CRISP_MAGMA_ENGINE_AVX2,
+  /** x86-64 AVX-512F, 16 lanes. */
+  CRISP_MAGMA_ENGINE_AVX512,
+} crisp_magma_engine_t;
+
+/**
+ * Initializes the Magma backend (GOST R 34.12-2015 block cipher, GOST R 34.13-2015 CTR and CMAC).
+ * - CTR uses the 64-bit counter block IV32 || 0^32, incremented per block.
+ * - CMAC output is truncated to the requested ICV size (MSB first, 1..8 bytes).
+ * - Keys must be exactly CRISP_MAGMA_KEY_SIZE bytes.
+ * Implements the keyed-context and batch APIs with CRISP_MAGMA_ENGINE_AUTO, resolved once
+ * here (so CRISP_CPU_LEVEL / crisp_cpu_force_level() apply to ifaces initialized afterwards).
+ * CTR uses the engine for single packets too; single-packet CMAC is a serial chain and stays
+ * scalar. derive_kenc_kmac is not provided.
+ */
+void crisp_magma_crypto_iface_init(crisp_crypto_iface_t* iface);
+
+/** Returns true when `engine` can run on this build and CPU (AUTO and SCALAR always can). */
+bool crisp_magma_engine_supported(crisp_magma_engine_t engine);
+
+/**
+ * Same as crisp_magma_crypto_iface_init() with an explicit batch engine.
+ * Every engine produces bit-identical output; single-packet callbacks are unaffected.
+ * Returns CRISP_ERR_NOT_SUPPORTED (iface untouched) when the engine cannot run here.
+ */
+crisp_error_t crisp_magma_crypto_iface_init_engine(crisp_crypto_iface_t* iface,
+                                                   crisp_magma_engine_t engine);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CRYPTO_MAGMA_BACKEND_H_
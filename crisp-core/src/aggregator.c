@@ -0,0 +1,186 @@
+#include "crisp/core/aggregator.h"
+
+#include <string.h>
+
+#include "mem_kernels.h"
+
+/** Lengths up to this value take a one-byte prefix; larger ones two bytes with the top bit set. */
+#define CRISP_AGGREGATE_SHORT_MAX ((size_t)0x7FU)
+
+size_t crisp_aggregate_frame_size(size_t message_size) {
+  return (message_size <= CRISP_AGGREGATE_SHORT_MAX ? 1U : CRISP_AGGREGATE_MAX_FRAME_HEADER) +
+         message_size;
+}
+
+crisp_error_t crisp_aggregator_init(crisp_aggregator_t* aggregator,
+                                    const crisp_aggregator_config_t* config) {
+  if (aggregator == NULL || config == NULL || config->session == NULL ||
+      config->session->keys.crypto == NULL || config->emit == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const size_t payload_offset = crisp_session_headroom(config->session);
+  const size_t overhead = payload_offset + config->session->suite_params.icv_size;
+  const size_t max_packet_size =
+      config->max_packet_size == 0U || config->max_packet_size > CRISP_MAX_MESSAGE_SIZE
+          ? CRISP_MAX_MESSAGE_SIZE
+          : config->max_packet_size;
+  if (max_packet_size <= overhead) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+
+  (void)memset(aggregator, 0, sizeof(*aggregator));
+  aggregator->session = config->session;
+  aggregator->emit = config->emit;
+  aggregator->user_ctx = config->user_ctx;
+  aggregator->payload_offset = payload_offset;
+  aggregator->capacity = max_packet_size - overhead;
+  aggregator->flush_threshold =
+      config->flush_threshold == 0U || config->flush_threshold > aggregator->capacity
+          ? aggregator->capacity
+          : config->flush_threshold;
+  aggregator->flush_timeout = config->flush_timeout;
+  return CRISP_OK;
+}
+
+/** Protects the pending payload in place under a fresh SeqNum and hands it to `emit`. */
+static crisp_error_t crisp_aggregator_send(crisp_aggregator_t* aggregator) {
+  const size_t payload_size = aggregator->pending_size;
+  aggregator->pending_size = 0U;
+  aggregator->pending_count = 0U;
+
+  crisp_seqnum_block_t block;
+  crisp_error_t err = crisp_session_reserve_seqnums(aggregator->session, 1U, &block);
+  crisp_mutable_byte_span_t packet = {NULL, 0U};
+  if (err == CRISP_OK) {
+    const crisp_mutable_byte_span_t buffer = {
+        .data = aggregator->packet,
+        .size = sizeof(aggregator->packet),
+    };
+    err = crisp_session_protect_in_place(aggregator->session, block.next, buffer,
+                                         aggregator->payload_offset, payload_size, &packet);
+  }
+  if (err != CRISP_OK) {
+    /* The dropped messages may still be plaintext in the buffer. */
+    crisp_secure_zero(aggregator->packet + aggregator->payload_offset, payload_size);
+    return err;
+  }
+  const crisp_const_byte_span_t emitted = {
+      .data = packet.data,
+      .size = packet.size,
+  };
+  return aggregator->emit(aggregator->user_ctx, emitted, block.next);
+}
+
+static bool crisp_aggregator_expired(const crisp_aggregator_t* aggregator, uint64_t now) {
+  return aggregator->pending_count > 0U && aggregator->flush_timeout > 0U &&
+         now - aggregator->pending_since >= aggregator->flush_timeout;
+}
+
+crisp_error_t crisp_aggregator_push(crisp_aggregator_t* aggregator,
+                                    crisp_const_byte_span_t message,
+                                    uint64_t now) {
+  if (aggregator == NULL || aggregator->session == NULL ||
+      (message.size > 0U && message.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (message.size > aggregator->capacity) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  const size_t frame_size = crisp_aggregate_frame_size(message.size);
+  if (frame_size > aggregator->capacity) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+
+  crisp_error_t err = CRISP_OK;
+  if (crisp_aggregator_expired(aggregator, now) ||
+      (aggregator->pending_count > 0U &&
+       frame_size > aggregator->capacity - aggregator->pending_size)) {
+    err = crisp_aggregator_send(aggregator);
+    if (err != CRISP_OK) {
+      return err;
+    }
+  }
+
+  if (aggregator->pending_count == 0U) {
+    aggregator->pending_since = now;
+  }
+  uint8_t* out = aggregator->packet + aggregator->payload_offset + aggregator->pending_size;
+  if (message.size <= CRISP_AGGREGATE_SHORT_MAX) {
+    *out++ = (uint8_t)message.size;
+  } else {
+    /* capacity < CRISP_MAX_MESSAGE_SIZE, so the length fits the two-byte prefix. */
+    *out++ = (uint8_t)(0x80U | (message.size >> 8U));
+    *out++ = (uint8_t)(message.size & 0xFFU);
+  }
+  if (message.size > 0U) {
+    (void)memcpy(out, message.data, message.size);
+  }
+  aggregator->pending_size += frame_size;
+  ++aggregator->pending_count;
+
+  if (aggregator->pending_size >= aggregator->flush_threshold) {
+    err = crisp_aggregator_send(aggregator);
+  }
+  return err;
+}
+
+crisp_error_t crisp_aggregator_poll(crisp_aggregator_t* aggregator, uint64_t now) {
+  if (aggregator == NULL || aggregator->session == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  return crisp_aggregator_expired(aggregator, now) ? crisp_aggregator_send(aggregator)
+                                                   : CRISP_OK;
+}
+
+crisp_error_t crisp_aggregator_flush(crisp_aggregator_t* aggregator) {
+  if (aggregator == NULL || aggregator->session == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  return aggregator->pending_count > 0U ? crisp_aggregator_send(aggregator) : CRISP_OK;
+}
+
+void crisp_aggregator_clear(crisp_aggregator_t* aggregator) {
+  if (aggregator == NULL) {
+    return;
+  }
+  crisp_secure_zero(aggregator, sizeof(*aggregator));
+}
+
+crisp_error_t crisp_aggregate_split(crisp_const_byte_span_t payload,
+                                    crisp_const_byte_span_t* out_messages,
+                                    size_t max_messages,
+                                    size_t* out_count) {
+  if (out_count == NULL || (payload.size > 0U && payload.data == NULL) ||
+      (max_messages > 0U && out_messages == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  *out_count = 0U;
+
+  size_t offset = 0U;
+  size_t count = 0U;
+  while (offset < payload.size) {
+    size_t length = payload.data[offset++];
+    if (length > CRISP_AGGREGATE_SHORT_MAX) {
+      if (offset == payload.size) {
+        return CRISP_ERR_INVALID_FORMAT;
+      }
+      length = ((length & 0x7FU) << 8U) | payload.data[offset++];
+      /* Only the shortest encoding is accepted, so every payload has one framing. */
+      if (length <= CRISP_AGGREGATE_SHORT_MAX) {
+        return CRISP_ERR_INVALID_FORMAT;
+      }
+    }
+    if (length > payload.size - offset) {
+      return CRISP_ERR_INVALID_FORMAT;
+    }
+    if (count == max_messages) {
+      return CRISP_ERR_BUFFER_TOO_SMALL;
+    }
+    out_messages[count].data = payload.data + offset;
+    out_messages[count].size = length;
+    offset += length;
+    ++count;
+  }
+  *out_count = count;
+  return CRISP_OK;
+}
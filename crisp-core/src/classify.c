@@ -0,0 +1,269 @@
+#include "crisp/core/classify.h"
+
+#include <string.h>
+
+#include "crisp/core/message.h"
+
+#if defined(__SSE2__)
+#define CRISP_CLASSIFY_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/*
+ * Fast-path layout: prefix, a one-byte or unused KeyId, then the SeqNum at a fixed offset.
+ * Packets of at least CRISP_CLASSIFY_FAST_MIN_SIZE bytes have room for either ICV size, and
+ * the 8-byte SeqNum load starting at the CS byte stays inside them.
+ */
+#define CRISP_CLASSIFY_FAST_SEQNUM_OFFSET (CRISP_MESSAGE_HEADER_PREFIX_SIZE + 1U)
+#define CRISP_CLASSIFY_FAST_PAYLOAD_OFFSET \
+  (CRISP_CLASSIFY_FAST_SEQNUM_OFFSET + CRISP_MESSAGE_SEQNUM_SIZE)
+#define CRISP_CLASSIFY_FAST_MIN_SIZE (CRISP_CLASSIFY_FAST_PAYLOAD_OFFSET + 8U)
+#define CRISP_CLASSIFY_FAST_LOAD_OFFSET (CRISP_CLASSIFY_FAST_SEQNUM_OFFSET + 6U - 8U)
+
+/* First four header bytes as a little-endian word: flag|version, version, CS, KeyId byte. */
+#define CRISP_CLASSIFY_VERSION_MASK 0x0000FF7FU
+#define CRISP_CLASSIFY_SUITE_MIN 1U
+#define CRISP_CLASSIFY_SUITE_MAX 4U
+/* CS3 and CS4 carry an 8-byte ICV, CS1 and CS2 a 4-byte one. */
+#define CRISP_CLASSIFY_SHORT_ICV_SUITE_MAX 2U
+
+_Static_assert(CRISP_VERSION_2024 == 0U, "fast path assumes version 0");
+_Static_assert(CRISP_MAX_MESSAGE_SIZE <= UINT16_MAX, "offsets must fit uint16_t outputs");
+
+typedef struct crisp_classify_entry {
+  crisp_error_t status;
+  uint8_t cs;
+  uint8_t flags;
+  uint64_t seqnum;
+  uint16_t key_id_offset;
+  uint16_t key_id_size;
+  uint16_t payload_offset;
+  uint16_t payload_size;
+} crisp_classify_entry_t;
+
+static void crisp_classify_store(const crisp_classify_batch_out_t* out,
+                                 size_t index,
+                                 const crisp_classify_entry_t* entry) {
+  out->status[index] = entry->status;
+  if (out->cs != NULL) {
+    out->cs[index] = entry->cs;
+  }
+  if (out->flags != NULL) {
+    out->flags[index] = entry->flags;
+  }
+  if (out->seqnum != NULL) {
+    out->seqnum[index] = entry->seqnum;
+  }
+  if (out->key_id_offset != NULL) {
+    out->key_id_offset[index] = entry->key_id_offset;
+  }
+  if (out->key_id_size != NULL) {
+    out->key_id_size[index] = entry->key_id_size;
+  }
+  if (out->payload_offset != NULL) {
+    out->payload_offset[index] = entry->payload_offset;
+  }
+  if (out->payload_size != NULL) {
+    out->payload_size[index] = entry->payload_size;
+  }
+}
+
+/* Header word of a packet, or one that fails the version check if it is too short to hold it. */
+static uint32_t crisp_classify_header_word(crisp_const_byte_span_t packet) {
+  if (packet.data == NULL || packet.size < sizeof(uint32_t)) {
+    return UINT32_MAX;
+  }
+  return (uint32_t)packet.data[0] | ((uint32_t)packet.data[1] << 8U) |
+         ((uint32_t)packet.data[2] << 16U) | ((uint32_t)packet.data[3] << 24U);
+}
+
+static uint32_t crisp_classify_icv_size(uint32_t cs) {
+  return cs <= CRISP_CLASSIFY_SHORT_ICV_SUITE_MAX ? 4U : 8U;
+}
+
+/*
+ * Scalar path for any layout. Checks run in the order crisp_parse_message() applies them so
+ * that the first failing one picks the same status.
+ */
+static crisp_error_t crisp_classify_decode(crisp_const_byte_span_t packet,
+                                           crisp_classify_entry_t* entry) {
+  if (packet.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (packet.size > CRISP_MAX_MESSAGE_SIZE ||
+      packet.size < CRISP_MESSAGE_HEADER_PREFIX_SIZE + 1U + CRISP_MESSAGE_SEQNUM_SIZE + 4U) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  const uint32_t header = crisp_classify_header_word(packet);
+  if ((header & CRISP_CLASSIFY_VERSION_MASK) != 0U) {
+    return CRISP_ERR_INVALID_FORMAT;
+  }
+  const uint32_t cs = (header >> 16U) & 0xFFU;
+  if (cs < CRISP_CLASSIFY_SUITE_MIN || cs > CRISP_CLASSIFY_SUITE_MAX) {
+    return CRISP_ERR_UNSUPPORTED_SUITE;
+  }
+
+  const uint8_t first = (uint8_t)(header >> 24U);
+  size_t key_id_size = 1U;
+  if ((first & 0x80U) != 0U && first != CRISP_KEY_ID_UNUSED_MARKER) {
+    /* 1 + 7 length bits never exceeds CRISP_MAX_KEY_ID_SIZE, so only truncation can fail. */
+    key_id_size = 1U + (size_t)(first & 0x7FU);
+    if (CRISP_MESSAGE_HEADER_PREFIX_SIZE + key_id_size > packet.size) {
+      return CRISP_ERR_INVALID_SIZE;
+    }
+  }
+  const size_t seqnum_offset = CRISP_MESSAGE_HEADER_PREFIX_SIZE + key_id_size;
+  const size_t payload_offset = seqnum_offset + CRISP_MESSAGE_SEQNUM_SIZE;
+  const size_t icv_size = crisp_classify_icv_size(cs);
+  if (payload_offset > packet.size || packet.size - payload_offset < icv_size) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+
+  uint64_t seqnum = 0U;
+  for (size_t i = 0U; i < CRISP_MESSAGE_SEQNUM_SIZE; ++i) {
+    seqnum = (seqnum << 8U) | (uint64_t)packet.data[seqnum_offset + i];
+  }
+  const bool key_id_present = first != CRISP_KEY_ID_UNUSED_MARKER;
+  entry->cs = (uint8_t)cs;
+  entry->flags = (uint8_t)(((header & 0x80U) != 0U ? CRISP_CLASSIFY_FLAG_EXTERNAL_KEY_ID : 0U) |
+                           (key_id_present ? CRISP_CLASSIFY_FLAG_KEY_ID_PRESENT : 0U));
+  entry->seqnum = seqnum;
+  entry->key_id_offset = key_id_present ? (uint16_t)CRISP_MESSAGE_HEADER_PREFIX_SIZE : 0U;
+  entry->key_id_size = key_id_present ? (uint16_t)key_id_size : 0U;
+  entry->payload_offset = (uint16_t)payload_offset;
+  entry->payload_size = (uint16_t)(packet.size - payload_offset - icv_size);
+  return CRISP_OK;
+}
+
+static void crisp_classify_slow(crisp_const_byte_span_t packet,
+                                const crisp_classify_batch_out_t* out,
+                                size_t index) {
+  crisp_classify_entry_t entry;
+  (void)memset(&entry, 0, sizeof(entry));
+  const crisp_error_t status = crisp_classify_decode(packet, &entry);
+  if (status != CRISP_OK) {
+    (void)memset(&entry, 0, sizeof(entry));
+  }
+  entry.status = status;
+  crisp_classify_store(out, index, &entry);
+}
+
+#if defined(CRISP_CLASSIFY_HAVE_SSE2)
+
+/* Big-endian 48-bit SeqNum as the low bytes of one 8-byte load ending at the SeqNum. */
+static uint64_t crisp_classify_load_seqnum(const uint8_t* packet) {
+  uint64_t word = 0U;
+  (void)memcpy(&word, packet + CRISP_CLASSIFY_FAST_LOAD_OFFSET, sizeof(word));
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  word = __builtin_bswap64(word);
+#elif !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+  const uint8_t* bytes = packet + CRISP_CLASSIFY_FAST_LOAD_OFFSET;
+  word = 0U;
+  for (size_t i = 0U; i < sizeof(word); ++i) {
+    word = (word << 8U) | (uint64_t)bytes[i];
+  }
+#endif
+  return word & CRISP_SEQNUM_MAX;
+}
+
+static void crisp_classify_fast(crisp_const_byte_span_t packet,
+                                uint32_t header,
+                                uint32_t payload_size,
+                                const crisp_classify_batch_out_t* out,
+                                size_t index) {
+  const bool key_id_present = (header >> 24U) != CRISP_KEY_ID_UNUSED_MARKER;
+  crisp_classify_entry_t entry = {
+      .status = CRISP_OK,
+      .cs = (uint8_t)(header >> 16U),
+      .flags = (uint8_t)(((header & 0x80U) != 0U ? CRISP_CLASSIFY_FLAG_EXTERNAL_KEY_ID : 0U) |
+                         (key_id_present ? CRISP_CLASSIFY_FLAG_KEY_ID_PRESENT : 0U)),
+      .seqnum = crisp_classify_load_seqnum(packet.data),
+      .key_id_offset = key_id_present ? (uint16_t)CRISP_MESSAGE_HEADER_PREFIX_SIZE : 0U,
+      .key_id_size = key_id_present ? 1U : 0U,
+      .payload_offset = (uint16_t)CRISP_CLASSIFY_FAST_PAYLOAD_OFFSET,
+      .payload_size = (uint16_t)payload_size,
+  };
+  crisp_classify_store(out, index, &entry);
+}
+
+/* Sizes above the message limit clamp to a value that still fails the size check. */
+static int crisp_classify_lane_size(size_t size) {
+  return size > CRISP_MAX_MESSAGE_SIZE ? (int)CRISP_MAX_MESSAGE_SIZE + 1 : (int)size;
+}
+
+/*
+ * Validates the headers of one group with 32-bit lane compares and computes the fast-path
+ * payload sizes alongside; packets failing any check go to the scalar parser.
+ */
+static void crisp_classify_group(const crisp_const_byte_span_t* packets,
+                                 const crisp_classify_batch_out_t* out,
+                                 size_t base) {
+  uint32_t headers[CRISP_CLASSIFY_GROUP_SIZE];
+  for (size_t lane = 0U; lane < CRISP_CLASSIFY_GROUP_SIZE; ++lane) {
+    headers[lane] = crisp_classify_header_word(packets[base + lane]);
+  }
+  const __m128i header = _mm_loadu_si128((const __m128i*)(const void*)headers);
+  const __m128i size =
+      _mm_set_epi32(crisp_classify_lane_size(packets[base + 3U].size),
+                    crisp_classify_lane_size(packets[base + 2U].size),
+                    crisp_classify_lane_size(packets[base + 1U].size),
+                    crisp_classify_lane_size(packets[base].size));
+
+  const __m128i cs = _mm_and_si128(_mm_srli_epi32(header, 16), _mm_set1_epi32(0xFF));
+  const __m128i key_id_byte = _mm_srli_epi32(header, 24);
+  const __m128i version_ok = _mm_cmpeq_epi32(
+      _mm_and_si128(header, _mm_set1_epi32((int)CRISP_CLASSIFY_VERSION_MASK)),
+      _mm_setzero_si128());
+  const __m128i cs_ok =
+      _mm_and_si128(_mm_cmpgt_epi32(cs, _mm_set1_epi32((int)CRISP_CLASSIFY_SUITE_MIN - 1)),
+                    _mm_cmplt_epi32(cs, _mm_set1_epi32((int)CRISP_CLASSIFY_SUITE_MAX + 1)));
+  const __m128i key_id_ok =
+      _mm_cmplt_epi32(key_id_byte, _mm_set1_epi32((int)CRISP_KEY_ID_UNUSED_MARKER + 1));
+  const __m128i size_ok = _mm_and_si128(
+      _mm_cmpgt_epi32(size, _mm_set1_epi32((int)CRISP_CLASSIFY_FAST_MIN_SIZE - 1)),
+      _mm_cmplt_epi32(size, _mm_set1_epi32((int)CRISP_MAX_MESSAGE_SIZE + 1)));
+  const __m128i ok =
+      _mm_and_si128(_mm_and_si128(version_ok, cs_ok), _mm_and_si128(key_id_ok, size_ok));
+  const int mask = _mm_movemask_ps(_mm_castsi128_ps(ok));
+
+  const __m128i long_icv = _mm_and_si128(
+      _mm_cmpgt_epi32(cs, _mm_set1_epi32((int)CRISP_CLASSIFY_SHORT_ICV_SUITE_MAX)),
+      _mm_set1_epi32(4));
+  const __m128i payload_size = _mm_sub_epi32(
+      size, _mm_add_epi32(long_icv, _mm_set1_epi32((int)CRISP_CLASSIFY_FAST_PAYLOAD_OFFSET + 4)));
+  uint32_t payload_sizes[CRISP_CLASSIFY_GROUP_SIZE];
+  _mm_storeu_si128((__m128i*)(void*)payload_sizes, payload_size);
+
+  for (size_t lane = 0U; lane < CRISP_CLASSIFY_GROUP_SIZE; ++lane) {
+    if (((unsigned)mask & (1U << lane)) != 0U) {
+      crisp_classify_fast(packets[base + lane], headers[lane], payload_sizes[lane], out,
+                          base + lane);
+    } else {
+      crisp_classify_slow(packets[base + lane], out, base + lane);
+    }
+  }
+}
+
+#endif  // CRISP_CLASSIFY_HAVE_SSE2
+
+crisp_error_t crisp_classify_batch(const crisp_const_byte_span_t* packets,
+                                   size_t count,
+                                   const crisp_classify_batch_out_t* out) {
+  if (count == 0U) {
+    return CRISP_OK;
+  }
+  if (packets == NULL || out == NULL || out->status == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  size_t i = 0U;
+#if defined(CRISP_CLASSIFY_HAVE_SSE2)
+  for (; i + CRISP_CLASSIFY_GROUP_SIZE <= count; i += CRISP_CLASSIFY_GROUP_SIZE) {
+    crisp_classify_group(packets, out, i);
+  }
+#endif
+  for (; i < count; ++i) {
+    crisp_classify_slow(packets[i], out, i);
+  }
+  return CRISP_OK;
+}
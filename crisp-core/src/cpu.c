@@ -0,0 +1,88 @@
+#include "crisp/core/cpu.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem_kernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRISP_CPU_HAVE_X86_DETECT 1
+#else
+#define CRISP_CPU_HAVE_X86_DETECT 0
+#endif
+
+/** -1 means "no forced level". Read by any thread that resolves the mem-kernel table. */
+static _Atomic int g_crisp_cpu_forced_level = -1;
+
+static const char* const k_crisp_cpu_level_names[] = {"scalar", "sse42", "avx2", "avx512"};
+
+crisp_cpu_level_t crisp_cpu_detected_level(void) {
+#if CRISP_CPU_HAVE_X86_DETECT
+  /* __builtin_cpu_supports also checks that the OS saves the wider register state. */
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return CRISP_CPU_LEVEL_AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return CRISP_CPU_LEVEL_AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return CRISP_CPU_LEVEL_SSE42;
+  }
+#endif
+  return CRISP_CPU_LEVEL_SCALAR;
+}
+
+crisp_cpu_level_t crisp_cpu_active_level(void) {
+  const crisp_cpu_level_t detected = crisp_cpu_detected_level();
+  crisp_cpu_level_t cap = detected;
+  const int forced = atomic_load_explicit(&g_crisp_cpu_forced_level, memory_order_relaxed);
+  if (forced >= 0) {
+    cap = (crisp_cpu_level_t)forced;
+  } else {
+    const char* env = getenv(CRISP_CPU_LEVEL_ENV);
+    if (env != NULL) {
+      (void)crisp_cpu_parse_level(env, &cap);
+    }
+  }
+  return cap < detected ? cap : detected;
+}
+
+crisp_error_t crisp_cpu_force_level(crisp_cpu_level_t level) {
+  if ((int)level < (int)CRISP_CPU_LEVEL_SCALAR || (int)level > (int)CRISP_CPU_LEVEL_AVX512) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (level > crisp_cpu_detected_level()) {
+    return CRISP_ERR_NOT_SUPPORTED;
+  }
+  atomic_store_explicit(&g_crisp_cpu_forced_level, (int)level, memory_order_relaxed);
+  crisp_mem_kernels_reset();
+  return CRISP_OK;
+}
+
+void crisp_cpu_reset_level(void) {
+  atomic_store_explicit(&g_crisp_cpu_forced_level, -1, memory_order_relaxed);
+  crisp_mem_kernels_reset();
+}
+
+bool crisp_cpu_parse_level(const char* name, crisp_cpu_level_t* out_level) {
+  if (name == NULL || out_level == NULL) {
+    return false;
+  }
+  for (size_t i = 0U; i < sizeof(k_crisp_cpu_level_names) / sizeof(k_crisp_cpu_level_names[0]);
+       ++i) {
+    if (strcmp(name, k_crisp_cpu_level_names[i]) == 0) {
+      *out_level = (crisp_cpu_level_t)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* crisp_cpu_level_name(crisp_cpu_level_t level) {
+  if ((int)level < (int)CRISP_CPU_LEVEL_SCALAR || (int)level > (int)CRISP_CPU_LEVEL_AVX512) {
+    return "unknown";
+  }
+  return k_crisp_cpu_level_names[level];
+}
@@ -1,5 +1,18 @@
 #include "crisp/crypto/iface.h"
 
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mem_kernels.h"
+
+/* Source of crisp_crypto_keys_t::generation; 0 is never handed out. */
+static _Atomic uint64_t g_crisp_crypto_keys_generation = 0U;
+
+static uint64_t crisp_crypto_keys_next_generation(void) {
+  return atomic_fetch_add_explicit(&g_crisp_crypto_keys_generation, 1U, memory_order_relaxed) + 1U;
+}
+
 crisp_error_t crisp_derive_kenc_kmac(const crisp_crypto_iface_t* iface,
                                      crisp_const_byte_span_t master_key,
                                      crisp_const_byte_span_t salt,
@@ -17,3 +30,418 @@ crisp_error_t crisp_derive_kenc_kmac(const crisp_crypto_iface_t* iface,
 
   return iface->derive_kenc_kmac(iface->user_ctx, master_key, salt, out_kenc, out_kmac);
 }
+
+bool crisp_crypto_iface_has_keyed_api(const crisp_crypto_iface_t* iface) {
+  return iface != NULL && iface->magma_key_init != NULL && iface->magma_key_release != NULL &&
+         iface->magma_cmac_keyed != NULL && iface->magma_ctr_xcrypt_keyed != NULL;
+}
+
+crisp_error_t crisp_crypto_keys_init(crisp_crypto_keys_t* out_keys,
+                                     const crisp_crypto_iface_t* iface,
+                                     crisp_const_byte_span_t kenc,
+                                     crisp_const_byte_span_t kmac) {
+  if (out_keys == NULL || iface == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  (void)memset(out_keys, 0, sizeof(*out_keys));
+  if ((kenc.size > 0U && kenc.data == NULL) || (kmac.size > 0U && kmac.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  if (!crisp_crypto_iface_has_keyed_api(iface)) {
+    out_keys->crypto = iface;
+    out_keys->kenc = kenc;
+    out_keys->kmac = kmac;
+    out_keys->generation = crisp_crypto_keys_next_generation();
+    return CRISP_OK;
+  }
+
+  void* kenc_ctx = NULL;
+  crisp_error_t err = iface->magma_key_init(iface->user_ctx, kenc, &kenc_ctx);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  void* kmac_ctx = NULL;
+  err = iface->magma_key_init(iface->user_ctx, kmac, &kmac_ctx);
+  if (err != CRISP_OK) {
+    iface->magma_key_release(iface->user_ctx, kenc_ctx);
+    return err;
+  }
+  if (kenc_ctx == NULL || kmac_ctx == NULL) {
+    iface->magma_key_release(iface->user_ctx, kenc_ctx);
+    iface->magma_key_release(iface->user_ctx, kmac_ctx);
+    return CRISP_ERR_CRYPTO;
+  }
+
+  out_keys->crypto = iface;
+  out_keys->kenc_ctx = kenc_ctx;
+  out_keys->kmac_ctx = kmac_ctx;
+  out_keys->generation = crisp_crypto_keys_next_generation();
+  return CRISP_OK;
+}
+
+void crisp_crypto_keys_release(crisp_crypto_keys_t* keys) {
+  if (keys == NULL) {
+    return;
+  }
+  if (keys->crypto != NULL && keys->crypto->magma_key_release != NULL) {
+    if (keys->kenc_ctx != NULL) {
+      keys->crypto->magma_key_release(keys->crypto->user_ctx, keys->kenc_ctx);
+    }
+    if (keys->kmac_ctx != NULL) {
+      keys->crypto->magma_key_release(keys->crypto->user_ctx, keys->kmac_ctx);
+    }
+  }
+  (void)memset(keys, 0, sizeof(*keys));
+}
+
+crisp_error_t crisp_crypto_cmac(const crisp_crypto_keys_t* keys,
+                                crisp_const_byte_span_t data,
+                                crisp_mutable_byte_span_t out_icv) {
+  if (keys == NULL || keys->crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_crypto_iface_t* iface = keys->crypto;
+  if (keys->kmac_ctx != NULL && iface->magma_cmac_keyed != NULL) {
+    return iface->magma_cmac_keyed(iface->user_ctx, keys->kmac_ctx, data, out_icv);
+  }
+  if (iface->magma_cmac == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  return iface->magma_cmac(iface->user_ctx, keys->kmac, data, out_icv);
+}
+
+crisp_error_t crisp_crypto_ctr_xcrypt(const crisp_crypto_keys_t* keys,
+                                      uint32_t iv32,
+                                      crisp_const_byte_span_t in,
+                                      crisp_mutable_byte_span_t out) {
+  if (keys == NULL || keys->crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_crypto_iface_t* iface = keys->crypto;
+  if (keys->kenc_ctx != NULL && iface->magma_ctr_xcrypt_keyed != NULL) {
+    return iface->magma_ctr_xcrypt_keyed(iface->user_ctx, keys->kenc_ctx, iv32, in, out);
+  }
+  if (iface->magma_ctr_xcrypt == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  return iface->magma_ctr_xcrypt(iface->user_ctx, keys->kenc, iv32, in, out);
+}
+
+crisp_error_t crisp_crypto_cmac_batch(const crisp_crypto_keys_t* keys,
+                                      const crisp_magma_cmac_job_t* jobs,
+                                      size_t count) {
+  if (keys == NULL || keys->crypto == NULL || (count > 0U && jobs == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (count == 0U) {
+    return CRISP_OK;
+  }
+  const crisp_crypto_iface_t* iface = keys->crypto;
+  if (keys->kmac_ctx != NULL && iface->magma_cmac_batch != NULL) {
+    return iface->magma_cmac_batch(iface->user_ctx, keys->kmac_ctx, jobs, count);
+  }
+
+  for (size_t i = 0U; i < count; ++i) {
+    const crisp_error_t err = crisp_crypto_cmac(keys, jobs[i].data, jobs[i].out_icv);
+    if (err != CRISP_OK) {
+      return err;
+    }
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_crypto_ctr_xcrypt_batch(const crisp_crypto_keys_t* keys,
+                                            const crisp_magma_ctr_job_t* jobs,
+                                            size_t count) {
+  if (keys == NULL || keys->crypto == NULL || (count > 0U && jobs == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (count == 0U) {
+    return CRISP_OK;
+  }
+  const crisp_crypto_iface_t* iface = keys->crypto;
+  if (keys->kenc_ctx != NULL && iface->magma_ctr_xcrypt_batch != NULL) {
+    return iface->magma_ctr_xcrypt_batch(iface->user_ctx, keys->kenc_ctx, jobs, count);
+  }
+
+  for (size_t i = 0U; i < count; ++i) {
+    const crisp_error_t err = crisp_crypto_ctr_xcrypt(keys, jobs[i].iv32, jobs[i].in, jobs[i].out);
+    if (err != CRISP_OK) {
+      return err;
+    }
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_cmac_prefix_init(crisp_cmac_prefix_t* out_prefix,
+                                     const crisp_crypto_keys_t* keys,
+                                     crisp_const_byte_span_t constant_bytes) {
+  if (out_prefix == NULL || keys == NULL || keys->crypto == NULL ||
+      (constant_bytes.size > 0U && constant_bytes.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  (void)memset(out_prefix, 0, sizeof(*out_prefix));
+
+  const crisp_crypto_iface_t* iface = keys->crypto;
+  if (keys->kmac_ctx == NULL || iface->magma_cmac_absorb == NULL ||
+      iface->magma_cmac_resume == NULL) {
+    return CRISP_OK;
+  }
+
+  size_t size = constant_bytes.size < CRISP_CMAC_PREFIX_MAX_SIZE ? constant_bytes.size
+                                                                  : CRISP_CMAC_PREFIX_MAX_SIZE;
+  size -= size % CRISP_CMAC_BLOCK_SIZE;
+  if (size == 0U) {
+    return CRISP_OK;
+  }
+
+  const crisp_const_byte_span_t prefix = {
+      .data = constant_bytes.data,
+      .size = size,
+  };
+  const crisp_error_t err =
+      iface->magma_cmac_absorb(iface->user_ctx, keys->kmac_ctx, prefix, &out_prefix->midstate);
+  if (err != CRISP_OK) {
+    (void)memset(out_prefix, 0, sizeof(*out_prefix));
+    return err;
+  }
+  out_prefix->kmac_ctx = keys->kmac_ctx;
+  out_prefix->generation = keys->generation;
+  out_prefix->size = size;
+  (void)memcpy(out_prefix->bytes, constant_bytes.data, size);
+  return CRISP_OK;
+}
+
+void crisp_cmac_prefix_clear(crisp_cmac_prefix_t* prefix) {
+  if (prefix == NULL) {
+    return;
+  }
+  crisp_secure_zero(prefix, sizeof(*prefix));
+}
+
+/**
+ * Returns the cached midstate when it applies to `data` under `keys`: non-empty, computed with
+ * the same Kmac context and key generation, no longer than `limit`, shorter than `data` and
+ * byte-identical to the start of `data`. Otherwise returns NULL.
+ */
+static const crisp_cmac_midstate_t* crisp_cmac_prefix_match(const crisp_crypto_keys_t* keys,
+                                                            const crisp_cmac_prefix_t* prefix,
+                                                            crisp_const_byte_span_t data,
+                                                            size_t limit) {
+  if (prefix == NULL || prefix->size == 0U || prefix->size > limit ||
+      prefix->size >= data.size || data.data == NULL || keys->kmac_ctx == NULL ||
+      prefix->kmac_ctx != keys->kmac_ctx || prefix->generation != keys->generation ||
+      keys->crypto->magma_cmac_resume == NULL) {
+    return NULL;
+  }
+  if (memcmp(data.data, prefix->bytes, prefix->size) != 0) {
+    return NULL;
+  }
+  return &prefix->midstate;
+}
+
+crisp_error_t crisp_crypto_cmac_prefixed(const crisp_crypto_keys_t* keys,
+                                         const crisp_cmac_prefix_t* prefix,
+                                         crisp_const_byte_span_t data,
+                                         crisp_mutable_byte_span_t out_icv) {
+  if (keys == NULL || keys->crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_cmac_midstate_t* midstate = crisp_cmac_prefix_match(keys, prefix, data, SIZE_MAX);
+  if (midstate != NULL) {
+    return keys->crypto->magma_cmac_resume(keys->crypto->user_ctx, keys->kmac_ctx, midstate, data,
+                                           out_icv);
+  }
+  return crisp_crypto_cmac(keys, data, out_icv);
+}
+
+bool crisp_crypto_keys_have_fused(const crisp_crypto_keys_t* keys) {
+  return keys != NULL && keys->crypto != NULL && keys->kenc_ctx != NULL &&
+         keys->kmac_ctx != NULL && keys->crypto->magma_ctr_then_cmac != NULL &&
+         keys->crypto->magma_cmac_then_ctr != NULL;
+}
+
+crisp_error_t crisp_crypto_ctr_then_cmac(const crisp_crypto_keys_t* keys,
+                                         const crisp_cmac_prefix_t* prefix,
+                                         uint32_t iv32,
+                                         crisp_const_byte_span_t in,
+                                         crisp_mutable_byte_span_t auth,
+                                         size_t payload_offset,
+                                         crisp_mutable_byte_span_t out_icv) {
+  if (keys == NULL || keys->crypto == NULL || auth.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (payload_offset > auth.size || in.size != auth.size - payload_offset) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  const crisp_const_byte_span_t authenticated = {
+      .data = auth.data,
+      .size = auth.size,
+  };
+  if (crisp_crypto_keys_have_fused(keys)) {
+    /* Ciphertext is not written yet, so only header bytes may be matched against the cache. */
+    const crisp_cmac_midstate_t* midstate =
+        crisp_cmac_prefix_match(keys, prefix, authenticated, payload_offset);
+    return keys->crypto->magma_ctr_then_cmac(keys->crypto->user_ctx, keys->kenc_ctx,
+                                             keys->kmac_ctx, midstate, iv32, in, auth,
+                                             payload_offset, out_icv);
+  }
+
+  crisp_mutable_byte_span_t ciphertext = {
+      .data = auth.data + payload_offset,
+      .size = in.size,
+  };
+  const crisp_error_t err = crisp_crypto_ctr_xcrypt(keys, iv32, in, ciphertext);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_crypto_cmac_prefixed(keys, prefix, authenticated, out_icv);
+}
+
+crisp_error_t crisp_crypto_cmac_then_ctr(const crisp_crypto_keys_t* keys,
+                                         const crisp_cmac_prefix_t* prefix,
+                                         uint32_t iv32,
+                                         crisp_const_byte_span_t auth,
+                                         size_t payload_offset,
+                                         crisp_mutable_byte_span_t out,
+                                         crisp_mutable_byte_span_t out_icv) {
+  if (keys == NULL || keys->crypto == NULL || auth.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (payload_offset > auth.size || out.size != auth.size - payload_offset) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  if (crisp_crypto_keys_have_fused(keys)) {
+    const crisp_cmac_midstate_t* midstate =
+        crisp_cmac_prefix_match(keys, prefix, auth, payload_offset);
+    return keys->crypto->magma_cmac_then_ctr(keys->crypto->user_ctx, keys->kenc_ctx,
+                                             keys->kmac_ctx, midstate, iv32, auth, payload_offset,
+                                             out, out_icv);
+  }
+
+  const crisp_error_t err = crisp_crypto_cmac_prefixed(keys, prefix, auth, out_icv);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  const crisp_const_byte_span_t ciphertext = {
+      .data = auth.data + payload_offset,
+      .size = out.size,
+  };
+  return crisp_crypto_ctr_xcrypt(keys, iv32, ciphertext, out);
+}
+
+bool crisp_crypto_keys_have_segmented(const crisp_crypto_keys_t* keys) {
+  return keys != NULL && keys->crypto != NULL && keys->kenc_ctx != NULL &&
+         keys->kmac_ctx != NULL && keys->crypto->magma_cmac_update != NULL &&
+         keys->crypto->magma_cmac_final != NULL && keys->crypto->magma_ctr_xcrypt_at != NULL;
+}
+
+crisp_error_t crisp_crypto_cmac_stream_init(const crisp_crypto_keys_t* keys,
+                                            const crisp_cmac_prefix_t* prefix,
+                                            crisp_const_byte_span_t head,
+                                            crisp_cmac_stream_t* out_stream) {
+  if (out_stream == NULL || !crisp_crypto_keys_have_segmented(keys) ||
+      (head.size > 0U && head.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  (void)memset(out_stream, 0, sizeof(*out_stream));
+  const crisp_cmac_midstate_t* midstate = crisp_cmac_prefix_match(keys, prefix, head, SIZE_MAX);
+  if (midstate != NULL) {
+    out_stream->midstate = *midstate;
+    out_stream->skip = midstate->absorbed;
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_crypto_cmac_stream_update(const crisp_crypto_keys_t* keys,
+                                              crisp_cmac_stream_t* stream,
+                                              crisp_const_byte_span_t data) {
+  if (stream == NULL || !crisp_crypto_keys_have_segmented(keys) ||
+      (data.size > 0U && data.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (data.size <= stream->skip) {
+    stream->skip -= data.size;
+    return CRISP_OK;
+  }
+
+  const crisp_crypto_iface_t* iface = keys->crypto;
+  const uint8_t* bytes = data.data + stream->skip;
+  size_t size = data.size - stream->skip;
+  stream->skip = 0U;
+  while (size > 0U) {
+    /* A held-back block is absorbed only once more bytes prove it is not the last one. */
+    if (stream->pending_size == CRISP_CMAC_BLOCK_SIZE) {
+      const crisp_const_byte_span_t block = {
+          .data = stream->pending,
+          .size = CRISP_CMAC_BLOCK_SIZE,
+      };
+      const crisp_error_t err =
+          iface->magma_cmac_update(iface->user_ctx, keys->kmac_ctx, &stream->midstate, block);
+      if (err != CRISP_OK) {
+        return err;
+      }
+      stream->pending_size = 0U;
+    }
+    if (stream->pending_size > 0U || size <= CRISP_CMAC_BLOCK_SIZE) {
+      const size_t room = CRISP_CMAC_BLOCK_SIZE - stream->pending_size;
+      const size_t take = size < room ? size : room;
+      (void)memcpy(stream->pending + stream->pending_size, bytes, take);
+      stream->pending_size += take;
+      bytes += take;
+      size -= take;
+      continue;
+    }
+
+    /* Block-aligned: whole blocks straight from `data`, keeping the last 1..8 bytes back. */
+    const crisp_const_byte_span_t blocks = {
+        .data = bytes,
+        .size = ((size - 1U) / CRISP_CMAC_BLOCK_SIZE) * CRISP_CMAC_BLOCK_SIZE,
+    };
+    const crisp_error_t err =
+        iface->magma_cmac_update(iface->user_ctx, keys->kmac_ctx, &stream->midstate, blocks);
+    if (err != CRISP_OK) {
+      return err;
+    }
+    bytes += blocks.size;
+    size -= blocks.size;
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_crypto_cmac_stream_final(const crisp_crypto_keys_t* keys,
+                                             const crisp_cmac_stream_t* stream,
+                                             crisp_mutable_byte_span_t out_icv) {
+  if (stream == NULL || !crisp_crypto_keys_have_segmented(keys)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  /* The message ended inside the cached prefix it was matched against. */
+  if (stream->skip > 0U) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  const crisp_const_byte_span_t last = {
+      .data = stream->pending,
+      .size = stream->pending_size,
+  };
+  return keys->crypto->magma_cmac_final(keys->crypto->user_ctx, keys->kmac_ctx,
+                                        &stream->midstate, last, out_icv);
+}
+
+crisp_error_t crisp_crypto_ctr_xcrypt_at(const crisp_crypto_keys_t* keys,
+                                         uint32_t iv32,
+                                         size_t offset,
+                                         crisp_const_byte_span_t in,
+                                         crisp_mutable_byte_span_t out) {
+  if (keys == NULL || keys->crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_crypto_iface_t* iface = keys->crypto;
+  if (keys->kenc_ctx != NULL && iface->magma_ctr_xcrypt_at != NULL) {
+    return iface->magma_ctr_xcrypt_at(iface->user_ctx, keys->kenc_ctx, iv32, offset, in, out);
+  }
+  if (offset != 0U) {
+    return CRISP_ERR_NOT_SUPPORTED;
+  }
+  return crisp_crypto_ctr_xcrypt(keys, iv32, in, out);
+}
@@ -1,8 +1,16 @@
 #include "crisp/crypto/dummy_backend.h"
 
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
+/** Prepared dummy key: CMAC state with the key already absorbed plus a key copy for CTR. */
+typedef struct crisp_dummy_key_ctx {
+  uint64_t cmac_state;
+  size_t key_size;
+  uint8_t key[];
+} crisp_dummy_key_ctx_t;
+
 static uint64_t crisp_dummy_seed(const void* user_ctx) {
   const crisp_dummy_crypto_state_t* state = (const crisp_dummy_crypto_state_t*)user_ctx;
   if (state == NULL || state->seed == 0U) {
@@ -18,19 +26,17 @@ static uint64_t crisp_mix64(uint64_t state, uint8_t value) {
   return state;
 }
 
-static crisp_error_t crisp_dummy_magma_cmac(void* user_ctx,
-                                            crisp_const_byte_span_t key,
-                                            crisp_const_byte_span_t data,
-                                            crisp_mutable_byte_span_t out_icv) {
-  if ((key.size > 0U && key.data == NULL) || (data.size > 0U && data.data == NULL) ||
-      (out_icv.size > 0U && out_icv.data == NULL)) {
-    return CRISP_ERR_INVALID_ARGUMENT;
-  }
-
+static uint64_t crisp_dummy_cmac_absorb_key(const void* user_ctx, crisp_const_byte_span_t key) {
   uint64_t state = crisp_dummy_seed(user_ctx) ^ 0x9E3779B97F4A7C15ULL;
   for (size_t i = 0U; i < key.size; ++i) {
     state = crisp_mix64(state, key.data[i]);
   }
+  return state;
+}
+
+static void crisp_dummy_cmac_finish(uint64_t state,
+                                    crisp_const_byte_span_t data,
+                                    crisp_mutable_byte_span_t out_icv) {
   for (size_t i = 0U; i < data.size; ++i) {
     state = crisp_mix64(state, data.data[i]);
   }
@@ -39,7 +45,32 @@ static crisp_error_t crisp_dummy_magma_cmac(void* user_ctx,
     state = crisp_mix64(state, (uint8_t)i);
     out_icv.data[i] = (uint8_t)(state >> ((i % 8U) * 8U));
   }
+}
+
+static void crisp_dummy_ctr_apply(const uint8_t* key,
+                                  size_t key_size,
+                                  uint32_t iv32,
+                                  crisp_const_byte_span_t in,
+                                  crisp_mutable_byte_span_t out) {
+  const size_t offset = (size_t)(iv32 & 0xFFU);
+  for (size_t i = 0U; i < in.size; ++i) {
+    const uint8_t iv_byte = (uint8_t)((iv32 >> ((i % 4U) * 8U)) & 0xFFU);
+    const uint8_t key_byte = key[(i + offset) % key_size];
+    const uint8_t stream = (uint8_t)(key_byte ^ iv_byte ^ (uint8_t)(0xA5U + (uint8_t)i));
+    out.data[i] = (uint8_t)(in.data[i] ^ stream);
+  }
+}
 
+static crisp_error_t crisp_dummy_magma_cmac(void* user_ctx,
+                                            crisp_const_byte_span_t key,
+                                            crisp_const_byte_span_t data,
+                                            crisp_mutable_byte_span_t out_icv) {
+  if ((key.size > 0U && key.data == NULL) || (data.size > 0U && data.data == NULL) ||
+      (out_icv.size > 0U && out_icv.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_dummy_cmac_finish(crisp_dummy_cmac_absorb_key(user_ctx, key), data, out_icv);
   return CRISP_OK;
 }
 
@@ -60,14 +91,78 @@ static crisp_error_t crisp_dummy_magma_ctr_xcrypt(void* user_ctx,
     return CRISP_ERR_INVALID_ARGUMENT;
   }
 
-  const size_t offset = (size_t)(iv32 & 0xFFU);
-  for (size_t i = 0U; i < in.size; ++i) {
-    const uint8_t iv_byte = (uint8_t)((iv32 >> ((i % 4U) * 8U)) & 0xFFU);
-    const uint8_t key_byte = key.data[(i + offset) % key.size];
-    const uint8_t stream = (uint8_t)(key_byte ^ iv_byte ^ (uint8_t)(0xA5U + (uint8_t)i));
-    out.data[i] = (uint8_t)(in.data[i] ^ stream);
+  crisp_dummy_ctr_apply(key.data, key.size, iv32, in, out);
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_dummy_magma_key_init(void* user_ctx,
+                                                crisp_const_byte_span_t key,
+                                                void** out_key_ctx) {
+  if (out_key_ctx == NULL || (key.size > 0U && key.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_dummy_key_ctx_t* ctx =
+      (crisp_dummy_key_ctx_t*)malloc(sizeof(crisp_dummy_key_ctx_t) + key.size);
+  if (ctx == NULL) {
+    return CRISP_ERR_CRYPTO;
+  }
+  ctx->cmac_state = crisp_dummy_cmac_absorb_key(user_ctx, key);
+  ctx->key_size = key.size;
+  if (key.size > 0U) {
+    (void)memcpy(ctx->key, key.data, key.size);
+  }
+  *out_key_ctx = ctx;
+  return CRISP_OK;
+}
+
+static void crisp_dummy_magma_key_release(void* user_ctx, void* key_ctx) {
+  (void)user_ctx;
+  crisp_dummy_key_ctx_t* ctx = (crisp_dummy_key_ctx_t*)key_ctx;
+  if (ctx == NULL) {
+    return;
+  }
+  const size_t total_size = sizeof(*ctx) + ctx->key_size;
+  volatile uint8_t* p = (volatile uint8_t*)ctx;
+  for (size_t i = 0U; i < total_size; ++i) {
+    p[i] = 0U;
+  }
+  free(ctx);
+}
+
+static crisp_error_t crisp_dummy_magma_cmac_keyed(void* user_ctx,
+                                                  const void* key_ctx,
+                                                  crisp_const_byte_span_t data,
+                                                  crisp_mutable_byte_span_t out_icv) {
+  (void)user_ctx;
+  const crisp_dummy_key_ctx_t* ctx = (const crisp_dummy_key_ctx_t*)key_ctx;
+  if (ctx == NULL || (data.size > 0U && data.data == NULL) ||
+      (out_icv.size > 0U && out_icv.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_dummy_cmac_finish(ctx->cmac_state, data, out_icv);
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_dummy_magma_ctr_xcrypt_keyed(void* user_ctx,
+                                                        const void* key_ctx,
+                                                        uint32_t iv32,
+                                                        crisp_const_byte_span_t in,
+                                                        crisp_mutable_byte_span_t out) {
+  (void)user_ctx;
+  const crisp_dummy_key_ctx_t* ctx = (const crisp_dummy_key_ctx_t*)key_ctx;
+  if (ctx == NULL || (in.size > 0U && in.data == NULL) || (out.size > 0U && out.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (in.size != out.size) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  if (ctx->key_size == 0U) {
+    return CRISP_ERR_INVALID_ARGUMENT;
   }
 
+  crisp_dummy_ctr_apply(ctx->key, ctx->key_size, iv32, in, out);
   return CRISP_OK;
 }
 
@@ -113,4 +208,8 @@ void crisp_dummy_crypto_iface_init(crisp_crypto_iface_t* iface, crisp_dummy_cryp
   iface->magma_cmac = crisp_dummy_magma_cmac;
   iface->magma_ctr_xcrypt = crisp_dummy_magma_ctr_xcrypt;
   iface->derive_kenc_kmac = crisp_dummy_derive_kenc_kmac;
+  iface->magma_key_init = crisp_dummy_magma_key_init;
+  iface->magma_key_release = crisp_dummy_magma_key_release;
+  iface->magma_cmac_keyed = crisp_dummy_magma_cmac_keyed;
+  iface->magma_ctr_xcrypt_keyed = crisp_dummy_magma_ctr_xcrypt_keyed;
 }
@@ -0,0 +1,496 @@
+#include "crisp/core/key_table.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+/*
+ * Vector tag probing reads a group with one plain 16-byte load and orders the entry reads
+ * behind it with an acquire fence. ThreadSanitizer does not model that pattern, so sanitized
+ * builds fall back to per-byte atomic loads.
+ */
+#if defined(__SANITIZE_THREAD__)
+#define CRISP_KEY_TABLE_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define CRISP_KEY_TABLE_TSAN 1
+#endif
+#endif
+
+#if defined(__SSE2__) && !defined(CRISP_KEY_TABLE_TSAN)
+#define CRISP_KEY_TABLE_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* Tag values: a full slot holds 7 bits of its KeyId hash, so the top bit marks the rest. */
+#define CRISP_KEY_TABLE_TAG_EMPTY ((uint8_t)0x80U)
+#define CRISP_KEY_TABLE_TAG_DELETED ((uint8_t)0xFEU)
+
+/* Maximum load is 7/8 of the slots, live entries and tombstones together. */
+#define CRISP_KEY_TABLE_LOAD_DEN 8U
+#define CRISP_KEY_TABLE_LOAD_NUM 7U
+
+/*
+ * Readers touch `value`, `key_id_size` and the leading KeyId bytes, which share the first
+ * cache line of the entry for KeyIds of up to 55 bytes. `retire_epoch` is writer-only.
+ */
+struct crisp_key_table_entry {
+  CRISP_CACHE_ALIGNED const void* value;
+  uint8_t key_id_size;
+  uint8_t key_id[CRISP_MAX_KEY_ID_SIZE];
+  uint64_t retire_epoch;
+};
+
+typedef struct crisp_key_table_entry crisp_key_table_entry_t;
+
+_Static_assert(sizeof(_Atomic uint64_t) == sizeof(uint64_t) &&
+                   _Alignof(_Atomic uint64_t) == _Alignof(uint64_t),
+               "_Atomic uint64_t must share the layout of uint64_t");
+_Static_assert(sizeof(_Atomic uint8_t) == sizeof(uint8_t), "_Atomic uint8_t must be one byte");
+_Static_assert(CRISP_MAX_KEY_ID_SIZE <= UINT8_MAX, "KeyId size must fit the entry size field");
+
+static _Atomic uint64_t* crisp_atomic_u64(uint64_t* value) {
+  return (_Atomic uint64_t*)value;
+}
+
+static const _Atomic uint64_t* crisp_atomic_u64_const(const uint64_t* value) {
+  return (const _Atomic uint64_t*)value;
+}
+
+static _Atomic uint8_t* crisp_key_table_tag(const crisp_key_table_t* table, size_t slot) {
+  return (_Atomic uint8_t*)&table->tags[slot];
+}
+
+static uint64_t crisp_rotl64(uint64_t value, unsigned shift) {
+  return (value << shift) | (value >> (64U - shift));
+}
+
+static uint64_t crisp_key_table_mix(uint64_t word) {
+  word *= 0x87C37B91114253D5ULL;
+  word = crisp_rotl64(word, 31U);
+  return word * 0x4CF5AD432745937FULL;
+}
+
+/* Seeded 64-bit hash of one KeyId: Murmur3-style word mixing with a 64-bit finalizer. */
+static uint64_t crisp_key_table_hash(uint64_t seed, const uint8_t* data, size_t size) {
+  uint64_t h = seed ^ ((uint64_t)size * 0x9E3779B97F4A7C15ULL);
+  size_t i = 0U;
+  for (; i + 8U <= size; i += 8U) {
+    uint64_t word;
+    (void)memcpy(&word, data + i, sizeof(word));
+    h ^= crisp_key_table_mix(word);
+    h = crisp_rotl64(h, 27U) * 5U + 0x52DCE729U;
+  }
+  if (i < size) {
+    uint64_t word = 0U;
+    (void)memcpy(&word, data + i, size - i);
+    h ^= crisp_key_table_mix(word);
+  }
+  h ^= h >> 33U;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33U;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33U;
+  return h;
+}
+
+static uint64_t crisp_key_table_hash_key(const crisp_key_table_t* table,
+                                         crisp_const_byte_span_t key_id) {
+  return crisp_key_table_hash(table->seed, key_id.data, key_id.size);
+}
+
+static uint8_t crisp_key_table_h2(uint64_t hash) {
+  return (uint8_t)(hash & 0x7FU);
+}
+
+static size_t crisp_key_table_h1(uint64_t hash) {
+  return (size_t)(hash >> 7U);
+}
+
+/* Bitmasks of the slots of one group holding `tag` and holding CRISP_KEY_TABLE_TAG_EMPTY. */
+typedef struct crisp_key_table_group_match {
+  uint32_t tag;
+  uint32_t empty;
+} crisp_key_table_group_match_t;
+
+static crisp_key_table_group_match_t crisp_key_table_match_group(const crisp_key_table_t* table,
+                                                                 size_t group,
+                                                                 uint8_t tag) {
+  crisp_key_table_group_match_t match;
+  const size_t first = group * CRISP_KEY_TABLE_GROUP_SIZE;
+#if defined(CRISP_KEY_TABLE_HAVE_SSE2)
+  const __m128i tags = _mm_load_si128((const __m128i*)(const void*)(table->tags + first));
+  match.tag = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8((char)tag)));
+  match.empty = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(tags, _mm_set1_epi8((char)CRISP_KEY_TABLE_TAG_EMPTY)));
+  if (match.tag != 0U) {
+    atomic_thread_fence(memory_order_acquire);
+  }
+#else
+  match.tag = 0U;
+  match.empty = 0U;
+  for (size_t i = 0U; i < CRISP_KEY_TABLE_GROUP_SIZE; ++i) {
+    const uint8_t slot_tag =
+        atomic_load_explicit(crisp_key_table_tag(table, first + i), memory_order_acquire);
+    match.tag |= (uint32_t)(slot_tag == tag) << i;
+    match.empty |= (uint32_t)(slot_tag == CRISP_KEY_TABLE_TAG_EMPTY) << i;
+  }
+#endif
+  return match;
+}
+
+static unsigned crisp_key_table_lowest_bit(uint32_t mask) {
+  return (unsigned)__builtin_ctz(mask);
+}
+
+static bool crisp_key_table_entry_matches(const crisp_key_table_entry_t* entry,
+                                          crisp_const_byte_span_t key_id) {
+  return entry->key_id_size == key_id.size && memcmp(entry->key_id, key_id.data, key_id.size) == 0;
+}
+
+/*
+ * Returns the slot holding `key_id`, or SIZE_MAX. Groups are visited by triangular probing,
+ * which covers every group of a power-of-two table; the chain ends at the first group that
+ * still has an empty slot, as inserts never skip past one.
+ */
+static size_t crisp_key_table_find(const crisp_key_table_t* table,
+                                   crisp_const_byte_span_t key_id,
+                                   uint64_t hash) {
+  const uint8_t tag = crisp_key_table_h2(hash);
+  size_t group = crisp_key_table_h1(hash) & table->group_mask;
+  for (size_t probe = 0U; probe <= table->group_mask; ++probe) {
+    const crisp_key_table_group_match_t match = crisp_key_table_match_group(table, group, tag);
+    for (uint32_t candidates = match.tag; candidates != 0U; candidates &= candidates - 1U) {
+      const size_t slot =
+          group * CRISP_KEY_TABLE_GROUP_SIZE + crisp_key_table_lowest_bit(candidates);
+      if (crisp_key_table_entry_matches(&table->entries[slot], key_id)) {
+        return slot;
+      }
+    }
+    if (match.empty != 0U) {
+      break;
+    }
+    group = (group + probe + 1U) & table->group_mask;
+  }
+  return SIZE_MAX;
+}
+
+static bool crisp_key_table_key_id_valid(crisp_const_byte_span_t key_id) {
+  return key_id.data != NULL && key_id.size > 0U && key_id.size <= CRISP_MAX_KEY_ID_SIZE;
+}
+
+static size_t crisp_round_up_pow2(size_t value) {
+  size_t result = 1U;
+  while (result < value) {
+    result <<= 1U;
+  }
+  return result;
+}
+
+static size_t crisp_round_up(size_t value, size_t align) {
+  return (value + align - 1U) & ~(align - 1U);
+}
+
+/* Storage layout: tags | negative cache | entries, each section cache-line aligned. */
+typedef struct crisp_key_table_layout {
+  size_t group_count;
+  size_t negative_slots;
+  size_t negative_offset;
+  size_t entries_offset;
+  size_t total;
+} crisp_key_table_layout_t;
+
+static bool crisp_key_table_plan(const crisp_key_table_config_t* config,
+                                 crisp_key_table_layout_t* layout) {
+  /* Keeps every size computation below far from overflow. */
+  const size_t max_items = SIZE_MAX / (4U * sizeof(crisp_key_table_entry_t));
+  if (config == NULL || config->capacity == 0U || config->capacity > max_items ||
+      config->negative_cache_slots > max_items ||
+      (config->reader_count > 0U && config->readers == NULL)) {
+    return false;
+  }
+  const size_t min_slots =
+      (config->capacity * CRISP_KEY_TABLE_LOAD_DEN + CRISP_KEY_TABLE_LOAD_NUM - 1U) /
+      CRISP_KEY_TABLE_LOAD_NUM;
+  layout->group_count = crisp_round_up_pow2((min_slots + CRISP_KEY_TABLE_GROUP_SIZE - 1U) /
+                                            CRISP_KEY_TABLE_GROUP_SIZE);
+  layout->negative_slots =
+      config->negative_cache_slots == 0U ? 0U : crisp_round_up_pow2(config->negative_cache_slots);
+
+  const size_t slot_count = layout->group_count * CRISP_KEY_TABLE_GROUP_SIZE;
+  layout->negative_offset = crisp_round_up(slot_count, CRISP_KEY_TABLE_STORAGE_ALIGN);
+  layout->entries_offset =
+      crisp_round_up(layout->negative_offset + layout->negative_slots * sizeof(uint64_t),
+                     CRISP_KEY_TABLE_STORAGE_ALIGN);
+  layout->total = layout->entries_offset + slot_count * sizeof(crisp_key_table_entry_t);
+  return true;
+}
+
+size_t crisp_key_table_storage_size(const crisp_key_table_config_t* config) {
+  crisp_key_table_layout_t layout;
+  return crisp_key_table_plan(config, &layout) ? layout.total : 0U;
+}
+
+crisp_error_t crisp_key_table_init(crisp_key_table_t* table,
+                                   const crisp_key_table_config_t* config,
+                                   void* storage,
+                                   size_t storage_size) {
+  if (table == NULL || storage == NULL ||
+      ((uintptr_t)storage & (CRISP_KEY_TABLE_STORAGE_ALIGN - 1U)) != 0U) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_key_table_layout_t layout;
+  if (!crisp_key_table_plan(config, &layout)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (storage_size < layout.total) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
+  }
+
+  uint8_t* base = (uint8_t*)storage;
+  const size_t slot_count = layout.group_count * CRISP_KEY_TABLE_GROUP_SIZE;
+  (void)memset(base, CRISP_KEY_TABLE_TAG_EMPTY, slot_count);
+  table->tags = base;
+  table->negative = NULL;
+  table->negative_mask = 0U;
+  if (layout.negative_slots > 0U) {
+    table->negative = (uint64_t*)(void*)(base + layout.negative_offset);
+    (void)memset(table->negative, 0, layout.negative_slots * sizeof(uint64_t));
+    table->negative_mask = layout.negative_slots - 1U;
+  }
+  table->entries = (crisp_key_table_entry_t*)(void*)(base + layout.entries_offset);
+  table->group_mask = layout.group_count - 1U;
+  table->max_used = slot_count / CRISP_KEY_TABLE_LOAD_DEN * CRISP_KEY_TABLE_LOAD_NUM;
+  table->used = 0U;
+  table->live = 0U;
+  table->seed = config->seed;
+  table->readers = config->readers;
+  table->reader_count = config->reader_count;
+  for (size_t i = 0U; i < table->reader_count; ++i) {
+    atomic_init(crisp_atomic_u64(&table->readers[i].epoch), 0U);
+  }
+  atomic_init(crisp_atomic_u64(&table->epoch), 1U);
+  return CRISP_OK;
+}
+
+void crisp_key_table_read_begin(crisp_key_table_t* table, crisp_key_table_reader_t* reader) {
+  if (table == NULL || reader == NULL) {
+    return;
+  }
+  const uint64_t epoch =
+      atomic_load_explicit(crisp_atomic_u64(&table->epoch), memory_order_seq_cst);
+  atomic_store_explicit(crisp_atomic_u64(&reader->epoch), epoch, memory_order_relaxed);
+  /* Publishes the epoch before any tag is read; pairs with the fence in the grace check. */
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+void crisp_key_table_read_end(crisp_key_table_reader_t* reader) {
+  if (reader == NULL) {
+    return;
+  }
+  atomic_store_explicit(crisp_atomic_u64(&reader->epoch), 0U, memory_order_release);
+}
+
+const void* crisp_key_table_lookup(const crisp_key_table_t* table, crisp_const_byte_span_t key_id) {
+  if (table == NULL || !crisp_key_table_key_id_valid(key_id)) {
+    return NULL;
+  }
+  const size_t slot = crisp_key_table_find(table, key_id, crisp_key_table_hash_key(table, key_id));
+  return slot == SIZE_MAX ? NULL : table->entries[slot].value;
+}
+
+/* Smallest epoch of a reader inside a read section, UINT64_MAX when there is none. */
+static uint64_t crisp_key_table_oldest_reader(const crisp_key_table_t* table) {
+  atomic_thread_fence(memory_order_seq_cst);
+  uint64_t oldest = UINT64_MAX;
+  for (size_t i = 0U; i < table->reader_count; ++i) {
+    const uint64_t epoch = atomic_load_explicit(crisp_atomic_u64_const(&table->readers[i].epoch),
+                                                memory_order_acquire);
+    if (epoch != 0U && epoch < oldest) {
+      oldest = epoch;
+    }
+  }
+  return oldest;
+}
+
+bool crisp_key_table_grace_elapsed(const crisp_key_table_t* table, uint64_t retire_epoch) {
+  if (table == NULL) {
+    return false;
+  }
+  return crisp_key_table_oldest_reader(table) >= retire_epoch;
+}
+
+static size_t crisp_key_table_negative_slot(const crisp_key_table_t* table, uint64_t hash) {
+  return (size_t)(hash >> 20U) & table->negative_mask;
+}
+
+/* Nonzero fingerprint kept in the negative cache; 0 marks an empty cache slot. */
+static uint64_t crisp_key_table_negative_fingerprint(uint64_t hash) {
+  return hash == 0U ? 1U : hash;
+}
+
+crisp_error_t crisp_key_table_insert(crisp_key_table_t* table,
+                                     crisp_const_byte_span_t key_id,
+                                     const void* value) {
+  if (table == NULL || value == NULL || !crisp_key_table_key_id_valid(key_id)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const uint64_t hash = crisp_key_table_hash_key(table, key_id);
+  const uint8_t tag = crisp_key_table_h2(hash);
+
+  /*
+   * One pass over the probe chain both rejects duplicates and picks the target: the first
+   * tombstone whose grace period has passed, otherwise the first empty slot of the group that
+   * ends the chain.
+   */
+  size_t target = SIZE_MAX;
+  bool reuses_tombstone = false;
+  uint64_t oldest_reader = 0U;
+  bool have_oldest_reader = false;
+  size_t group = crisp_key_table_h1(hash) & table->group_mask;
+  for (size_t probe = 0U; probe <= table->group_mask; ++probe) {
+    const crisp_key_table_group_match_t match = crisp_key_table_match_group(table, group, tag);
+    const size_t first = group * CRISP_KEY_TABLE_GROUP_SIZE;
+    for (uint32_t candidates = match.tag; candidates != 0U; candidates &= candidates - 1U) {
+      const size_t slot = first + crisp_key_table_lowest_bit(candidates);
+      if (crisp_key_table_entry_matches(&table->entries[slot], key_id)) {
+        return CRISP_ERR_INVALID_ARGUMENT;
+      }
+    }
+    for (size_t i = 0U; target == SIZE_MAX && i < CRISP_KEY_TABLE_GROUP_SIZE; ++i) {
+      if (table->tags[first + i] != CRISP_KEY_TABLE_TAG_DELETED) {
+        continue;
+      }
+      if (!have_oldest_reader) {
+        oldest_reader = crisp_key_table_oldest_reader(table);
+        have_oldest_reader = true;
+      }
+      if (oldest_reader >= table->entries[first + i].retire_epoch) {
+        target = first + i;
+        reuses_tombstone = true;
+      }
+    }
+    if (match.empty != 0U) {
+      if (target == SIZE_MAX && table->used < table->max_used) {
+        target = first + crisp_key_table_lowest_bit(match.empty);
+      }
+      break;
+    }
+    group = (group + probe + 1U) & table->group_mask;
+  }
+  if (target == SIZE_MAX) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
+  }
+
+  crisp_key_table_entry_t* entry = &table->entries[target];
+  entry->value = value;
+  entry->key_id_size = (uint8_t)key_id.size;
+  (void)memcpy(entry->key_id, key_id.data, key_id.size);
+  entry->retire_epoch = 0U;
+  /* Readers that see the tag also see the entry written above. */
+  atomic_store_explicit(crisp_key_table_tag(table, target), tag, memory_order_release);
+  if (!reuses_tombstone) {
+    table->used += 1U;
+  }
+  table->live += 1U;
+
+  if (table->negative != NULL) {
+    /*
+     * Orders the tag store before the cache is read; pairs with the fence in
+     * crisp_key_table_read_begin() taken by crisp_key_table_negative_record(): either this CAS
+     * sees a racing record, or that reader's recheck sees the new entry.
+     */
+    atomic_thread_fence(memory_order_seq_cst);
+    _Atomic uint64_t* cached =
+        crisp_atomic_u64(&table->negative[crisp_key_table_negative_slot(table, hash)]);
+    uint64_t expected = crisp_key_table_negative_fingerprint(hash);
+    (void)atomic_compare_exchange_strong_explicit(cached, &expected, 0U, memory_order_relaxed,
+                                                  memory_order_relaxed);
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_key_table_remove(crisp_key_table_t* table,
+                                     crisp_const_byte_span_t key_id,
+                                     const void** out_value,
+                                     uint64_t* out_retire_epoch) {
+  if (table == NULL || !crisp_key_table_key_id_valid(key_id)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const size_t slot = crisp_key_table_find(table, key_id, crisp_key_table_hash_key(table, key_id));
+  if (slot == SIZE_MAX) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  atomic_store_explicit(crisp_key_table_tag(table, slot), CRISP_KEY_TABLE_TAG_DELETED,
+                        memory_order_relaxed);
+  /*
+   * The seq_cst increment orders the tombstone before the new epoch: a reader that enters
+   * with the new epoch or later can no longer reach the entry.
+   */
+  const uint64_t retire_epoch =
+      atomic_fetch_add_explicit(crisp_atomic_u64(&table->epoch), 1U, memory_order_seq_cst) + 1U;
+  crisp_key_table_entry_t* entry = &table->entries[slot];
+  entry->retire_epoch = retire_epoch;
+  table->live -= 1U;
+  if (out_value != NULL) {
+    *out_value = entry->value;
+  }
+  if (out_retire_epoch != NULL) {
+    *out_retire_epoch = retire_epoch;
+  }
+  return CRISP_OK;
+}
+
+bool crisp_key_table_negative_contains(const crisp_key_table_t* table,
+                                       crisp_const_byte_span_t key_id) {
+  if (table == NULL || table->negative == NULL || !crisp_key_table_key_id_valid(key_id)) {
+    return false;
+  }
+  const uint64_t hash = crisp_key_table_hash_key(table, key_id);
+  const uint64_t* cached = &table->negative[crisp_key_table_negative_slot(table, hash)];
+  return atomic_load_explicit(crisp_atomic_u64_const(cached), memory_order_relaxed) ==
+         crisp_key_table_negative_fingerprint(hash);
+}
+
+void crisp_key_table_negative_insert(crisp_key_table_t* table, crisp_const_byte_span_t key_id) {
+  if (table == NULL || table->negative == NULL || !crisp_key_table_key_id_valid(key_id)) {
+    return;
+  }
+  const uint64_t hash = crisp_key_table_hash_key(table, key_id);
+  uint64_t* cached = &table->negative[crisp_key_table_negative_slot(table, hash)];
+  atomic_store_explicit(crisp_atomic_u64(cached), crisp_key_table_negative_fingerprint(hash),
+                        memory_order_relaxed);
+}
+
+void crisp_key_table_negative_record(crisp_key_table_t* table,
+                                     crisp_key_table_reader_t* reader,
+                                     crisp_const_byte_span_t key_id) {
+  if (table == NULL || reader == NULL || table->negative == NULL ||
+      !crisp_key_table_key_id_valid(key_id)) {
+    return;
+  }
+  const uint64_t hash = crisp_key_table_hash_key(table, key_id);
+  const uint64_t fingerprint = crisp_key_table_negative_fingerprint(hash);
+  _Atomic uint64_t* cached =
+      crisp_atomic_u64(&table->negative[crisp_key_table_negative_slot(table, hash)]);
+  atomic_store_explicit(cached, fingerprint, memory_order_relaxed);
+
+  crisp_key_table_read_begin(table, reader);
+  const bool known = crisp_key_table_find(table, key_id, hash) != SIZE_MAX;
+  crisp_key_table_read_end(reader);
+  if (known) {
+    /* Only our own record is taken back; a KeyId that evicted it since keeps its slot. */
+    uint64_t expected = fingerprint;
+    (void)atomic_compare_exchange_strong_explicit(cached, &expected, 0U, memory_order_relaxed,
+                                                  memory_order_relaxed);
+  }
+}
+
+void crisp_key_table_negative_clear(crisp_key_table_t* table) {
+  if (table == NULL || table->negative == NULL) {
+    return;
+  }
+  for (size_t i = 0U; i <= table->negative_mask; ++i) {
+    atomic_store_explicit(crisp_atomic_u64(&table->negative[i]), 0U, memory_order_relaxed);
+  }
+}
@@ -0,0 +1,156 @@
+#include "crisp/core/keystream_pool.h"
+
+#include <string.h>
+
+#include "mem_kernels.h"
+
+static uint8_t* crisp_keystream_pool_slot(const crisp_keystream_pool_t* pool, size_t index) {
+  return pool->storage + (index % pool->slot_count) * pool->slot_size;
+}
+
+/** Zeroizes and drops the `count` oldest filled slots. */
+static void crisp_keystream_pool_drop(crisp_keystream_pool_t* pool, size_t count) {
+  for (size_t k = 0U; k < count; ++k) {
+    crisp_secure_zero(crisp_keystream_pool_slot(pool, pool->head), pool->slot_size);
+    pool->head = (pool->head + 1U) % pool->slot_count;
+  }
+  pool->filled -= count;
+  pool->first_seqnum += count;
+}
+
+crisp_error_t crisp_keystream_pool_init(crisp_keystream_pool_t* pool,
+                                        const crisp_crypto_keys_t* keys,
+                                        crisp_mutable_byte_span_t storage,
+                                        size_t slot_size,
+                                        uint64_t next_seqnum) {
+  if (pool == NULL || keys == NULL || keys->crypto == NULL || keys->kenc_ctx == NULL ||
+      storage.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (next_seqnum > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+  if (slot_size == 0U || slot_size > CRISP_MAX_MESSAGE_SIZE || storage.size < slot_size) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+
+  const size_t slot_count = storage.size / slot_size;
+  (void)memset(pool, 0, sizeof(*pool));
+  pool->keys = keys;
+  pool->generation = keys->generation;
+  pool->storage = storage.data;
+  pool->slot_size = slot_size;
+  pool->slot_count =
+      slot_count < CRISP_KEYSTREAM_POOL_MAX_SLOTS ? slot_count : CRISP_KEYSTREAM_POOL_MAX_SLOTS;
+  pool->first_seqnum = next_seqnum;
+  crisp_secure_zero(pool->storage, pool->slot_count * pool->slot_size);
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_keystream_pool_refill(crisp_keystream_pool_t* pool,
+                                          size_t max_slots,
+                                          size_t* out_filled) {
+  if (pool == NULL || pool->keys == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (out_filled != NULL) {
+    *out_filled = 0U;
+  }
+  if (pool->keys->generation != pool->generation) {
+    /* Keys were re-initialized in place: the filled slots belong to the old Kenc. */
+    crisp_keystream_pool_drop(pool, pool->filled);
+    pool->generation = pool->keys->generation;
+  }
+
+  /* first_seqnum + filled never exceeds CRISP_SEQNUM_MAX + 1, so this cannot wrap. */
+  const uint64_t next_seqnum = pool->first_seqnum + pool->filled;
+  size_t count = pool->slot_count - pool->filled;
+  if (count > max_slots) {
+    count = max_slots;
+  }
+  if ((uint64_t)count > CRISP_SEQNUM_MAX + 1U - next_seqnum) {
+    count = (size_t)(CRISP_SEQNUM_MAX + 1U - next_seqnum);
+  }
+  if (count == 0U) {
+    return CRISP_OK;
+  }
+
+  /* Keystream is the CTR transform of zeros, generated in place. */
+  crisp_magma_ctr_job_t jobs[CRISP_KEYSTREAM_POOL_MAX_SLOTS];
+  for (size_t k = 0U; k < count; ++k) {
+    uint8_t* slot = crisp_keystream_pool_slot(pool, pool->head + pool->filled + k);
+    (void)memset(slot, 0, pool->slot_size);
+    jobs[k].iv32 = (uint32_t)((next_seqnum + k) & 0xFFFFFFFFU);
+    jobs[k].in.data = slot;
+    jobs[k].in.size = pool->slot_size;
+    jobs[k].out.data = slot;
+    jobs[k].out.size = pool->slot_size;
+  }
+
+  const crisp_error_t err = crisp_crypto_ctr_xcrypt_batch(pool->keys, jobs, count);
+  if (err != CRISP_OK) {
+    for (size_t k = 0U; k < count; ++k) {
+      crisp_secure_zero(jobs[k].out.data, pool->slot_size);
+    }
+    return err;
+  }
+
+  pool->filled += count;
+  if (out_filled != NULL) {
+    *out_filled = count;
+  }
+  return CRISP_OK;
+}
+
+bool crisp_keystream_pool_xcrypt(crisp_keystream_pool_t* pool,
+                                 const crisp_crypto_keys_t* keys,
+                                 uint64_t seqnum,
+                                 crisp_const_byte_span_t in,
+                                 crisp_mutable_byte_span_t out) {
+  if (pool == NULL || pool->keys == NULL || keys == NULL || keys->crypto != pool->keys->crypto ||
+      keys->kenc_ctx != pool->keys->kenc_ctx || in.size != out.size ||
+      in.size > pool->slot_size || (in.size > 0U && (in.data == NULL || out.data == NULL)) ||
+      seqnum < pool->first_seqnum) {
+    return false;
+  }
+  if (keys->generation != pool->generation) {
+    crisp_keystream_pool_drop(pool, pool->filled);
+    return false;
+  }
+
+  const uint64_t ahead = seqnum - pool->first_seqnum;
+  if (ahead >= (uint64_t)pool->filled) {
+    /* The sender moved past everything pooled: restart generation after `seqnum`. */
+    crisp_keystream_pool_drop(pool, pool->filled);
+    pool->first_seqnum = seqnum < CRISP_SEQNUM_MAX ? seqnum + 1U : CRISP_SEQNUM_MAX + 1U;
+    return false;
+  }
+  crisp_keystream_pool_drop(pool, (size_t)ahead);
+
+  const uint8_t* keystream = crisp_keystream_pool_slot(pool, pool->head);
+  for (size_t i = 0U; i < in.size; ++i) {
+    out.data[i] = (uint8_t)(in.data[i] ^ keystream[i]);
+  }
+  crisp_keystream_pool_drop(pool, 1U);
+  return true;
+}
+
+void crisp_keystream_pool_reset(crisp_keystream_pool_t* pool, uint64_t next_seqnum) {
+  if (pool == NULL || pool->storage == NULL) {
+    return;
+  }
+  crisp_secure_zero(pool->storage, pool->slot_count * pool->slot_size);
+  pool->head = 0U;
+  pool->filled = 0U;
+  pool->first_seqnum = next_seqnum <= CRISP_SEQNUM_MAX ? next_seqnum : CRISP_SEQNUM_MAX + 1U;
+}
+
+void crisp_keystream_pool_clear(crisp_keystream_pool_t* pool) {
+  if (pool == NULL) {
+    return;
+  }
+  if (pool->storage != NULL) {
+    crisp_secure_zero(pool->storage, pool->slot_count * pool->slot_size);
+  }
+  crisp_secure_zero(pool, sizeof(*pool));
+}
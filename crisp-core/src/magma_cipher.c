@@ -0,0 +1,222 @@
+#include "magma_cipher.h"
+
+/*
+ * Merged S-box + <<<11 tables:
+ *   crisp_magma_t[j][b] = ROTL11((pi[2j+1][b >> 4] << 4 | pi[2j][b & 15]) << 8j),
+ * so g[k](a) = T0[t0] ^ T1[t1] ^ T2[t2] ^ T3[t3] for the four bytes of t = a + k.
+ * Generated from the GOST R 34.12-2015 Magma S-boxes pi0..pi7.
+ */
+const uint32_t crisp_magma_t[4][256] = {
+    {
+        0x00036000U, 0x00032000U, 0x00033000U, 0x00031000U, 0x00035000U, 0x00032800U,
+        0x00035800U, 0x00034800U, 0x00037000U, 0x00034000U, 0x00036800U, 0x00033800U,
+        0x00030000U, 0x00031800U, 0x00037800U, 0x00030800U, 0x00046000U, 0x00042000U,
+        0x00043000U, 0x00041000U, 0x00045000U, 0x00042800U, 0x00045800U, 0x00044800U,
+        0x00047000U, 0x00044000U, 0x00046800U, 0x00043800U, 0x00040000U, 0x00041800U,
+        0x00047800U, 0x00040800U, 0x00016000U, 0x00012000U, 0x00013000U, 0x00011000U,
+        0x00015000U, 0x00012800U, 0x00015800U, 0x00014800U, 0x00017000U, 0x00014000U,
+        0x00016800U, 0x00013800U, 0x00010000U, 0x00011800U, 0x00017800U, 0x00010800U,
+        0x0001E000U, 0x0001A000U, 0x0001B000U, 0x00019000U, 0x0001D000U, 0x0001A800U,
+        0x0001D800U, 0x0001C800U, 0x0001F000U, 0x0001C000U, 0x0001E800U, 0x0001B800U,
+        0x00018000U, 0x00019800U, 0x0001F800U, 0x00018800U, 0x0004E000U, 0x0004A000U,
+        0x0004B000U, 0x00049000U, 0x0004D000U, 0x0004A800U, 0x0004D800U, 0x0004C800U,
+        0x0004F000U, 0x0004C000U, 0x0004E800U, 0x0004B800U, 0x00048000U, 0x00049800U,
+        0x0004F800U, 0x00048800U, 0x00056000U, 0x00052000U, 0x00053000U, 0x00051000U,
+        0x00055000U, 0x00052800U, 0x00055800U, 0x00054800U, 0x00057000U, 0x00054000U,
+        0x00056800U, 0x00053800U, 0x00050000U, 0x00051800U, 0x00057800U, 0x00050800U,
+        0x0002E000U, 0x0002A000U, 0x0002B000U, 0x00029000U, 0x0002D000U, 0x0002A800U,
+        0x0002D800U, 0x0002C800U, 0x0002F000U, 0x0002C000U, 0x0002E800U, 0x0002B800U,
+        0x00028000U, 0x00029800U, 0x0002F800U, 0x00028800U, 0x00066000U, 0x00062000U,
+        0x00063000U, 0x00061000U, 0x00065000U, 0x00062800U, 0x00065800U, 0x00064800U,
+        0x00067000U, 0x00064000U, 0x00066800U, 0x00063800U, 0x00060000U, 0x00061800U,
+        0x00067800U, 0x00060800U, 0x0000E000U, 0x0000A000U, 0x0000B000U, 0x00009000U,
+        0x0000D000U, 0x0000A800U, 0x0000D800U, 0x0000C800U, 0x0000F000U, 0x0000C000U,
+        0x0000E800U, 0x0000B800U, 0x00008000U, 0x00009800U, 0x0000F800U, 0x00008800U,
+        0x00076000U, 0x00072000U, 0x00073000U, 0x00071000U, 0x00075000U, 0x00072800U,
+        0x00075800U, 0x00074800U, 0x00077000U, 0x00074000U, 0x00076800U, 0x00073800U,
+        0x00070000U, 0x00071800U, 0x00077800U, 0x00070800U, 0x00026000U, 0x00022000U,
+        0x00023000U, 0x00021000U, 0x00025000U, 0x00022800U, 0x00025800U, 0x00024800U,
+        0x00027000U, 0x00024000U, 0x00026800U, 0x00023800U, 0x00020000U, 0x00021800U,
+        0x00027800U, 0x00020800U, 0x0003E000U, 0x0003A000U, 0x0003B000U, 0x00039000U,
+        0x0003D000U, 0x0003A800U, 0x0003D800U, 0x0003C800U, 0x0003F000U, 0x0003C000U,
+        0x0003E800U, 0x0003B800U, 0x00038000U, 0x00039800U, 0x0003F800U, 0x00038800U,
+        0x0005E000U, 0x0005A000U, 0x0005B000U, 0x00059000U, 0x0005D000U, 0x0005A800U,
+        0x0005D800U, 0x0005C800U, 0x0005F000U, 0x0005C000U, 0x0005E800U, 0x0005B800U,
+        0x00058000U, 0x00059800U, 0x0005F800U, 0x00058800U, 0x0006E000U, 0x0006A000U,
+        0x0006B000U, 0x00069000U, 0x0006D000U, 0x0006A800U, 0x0006D800U, 0x0006C800U,
+        0x0006F000U, 0x0006C000U, 0x0006E800U, 0x0006B800U, 0x00068000U, 0x00069800U,
+        0x0006F800U, 0x00068800U, 0x00006000U, 0x00002000U, 0x00003000U, 0x00001000U,
+        0x00005000U, 0x00002800U, 0x00005800U, 0x00004800U, 0x00007000U, 0x00004000U,
+        0x00006800U, 0x00003800U, 0x00000000U, 0x00001800U, 0x00007800U, 0x00000800U,
+        0x0007E000U, 0x0007A000U, 0x0007B000U, 0x00079000U, 0x0007D000U, 0x0007A800U,
+        0x0007D800U, 0x0007C800U, 0x0007F000U, 0x0007C000U, 0x0007E800U, 0x0007B800U,
+        0x00078000U, 0x00079800U, 0x0007F800U, 0x00078800U,
+    },
+    {
+        0x06580000U, 0x06180000U, 0x06280000U, 0x06400000U, 0x06100000U, 0x06780000U,
+        0x06500000U, 0x06680000U, 0x06700000U, 0x06080000U, 0x06380000U, 0x06200000U,
+        0x06600000U, 0x06480000U, 0x06300000U, 0x06000000U, 0x04580000U, 0x04180000U,
+        0x04280000U, 0x04400000U, 0x04100000U, 0x04780000U, 0x04500000U, 0x04680000U,
+        0x04700000U, 0x04080000U, 0x04380000U, 0x04200000U, 0x04600000U, 0x04480000U,
+        0x04300000U, 0x04000000U, 0x01580000U, 0x01180000U, 0x01280000U, 0x01400000U,
+        0x01100000U, 0x01780000U, 0x01500000U, 0x01680000U, 0x01700000U, 0x01080000U,
+        0x01380000U, 0x01200000U, 0x01600000U, 0x01480000U, 0x01300000U, 0x01000000U,
+        0x00D80000U, 0x00980000U, 0x00A80000U, 0x00C00000U, 0x00900000U, 0x00F80000U,
+        0x00D00000U, 0x00E80000U, 0x00F00000U, 0x00880000U, 0x00B80000U, 0x00A00000U,
+        0x00E00000U, 0x00C80000U, 0x00B00000U, 0x00800000U, 0x06D80000U, 0x06980000U,
+        0x06A80000U, 0x06C00000U, 0x06900000U, 0x06F80000U, 0x06D00000U, 0x06E80000U,
+        0x06F00000U, 0x06880000U, 0x06B80000U, 0x06A00000U, 0x06E00000U, 0x06C80000U,
+        0x06B00000U, 0x06800000U, 0x02580000U, 0x02180000U, 0x02280000U, 0x02400000U,
+        0x02100000U, 0x02780000U, 0x02500000U, 0x02680000U, 0x02700000U, 0x02080000U,
+        0x02380000U, 0x02200000U, 0x02600000U, 0x02480000U, 0x02300000U, 0x02000000U,
+        0x07D80000U, 0x07980000U, 0x07A80000U, 0x07C00000U, 0x07900000U, 0x07F80000U,
+        0x07D00000U, 0x07E80000U, 0x07F00000U, 0x07880000U, 0x07B80000U, 0x07A00000U,
+        0x07E00000U, 0x07C80000U, 0x07B00000U, 0x07800000U, 0x03580000U, 0x03180000U,
+        0x03280000U, 0x03400000U, 0x03100000U, 0x03780000U, 0x03500000U, 0x03680000U,
+        0x03700000U, 0x03080000U, 0x03380000U, 0x03200000U, 0x03600000U, 0x03480000U,
+        0x03300000U, 0x03000000U, 0x03D80000U, 0x03980000U, 0x03A80000U, 0x03C00000U,
+        0x03900000U, 0x03F80000U, 0x03D00000U, 0x03E80000U, 0x03F00000U, 0x03880000U,
+        0x03B80000U, 0x03A00000U, 0x03E00000U, 0x03C80000U, 0x03B00000U, 0x03800000U,
+        0x00580000U, 0x00180000U, 0x00280000U, 0x00400000U, 0x00100000U, 0x00780000U,
+        0x00500000U, 0x00680000U, 0x00700000U, 0x00080000U, 0x00380000U, 0x00200000U,
+        0x00600000U, 0x00480000U, 0x00300000U, 0x00000000U, 0x05580000U, 0x05180000U,
+        0x05280000U, 0x05400000U, 0x05100000U, 0x05780000U, 0x05500000U, 0x05680000U,
+        0x05700000U, 0x05080000U, 0x05380000U, 0x05200000U, 0x05600000U, 0x05480000U,
+        0x05300000U, 0x05000000U, 0x02D80000U, 0x02980000U, 0x02A80000U, 0x02C00000U,
+        0x02900000U, 0x02F80000U, 0x02D00000U, 0x02E80000U, 0x02F00000U, 0x02880000U,
+        0x02B80000U, 0x02A00000U, 0x02E00000U, 0x02C80000U, 0x02B00000U, 0x02800000U,
+        0x01D80000U, 0x01980000U, 0x01A80000U, 0x01C00000U, 0x01900000U, 0x01F80000U,
+        0x01D00000U, 0x01E80000U, 0x01F00000U, 0x01880000U, 0x01B80000U, 0x01A00000U,
+        0x01E00000U, 0x01C80000U, 0x01B00000U, 0x01800000U, 0x07580000U, 0x07180000U,
+        0x07280000U, 0x07400000U, 0x07100000U, 0x07780000U, 0x07500000U, 0x07680000U,
+        0x07700000U, 0x07080000U, 0x07380000U, 0x07200000U, 0x07600000U, 0x07480000U,
+        0x07300000U, 0x07000000U, 0x04D80000U, 0x04980000U, 0x04A80000U, 0x04C00000U,
+        0x04900000U, 0x04F80000U, 0x04D00000U, 0x04E80000U, 0x04F00000U, 0x04880000U,
+        0x04B80000U, 0x04A00000U, 0x04E00000U, 0x04C80000U, 0x04B00000U, 0x04800000U,
+        0x05D80000U, 0x05980000U, 0x05A80000U, 0x05C00000U, 0x05900000U, 0x05F80000U,
+        0x05D00000U, 0x05E80000U, 0x05F00000U, 0x05880000U, 0x05B80000U, 0x05A00000U,
+        0x05E00000U, 0x05C80000U, 0x05B00000U, 0x05800000U,
+    },
+    {
+        0xB8000002U, 0xF8000002U, 0xA8000002U, 0xD0000002U, 0xC0000002U, 0x88000002U,
+        0xB0000002U, 0xE8000002U, 0x80000002U, 0xC8000002U, 0x98000002U, 0xF0000002U,
+        0xD8000002U, 0xA0000002U, 0x90000002U, 0xE0000002U, 0xB8000006U, 0xF8000006U,
+        0xA8000006U, 0xD0000006U, 0xC0000006U, 0x88000006U, 0xB0000006U, 0xE8000006U,
+        0x80000006U, 0xC8000006U, 0x98000006U, 0xF0000006U, 0xD8000006U, 0xA0000006U,
+        0x90000006U, 0xE0000006U, 0xB8000007U, 0xF8000007U, 0xA8000007U, 0xD0000007U,
+        0xC0000007U, 0x88000007U, 0xB0000007U, 0xE8000007U, 0x80000007U, 0xC8000007U,
+        0x98000007U, 0xF0000007U, 0xD8000007U, 0xA0000007U, 0x90000007U, 0xE0000007U,
+        0x38000003U, 0x78000003U, 0x28000003U, 0x50000003U, 0x40000003U, 0x08000003U,
+        0x30000003U, 0x68000003U, 0x00000003U, 0x48000003U, 0x18000003U, 0x70000003U,
+        0x58000003U, 0x20000003U, 0x10000003U, 0x60000003U, 0xB8000004U, 0xF8000004U,
+        0xA8000004U, 0xD0000004U, 0xC0000004U, 0x88000004U, 0xB0000004U, 0xE8000004U,
+        0x80000004U, 0xC8000004U, 0x98000004U, 0xF0000004U, 0xD8000004U, 0xA0000004U,
+        0x90000004U, 0xE0000004U, 0x38000001U, 0x78000001U, 0x28000001U, 0x50000001U,
+        0x40000001U, 0x08000001U, 0x30000001U, 0x68000001U, 0x00000001U, 0x48000001U,
+        0x18000001U, 0x70000001U, 0x58000001U, 0x20000001U, 0x10000001U, 0x60000001U,
+        0x38000006U, 0x78000006U, 0x28000006U, 0x50000006U, 0x40000006U, 0x08000006U,
+        0x30000006U, 0x68000006U, 0x00000006U, 0x48000006U, 0x18000006U, 0x70000006U,
+        0x58000006U, 0x20000006U, 0x10000006U, 0x60000006U, 0x38000005U, 0x78000005U,
+        0x28000005U, 0x50000005U, 0x40000005U, 0x08000005U, 0x30000005U, 0x68000005U,
+        0x00000005U, 0x48000005U, 0x18000005U, 0x70000005U, 0x58000005U, 0x20000005U,
+        0x10000005U, 0x60000005U, 0xB8000005U, 0xF8000005U, 0xA8000005U, 0xD0000005U,
+        0xC0000005U, 0x88000005U, 0xB0000005U, 0xE8000005U, 0x80000005U, 0xC8000005U,
+        0x98000005U, 0xF0000005U, 0xD8000005U, 0xA0000005U, 0x90000005U, 0xE0000005U,
+        0xB8000003U, 0xF8000003U, 0xA8000003U, 0xD0000003U, 0xC0000003U, 0x88000003U,
+        0xB0000003U, 0xE8000003U, 0x80000003U, 0xC8000003U, 0x98000003U, 0xF0000003U,
+        0xD8000003U, 0xA0000003U, 0x90000003U, 0xE0000003U, 0x38000004U, 0x78000004U,
+        0x28000004U, 0x50000004U, 0x40000004U, 0x08000004U, 0x30000004U, 0x68000004U,
+        0x00000004U, 0x48000004U, 0x18000004U, 0x70000004U, 0x58000004U, 0x20000004U,
+        0x10000004U, 0x60000004U, 0xB8000000U, 0xF8000000U, 0xA8000000U, 0xD0000000U,
+        0xC0000000U, 0x88000000U, 0xB0000000U, 0xE8000000U, 0x80000000U, 0xC8000000U,
+        0x98000000U, 0xF0000000U, 0xD8000000U, 0xA0000000U, 0x90000000U, 0xE0000000U,
+        0x38000002U, 0x78000002U, 0x28000002U, 0x50000002U, 0x40000002U, 0x08000002U,
+        0x30000002U, 0x68000002U, 0x00000002U, 0x48000002U, 0x18000002U, 0x70000002U,
+        0x58000002U, 0x20000002U, 0x10000002U, 0x60000002U, 0xB8000001U, 0xF8000001U,
+        0xA8000001U, 0xD0000001U, 0xC0000001U, 0x88000001U, 0xB0000001U, 0xE8000001U,
+        0x80000001U, 0xC8000001U, 0x98000001U, 0xF0000001U, 0xD8000001U, 0xA0000001U,
+        0x90000001U, 0xE0000001U, 0x38000007U, 0x78000007U, 0x28000007U, 0x50000007U,
+        0x40000007U, 0x08000007U, 0x30000007U, 0x68000007U, 0x00000007U, 0x48000007U,
+        0x18000007U, 0x70000007U, 0x58000007U, 0x20000007U, 0x10000007U, 0x60000007U,
+        0x38000000U, 0x78000000U, 0x28000000U, 0x50000000U, 0x40000000U, 0x08000000U,
+        0x30000000U, 0x68000000U, 0x00000000U, 0x48000000U, 0x18000000U, 0x70000000U,
+        0x58000000U, 0x20000000U, 0x10000000U, 0x60000000U,
+    },
+    {
+        0x000000C0U, 0x000000F0U, 0x00000090U, 0x000000A8U, 0x000000B0U, 0x000000C8U,
+        0x00000088U, 0x000000E0U, 0x000000F8U, 0x000000A0U, 0x000000D8U, 0x00000080U,
+        0x000000E8U, 0x000000D0U, 0x00000098U, 0x000000B8U, 0x000003C0U, 0x000003F0U,
+        0x00000390U, 0x000003A8U, 0x000003B0U, 0x000003C8U, 0x00000388U, 0x000003E0U,
+        0x000003F8U, 0x000003A0U, 0x000003D8U, 0x00000380U, 0x000003E8U, 0x000003D0U,
+        0x00000398U, 0x000003B8U, 0x00000740U, 0x00000770U, 0x00000710U, 0x00000728U,
+        0x00000730U, 0x00000748U, 0x00000708U, 0x00000760U, 0x00000778U, 0x00000720U,
+        0x00000758U, 0x00000700U, 0x00000768U, 0x00000750U, 0x00000718U, 0x00000738U,
+        0x000006C0U, 0x000006F0U, 0x00000690U, 0x000006A8U, 0x000006B0U, 0x000006C8U,
+        0x00000688U, 0x000006E0U, 0x000006F8U, 0x000006A0U, 0x000006D8U, 0x00000680U,
+        0x000006E8U, 0x000006D0U, 0x00000698U, 0x000006B8U, 0x00000040U, 0x00000070U,
+        0x00000010U, 0x00000028U, 0x00000030U, 0x00000048U, 0x00000008U, 0x00000060U,
+        0x00000078U, 0x00000020U, 0x00000058U, 0x00000000U, 0x00000068U, 0x00000050U,
+        0x00000018U, 0x00000038U, 0x000002C0U, 0x000002F0U, 0x00000290U, 0x000002A8U,
+        0x000002B0U, 0x000002C8U, 0x00000288U, 0x000002E0U, 0x000002F8U, 0x000002A0U,
+        0x000002D8U, 0x00000280U, 0x000002E8U, 0x000002D0U, 0x00000298U, 0x000002B8U,
+        0x00000440U, 0x00000470U, 0x00000410U, 0x00000428U, 0x00000430U, 0x00000448U,
+        0x00000408U, 0x00000460U, 0x00000478U, 0x00000420U, 0x00000458U, 0x00000400U,
+        0x00000468U, 0x00000450U, 0x00000418U, 0x00000438U, 0x000001C0U, 0x000001F0U,
+        0x00000190U, 0x000001A8U, 0x000001B0U, 0x000001C8U, 0x00000188U, 0x000001E0U,
+        0x000001F8U, 0x000001A0U, 0x000001D8U, 0x00000180U, 0x000001E8U, 0x000001D0U,
+        0x00000198U, 0x000001B8U, 0x00000240U, 0x00000270U, 0x00000210U, 0x00000228U,
+        0x00000230U, 0x00000248U, 0x00000208U, 0x00000260U, 0x00000278U, 0x00000220U,
+        0x00000258U, 0x00000200U, 0x00000268U, 0x00000250U, 0x00000218U, 0x00000238U,
+        0x000007C0U, 0x000007F0U, 0x00000790U, 0x000007A8U, 0x000007B0U, 0x000007C8U,
+        0x00000788U, 0x000007E0U, 0x000007F8U, 0x000007A0U, 0x000007D8U, 0x00000780U,
+        0x000007E8U, 0x000007D0U, 0x00000798U, 0x000007B8U, 0x00000540U, 0x00000570U,
+        0x00000510U, 0x00000528U, 0x00000530U, 0x00000548U, 0x00000508U, 0x00000560U,
+        0x00000578U, 0x00000520U, 0x00000558U, 0x00000500U, 0x00000568U, 0x00000550U,
+        0x00000518U, 0x00000538U, 0x00000340U, 0x00000370U, 0x00000310U, 0x00000328U,
+        0x00000330U, 0x00000348U, 0x00000308U, 0x00000360U, 0x00000378U, 0x00000320U,
+        0x00000358U, 0x00000300U, 0x00000368U, 0x00000350U, 0x00000318U, 0x00000338U,
+        0x000004C0U, 0x000004F0U, 0x00000490U, 0x000004A8U, 0x000004B0U, 0x000004C8U,
+        0x00000488U, 0x000004E0U, 0x000004F8U, 0x000004A0U, 0x000004D8U, 0x00000480U,
+        0x000004E8U, 0x000004D0U, 0x00000498U, 0x000004B8U, 0x00000640U, 0x00000670U,
+        0x00000610U, 0x00000628U, 0x00000630U, 0x00000648U, 0x00000608U, 0x00000660U,
+        0x00000678U, 0x00000620U, 0x00000658U, 0x00000600U, 0x00000668U, 0x00000650U,
+        0x00000618U, 0x00000638U, 0x000005C0U, 0x000005F0U, 0x00000590U, 0x000005A8U,
+        0x000005B0U, 0x000005C8U, 0x00000588U, 0x000005E0U, 0x000005F8U, 0x000005A0U,
+        0x000005D8U, 0x00000580U, 0x000005E8U, 0x000005D0U, 0x00000598U, 0x000005B8U,
+        0x00000140U, 0x00000170U, 0x00000110U, 0x00000128U, 0x00000130U, 0x00000148U,
+        0x00000108U, 0x00000160U, 0x00000178U, 0x00000120U, 0x00000158U, 0x00000100U,
+        0x00000168U, 0x00000150U, 0x00000118U, 0x00000138U,
+    },
+};
+
+/** CMAC subkey doubling in GF(2^64) with R_64 = 0x1B (GOST R 34.13-2015, 5.6). */
+static uint64_t crisp_magma_cmac_double(uint64_t value) {
+  const uint64_t reduce = ((value >> 63U) != 0U) ? 0x1BULL : 0ULL;
+  return (value << 1U) ^ reduce;
+}
+
+void crisp_magma_expand_key(const uint8_t* key32, bool with_cmac_subkeys, crisp_magma_key_t* out) {
+  for (size_t i = 0U; i < 8U; ++i) {
+    const uint8_t* word = key32 + 4U * i;
+    out->rk[i] = ((uint32_t)word[0] << 24U) | ((uint32_t)word[1] << 16U) |
+                 ((uint32_t)word[2] << 8U) | (uint32_t)word[3];
+  }
+
+  out->cmac_k1 = 0U;
+  out->cmac_k2 = 0U;
+  if (with_cmac_subkeys) {
+    const uint64_t r = crisp_magma_encrypt_block(out, 0U);
+    out->cmac_k1 = crisp_magma_cmac_double(r);
+    out->cmac_k2 = crisp_magma_cmac_double(out->cmac_k1);
+  }
+}
+
+void crisp_magma_wipe(void* data, size_t size) {
+  if (data == NULL || size == 0U) {
+    return;
+  }
+  volatile uint8_t* p = (volatile uint8_t*)data;
+  for (size_t i = 0U; i < size; ++i) {
+    p[i] = 0U;
+  }
+}
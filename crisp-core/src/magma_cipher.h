@@ -0,0 +1,95 @@
+#ifndef CRISP_CORE_SRC_MAGMA_CIPHER_H_
+#define CRISP_CORE_SRC_MAGMA_CIPHER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Internal Magma (GOST R 34.12-2015, 64-bit block) primitives shared by the Magma backend
+ * kernels. Blocks are handled as big-endian 64-bit integers: high half a1, low half a0.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Merged S-box + rotation tables (see magma_cipher.c). */
+extern const uint32_t crisp_magma_t[4][256];
+
+/** Expanded key: round keys K1..K8 (rounds 9..32 reuse them) and CMAC subkeys K1/K2. */
+typedef struct crisp_magma_key {
+  uint32_t rk[8];
+  uint64_t cmac_k1;
+  uint64_t cmac_k2;
+} crisp_magma_key_t;
+
+static inline uint64_t crisp_magma_load_be64(const uint8_t* bytes) {
+  return ((uint64_t)bytes[0] << 56U) | ((uint64_t)bytes[1] << 48U) | ((uint64_t)bytes[2] << 40U) |
+         ((uint64_t)bytes[3] << 32U) | ((uint64_t)bytes[4] << 24U) | ((uint64_t)bytes[5] << 16U) |
+         ((uint64_t)bytes[6] << 8U) | (uint64_t)bytes[7];
+}
+
+static inline void crisp_magma_store_be64(uint64_t value, uint8_t* out) {
+  for (size_t i = 0U; i < 8U; ++i) {
+    out[7U - i] = (uint8_t)(value & 0xFFU);
+    value >>= 8U;
+  }
+}
+
+/** Round function g[k](a) = (t(a + k mod 2^32)) <<< 11 via merged tables. */
+static inline uint32_t crisp_magma_g(uint32_t a, uint32_t k) {
+  const uint32_t t = a + k;
+  return crisp_magma_t[0][t & 0xFFU] ^ crisp_magma_t[1][(t >> 8U) & 0xFFU] ^
+         crisp_magma_t[2][(t >> 16U) & 0xFFU] ^ crisp_magma_t[3][t >> 24U];
+}
+
+/**
+ * Encrypts one block with a fully unrolled 32-round Feistel network.
+ * Key order is K1..K8 three times, then K8..K1; the final round does not swap halves.
+ */
+static inline uint64_t crisp_magma_encrypt_block(const crisp_magma_key_t* key, uint64_t block) {
+  const uint32_t* k = key->rk;
+  uint32_t n1 = (uint32_t)(block & 0xFFFFFFFFU);
+  uint32_t n2 = (uint32_t)(block >> 32U);
+
+#define CRISP_MAGMA_ROUND_PAIR(ka, kb) \
+  n2 ^= crisp_magma_g(n1, (ka));       \
+  n1 ^= crisp_magma_g(n2, (kb))
+
+  CRISP_MAGMA_ROUND_PAIR(k[0], k[1]);
+  CRISP_MAGMA_ROUND_PAIR(k[2], k[3]);
+  CRISP_MAGMA_ROUND_PAIR(k[4], k[5]);
+  CRISP_MAGMA_ROUND_PAIR(k[6], k[7]);
+  CRISP_MAGMA_ROUND_PAIR(k[0], k[1]);
+  CRISP_MAGMA_ROUND_PAIR(k[2], k[3]);
+  CRISP_MAGMA_ROUND_PAIR(k[4], k[5]);
+  CRISP_MAGMA_ROUND_PAIR(k[6], k[7]);
+  CRISP_MAGMA_ROUND_PAIR(k[0], k[1]);
+  CRISP_MAGMA_ROUND_PAIR(k[2], k[3]);
+  CRISP_MAGMA_ROUND_PAIR(k[4], k[5]);
+  CRISP_MAGMA_ROUND_PAIR(k[6], k[7]);
+  CRISP_MAGMA_ROUND_PAIR(k[7], k[6]);
+  CRISP_MAGMA_ROUND_PAIR(k[5], k[4]);
+  CRISP_MAGMA_ROUND_PAIR(k[3], k[2]);
+  CRISP_MAGMA_ROUND_PAIR(k[1], k[0]);
+
+#undef CRISP_MAGMA_ROUND_PAIR
+
+  return ((uint64_t)n1 << 32U) | (uint64_t)n2;
+}
+
+/**
+ * Expands a 256-bit key into round keys.
+ * CMAC subkeys are derived only when `with_cmac_subkeys` is true (costs one block encryption).
+ */
+void crisp_magma_expand_key(const uint8_t* key32, bool with_cmac_subkeys, crisp_magma_key_t* out);
+
+/** Zeroes key material in a way the optimizer cannot elide. */
+void crisp_magma_wipe(void* data, size_t size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_SRC_MAGMA_CIPHER_H_
@@ -0,0 +1,664 @@
+#include "crisp/crypto/magma_backend.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crisp/core/cpu.h"
+#include "magma_cipher.h"
+#include "magma_mb.h"
+
+/** Keyed contexts are cache-line aligned so a hot key never straddles two lines. */
+enum {
+  CRISP_MAGMA_KEY_CTX_ALIGN = 64,
+};
+
+static crisp_error_t crisp_magma_check_key(crisp_const_byte_span_t key) {
+  if (key.size > 0U && key.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (key.size != CRISP_MAGMA_KEY_SIZE) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_check_cmac_args(crisp_const_byte_span_t data,
+                                                 crisp_mutable_byte_span_t out_icv) {
+  if ((data.size > 0U && data.data == NULL) || out_icv.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (out_icv.size < 1U || out_icv.size > CRISP_MAGMA_BLOCK_SIZE) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_check_ctr_args(crisp_const_byte_span_t in,
+                                                crisp_mutable_byte_span_t out) {
+  if ((in.size > 0U && in.data == NULL) || (out.size > 0U && out.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (in.size != out.size) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  return CRISP_OK;
+}
+
+/**
+ * Absorbs the final (1..8 byte, or empty) CMAC block and writes the truncated tag.
+ * Full last block uses K1, padded last block uses K2.
+ */
+static void crisp_magma_cmac_finish(const crisp_magma_key_t* key,
+                                    uint64_t chain,
+                                    const uint8_t* tail,
+                                    size_t tail_size,
+                                    crisp_mutable_byte_span_t out_icv) {
+  uint64_t last = 0U;
+  if (tail_size == CRISP_MAGMA_BLOCK_SIZE) {
+    last = crisp_magma_load_be64(tail) ^ key->cmac_k1;
+  } else {
+    uint8_t padded[CRISP_MAGMA_BLOCK_SIZE] = {0};
+    if (tail_size > 0U) {
+      (void)memcpy(padded, tail, tail_size);
+    }
+    padded[tail_size] = 0x80U;
+    last = crisp_magma_load_be64(padded) ^ key->cmac_k2;
+  }
+  chain = crisp_magma_encrypt_block(key, chain ^ last);
+
+  uint8_t mac[CRISP_MAGMA_BLOCK_SIZE];
+  crisp_magma_store_be64(chain, mac);
+  (void)memcpy(out_icv.data, mac, out_icv.size);
+  crisp_magma_wipe(mac, sizeof(mac));
+}
+
+/** GOST R 34.13-2015 MAC (OMAC1). */
+static void crisp_magma_cmac_compute(const crisp_magma_key_t* key,
+                                     crisp_const_byte_span_t data,
+                                     crisp_mutable_byte_span_t out_icv) {
+  uint64_t chain = 0U;
+  size_t offset = 0U;
+  while (data.size - offset > CRISP_MAGMA_BLOCK_SIZE) {
+    chain = crisp_magma_encrypt_block(key, chain ^ crisp_magma_load_be64(data.data + offset));
+    offset += CRISP_MAGMA_BLOCK_SIZE;
+  }
+  crisp_magma_cmac_finish(key, chain, data.data + offset, data.size - offset, out_icv);
+}
+
+/**
+ * `user_ctx` carries the engine selected at iface init; a bare vtable copy falls back to scalar.
+ */
+static const crisp_magma_mb_engine_t* crisp_magma_engine_of(const void* user_ctx) {
+  return user_ctx != NULL ? (const crisp_magma_mb_engine_t*)user_ctx
+                          : &crisp_magma_mb_scalar_engine;
+}
+
+/**
+ * CTR with counter block IV32 || 0^32; `in` and `out` may alias exactly.
+ * Counter blocks are independent, so a single packet also fills the engine lanes.
+ */
+static void crisp_magma_ctr_compute(const crisp_magma_mb_engine_t* engine,
+                                    const crisp_magma_key_t* key,
+                                    uint32_t iv32,
+                                    crisp_const_byte_span_t in,
+                                    crisp_mutable_byte_span_t out) {
+  const crisp_magma_ctr_job_t job = {
+      .iv32 = iv32,
+      .in = in,
+      .out = out,
+  };
+  crisp_magma_mb_ctr(engine, key, &job, 1U);
+}
+
+/**
+ * Single pass CTR + CMAC. Keystream is produced by the engine one lane-width chunk at a time
+ * (kept on the stack); each payload block is then XORed and the CMAC blocks of `auth` it
+ * completes are absorbed, so payload bytes are touched once while still in L1. The final CMAC
+ * block is kept back for K1/K2. A non-NULL `midstate` (absorbed <= payload_offset, checked by
+ * the caller) replaces the CMAC over the first midstate->absorbed bytes of `auth`.
+ * TX: `ctr_in` is plaintext, ciphertext lands in `auth` at `payload_offset` (`ctr_out`).
+ * RX: `ctr_in` is the ciphertext inside `auth`, `ctr_out` receives plaintext (no overlap).
+ */
+static void crisp_magma_fused_compute(const crisp_magma_mb_engine_t* engine,
+                                      const crisp_magma_key_t* kenc,
+                                      const crisp_magma_key_t* kmac,
+                                      const crisp_cmac_midstate_t* midstate,
+                                      uint32_t iv32,
+                                      const uint8_t* ctr_in,
+                                      uint8_t* ctr_out,
+                                      const uint8_t* auth,
+                                      size_t auth_size,
+                                      size_t payload_offset,
+                                      crisp_mutable_byte_span_t out_icv) {
+  const size_t payload_size = auth_size - payload_offset;
+  const size_t chunk_bytes = engine->lanes * CRISP_MAGMA_BLOCK_SIZE;
+  uint64_t keystream[CRISP_MAGMA_MB_MAX_LANES];
+  uint64_t counter = (uint64_t)iv32 << 32U;
+  uint64_t chain = midstate != NULL ? midstate->state[0] : 0U;
+  size_t cmac_offset = midstate != NULL ? midstate->absorbed : 0U;
+
+  for (size_t offset = 0U; offset < payload_size; offset += CRISP_MAGMA_BLOCK_SIZE) {
+    const size_t block_index = (offset % chunk_bytes) / CRISP_MAGMA_BLOCK_SIZE;
+    if (block_index == 0U) {
+      const size_t remaining_blocks =
+          (payload_size - offset + CRISP_MAGMA_BLOCK_SIZE - 1U) / CRISP_MAGMA_BLOCK_SIZE;
+      crisp_magma_mb_keystream(engine, kenc, counter,
+                               remaining_blocks < engine->lanes ? remaining_blocks : engine->lanes,
+                               keystream);
+      counter += engine->lanes;
+    }
+
+    const size_t remaining = payload_size - offset;
+    if (remaining >= CRISP_MAGMA_BLOCK_SIZE) {
+      crisp_magma_store_be64(crisp_magma_load_be64(ctr_in + offset) ^ keystream[block_index],
+                             ctr_out + offset);
+    } else {
+      uint8_t bytes[CRISP_MAGMA_BLOCK_SIZE];
+      crisp_magma_store_be64(keystream[block_index], bytes);
+      for (size_t i = 0U; i < remaining; ++i) {
+        ctr_out[offset + i] = (uint8_t)(ctr_in[offset + i] ^ bytes[i]);
+      }
+      crisp_magma_wipe(bytes, sizeof(bytes));
+    }
+
+    const size_t available =
+        payload_offset + offset +
+        (remaining < CRISP_MAGMA_BLOCK_SIZE ? remaining : CRISP_MAGMA_BLOCK_SIZE);
+    while (auth_size - cmac_offset > CRISP_MAGMA_BLOCK_SIZE &&
+           cmac_offset + CRISP_MAGMA_BLOCK_SIZE <= available) {
+      chain = crisp_magma_encrypt_block(kmac, chain ^ crisp_magma_load_be64(auth + cmac_offset));
+      cmac_offset += CRISP_MAGMA_BLOCK_SIZE;
+    }
+  }
+
+  while (auth_size - cmac_offset > CRISP_MAGMA_BLOCK_SIZE) {
+    chain = crisp_magma_encrypt_block(kmac, chain ^ crisp_magma_load_be64(auth + cmac_offset));
+    cmac_offset += CRISP_MAGMA_BLOCK_SIZE;
+  }
+  crisp_magma_cmac_finish(kmac, chain, auth + cmac_offset, auth_size - cmac_offset, out_icv);
+  crisp_magma_wipe(keystream, sizeof(keystream));
+}
+
+static crisp_error_t crisp_magma_cmac(void* user_ctx,
+                                      crisp_const_byte_span_t key,
+                                      crisp_const_byte_span_t data,
+                                      crisp_mutable_byte_span_t out_icv) {
+  (void)user_ctx;
+  crisp_error_t err = crisp_magma_check_key(key);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  err = crisp_magma_check_cmac_args(data, out_icv);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_magma_key_t expanded;
+  crisp_magma_expand_key(key.data, true, &expanded);
+  crisp_magma_cmac_compute(&expanded, data, out_icv);
+  crisp_magma_wipe(&expanded, sizeof(expanded));
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_ctr_xcrypt(void* user_ctx,
+                                            crisp_const_byte_span_t key,
+                                            uint32_t iv32,
+                                            crisp_const_byte_span_t in,
+                                            crisp_mutable_byte_span_t out) {
+  crisp_error_t err = crisp_magma_check_key(key);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  err = crisp_magma_check_ctr_args(in, out);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_magma_key_t expanded;
+  crisp_magma_expand_key(key.data, false, &expanded);
+  crisp_magma_ctr_compute(crisp_magma_engine_of(user_ctx), &expanded, iv32, in, out);
+  crisp_magma_wipe(&expanded, sizeof(expanded));
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_key_init(void* user_ctx,
+                                          crisp_const_byte_span_t key,
+                                          void** out_key_ctx) {
+  (void)user_ctx;
+  if (out_key_ctx == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_error_t err = crisp_magma_check_key(key);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  const size_t alloc_size = ((sizeof(crisp_magma_key_t) + CRISP_MAGMA_KEY_CTX_ALIGN - 1U) /
+                             CRISP_MAGMA_KEY_CTX_ALIGN) *
+                            CRISP_MAGMA_KEY_CTX_ALIGN;
+  crisp_magma_key_t* ctx = (crisp_magma_key_t*)aligned_alloc(CRISP_MAGMA_KEY_CTX_ALIGN, alloc_size);
+  if (ctx == NULL) {
+    return CRISP_ERR_CRYPTO;
+  }
+  crisp_magma_expand_key(key.data, true, ctx);
+  *out_key_ctx = ctx;
+  return CRISP_OK;
+}
+
+static void crisp_magma_key_release(void* user_ctx, void* key_ctx) {
+  (void)user_ctx;
+  if (key_ctx == NULL) {
+    return;
+  }
+  crisp_magma_wipe(key_ctx, sizeof(crisp_magma_key_t));
+  free(key_ctx);
+}
+
+static crisp_error_t crisp_magma_cmac_keyed(void* user_ctx,
+                                            const void* key_ctx,
+                                            crisp_const_byte_span_t data,
+                                            crisp_mutable_byte_span_t out_icv) {
+  (void)user_ctx;
+  if (key_ctx == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_error_t err = crisp_magma_check_cmac_args(data, out_icv);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_magma_cmac_compute((const crisp_magma_key_t*)key_ctx, data, out_icv);
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_cmac_absorb(void* user_ctx,
+                                             const void* key_ctx,
+                                             crisp_const_byte_span_t prefix,
+                                             crisp_cmac_midstate_t* out_midstate) {
+  (void)user_ctx;
+  if (key_ctx == NULL || out_midstate == NULL || (prefix.size > 0U && prefix.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (prefix.size % CRISP_MAGMA_BLOCK_SIZE != 0U) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+
+  const crisp_magma_key_t* key = (const crisp_magma_key_t*)key_ctx;
+  uint64_t chain = 0U;
+  for (size_t offset = 0U; offset < prefix.size; offset += CRISP_MAGMA_BLOCK_SIZE) {
+    chain = crisp_magma_encrypt_block(key, chain ^ crisp_magma_load_be64(prefix.data + offset));
+  }
+  (void)memset(out_midstate, 0, sizeof(*out_midstate));
+  out_midstate->absorbed = prefix.size;
+  out_midstate->state[0] = chain;
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_check_midstate(const crisp_cmac_midstate_t* midstate,
+                                                size_t limit) {
+  if (midstate->absorbed % CRISP_MAGMA_BLOCK_SIZE != 0U || midstate->absorbed > limit) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_cmac_resume(void* user_ctx,
+                                             const void* key_ctx,
+                                             const crisp_cmac_midstate_t* midstate,
+                                             crisp_const_byte_span_t data,
+                                             crisp_mutable_byte_span_t out_icv) {
+  (void)user_ctx;
+  if (key_ctx == NULL || midstate == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_error_t err = crisp_magma_check_cmac_args(data, out_icv);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  /* The final block is never part of the midstate, so at least one byte must follow it. */
+  if (data.size == 0U) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  err = crisp_magma_check_midstate(midstate, data.size - 1U);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  const crisp_magma_key_t* key = (const crisp_magma_key_t*)key_ctx;
+  uint64_t chain = midstate->state[0];
+  size_t offset = midstate->absorbed;
+  while (data.size - offset > CRISP_MAGMA_BLOCK_SIZE) {
+    chain = crisp_magma_encrypt_block(key, chain ^ crisp_magma_load_be64(data.data + offset));
+    offset += CRISP_MAGMA_BLOCK_SIZE;
+  }
+  crisp_magma_cmac_finish(key, chain, data.data + offset, data.size - offset, out_icv);
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_cmac_update(void* user_ctx,
+                                             const void* key_ctx,
+                                             crisp_cmac_midstate_t* midstate,
+                                             crisp_const_byte_span_t blocks) {
+  (void)user_ctx;
+  if (key_ctx == NULL || midstate == NULL || (blocks.size > 0U && blocks.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (blocks.size % CRISP_MAGMA_BLOCK_SIZE != 0U) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  const crisp_error_t err = crisp_magma_check_midstate(midstate, SIZE_MAX - blocks.size);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  const crisp_magma_key_t* key = (const crisp_magma_key_t*)key_ctx;
+  uint64_t chain = midstate->absorbed > 0U ? midstate->state[0] : 0U;
+  for (size_t offset = 0U; offset < blocks.size; offset += CRISP_MAGMA_BLOCK_SIZE) {
+    chain = crisp_magma_encrypt_block(key, chain ^ crisp_magma_load_be64(blocks.data + offset));
+  }
+  midstate->absorbed += blocks.size;
+  midstate->state[0] = chain;
+  midstate->state[1] = 0U;
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_cmac_final(void* user_ctx,
+                                            const void* key_ctx,
+                                            const crisp_cmac_midstate_t* midstate,
+                                            crisp_const_byte_span_t last,
+                                            crisp_mutable_byte_span_t out_icv) {
+  (void)user_ctx;
+  if (key_ctx == NULL || midstate == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_error_t err = crisp_magma_check_cmac_args(last, out_icv);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  /* Only an empty message has no final block to hold back. */
+  if (last.size > CRISP_MAGMA_BLOCK_SIZE || (last.size == 0U && midstate->absorbed > 0U)) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  err = crisp_magma_check_midstate(midstate, SIZE_MAX);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  const uint64_t chain = midstate->absorbed > 0U ? midstate->state[0] : 0U;
+  crisp_magma_cmac_finish((const crisp_magma_key_t*)key_ctx, chain, last.data, last.size,
+                          out_icv);
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_ctr_xcrypt_keyed(void* user_ctx,
+                                                  const void* key_ctx,
+                                                  uint32_t iv32,
+                                                  crisp_const_byte_span_t in,
+                                                  crisp_mutable_byte_span_t out) {
+  if (key_ctx == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_error_t err = crisp_magma_check_ctr_args(in, out);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_magma_ctr_compute(crisp_magma_engine_of(user_ctx), (const crisp_magma_key_t*)key_ctx, iv32,
+                          in, out);
+  return CRISP_OK;
+}
+
+/**
+ * CTR from keystream byte `offset`: counters start at block offset / 8 and the leading
+ * offset % 8 keystream bytes of that block are skipped. Keystream is produced a lane-width
+ * chunk at a time, as in the fused pass.
+ */
+static void crisp_magma_ctr_at_compute(const crisp_magma_mb_engine_t* engine,
+                                       const crisp_magma_key_t* key,
+                                       uint32_t iv32,
+                                       size_t offset,
+                                       crisp_const_byte_span_t in,
+                                       crisp_mutable_byte_span_t out) {
+  uint64_t keystream[CRISP_MAGMA_MB_MAX_LANES];
+  uint64_t counter = ((uint64_t)iv32 << 32U) + (uint64_t)(offset / CRISP_MAGMA_BLOCK_SIZE);
+  size_t skip = offset % CRISP_MAGMA_BLOCK_SIZE;
+  size_t done = 0U;
+  while (done < in.size) {
+    const size_t needed = (skip + in.size - done + CRISP_MAGMA_BLOCK_SIZE - 1U) /
+                          CRISP_MAGMA_BLOCK_SIZE;
+    const size_t blocks = needed < engine->lanes ? needed : engine->lanes;
+    crisp_magma_mb_keystream(engine, key, counter, blocks, keystream);
+    counter += blocks;
+
+    for (size_t b = 0U; b < blocks; ++b) {
+      const size_t remaining = in.size - done;
+      if (skip == 0U && remaining >= CRISP_MAGMA_BLOCK_SIZE) {
+        crisp_magma_store_be64(crisp_magma_load_be64(in.data + done) ^ keystream[b],
+                               out.data + done);
+        done += CRISP_MAGMA_BLOCK_SIZE;
+        continue;
+      }
+      uint8_t bytes[CRISP_MAGMA_BLOCK_SIZE];
+      crisp_magma_store_be64(keystream[b], bytes);
+      const size_t take = CRISP_MAGMA_BLOCK_SIZE - skip < remaining
+                              ? CRISP_MAGMA_BLOCK_SIZE - skip
+                              : remaining;
+      for (size_t i = 0U; i < take; ++i) {
+        out.data[done + i] = (uint8_t)(in.data[done + i] ^ bytes[skip + i]);
+      }
+      crisp_magma_wipe(bytes, sizeof(bytes));
+      done += take;
+      skip = 0U;
+    }
+  }
+  crisp_magma_wipe(keystream, sizeof(keystream));
+}
+
+static crisp_error_t crisp_magma_ctr_xcrypt_at(void* user_ctx,
+                                               const void* key_ctx,
+                                               uint32_t iv32,
+                                               size_t offset,
+                                               crisp_const_byte_span_t in,
+                                               crisp_mutable_byte_span_t out) {
+  if (key_ctx == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_error_t err = crisp_magma_check_ctr_args(in, out);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_magma_ctr_at_compute(crisp_magma_engine_of(user_ctx), (const crisp_magma_key_t*)key_ctx,
+                             iv32, offset, in, out);
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_check_fused_args(const void* kenc_ctx,
+                                                  const void* kmac_ctx,
+                                                  const crisp_cmac_midstate_t* midstate,
+                                                  const uint8_t* auth,
+                                                  size_t auth_size,
+                                                  size_t payload_offset,
+                                                  crisp_const_byte_span_t payload,
+                                                  crisp_mutable_byte_span_t out_icv) {
+  if (kenc_ctx == NULL || kmac_ctx == NULL || auth == NULL ||
+      (payload.size > 0U && payload.data == NULL) || out_icv.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (payload_offset > auth_size || payload.size != auth_size - payload_offset ||
+      out_icv.size < 1U || out_icv.size > CRISP_MAGMA_BLOCK_SIZE) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  if (midstate == NULL) {
+    return CRISP_OK;
+  }
+  /* The midstate covers header bytes only and never the final CMAC block. */
+  if (auth_size == 0U) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  return crisp_magma_check_midstate(midstate,
+                                    payload_offset < auth_size ? payload_offset : auth_size - 1U);
+}
+
+static crisp_error_t crisp_magma_ctr_then_cmac(void* user_ctx,
+                                               const void* kenc_ctx,
+                                               const void* kmac_ctx,
+                                               const crisp_cmac_midstate_t* midstate,
+                                               uint32_t iv32,
+                                               crisp_const_byte_span_t in,
+                                               crisp_mutable_byte_span_t auth,
+                                               size_t payload_offset,
+                                               crisp_mutable_byte_span_t out_icv) {
+  const crisp_error_t err = crisp_magma_check_fused_args(kenc_ctx, kmac_ctx, midstate, auth.data,
+                                                         auth.size, payload_offset, in, out_icv);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_magma_fused_compute(crisp_magma_engine_of(user_ctx), (const crisp_magma_key_t*)kenc_ctx,
+                            (const crisp_magma_key_t*)kmac_ctx, midstate, iv32, in.data,
+                            auth.data + payload_offset, auth.data, auth.size, payload_offset,
+                            out_icv);
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_cmac_then_ctr(void* user_ctx,
+                                               const void* kenc_ctx,
+                                               const void* kmac_ctx,
+                                               const crisp_cmac_midstate_t* midstate,
+                                               uint32_t iv32,
+                                               crisp_const_byte_span_t auth,
+                                               size_t payload_offset,
+                                               crisp_mutable_byte_span_t out,
+                                               crisp_mutable_byte_span_t out_icv) {
+  const crisp_const_byte_span_t out_view = {
+      .data = out.data,
+      .size = out.size,
+  };
+  const crisp_error_t err =
+      crisp_magma_check_fused_args(kenc_ctx, kmac_ctx, midstate, auth.data, auth.size,
+                                   payload_offset, out_view, out_icv);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_magma_fused_compute(crisp_magma_engine_of(user_ctx), (const crisp_magma_key_t*)kenc_ctx,
+                            (const crisp_magma_key_t*)kmac_ctx, midstate, iv32,
+                            auth.data + payload_offset, out.data, auth.data, auth.size,
+                            payload_offset, out_icv);
+  return CRISP_OK;
+}
+
+/** `user_ctx` carries the selected multi-buffer engine. */
+static crisp_error_t crisp_magma_cmac_batch(void* user_ctx,
+                                            const void* key_ctx,
+                                            const crisp_magma_cmac_job_t* jobs,
+                                            size_t count) {
+  if (key_ctx == NULL || (count > 0U && jobs == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  for (size_t i = 0U; i < count; ++i) {
+    const crisp_error_t err = crisp_magma_check_cmac_args(jobs[i].data, jobs[i].out_icv);
+    if (err != CRISP_OK) {
+      return err;
+    }
+  }
+
+  crisp_magma_mb_cmac(crisp_magma_engine_of(user_ctx), (const crisp_magma_key_t*)key_ctx, jobs,
+                      count);
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_magma_ctr_xcrypt_batch(void* user_ctx,
+                                                  const void* key_ctx,
+                                                  const crisp_magma_ctr_job_t* jobs,
+                                                  size_t count) {
+  if (key_ctx == NULL || (count > 0U && jobs == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  for (size_t i = 0U; i < count; ++i) {
+    const crisp_error_t err = crisp_magma_check_ctr_args(jobs[i].in, jobs[i].out);
+    if (err != CRISP_OK) {
+      return err;
+    }
+  }
+
+  crisp_magma_mb_ctr(crisp_magma_engine_of(user_ctx), (const crisp_magma_key_t*)key_ctx, jobs,
+                     count);
+  return CRISP_OK;
+}
+
+/** Engine for a CPU level; SSE4.2 has no gather, so it keeps the scalar engine. */
+static const crisp_magma_mb_engine_t* crisp_magma_engine_for_level(crisp_cpu_level_t level) {
+#if CRISP_MAGMA_MB_HAVE_X86
+  if (level >= CRISP_CPU_LEVEL_AVX512) {
+    return &crisp_magma_mb_avx512_engine;
+  }
+  if (level >= CRISP_CPU_LEVEL_AVX2) {
+    return &crisp_magma_mb_avx2_engine;
+  }
+#else
+  (void)level;
+#endif
+  return &crisp_magma_mb_scalar_engine;
+}
+
+/** Maps an engine id to its kernel table; NULL when it cannot run on this build/CPU. */
+static const crisp_magma_mb_engine_t* crisp_magma_select_engine(crisp_magma_engine_t engine) {
+  switch (engine) {
+    case CRISP_MAGMA_ENGINE_AUTO:
+      return crisp_magma_engine_for_level(crisp_cpu_active_level());
+    case CRISP_MAGMA_ENGINE_SCALAR:
+      return &crisp_magma_mb_scalar_engine;
+#if CRISP_MAGMA_MB_HAVE_X86
+    case CRISP_MAGMA_ENGINE_AVX2:
+      return crisp_cpu_detected_level() >= CRISP_CPU_LEVEL_AVX2 ? &crisp_magma_mb_avx2_engine
+                                                                : NULL;
+    case CRISP_MAGMA_ENGINE_AVX512:
+      return crisp_cpu_detected_level() >= CRISP_CPU_LEVEL_AVX512 ? &crisp_magma_mb_avx512_engine
+                                                                  : NULL;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+bool crisp_magma_engine_supported(crisp_magma_engine_t engine) {
+  return crisp_magma_select_engine(engine) != NULL;
+}
+
+crisp_error_t crisp_magma_crypto_iface_init_engine(crisp_crypto_iface_t* iface,
+                                                   crisp_magma_engine_t engine) {
+  if (iface == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_magma_mb_engine_t* selected = crisp_magma_select_engine(engine);
+  if (selected == NULL) {
+    return CRISP_ERR_NOT_SUPPORTED;
+  }
+
+  (void)memset(iface, 0, sizeof(*iface));
+  /* Engines are immutable; user_ctx is only ever read back as const. */
+  iface->user_ctx = (void*)selected;
+  iface->magma_cmac = crisp_magma_cmac;
+  iface->magma_ctr_xcrypt = crisp_magma_ctr_xcrypt;
+  iface->magma_key_init = crisp_magma_key_init;
+  iface->magma_key_release = crisp_magma_key_release;
+  iface->magma_cmac_keyed = crisp_magma_cmac_keyed;
+  iface->magma_ctr_xcrypt_keyed = crisp_magma_ctr_xcrypt_keyed;
+  iface->magma_cmac_batch = crisp_magma_cmac_batch;
+  iface->magma_ctr_xcrypt_batch = crisp_magma_ctr_xcrypt_batch;
+  iface->magma_ctr_then_cmac = crisp_magma_ctr_then_cmac;
+  iface->magma_cmac_then_ctr = crisp_magma_cmac_then_ctr;
+  iface->magma_cmac_absorb = crisp_magma_cmac_absorb;
+  iface->magma_cmac_resume = crisp_magma_cmac_resume;
+  iface->magma_cmac_update = crisp_magma_cmac_update;
+  iface->magma_cmac_final = crisp_magma_cmac_final;
+  iface->magma_ctr_xcrypt_at = crisp_magma_ctr_xcrypt_at;
+  return CRISP_OK;
+}
+
+void crisp_magma_crypto_iface_init(crisp_crypto_iface_t* iface) {
+  (void)crisp_magma_crypto_iface_init_engine(iface, CRISP_MAGMA_ENGINE_AUTO);
+}
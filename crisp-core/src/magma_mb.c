@@ -0,0 +1,227 @@
+#include "magma_mb.h"
+
+#include <string.h>
+
+enum {
+  CRISP_MAGMA_MB_SCALAR_LANES = 4,
+};
+
+static void crisp_magma_mb_scalar_encrypt(const crisp_magma_key_t* key,
+                                          uint32_t* lo,
+                                          uint32_t* hi) {
+  /* Independent blocks: the out-of-order core overlaps their table lookups. */
+  for (size_t i = 0U; i < (size_t)CRISP_MAGMA_MB_SCALAR_LANES; ++i) {
+    const uint64_t block =
+        crisp_magma_encrypt_block(key, ((uint64_t)hi[i] << 32U) | (uint64_t)lo[i]);
+    lo[i] = (uint32_t)(block & 0xFFFFFFFFU);
+    hi[i] = (uint32_t)(block >> 32U);
+  }
+}
+
+const crisp_magma_mb_engine_t crisp_magma_mb_scalar_engine = {
+    .lanes = CRISP_MAGMA_MB_SCALAR_LANES,
+    .encrypt = crisp_magma_mb_scalar_encrypt,
+};
+
+/** CMAC lane state; `job == NULL` marks an idle lane. */
+typedef struct crisp_magma_mb_cmac_lane {
+  const crisp_magma_cmac_job_t* job;
+  size_t offset;
+  uint64_t chain;
+  bool final_block;
+} crisp_magma_mb_cmac_lane_t;
+
+/** Returns the next CMAC input block of a lane (chain already mixed in). */
+static uint64_t crisp_magma_mb_cmac_next_block(const crisp_magma_key_t* key,
+                                               crisp_magma_mb_cmac_lane_t* lane) {
+  const crisp_const_byte_span_t data = lane->job->data;
+  const size_t remaining = data.size - lane->offset;
+  if (remaining > CRISP_MAGMA_BLOCK_SIZE) {
+    const uint64_t block = crisp_magma_load_be64(data.data + lane->offset);
+    lane->offset += CRISP_MAGMA_BLOCK_SIZE;
+    return lane->chain ^ block;
+  }
+
+  lane->final_block = true;
+  if (remaining == CRISP_MAGMA_BLOCK_SIZE) {
+    return lane->chain ^ crisp_magma_load_be64(data.data + lane->offset) ^ key->cmac_k1;
+  }
+  uint8_t padded[CRISP_MAGMA_BLOCK_SIZE] = {0};
+  if (remaining > 0U) {
+    (void)memcpy(padded, data.data + lane->offset, remaining);
+  }
+  padded[remaining] = 0x80U;
+  return lane->chain ^ crisp_magma_load_be64(padded) ^ key->cmac_k2;
+}
+
+void crisp_magma_mb_cmac(const crisp_magma_mb_engine_t* engine,
+                         const crisp_magma_key_t* key,
+                         const crisp_magma_cmac_job_t* jobs,
+                         size_t count) {
+  crisp_magma_mb_cmac_lane_t lanes[CRISP_MAGMA_MB_MAX_LANES];
+  uint32_t lo[CRISP_MAGMA_MB_MAX_LANES];
+  uint32_t hi[CRISP_MAGMA_MB_MAX_LANES];
+  size_t next_job = 0U;
+  size_t active = 0U;
+
+  for (size_t l = 0U; l < engine->lanes; ++l) {
+    (void)memset(&lanes[l], 0, sizeof(lanes[l]));
+    if (next_job < count) {
+      lanes[l].job = &jobs[next_job++];
+      ++active;
+    }
+  }
+
+  while (active > 0U) {
+    for (size_t l = 0U; l < engine->lanes; ++l) {
+      uint64_t block = 0U;
+      if (lanes[l].job != NULL) {
+        block = crisp_magma_mb_cmac_next_block(key, &lanes[l]);
+      }
+      lo[l] = (uint32_t)(block & 0xFFFFFFFFU);
+      hi[l] = (uint32_t)(block >> 32U);
+    }
+
+    engine->encrypt(key, lo, hi);
+
+    for (size_t l = 0U; l < engine->lanes; ++l) {
+      crisp_magma_mb_cmac_lane_t* lane = &lanes[l];
+      if (lane->job == NULL) {
+        continue;
+      }
+      lane->chain = ((uint64_t)hi[l] << 32U) | (uint64_t)lo[l];
+      if (!lane->final_block) {
+        continue;
+      }
+
+      uint8_t mac[CRISP_MAGMA_BLOCK_SIZE];
+      crisp_magma_store_be64(lane->chain, mac);
+      (void)memcpy(lane->job->out_icv.data, mac, lane->job->out_icv.size);
+      crisp_magma_wipe(mac, sizeof(mac));
+
+      (void)memset(lane, 0, sizeof(*lane));
+      if (next_job < count) {
+        lane->job = &jobs[next_job++];
+      } else {
+        --active;
+      }
+    }
+  }
+
+  crisp_magma_wipe(lanes, sizeof(lanes));
+  crisp_magma_wipe(lo, sizeof(lo));
+  crisp_magma_wipe(hi, sizeof(hi));
+}
+
+/** One pending CTR block: where its input comes from and where the XOR result goes. */
+typedef struct crisp_magma_mb_ctr_slot {
+  const uint8_t* in;
+  uint8_t* out;
+  size_t size;
+} crisp_magma_mb_ctr_slot_t;
+
+/** Encrypts the first `filled` lane blocks, padding the rest when the engine is used. */
+static void crisp_magma_mb_encrypt_filled(const crisp_magma_mb_engine_t* engine,
+                                          const crisp_magma_key_t* key,
+                                          size_t filled,
+                                          uint32_t* lo,
+                                          uint32_t* hi) {
+  if (filled * 2U < engine->lanes) {
+    /* Mostly idle lanes (short packet, batch tail): one-block path is cheaper than padding. */
+    for (size_t l = 0U; l < filled; ++l) {
+      const uint64_t block =
+          crisp_magma_encrypt_block(key, ((uint64_t)hi[l] << 32U) | (uint64_t)lo[l]);
+      lo[l] = (uint32_t)(block & 0xFFFFFFFFU);
+      hi[l] = (uint32_t)(block >> 32U);
+    }
+  } else {
+    for (size_t l = filled; l < engine->lanes; ++l) {
+      lo[l] = 0U;
+      hi[l] = 0U;
+    }
+    engine->encrypt(key, lo, hi);
+  }
+}
+
+static void crisp_magma_mb_ctr_flush(const crisp_magma_mb_engine_t* engine,
+                                     const crisp_magma_key_t* key,
+                                     const crisp_magma_mb_ctr_slot_t* slots,
+                                     size_t filled,
+                                     uint32_t* lo,
+                                     uint32_t* hi) {
+  crisp_magma_mb_encrypt_filled(engine, key, filled, lo, hi);
+
+  for (size_t l = 0U; l < filled; ++l) {
+    const uint64_t keystream = ((uint64_t)hi[l] << 32U) | (uint64_t)lo[l];
+    if (slots[l].size == CRISP_MAGMA_BLOCK_SIZE) {
+      crisp_magma_store_be64(crisp_magma_load_be64(slots[l].in) ^ keystream, slots[l].out);
+      continue;
+    }
+    uint8_t bytes[CRISP_MAGMA_BLOCK_SIZE];
+    crisp_magma_store_be64(keystream, bytes);
+    for (size_t i = 0U; i < slots[l].size; ++i) {
+      slots[l].out[i] = (uint8_t)(slots[l].in[i] ^ bytes[i]);
+    }
+    crisp_magma_wipe(bytes, sizeof(bytes));
+  }
+}
+
+void crisp_magma_mb_ctr(const crisp_magma_mb_engine_t* engine,
+                        const crisp_magma_key_t* key,
+                        const crisp_magma_ctr_job_t* jobs,
+                        size_t count) {
+  crisp_magma_mb_ctr_slot_t slots[CRISP_MAGMA_MB_MAX_LANES];
+  uint32_t lo[CRISP_MAGMA_MB_MAX_LANES];
+  uint32_t hi[CRISP_MAGMA_MB_MAX_LANES];
+  size_t filled = 0U;
+
+  /* Counter blocks of all jobs are packed back to back, so one long job also fills the lanes. */
+  for (size_t j = 0U; j < count; ++j) {
+    const crisp_magma_ctr_job_t* job = &jobs[j];
+    uint64_t counter = (uint64_t)job->iv32 << 32U;
+    for (size_t offset = 0U; offset < job->in.size; offset += CRISP_MAGMA_BLOCK_SIZE) {
+      const size_t remaining = job->in.size - offset;
+      slots[filled].in = job->in.data + offset;
+      slots[filled].out = job->out.data + offset;
+      slots[filled].size =
+          remaining < CRISP_MAGMA_BLOCK_SIZE ? remaining : CRISP_MAGMA_BLOCK_SIZE;
+      lo[filled] = (uint32_t)(counter & 0xFFFFFFFFU);
+      hi[filled] = (uint32_t)(counter >> 32U);
+      ++counter;
+      if (++filled == engine->lanes) {
+        crisp_magma_mb_ctr_flush(engine, key, slots, filled, lo, hi);
+        filled = 0U;
+      }
+    }
+  }
+  if (filled > 0U) {
+    crisp_magma_mb_ctr_flush(engine, key, slots, filled, lo, hi);
+  }
+
+  crisp_magma_wipe(lo, sizeof(lo));
+  crisp_magma_wipe(hi, sizeof(hi));
+}
+
+void crisp_magma_mb_keystream(const crisp_magma_mb_engine_t* engine,
+                              const crisp_magma_key_t* key,
+                              uint64_t first_counter,
+                              size_t blocks,
+                              uint64_t* out) {
+  uint32_t lo[CRISP_MAGMA_MB_MAX_LANES];
+  uint32_t hi[CRISP_MAGMA_MB_MAX_LANES];
+  for (size_t done = 0U; done < blocks; done += engine->lanes) {
+    const size_t remaining = blocks - done;
+    const size_t filled = remaining < engine->lanes ? remaining : engine->lanes;
+    for (size_t l = 0U; l < filled; ++l) {
+      const uint64_t counter = first_counter + done + l;
+      lo[l] = (uint32_t)(counter & 0xFFFFFFFFU);
+      hi[l] = (uint32_t)(counter >> 32U);
+    }
+    crisp_magma_mb_encrypt_filled(engine, key, filled, lo, hi);
+    for (size_t l = 0U; l < filled; ++l) {
+      out[done + l] = ((uint64_t)hi[l] << 32U) | (uint64_t)lo[l];
+    }
+  }
+  crisp_magma_wipe(lo, sizeof(lo));
+  crisp_magma_wipe(hi, sizeof(hi));
+}
@@ -0,0 +1,79 @@
+#ifndef CRISP_CORE_SRC_MAGMA_MB_H_
+#define CRISP_CORE_SRC_MAGMA_MB_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crisp/crypto/magma_backend.h"
+#include "magma_cipher.h"
+
+/*
+ * Multi-buffer Magma: one engine call encrypts one block in each of `lanes` independent
+ * streams under the same key. The schedulers below keep every lane busy with CMAC chains or
+ * CTR counter blocks taken from a job list, so short and long packets can share a batch.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** x86-64 AVX2/AVX-512 kernels are built with per-function target attributes (GCC/Clang). */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRISP_MAGMA_MB_HAVE_X86 1
+#else
+#define CRISP_MAGMA_MB_HAVE_X86 0
+#endif
+
+enum {
+  CRISP_MAGMA_MB_MAX_LANES = 16,
+};
+
+/**
+ * Encrypts lane blocks in place. Block i is (hi[i] << 32) | lo[i]; the arrays hold exactly
+ * `lanes` entries of the engine.
+ */
+typedef void (*crisp_magma_mb_encrypt_fn)(const crisp_magma_key_t* key, uint32_t* lo, uint32_t* hi);
+
+typedef struct crisp_magma_mb_engine {
+  size_t lanes;
+  crisp_magma_mb_encrypt_fn encrypt;
+} crisp_magma_mb_engine_t;
+
+/** Portable engine: four interleaved table-driven blocks per call. */
+extern const crisp_magma_mb_engine_t crisp_magma_mb_scalar_engine;
+
+#if CRISP_MAGMA_MB_HAVE_X86
+/** AVX2 engine: 8 lanes, S-box lookups via 32-bit gathers. */
+extern const crisp_magma_mb_engine_t crisp_magma_mb_avx2_engine;
+/** AVX-512F engine: 16 lanes, S-box lookups via 32-bit gathers. */
+extern const crisp_magma_mb_engine_t crisp_magma_mb_avx512_engine;
+#endif
+
+/** Computes every CMAC job; arguments must already be validated. */
+void crisp_magma_mb_cmac(const crisp_magma_mb_engine_t* engine,
+                         const crisp_magma_key_t* key,
+                         const crisp_magma_cmac_job_t* jobs,
+                         size_t count);
+
+/** Applies CTR to every job; arguments must already be validated. */
+void crisp_magma_mb_ctr(const crisp_magma_mb_engine_t* engine,
+                        const crisp_magma_key_t* key,
+                        const crisp_magma_ctr_job_t* jobs,
+                        size_t count);
+
+/**
+ * Writes `blocks` (<= CRISP_MAGMA_MB_MAX_LANES) CTR keystream blocks for counters
+ * first_counter, first_counter + 1, ... into `out`.
+ */
+void crisp_magma_mb_keystream(const crisp_magma_mb_engine_t* engine,
+                              const crisp_magma_key_t* key,
+                              uint64_t first_counter,
+                              size_t blocks,
+                              uint64_t* out);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_SRC_MAGMA_MB_H_
@@ -0,0 +1,130 @@
+#include "magma_mb.h"
+
+#if CRISP_MAGMA_MB_HAVE_X86
+
+#include <immintrin.h>
+
+/*
+ * Gather-based kernels. Each round looks up the four merged S-box/rotation tables for all lanes
+ * at once; key words are broadcast once per call. Functions carry their own target attribute so
+ * the rest of the library keeps the baseline ISA and the kernels are only entered after a
+ * runtime CPU check.
+ */
+
+#define CRISP_MAGMA_MB_TABLE(i) ((const int*)crisp_magma_t[(i)])
+
+__attribute__((target("avx2"))) static inline __m256i crisp_magma_g_avx2(__m256i a, __m256i k) {
+  const __m256i mask = _mm256_set1_epi32(0xFF);
+  const __m256i t = _mm256_add_epi32(a, k);
+  __m256i r = _mm256_i32gather_epi32(CRISP_MAGMA_MB_TABLE(0), _mm256_and_si256(t, mask), 4);
+  r = _mm256_xor_si256(r, _mm256_i32gather_epi32(CRISP_MAGMA_MB_TABLE(1),
+                                                 _mm256_and_si256(_mm256_srli_epi32(t, 8), mask),
+                                                 4));
+  r = _mm256_xor_si256(r, _mm256_i32gather_epi32(CRISP_MAGMA_MB_TABLE(2),
+                                                 _mm256_and_si256(_mm256_srli_epi32(t, 16), mask),
+                                                 4));
+  r = _mm256_xor_si256(
+      r, _mm256_i32gather_epi32(CRISP_MAGMA_MB_TABLE(3), _mm256_srli_epi32(t, 24), 4));
+  return r;
+}
+
+__attribute__((target("avx2"))) static void crisp_magma_mb_avx2_encrypt(
+    const crisp_magma_key_t* key, uint32_t* lo, uint32_t* hi) {
+  __m256i k[8];
+  for (size_t i = 0U; i < 8U; ++i) {
+    k[i] = _mm256_set1_epi32((int)key->rk[i]);
+  }
+  __m256i n1 = _mm256_loadu_si256((const __m256i*)lo);
+  __m256i n2 = _mm256_loadu_si256((const __m256i*)hi);
+
+#define CRISP_MAGMA_ROUND_PAIR_AVX2(ka, kb)                  \
+  n2 = _mm256_xor_si256(n2, crisp_magma_g_avx2(n1, (ka))); \
+  n1 = _mm256_xor_si256(n1, crisp_magma_g_avx2(n2, (kb)))
+
+  for (size_t pass = 0U; pass < 3U; ++pass) {
+    CRISP_MAGMA_ROUND_PAIR_AVX2(k[0], k[1]);
+    CRISP_MAGMA_ROUND_PAIR_AVX2(k[2], k[3]);
+    CRISP_MAGMA_ROUND_PAIR_AVX2(k[4], k[5]);
+    CRISP_MAGMA_ROUND_PAIR_AVX2(k[6], k[7]);
+  }
+  CRISP_MAGMA_ROUND_PAIR_AVX2(k[7], k[6]);
+  CRISP_MAGMA_ROUND_PAIR_AVX2(k[5], k[4]);
+  CRISP_MAGMA_ROUND_PAIR_AVX2(k[3], k[2]);
+  CRISP_MAGMA_ROUND_PAIR_AVX2(k[1], k[0]);
+
+#undef CRISP_MAGMA_ROUND_PAIR_AVX2
+
+  /* Output block is n1 || n2 (see crisp_magma_encrypt_block()). */
+  _mm256_storeu_si256((__m256i*)hi, n1);
+  _mm256_storeu_si256((__m256i*)lo, n2);
+}
+
+/*
+ * Without optimization GCC expands _mm512_i32gather_epi32 to a macro that passes the all-ones
+ * __mmask16 to a builtin taking a signed short, which trips -Wsign-conversion.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+__attribute__((target("avx512f"))) static inline __m512i crisp_magma_g_avx512(__m512i a,
+                                                                              __m512i k) {
+  const __m512i mask = _mm512_set1_epi32(0xFF);
+  const __m512i t = _mm512_add_epi32(a, k);
+  __m512i r = _mm512_i32gather_epi32(_mm512_and_si512(t, mask), CRISP_MAGMA_MB_TABLE(0), 4);
+  r = _mm512_xor_si512(r, _mm512_i32gather_epi32(_mm512_and_si512(_mm512_srli_epi32(t, 8), mask),
+                                                 CRISP_MAGMA_MB_TABLE(1), 4));
+  r = _mm512_xor_si512(r, _mm512_i32gather_epi32(_mm512_and_si512(_mm512_srli_epi32(t, 16), mask),
+                                                 CRISP_MAGMA_MB_TABLE(2), 4));
+  r = _mm512_xor_si512(
+      r, _mm512_i32gather_epi32(_mm512_srli_epi32(t, 24), CRISP_MAGMA_MB_TABLE(3), 4));
+  return r;
+}
+#pragma GCC diagnostic pop
+
+__attribute__((target("avx512f"))) static void crisp_magma_mb_avx512_encrypt(
+    const crisp_magma_key_t* key, uint32_t* lo, uint32_t* hi) {
+  __m512i k[8];
+  for (size_t i = 0U; i < 8U; ++i) {
+    k[i] = _mm512_set1_epi32((int)key->rk[i]);
+  }
+  __m512i n1 = _mm512_loadu_si512((const void*)lo);
+  __m512i n2 = _mm512_loadu_si512((const void*)hi);
+
+#define CRISP_MAGMA_ROUND_PAIR_AVX512(ka, kb)                  \
+  n2 = _mm512_xor_si512(n2, crisp_magma_g_avx512(n1, (ka))); \
+  n1 = _mm512_xor_si512(n1, crisp_magma_g_avx512(n2, (kb)))
+
+  for (size_t pass = 0U; pass < 3U; ++pass) {
+    CRISP_MAGMA_ROUND_PAIR_AVX512(k[0], k[1]);
+    CRISP_MAGMA_ROUND_PAIR_AVX512(k[2], k[3]);
+    CRISP_MAGMA_ROUND_PAIR_AVX512(k[4], k[5]);
+    CRISP_MAGMA_ROUND_PAIR_AVX512(k[6], k[7]);
+  }
+  CRISP_MAGMA_ROUND_PAIR_AVX512(k[7], k[6]);
+  CRISP_MAGMA_ROUND_PAIR_AVX512(k[5], k[4]);
+  CRISP_MAGMA_ROUND_PAIR_AVX512(k[3], k[2]);
+  CRISP_MAGMA_ROUND_PAIR_AVX512(k[1], k[0]);
+
+#undef CRISP_MAGMA_ROUND_PAIR_AVX512
+
+  _mm512_storeu_si512((void*)hi, n1);
+  _mm512_storeu_si512((void*)lo, n2);
+}
+
+#undef CRISP_MAGMA_MB_TABLE
+
+const crisp_magma_mb_engine_t crisp_magma_mb_avx2_engine = {
+    .lanes = 8U,
+    .encrypt = crisp_magma_mb_avx2_encrypt,
+};
+
+const crisp_magma_mb_engine_t crisp_magma_mb_avx512_engine = {
+    .lanes = 16U,
+    .encrypt = crisp_magma_mb_avx512_encrypt,
+};
+
+#else
+
+/* Keeps the translation unit non-empty on targets without x86 kernels (ISO C). */
+typedef int crisp_magma_mb_x86_unused_t;
+
+#endif  // CRISP_MAGMA_MB_HAVE_X86
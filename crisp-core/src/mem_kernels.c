@@ -0,0 +1,56 @@
+#include "mem_kernels.h"
+
+#include <stdatomic.h>
+
+#include "crisp/core/cpu.h"
+
+static bool crisp_mem_ct_equal_scalar(const uint8_t* lhs, const uint8_t* rhs, size_t size) {
+  uint8_t diff = 0U;
+  for (size_t i = 0U; i < size; ++i) {
+    diff = (uint8_t)(diff | (uint8_t)(lhs[i] ^ rhs[i]));
+  }
+  return diff == 0U;
+}
+
+static void crisp_mem_secure_zero_scalar(void* data, size_t size) {
+  volatile uint8_t* p = (volatile uint8_t*)data;
+  for (size_t i = 0U; i < size; ++i) {
+    p[i] = 0U;
+  }
+}
+
+const crisp_mem_kernels_t crisp_mem_kernels_scalar = {
+    .ct_equal = crisp_mem_ct_equal_scalar,
+    .secure_zero = crisp_mem_secure_zero_scalar,
+};
+
+static _Atomic(const crisp_mem_kernels_t*) g_crisp_mem_kernels = NULL;
+
+static const crisp_mem_kernels_t* crisp_mem_kernels_for_level(crisp_cpu_level_t level) {
+#if CRISP_MEM_KERNELS_HAVE_X86
+  if (level >= CRISP_CPU_LEVEL_AVX2) {
+    return &crisp_mem_kernels_avx2;
+  }
+  if (level >= CRISP_CPU_LEVEL_SSE42) {
+    return &crisp_mem_kernels_sse42;
+  }
+#else
+  (void)level;
+#endif
+  return &crisp_mem_kernels_scalar;
+}
+
+const crisp_mem_kernels_t* crisp_mem_kernels(void) {
+  const crisp_mem_kernels_t* kernels =
+      atomic_load_explicit(&g_crisp_mem_kernels, memory_order_acquire);
+  if (kernels == NULL) {
+    /* Racing first calls resolve the same table; the extra store is harmless. */
+    kernels = crisp_mem_kernels_for_level(crisp_cpu_active_level());
+    atomic_store_explicit(&g_crisp_mem_kernels, kernels, memory_order_release);
+  }
+  return kernels;
+}
+
+void crisp_mem_kernels_reset(void) {
+  atomic_store_explicit(&g_crisp_mem_kernels, NULL, memory_order_release);
+}
@@ -0,0 +1,57 @@
+#ifndef CRISP_CORE_SRC_MEM_KERNELS_H_
+#define CRISP_CORE_SRC_MEM_KERNELS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Constant-time compare and secure-zero helpers with per-CPU-level implementations.
+ * The table is resolved on first use from crisp_cpu_active_level() and cached.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRISP_MEM_KERNELS_HAVE_X86 1
+#else
+#define CRISP_MEM_KERNELS_HAVE_X86 0
+#endif
+
+typedef struct crisp_mem_kernels {
+  /** Compares without data-dependent branches or early exit. */
+  bool (*ct_equal)(const uint8_t* lhs, const uint8_t* rhs, size_t size);
+  /** Zeroes memory with stores the optimizer cannot elide. */
+  void (*secure_zero)(void* data, size_t size);
+} crisp_mem_kernels_t;
+
+extern const crisp_mem_kernels_t crisp_mem_kernels_scalar;
+#if CRISP_MEM_KERNELS_HAVE_X86
+extern const crisp_mem_kernels_t crisp_mem_kernels_sse42;
+extern const crisp_mem_kernels_t crisp_mem_kernels_avx2;
+#endif
+
+/** Returns the kernel table for the active CPU level. */
+const crisp_mem_kernels_t* crisp_mem_kernels(void);
+
+/** Drops the cached table so the next call re-resolves it (after a forced level change). */
+void crisp_mem_kernels_reset(void);
+
+static inline bool crisp_constant_time_equal(const uint8_t* lhs, const uint8_t* rhs, size_t size) {
+  return crisp_mem_kernels()->ct_equal(lhs, rhs, size);
+}
+
+static inline void crisp_secure_zero(void* data, size_t size) {
+  if (data == NULL || size == 0U) {
+    return;
+  }
+  crisp_mem_kernels()->secure_zero(data, size);
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_SRC_MEM_KERNELS_H_
@@ -0,0 +1,92 @@
+#include "mem_kernels.h"
+
+#if CRISP_MEM_KERNELS_HAVE_X86
+
+#include <immintrin.h>
+
+/*
+ * Vector variants of the helpers in mem_kernels.c. Compare accumulates XOR differences over the
+ * whole range before testing, so timing depends only on `size`. Zeroing uses plain vector stores
+ * followed by a compiler barrier that makes the buffer observable.
+ */
+
+static inline void crisp_mem_compiler_barrier(void* data) {
+  __asm__ __volatile__("" : : "r"(data) : "memory");
+}
+
+__attribute__((target("sse4.2"))) static bool crisp_mem_ct_equal_sse42(const uint8_t* lhs,
+                                                                       const uint8_t* rhs,
+                                                                       size_t size) {
+  __m128i acc = _mm_setzero_si128();
+  size_t i = 0U;
+  for (; i + 16U <= size; i += 16U) {
+    const __m128i a = _mm_loadu_si128((const __m128i*)(const void*)(lhs + i));
+    const __m128i b = _mm_loadu_si128((const __m128i*)(const void*)(rhs + i));
+    acc = _mm_or_si128(acc, _mm_xor_si128(a, b));
+  }
+  uint8_t diff = 0U;
+  for (; i < size; ++i) {
+    diff = (uint8_t)(diff | (uint8_t)(lhs[i] ^ rhs[i]));
+  }
+  return (_mm_testz_si128(acc, acc) & (diff == 0U)) != 0;
+}
+
+__attribute__((target("sse4.2"))) static void crisp_mem_secure_zero_sse42(void* data, size_t size) {
+  uint8_t* p = (uint8_t*)data;
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0U;
+  for (; i + 16U <= size; i += 16U) {
+    _mm_storeu_si128((__m128i*)(void*)(p + i), zero);
+  }
+  for (; i < size; ++i) {
+    p[i] = 0U;
+  }
+  crisp_mem_compiler_barrier(data);
+}
+
+__attribute__((target("avx2"))) static bool crisp_mem_ct_equal_avx2(const uint8_t* lhs,
+                                                                    const uint8_t* rhs,
+                                                                    size_t size) {
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0U;
+  for (; i + 32U <= size; i += 32U) {
+    const __m256i a = _mm256_loadu_si256((const __m256i*)(const void*)(lhs + i));
+    const __m256i b = _mm256_loadu_si256((const __m256i*)(const void*)(rhs + i));
+    acc = _mm256_or_si256(acc, _mm256_xor_si256(a, b));
+  }
+  uint8_t diff = 0U;
+  for (; i < size; ++i) {
+    diff = (uint8_t)(diff | (uint8_t)(lhs[i] ^ rhs[i]));
+  }
+  return (_mm256_testz_si256(acc, acc) & (diff == 0U)) != 0;
+}
+
+__attribute__((target("avx2"))) static void crisp_mem_secure_zero_avx2(void* data, size_t size) {
+  uint8_t* p = (uint8_t*)data;
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0U;
+  for (; i + 32U <= size; i += 32U) {
+    _mm256_storeu_si256((__m256i*)(void*)(p + i), zero);
+  }
+  for (; i < size; ++i) {
+    p[i] = 0U;
+  }
+  crisp_mem_compiler_barrier(data);
+}
+
+const crisp_mem_kernels_t crisp_mem_kernels_sse42 = {
+    .ct_equal = crisp_mem_ct_equal_sse42,
+    .secure_zero = crisp_mem_secure_zero_sse42,
+};
+
+const crisp_mem_kernels_t crisp_mem_kernels_avx2 = {
+    .ct_equal = crisp_mem_ct_equal_avx2,
+    .secure_zero = crisp_mem_secure_zero_avx2,
+};
+
+#else
+
+/* Keeps the translation unit non-empty on targets without x86 kernels (ISO C). */
+typedef int crisp_mem_kernels_x86_unused_t;
+
+#endif  // CRISP_MEM_KERNELS_HAVE_X86
@@ -3,6 +3,9 @@
 #include <limits.h>
 #include <string.h>
 
+#include "mem_kernels.h"
+#include "message_internal.h"
+
 enum {
   CRISP_INTERNAL_MAX_ICV_SIZE = 8,
 };
@@ -33,25 +36,13 @@ static void crisp_write_be48(uint64_t value, uint8_t* out) {
   }
 }
 
-static bool crisp_constant_time_equal(const uint8_t* lhs, const uint8_t* rhs, size_t size) {
-  uint8_t diff = 0U;
-  for (size_t i = 0U; i < size; ++i) {
-    diff = (uint8_t)(diff | (uint8_t)(lhs[i] ^ rhs[i]));
-  }
-  return diff == 0U;
-}
-
-static void crisp_secure_zero(void* data, size_t size) {
-  if (data == NULL || size == 0U) {
-    return;
-  }
-  volatile uint8_t* p = (volatile uint8_t*)data;
-  for (size_t i = 0U; i < size; ++i) {
-    p[i] = 0U;
-  }
-}
-
-static crisp_error_t crisp_decode_key_id(crisp_const_byte_span_t packet,
+/*
+ * Decodes the KeyId at `offset` of a packet of `packet_size` bytes whose leading bytes are
+ * `head`. Bounds are checked against the packet; a KeyId length byte beyond `head` is
+ * CRISP_ERR_INVALID_ARGUMENT (only possible for scattered packets).
+ */
+static crisp_error_t crisp_decode_key_id(crisp_const_byte_span_t head,
+                                         size_t packet_size,
                                          size_t offset,
                                          bool* out_key_id_present,
                                          crisp_const_byte_span_t* out_key_id,
@@ -59,11 +50,14 @@ static crisp_error_t crisp_decode_key_id(crisp_const_byte_span_t packet,
   if (out_key_id_present == NULL || out_key_id == NULL || out_key_id_size == NULL) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-  if (offset >= packet.size) {
+  if (offset >= packet_size) {
     return CRISP_ERR_INVALID_SIZE;
   }
+  if (offset >= head.size) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
 
-  const uint8_t first = packet.data[offset];
+  const uint8_t first = head.data[offset];
   if (first == CRISP_KEY_ID_UNUSED_MARKER) {
     *out_key_id_present = false;
     out_key_id->data = NULL;
@@ -74,7 +68,7 @@ static crisp_error_t crisp_decode_key_id(crisp_const_byte_span_t packet,
 
   if ((first & 0x80U) == 0U) {
     *out_key_id_present = true;
-    out_key_id->data = packet.data + offset;
+    out_key_id->data = head.data + offset;
     out_key_id->size = 1U;
     *out_key_id_size = 1U;
     return CRISP_OK;
@@ -90,12 +84,12 @@ static crisp_error_t crisp_decode_key_id(crisp_const_byte_span_t packet,
   if (err != CRISP_OK) {
     return err;
   }
-  if (end > packet.size) {
+  if (end > packet_size) {
     return CRISP_ERR_INVALID_SIZE;
   }
 
   *out_key_id_present = true;
-  out_key_id->data = packet.data + offset;
+  out_key_id->data = head.data + offset;
   out_key_id->size = total_len;
   *out_key_id_size = total_len;
   return CRISP_OK;
@@ -129,43 +123,51 @@ crisp_error_t crisp_validate_key_id(crisp_const_byte_span_t key_id) {
   return CRISP_OK;
 }
 
-crisp_error_t crisp_parse_message(crisp_const_byte_span_t packet, crisp_message_view_t* out_message) {
-  if (out_message == NULL) {
-    return CRISP_ERR_INVALID_ARGUMENT;
-  }
-  if (packet.data == NULL) {
-    return CRISP_ERR_INVALID_ARGUMENT;
-  }
-  if (packet.size > CRISP_MAX_MESSAGE_SIZE) {
+/*
+ * Header checks of crisp_parse_message() for a packet of `packet_size` bytes whose leading
+ * bytes are `head` (the whole packet when contiguous). Fills every field of `out_message` but
+ * the payload and ICV spans and returns the payload offset. A header that fits the packet but
+ * runs past `head` is CRISP_ERR_INVALID_ARGUMENT.
+ */
+static crisp_error_t crisp_parse_header(crisp_const_byte_span_t head,
+                                        size_t packet_size,
+                                        crisp_message_view_t* out_message,
+                                        crisp_suite_params_t* out_suite_params,
+                                        size_t* out_payload_offset) {
+  if (packet_size > CRISP_MAX_MESSAGE_SIZE) {
     return CRISP_ERR_INVALID_SIZE;
   }
 
   const size_t min_possible_size = CRISP_MESSAGE_HEADER_PREFIX_SIZE + 1U + CRISP_MESSAGE_SEQNUM_SIZE + 4U;
-  if (packet.size < min_possible_size) {
+  if (packet_size < min_possible_size) {
     return CRISP_ERR_INVALID_SIZE;
   }
+  if (head.size < CRISP_MESSAGE_HEADER_PREFIX_SIZE) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
 
   (void)memset(out_message, 0, sizeof(*out_message));
 
-  const uint16_t first16 = (uint16_t)(((uint16_t)packet.data[0] << 8U) | (uint16_t)packet.data[1]);
+  const uint16_t first16 = (uint16_t)(((uint16_t)head.data[0] << 8U) | (uint16_t)head.data[1]);
   const bool external_key_id_flag = (first16 & 0x8000U) != 0U;
   const uint16_t version = (uint16_t)(first16 & 0x7FFFU);
   if (version != CRISP_VERSION_2024) {
     return CRISP_ERR_INVALID_FORMAT;
   }
 
-  const uint8_t cs = packet.data[2];
-  crisp_suite_params_t suite_params;
-  crisp_error_t err = crisp_suite_get_params((crisp_suite_t)cs, &suite_params);
+  const uint8_t cs = head.data[2];
+  crisp_error_t err = crisp_suite_get_params((crisp_suite_t)cs, out_suite_params);
   if (err != CRISP_OK) {
     return err;
   }
+  const crisp_suite_params_t suite_params = *out_suite_params;
 
   const size_t key_id_offset = CRISP_MESSAGE_HEADER_PREFIX_SIZE;
   bool key_id_present = false;
   crisp_const_byte_span_t key_id = {0};
   size_t key_id_size = 0U;
-  err = crisp_decode_key_id(packet, key_id_offset, &key_id_present, &key_id, &key_id_size);
+  err = crisp_decode_key_id(head, packet_size, key_id_offset, &key_id_present, &key_id,
+                            &key_id_size);
   if (err != CRISP_OK) {
     return err;
   }
@@ -181,350 +183,1589 @@ crisp_error_t crisp_parse_message(crisp_const_byte_span_t packet, crisp_message_
   if (err != CRISP_OK) {
     return err;
   }
-  if (payload_offset > packet.size) {
+  if (payload_offset > packet_size) {
     return CRISP_ERR_INVALID_SIZE;
   }
 
-  size_t payload_plus_icv_size = packet.size - payload_offset;
+  size_t payload_plus_icv_size = packet_size - payload_offset;
   if (payload_plus_icv_size < suite_params.icv_size) {
     return CRISP_ERR_INVALID_SIZE;
   }
+  if (payload_offset > head.size) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
 
-  const uint64_t seqnum = crisp_read_be48(packet.data + seqnum_offset);
+  const uint64_t seqnum = crisp_read_be48(head.data + seqnum_offset);
   if (seqnum > CRISP_SEQNUM_MAX) {
     return CRISP_ERR_OUT_OF_RANGE;
   }
 
-  const size_t payload_size = payload_plus_icv_size - suite_params.icv_size;
-  const crisp_const_byte_span_t payload = {
-      .data = packet.data + payload_offset,
-      .size = payload_size,
-  };
-  const crisp_const_byte_span_t icv = {
-      .data = packet.data + payload_offset + payload_size,
-      .size = suite_params.icv_size,
-  };
-
   out_message->external_key_id_flag = external_key_id_flag;
   out_message->version = version;
   out_message->cs = cs;
   out_message->key_id_present = key_id_present;
   out_message->key_id = key_id;
   out_message->seqnum = seqnum;
-  out_message->payload = payload;
-  out_message->icv = icv;
+  *out_payload_offset = payload_offset;
   return CRISP_OK;
 }
 
-crisp_error_t crisp_build_message(const crisp_build_params_t* params,
-                                 crisp_mutable_byte_span_t out_packet,
-                                 size_t* out_size) {
-  if (params == NULL || out_size == NULL) {
-    return CRISP_ERR_INVALID_ARGUMENT;
-  }
-  if (out_packet.data == NULL) {
+/* crisp_parse_message() that also hands back the suite parameters it looked up. */
+static crisp_error_t crisp_parse_message_suite(crisp_const_byte_span_t packet,
+                                               crisp_message_view_t* out_message,
+                                               crisp_suite_params_t* out_suite_params) {
+  if (out_message == NULL) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-  if ((params->payload.size > 0U && params->payload.data == NULL) ||
-      (params->kenc.size > 0U && params->kenc.data == NULL) ||
-      (params->kmac.size > 0U && params->kmac.data == NULL)) {
+  if (packet.data == NULL) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-  if (params->version != CRISP_VERSION_2024) {
-    return CRISP_ERR_OUT_OF_RANGE;
-  }
-  if (params->seqnum > CRISP_SEQNUM_MAX) {
-    return CRISP_ERR_OUT_OF_RANGE;
-  }
 
-  crisp_suite_params_t suite_params;
-  crisp_error_t err = crisp_suite_get_params((crisp_suite_t)params->cs, &suite_params);
+  size_t payload_offset = 0U;
+  const crisp_error_t err =
+      crisp_parse_header(packet, packet.size, out_message, out_suite_params, &payload_offset);
   if (err != CRISP_OK) {
     return err;
   }
 
-  size_t encoded_key_id_size = 1U;
-  if (params->key_id_present) {
-    err = crisp_validate_key_id(params->key_id);
-    if (err != CRISP_OK) {
-      return err;
-    }
-    encoded_key_id_size = params->key_id.size;
-  } else if (params->key_id.size != 0U) {
+  const size_t icv_size = out_suite_params->icv_size;
+  const size_t payload_size = packet.size - payload_offset - icv_size;
+  out_message->payload.data = packet.data + payload_offset;
+  out_message->payload.size = payload_size;
+  out_message->icv.data = packet.data + payload_offset + payload_size;
+  out_message->icv.size = icv_size;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_parse_message(crisp_const_byte_span_t packet, crisp_message_view_t* out_message) {
+  crisp_suite_params_t suite_params;
+  return crisp_parse_message_suite(packet, out_message, &suite_params);
+}
+
+crisp_error_t crisp_unprotect_parse(crisp_const_byte_span_t packet,
+                                    crisp_parsed_message_t* out_message) {
+  if (out_message == NULL) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
+  out_message->packet = packet;
+  return crisp_parse_message_suite(packet, &out_message->view, &out_message->suite_params);
+}
 
-  if (params->crypto == NULL || params->crypto->magma_cmac == NULL) {
+crisp_error_t crisp_parse_with_header(crisp_const_byte_span_t packet,
+                                      const uint8_t* header,
+                                      size_t header_size,
+                                      const crisp_suite_params_t* suite_params,
+                                      crisp_message_view_t* out_message) {
+  if (packet.data == NULL) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-  if (suite_params.encryption_enabled && params->payload.size > 0U &&
-      params->crypto->magma_ctr_xcrypt == NULL) {
+  if (packet.size > CRISP_MAX_MESSAGE_SIZE) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  const size_t payload_offset = header_size + CRISP_MESSAGE_SEQNUM_SIZE;
+  if (packet.size < payload_offset + suite_params->icv_size) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  if (memcmp(packet.data, header, header_size) != 0) {
+    return CRISP_ERR_INVALID_FORMAT;
+  }
+
+  const size_t payload_size = packet.size - payload_offset - suite_params->icv_size;
+  const bool key_id_present =
+      header[CRISP_MESSAGE_HEADER_PREFIX_SIZE] != CRISP_KEY_ID_UNUSED_MARKER;
+  (void)memset(out_message, 0, sizeof(*out_message));
+  out_message->external_key_id_flag = (header[0] & 0x80U) != 0U;
+  out_message->version = CRISP_VERSION_2024;
+  out_message->cs = header[2];
+  out_message->key_id_present = key_id_present;
+  if (key_id_present) {
+    out_message->key_id.data = packet.data + CRISP_MESSAGE_HEADER_PREFIX_SIZE;
+    out_message->key_id.size = header_size - CRISP_MESSAGE_HEADER_PREFIX_SIZE;
+  }
+  out_message->seqnum = crisp_read_be48(packet.data + header_size);
+  out_message->payload.data = packet.data + payload_offset;
+  out_message->payload.size = payload_size;
+  out_message->icv.data = packet.data + payload_offset + payload_size;
+  out_message->icv.size = suite_params->icv_size;
+  return CRISP_OK;
+}
+
+/*
+ * Sums the sizes of `count` segments. A NULL array or a NULL segment of non-zero size is
+ * CRISP_ERR_INVALID_ARGUMENT; a total above CRISP_MAX_MESSAGE_SIZE is CRISP_ERR_INVALID_SIZE.
+ */
+static crisp_error_t crisp_iov_size(const crisp_const_byte_span_t* iov,
+                                    size_t count,
+                                    size_t* out_size) {
+  if (count > 0U && iov == NULL) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
+  size_t total = 0U;
+  for (size_t i = 0U; i < count; ++i) {
+    if (iov[i].size > 0U && iov[i].data == NULL) {
+      return CRISP_ERR_INVALID_ARGUMENT;
+    }
+    if (iov[i].size > CRISP_MAX_MESSAGE_SIZE - total) {
+      return CRISP_ERR_INVALID_SIZE;
+    }
+    total += iov[i].size;
+  }
+  *out_size = total;
+  return CRISP_OK;
+}
 
-  size_t total_size = CRISP_MESSAGE_HEADER_PREFIX_SIZE;
-  err = crisp_checked_add_size(total_size, encoded_key_id_size, &total_size);
-  if (err != CRISP_OK) {
-    return err;
+/* Copies `size` bytes from `offset` bytes into the concatenated segments to `out`. */
+static void crisp_iov_gather(const crisp_const_byte_span_t* iov,
+                             size_t count,
+                             size_t offset,
+                             uint8_t* out,
+                             size_t size) {
+  for (size_t i = 0U; i < count && size > 0U; ++i) {
+    if (offset >= iov[i].size) {
+      offset -= iov[i].size;
+      continue;
+    }
+    const size_t available = iov[i].size - offset;
+    const size_t take = available < size ? available : size;
+    (void)memcpy(out, iov[i].data + offset, take);
+    out += take;
+    size -= take;
+    offset = 0U;
   }
-  err = crisp_checked_add_size(total_size, CRISP_MESSAGE_SEQNUM_SIZE, &total_size);
+}
+
+crisp_error_t crisp_parse_iov(const crisp_const_byte_span_t* packet_iov,
+                              size_t count,
+                              crisp_message_view_t* out_message,
+                              crisp_suite_params_t* out_suite_params,
+                              size_t* out_packet_size) {
+  if (count == 0U || out_message == NULL || out_suite_params == NULL ||
+      out_packet_size == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  size_t packet_size = 0U;
+  crisp_error_t err = crisp_iov_size(packet_iov, count, &packet_size);
   if (err != CRISP_OK) {
     return err;
   }
-  err = crisp_checked_add_size(total_size, params->payload.size, &total_size);
+
+  size_t payload_offset = 0U;
+  err = crisp_parse_header(packet_iov[0], packet_size, out_message, out_suite_params,
+                           &payload_offset);
   if (err != CRISP_OK) {
     return err;
   }
-  err = crisp_checked_add_size(total_size, suite_params.icv_size, &total_size);
+  out_message->payload.size = packet_size - payload_offset - out_suite_params->icv_size;
+  out_message->icv.size = out_suite_params->icv_size;
+  *out_packet_size = packet_size;
+  return CRISP_OK;
+}
+
+/**
+ * Selects the key material for one operation: prepared keys when provided, otherwise a
+ * raw-key binding of the loose kenc/kmac/crypto parameters (no contexts, nothing to release).
+ */
+static crisp_crypto_keys_t crisp_select_keys(const crisp_crypto_keys_t* prepared,
+                                             crisp_const_byte_span_t kenc,
+                                             crisp_const_byte_span_t kmac,
+                                             const crisp_crypto_iface_t* crypto) {
+  if (prepared != NULL) {
+    return *prepared;
+  }
+  const crisp_crypto_keys_t keys = {
+      .crypto = crypto,
+      .kenc = kenc,
+      .kmac = kmac,
+      .kenc_ctx = NULL,
+      .kmac_ctx = NULL,
+  };
+  return keys;
+}
+
+bool crisp_keys_can_cmac(const crisp_crypto_keys_t* keys) {
+  return keys->crypto != NULL &&
+         ((keys->kmac_ctx != NULL && keys->crypto->magma_cmac_keyed != NULL) ||
+          keys->crypto->magma_cmac != NULL);
+}
+
+static bool crisp_keys_can_ctr(const crisp_crypto_keys_t* keys) {
+  return keys->crypto != NULL &&
+         ((keys->kenc_ctx != NULL && keys->crypto->magma_ctr_xcrypt_keyed != NULL) ||
+          keys->crypto->magma_ctr_xcrypt != NULL);
+}
+
+crisp_error_t crisp_encode_header(bool external_key_id_flag,
+                                  uint16_t version,
+                                  uint8_t cs,
+                                  bool key_id_present,
+                                  crisp_const_byte_span_t key_id,
+                                  crisp_suite_params_t* out_suite_params,
+                                  uint8_t* out_header,
+                                  size_t* out_header_size) {
+  crisp_error_t err = crisp_suite_get_params((crisp_suite_t)cs, out_suite_params);
   if (err != CRISP_OK) {
     return err;
   }
 
-  if (total_size > CRISP_MAX_MESSAGE_SIZE) {
-    return CRISP_ERR_INVALID_SIZE;
-  }
-  if (out_packet.size < total_size) {
-    return CRISP_ERR_BUFFER_TOO_SMALL;
+  if (key_id_present) {
+    err = crisp_validate_key_id(key_id);
+    if (err != CRISP_OK) {
+      return err;
+    }
+  } else if (key_id.size != 0U) {
+    return CRISP_ERR_INVALID_ARGUMENT;
   }
 
-  const uint16_t first16 = (uint16_t)((params->external_key_id_flag ? 0x8000U : 0x0000U) |
-                                      (params->version & 0x7FFFU));
-  out_packet.data[0] = (uint8_t)(first16 >> 8U);
-  out_packet.data[1] = (uint8_t)(first16 & 0xFFU);
-  out_packet.data[2] = params->cs;
+  const uint16_t first16 =
+      (uint16_t)((external_key_id_flag ? 0x8000U : 0x0000U) | (version & 0x7FFFU));
+  out_header[0] = (uint8_t)(first16 >> 8U);
+  out_header[1] = (uint8_t)(first16 & 0xFFU);
+  out_header[2] = cs;
 
   size_t offset = CRISP_MESSAGE_HEADER_PREFIX_SIZE;
-  if (params->key_id_present) {
-    (void)memcpy(out_packet.data + offset, params->key_id.data, params->key_id.size);
-    offset += params->key_id.size;
+  if (key_id_present) {
+    (void)memcpy(out_header + offset, key_id.data, key_id.size);
+    offset += key_id.size;
   } else {
-    out_packet.data[offset] = CRISP_KEY_ID_UNUSED_MARKER;
+    out_header[offset] = CRISP_KEY_ID_UNUSED_MARKER;
     offset += 1U;
   }
 
-  crisp_write_be48(params->seqnum, out_packet.data + offset);
-  offset += CRISP_MESSAGE_SEQNUM_SIZE;
-
-  const size_t payload_offset = offset;
-  if (params->payload.size > 0U) {
-    crisp_mutable_byte_span_t payload_out = {
-        .data = out_packet.data + payload_offset,
-        .size = params->payload.size,
-    };
-
-    if (suite_params.encryption_enabled) {
-      const uint32_t iv32 = (uint32_t)(params->seqnum & 0xFFFFFFFFU);
-      err = params->crypto->magma_ctr_xcrypt(params->crypto->user_ctx, params->kenc, iv32,
-                                             params->payload, payload_out);
-      if (err != CRISP_OK) {
-        return err;
-      }
-    } else {
-      (void)memcpy(payload_out.data, params->payload.data, params->payload.size);
-    }
-  }
-
-  const size_t icv_offset = payload_offset + params->payload.size;
-  const crisp_const_byte_span_t cmac_input = {
-      .data = out_packet.data,
-      .size = icv_offset,
-  };
-  crisp_mutable_byte_span_t icv_out = {
-      .data = out_packet.data + icv_offset,
-      .size = suite_params.icv_size,
-  };
+  *out_header_size = offset;
+  return CRISP_OK;
+}
 
-  err = params->crypto->magma_cmac(params->crypto->user_ctx, params->kmac, cmac_input, icv_out);
+/**
+ * Validates session-level build parameters and pre-encodes the constant header
+ * (ExternalKeyIdFlag|Version, CS, KeyId) so per-packet work only touches SeqNum/Payload/ICV.
+ */
+static crisp_error_t crisp_tx_template_init(bool external_key_id_flag,
+                                            uint16_t version,
+                                            uint8_t cs,
+                                            bool key_id_present,
+                                            crisp_const_byte_span_t key_id,
+                                            const crisp_crypto_keys_t* keys,
+                                            crisp_tx_template_t* out_template) {
+  const crisp_error_t err =
+      crisp_encode_header(external_key_id_flag, version, cs, key_id_present, key_id,
+                          &out_template->suite_params, out_template->header,
+                          &out_template->header_size);
   if (err != CRISP_OK) {
     return err;
   }
 
-  *out_size = total_size;
+  if (!crisp_keys_can_cmac(keys)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  out_template->keys = *keys;
+  out_template->cmac_prefix = NULL;
+  out_template->keystream_pool = NULL;
   return CRISP_OK;
 }
 
-crisp_error_t crisp_protect(const crisp_protect_params_t* params,
-                            crisp_mutable_byte_span_t out_packet,
-                            size_t* out_size) {
-  if (params == NULL) {
+crisp_error_t crisp_session_cmac_prefix_init(crisp_cmac_prefix_t* out_prefix,
+                                             const crisp_crypto_keys_t* keys,
+                                             bool external_key_id_flag,
+                                             uint8_t cs,
+                                             bool key_id_present,
+                                             crisp_const_byte_span_t key_id) {
+  if (out_prefix == NULL || keys == NULL || (key_id.size > 0U && key_id.data == NULL)) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
 
-  const crisp_build_params_t build_params = {
-      .external_key_id_flag = params->external_key_id_flag,
-      .version = CRISP_VERSION_2024,
-      .cs = params->cs,
-      .key_id_present = params->key_id_present,
-      .seqnum = params->seqnum,
-      .key_id = params->key_id,
-      .payload = params->payload,
-      .kenc = params->kenc,
-      .kmac = params->kmac,
-      .crypto = params->crypto,
+  crisp_suite_params_t suite_params;
+  uint8_t header[CRISP_MESSAGE_HEADER_PREFIX_SIZE + CRISP_MAX_KEY_ID_SIZE];
+  size_t header_size = 0U;
+  const crisp_error_t err =
+      crisp_encode_header(external_key_id_flag, CRISP_VERSION_2024, cs, key_id_present, key_id,
+                          &suite_params, header, &header_size);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  const crisp_const_byte_span_t constant_bytes = {
+      .data = header,
+      .size = header_size,
   };
-  return crisp_build_message(&build_params, out_packet, out_size);
+  return crisp_cmac_prefix_init(out_prefix, keys, constant_bytes);
 }
 
-crisp_error_t crisp_unprotect(const crisp_unprotect_params_t* params,
-                              crisp_mutable_byte_span_t out_plaintext,
-                              crisp_unprotect_result_t* out_result) {
-  if (params == NULL || out_result == NULL) {
+/** Per-packet regions produced by crisp_tx_prepare(); crypto is applied afterwards. */
+typedef struct crisp_tx_layout {
+  size_t payload_offset;
+  crisp_mutable_byte_span_t payload_out;
+  crisp_const_byte_span_t cmac_input;
+  crisp_mutable_byte_span_t icv_out;
+  size_t total_size;
+} crisp_tx_layout_t;
+
+/**
+ * Validates one packet against a TX template and writes header and SeqNum.
+ * For NULL-encryption suites the payload is copied as well; CTR and CMAC are left to the caller.
+ */
+static crisp_error_t crisp_tx_prepare(const crisp_tx_template_t* tx,
+                                      uint64_t seqnum,
+                                      crisp_const_byte_span_t payload,
+                                      crisp_mutable_byte_span_t out_packet,
+                                      crisp_tx_layout_t* out_layout) {
+  if (out_packet.data == NULL || (payload.size > 0U && payload.data == NULL)) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-  if (params->packet.data == NULL) {
-    return CRISP_ERR_INVALID_ARGUMENT;
+  if (seqnum > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
   }
-  if ((params->kenc.size > 0U && params->kenc.data == NULL) ||
-      (params->kmac.size > 0U && params->kmac.data == NULL)) {
+  if (tx->suite_params.encryption_enabled && payload.size > 0U && !crisp_keys_can_ctr(&tx->keys)) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-  if (out_plaintext.size > 0U && out_plaintext.data == NULL) {
-    return CRISP_ERR_INVALID_ARGUMENT;
+
+  /* header_size + seqnum + icv is bounded by 3 + 128 + 6 + 8, so only the payload can overflow. */
+  const size_t overhead =
+      tx->header_size + CRISP_MESSAGE_SEQNUM_SIZE + tx->suite_params.icv_size;
+  if (payload.size > CRISP_MAX_MESSAGE_SIZE - overhead) {
+    return CRISP_ERR_INVALID_SIZE;
   }
-  if (params->crypto == NULL || params->crypto->magma_cmac == NULL) {
-    return CRISP_ERR_INVALID_ARGUMENT;
+  const size_t total_size = overhead + payload.size;
+  if (out_packet.size < total_size) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
   }
 
-  crisp_message_view_t view;
-  crisp_error_t err = crisp_parse_message(params->packet, &view);
+  (void)memcpy(out_packet.data, tx->header, tx->header_size);
+  const size_t payload_offset = tx->header_size + CRISP_MESSAGE_SEQNUM_SIZE;
+  crisp_write_be48(seqnum, out_packet.data + tx->header_size);
+
+  /* In-place emit hands in the payload already at its final position. */
+  if (payload.size > 0U && !tx->suite_params.encryption_enabled &&
+      payload.data != out_packet.data + payload_offset) {
+    (void)memcpy(out_packet.data + payload_offset, payload.data, payload.size);
+  }
+
+  const size_t icv_offset = payload_offset + payload.size;
+  out_layout->payload_offset = payload_offset;
+  out_layout->payload_out.data = out_packet.data + payload_offset;
+  out_layout->payload_out.size = payload.size;
+  out_layout->cmac_input.data = out_packet.data;
+  out_layout->cmac_input.size = icv_offset;
+  out_layout->icv_out.data = out_packet.data + icv_offset;
+  out_layout->icv_out.size = tx->suite_params.icv_size;
+  out_layout->total_size = total_size;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_tx_emit(const crisp_tx_template_t* tx,
+                            uint64_t seqnum,
+                            crisp_const_byte_span_t payload,
+                            crisp_mutable_byte_span_t out_packet,
+                            size_t* out_size) {
+  crisp_tx_layout_t layout;
+  crisp_error_t err = crisp_tx_prepare(tx, seqnum, payload, out_packet, &layout);
   if (err != CRISP_OK) {
     return err;
   }
 
-  crisp_suite_params_t suite_params;
-  err = crisp_suite_get_params((crisp_suite_t)view.cs, &suite_params);
+  if (tx->suite_params.encryption_enabled && payload.size > 0U &&
+      crisp_keystream_pool_xcrypt(tx->keystream_pool, &tx->keys, seqnum, payload,
+                                  layout.payload_out)) {
+    /* Precomputed keystream: CTR was a XOR, only the ICV is left. */
+    err = crisp_crypto_cmac_prefixed(&tx->keys, tx->cmac_prefix, layout.cmac_input,
+                                     layout.icv_out);
+  } else if (tx->suite_params.encryption_enabled && payload.size > 0U) {
+    /* One pass over the payload when the backend has a fused op, two otherwise. */
+    const uint32_t iv32 = (uint32_t)(seqnum & 0xFFFFFFFFU);
+    crisp_mutable_byte_span_t auth = {
+        .data = out_packet.data,
+        .size = layout.cmac_input.size,
+    };
+    err = crisp_crypto_ctr_then_cmac(&tx->keys, tx->cmac_prefix, iv32, payload, auth,
+                                     layout.payload_offset, layout.icv_out);
+  } else {
+    err = crisp_crypto_cmac_prefixed(&tx->keys, tx->cmac_prefix, layout.cmac_input,
+                                     layout.icv_out);
+  }
   if (err != CRISP_OK) {
     return err;
   }
-  if (view.icv.size != suite_params.icv_size) {
-    return CRISP_ERR_INVALID_FORMAT;
-  }
 
-  if (suite_params.icv_size > (size_t)CRISP_INTERNAL_MAX_ICV_SIZE) {
-    return CRISP_ERR_OUT_OF_RANGE;
+  *out_size = layout.total_size;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_tx_emit_in_place(const crisp_tx_template_t* tx,
+                                     uint64_t seqnum,
+                                     crisp_mutable_byte_span_t buffer,
+                                     size_t payload_offset,
+                                     size_t payload_size,
+                                     crisp_mutable_byte_span_t* out_packet) {
+  if (out_packet == NULL || buffer.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (payload_offset > buffer.size || payload_size > buffer.size - payload_offset) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const size_t headroom = tx->header_size + CRISP_MESSAGE_SEQNUM_SIZE;
+  if (payload_offset < headroom) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
   }
 
-  const size_t cmac_input_size = params->packet.size - view.icv.size;
-  const crisp_const_byte_span_t cmac_input = {
-      .data = params->packet.data,
-      .size = cmac_input_size,
+  /* The packet starts `headroom` bytes before the payload; crisp_tx_prepare() checks tailroom. */
+  const size_t packet_offset = payload_offset - headroom;
+  const crisp_const_byte_span_t payload = {
+      .data = buffer.data + payload_offset,
+      .size = payload_size,
   };
-  uint8_t expected_icv_storage[CRISP_INTERNAL_MAX_ICV_SIZE] = {0};
-  crisp_mutable_byte_span_t expected_icv_out = {
-      .data = expected_icv_storage,
-      .size = view.icv.size,
+  const crisp_mutable_byte_span_t packet = {
+      .data = buffer.data + packet_offset,
+      .size = buffer.size - packet_offset,
   };
-
-  err = params->crypto->magma_cmac(params->crypto->user_ctx, params->kmac, cmac_input, expected_icv_out);
+  size_t packet_size = 0U;
+  const crisp_error_t err = crisp_tx_emit(tx, seqnum, payload, packet, &packet_size);
   if (err != CRISP_OK) {
-    crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
     return err;
   }
-  if (!crisp_constant_time_equal(expected_icv_storage, view.icv.data, view.icv.size)) {
-    crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
-    return CRISP_ERR_CRYPTO;
-  }
+  out_packet->data = packet.data;
+  out_packet->size = packet_size;
+  return CRISP_OK;
+}
 
-  if (out_plaintext.size < view.payload.size) {
-    crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
-    return CRISP_ERR_BUFFER_TOO_SMALL;
-  }
-  if (view.payload.size > 0U && out_plaintext.data == NULL) {
-    crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
+crisp_error_t crisp_tx_emit_iov(const crisp_tx_template_t* tx,
+                                uint64_t seqnum,
+                                const crisp_const_byte_span_t* payload_iov,
+                                size_t payload_iovcnt,
+                                crisp_mutable_byte_span_t out_packet,
+                                size_t* out_size) {
+  if (out_packet.data == NULL || out_size == NULL) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-  if (suite_params.encryption_enabled && view.payload.size > 0U &&
-      params->crypto->magma_ctr_xcrypt == NULL) {
-    crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
-    return CRISP_ERR_INVALID_ARGUMENT;
+  size_t payload_size = 0U;
+  const crisp_error_t err = crisp_iov_size(payload_iov, payload_iovcnt, &payload_size);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  const size_t payload_offset = tx->header_size + CRISP_MESSAGE_SEQNUM_SIZE;
+  const size_t overhead = payload_offset + tx->suite_params.icv_size;
+  if (payload_size > CRISP_MAX_MESSAGE_SIZE - overhead) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  if (out_packet.size < overhead + payload_size) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
   }
 
-  if (params->replay_window != NULL) {
-    bool accepted = false;
-    err = crisp_replay_window_check_and_update(params->replay_window, view.seqnum, &accepted);
-    if (err != CRISP_OK) {
-      crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
-      return err;
-    }
-    if (!accepted) {
-      crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
-      return CRISP_ERR_REPLAY;
+  /*
+   * The packet itself is contiguous, so the segments are gathered straight into their final
+   * position and protected in place: one copy, and the fused CTR+CMAC pass still applies.
+   */
+  crisp_iov_gather(payload_iov, payload_iovcnt, 0U, out_packet.data + payload_offset,
+                   payload_size);
+  const crisp_const_byte_span_t payload = {
+      .data = out_packet.data + payload_offset,
+      .size = payload_size,
+  };
+  return crisp_tx_emit(tx, seqnum, payload, out_packet, out_size);
+}
+
+/**
+ * Processes one chunk (<= CRISP_PROTECT_BATCH_CHUNK packets) of crisp_protect_batch().
+ * Crypto is issued as one CTR and one CMAC batch call so multi-buffer backends see every
+ * packet of the chunk at once.
+ */
+static void crisp_protect_batch_chunk(const crisp_tx_template_t* tx,
+                                      const uint64_t* seqnums,
+                                      const crisp_const_byte_span_t* payloads,
+                                      const crisp_mutable_byte_span_t* out_packets,
+                                      size_t* out_sizes,
+                                      crisp_error_t* out_status,
+                                      size_t count) {
+  crisp_tx_layout_t layouts[CRISP_PROTECT_BATCH_CHUNK];
+  crisp_magma_ctr_job_t ctr_jobs[CRISP_PROTECT_BATCH_CHUNK];
+  crisp_magma_cmac_job_t cmac_jobs[CRISP_PROTECT_BATCH_CHUNK];
+  size_t job_packet[CRISP_PROTECT_BATCH_CHUNK];
+  size_t job_count = 0U;
+
+  /* Stage 1: headers, SeqNum and NULL-suite payload copies. */
+  for (size_t i = 0U; i < count; ++i) {
+    out_sizes[i] = 0U;
+    out_status[i] = crisp_tx_prepare(tx, seqnums[i], payloads[i], out_packets[i], &layouts[i]);
+    if (out_status[i] == CRISP_OK && tx->suite_params.encryption_enabled &&
+        payloads[i].size > 0U) {
+      ctr_jobs[job_count].iv32 = (uint32_t)(seqnums[i] & 0xFFFFFFFFU);
+      ctr_jobs[job_count].in = payloads[i];
+      ctr_jobs[job_count].out = layouts[i].payload_out;
+      job_packet[job_count++] = i;
     }
   }
 
-  crisp_mutable_byte_span_t plaintext_out = {
-      .data = out_plaintext.data,
-      .size = view.payload.size,
-  };
+  /* Stage 2: encrypt payloads. */
+  crisp_error_t err = crisp_crypto_ctr_xcrypt_batch(&tx->keys, ctr_jobs, job_count);
+  if (err != CRISP_OK) {
+    for (size_t k = 0U; k < job_count; ++k) {
+      out_status[job_packet[k]] = err;
+    }
+  }
 
-  if (view.payload.size > 0U) {
-    if (suite_params.encryption_enabled) {
-      const uint32_t iv32 = (uint32_t)(view.seqnum & 0xFFFFFFFFU);
-      err = params->crypto->magma_ctr_xcrypt(params->crypto->user_ctx, params->kenc, iv32, view.payload,
-                                             plaintext_out);
-      if (err != CRISP_OK) {
-        crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
-        return err;
-      }
-    } else {
-      (void)memcpy(plaintext_out.data, view.payload.data, view.payload.size);
+  /* Stage 3: ICVs over the finished packets. */
+  job_count = 0U;
+  for (size_t i = 0U; i < count; ++i) {
+    if (out_status[i] == CRISP_OK) {
+      cmac_jobs[job_count].data = layouts[i].cmac_input;
+      cmac_jobs[job_count].out_icv = layouts[i].icv_out;
+      job_packet[job_count++] = i;
+    }
+  }
+  err = crisp_crypto_cmac_batch(&tx->keys, cmac_jobs, job_count);
+  for (size_t k = 0U; k < job_count; ++k) {
+    const size_t i = job_packet[k];
+    out_status[i] = err;
+    if (err == CRISP_OK) {
+      out_sizes[i] = layouts[i].total_size;
     }
   }
+}
 
-  (void)memset(out_result, 0, sizeof(*out_result));
-  out_result->external_key_id_flag = view.external_key_id_flag;
-  out_result->version = view.version;
-  out_result->cs = view.cs;
-  out_result->key_id_present = view.key_id_present;
-  out_result->key_id = view.key_id;
-  out_result->seqnum = view.seqnum;
-  out_result->plaintext = plaintext_out;
-  crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
-  return CRISP_OK;
+void crisp_tx_emit_batch(const crisp_tx_template_t* tx,
+                         const uint64_t* seqnums,
+                         const crisp_const_byte_span_t* payloads,
+                         const crisp_mutable_byte_span_t* out_packets,
+                         size_t* out_sizes,
+                         crisp_error_t* out_status,
+                         size_t count) {
+  for (size_t offset = 0U; offset < count; offset += CRISP_PROTECT_BATCH_CHUNK) {
+    const size_t remaining = count - offset;
+    const size_t chunk =
+        remaining < CRISP_PROTECT_BATCH_CHUNK ? remaining : CRISP_PROTECT_BATCH_CHUNK;
+    crisp_protect_batch_chunk(tx, seqnums + offset, payloads + offset, out_packets + offset,
+                              out_sizes + offset, out_status + offset, chunk);
+  }
 }
 
-crisp_error_t crisp_unprotect_resolve(crisp_const_byte_span_t packet,
-                                      const crisp_key_resolver_t* resolver,
-                                      const crisp_crypto_iface_t* crypto,
-                                      crisp_replay_window_t* replay_window,
-                                      crisp_mutable_byte_span_t out_plaintext,
-                                      crisp_unprotect_result_t* out_result) {
-  if (resolver == NULL || resolver->resolve_keys == NULL || crypto == NULL || out_result == NULL) {
+/* Validates the per-call build parameters except the payload and prepares a TX template. */
+static crisp_error_t crisp_build_template(const crisp_build_params_t* params,
+                                          crisp_tx_template_t* out_tx) {
+  if ((params->kenc.size > 0U && params->kenc.data == NULL) ||
+      (params->kmac.size > 0U && params->kmac.data == NULL)) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-
-  crisp_message_view_t view;
-  crisp_error_t err = crisp_parse_message(packet, &view);
-  if (err != CRISP_OK) {
-    return err;
+  if (params->version != CRISP_VERSION_2024) {
+    return CRISP_ERR_OUT_OF_RANGE;
   }
-  if (!view.key_id_present && !resolver->allow_key_id_unused) {
-    return CRISP_ERR_INVALID_FORMAT;
+  if (params->seqnum > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
   }
 
-  const crisp_key_resolve_request_t req = {
-      .external_key_id_flag = view.external_key_id_flag,
-      .cs = view.cs,
-      .key_id_present = view.key_id_present,
-      .key_id = view.key_id,
-      .seqnum = view.seqnum,
-  };
-  crisp_const_byte_span_t kenc = {0};
-  crisp_const_byte_span_t kmac = {0};
-  err = resolver->resolve_keys(resolver->user_ctx, &req, &kenc, &kmac);
+  const crisp_crypto_keys_t keys =
+      crisp_select_keys(params->keys, params->kenc, params->kmac, params->crypto);
+  const crisp_error_t err =
+      crisp_tx_template_init(params->external_key_id_flag, params->version, params->cs,
+                             params->key_id_present, params->key_id, &keys, out_tx);
   if (err != CRISP_OK) {
     return err;
   }
-  if ((kenc.size > 0U && kenc.data == NULL) || (kmac.size > 0U && kmac.data == NULL)) {
-    return CRISP_ERR_INVALID_ARGUMENT;
-  }
+  out_tx->cmac_prefix = params->cmac_prefix;
+  out_tx->keystream_pool = params->keystream_pool;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_build_message(const crisp_build_params_t* params,
+                                 crisp_mutable_byte_span_t out_packet,
+                                 size_t* out_size) {
+  if (params == NULL || out_size == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (out_packet.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (params->payload.size > 0U && params->payload.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_tx_template_t tx;
+  const crisp_error_t err = crisp_build_template(params, &tx);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_tx_emit(&tx, params->seqnum, params->payload, out_packet, out_size);
+}
+
+static crisp_build_params_t crisp_protect_build_params(const crisp_protect_params_t* params) {
+  const crisp_build_params_t build_params = {
+      .external_key_id_flag = params->external_key_id_flag,
+      .version = CRISP_VERSION_2024,
+      .cs = params->cs,
+      .key_id_present = params->key_id_present,
+      .seqnum = params->seqnum,
+      .key_id = params->key_id,
+      .payload = params->payload,
+      .kenc = params->kenc,
+      .kmac = params->kmac,
+      .crypto = params->crypto,
+      .keys = params->keys,
+      .cmac_prefix = params->cmac_prefix,
+      .keystream_pool = params->keystream_pool,
+  };
+  return build_params;
+}
+
+crisp_error_t crisp_protect(const crisp_protect_params_t* params,
+                            crisp_mutable_byte_span_t out_packet,
+                            size_t* out_size) {
+  if (params == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_build_params_t build_params = crisp_protect_build_params(params);
+  return crisp_build_message(&build_params, out_packet, out_size);
+}
+
+crisp_error_t crisp_protect_in_place(const crisp_protect_params_t* params,
+                                     crisp_mutable_byte_span_t buffer,
+                                     size_t payload_offset,
+                                     size_t payload_size,
+                                     crisp_mutable_byte_span_t* out_packet) {
+  if (params == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_build_params_t build_params = crisp_protect_build_params(params);
+  crisp_tx_template_t tx;
+  const crisp_error_t err = crisp_build_template(&build_params, &tx);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_tx_emit_in_place(&tx, params->seqnum, buffer, payload_offset, payload_size,
+                                out_packet);
+}
+
+crisp_error_t crisp_protect_iov(const crisp_protect_params_t* params,
+                                const crisp_const_byte_span_t* payload_iov,
+                                size_t payload_iovcnt,
+                                crisp_mutable_byte_span_t out_packet,
+                                size_t* out_size) {
+  if (params == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const crisp_build_params_t build_params = crisp_protect_build_params(params);
+  crisp_tx_template_t tx;
+  const crisp_error_t err = crisp_build_template(&build_params, &tx);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_tx_emit_iov(&tx, params->seqnum, payload_iov, payload_iovcnt, out_packet,
+                           out_size);
+}
+
+crisp_error_t crisp_protect_batch(const crisp_protect_batch_params_t* params,
+                                  const uint64_t* seqnums,
+                                  const crisp_const_byte_span_t* payloads,
+                                  const crisp_mutable_byte_span_t* out_packets,
+                                  size_t* out_sizes,
+                                  crisp_error_t* out_status,
+                                  size_t count) {
+  if (params == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (count > 0U && (seqnums == NULL || payloads == NULL || out_packets == NULL ||
+                     out_sizes == NULL || out_status == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if ((params->kenc.size > 0U && params->kenc.data == NULL) ||
+      (params->kmac.size > 0U && params->kmac.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  const crisp_crypto_keys_t keys =
+      crisp_select_keys(params->keys, params->kenc, params->kmac, params->crypto);
+  crisp_tx_template_t tx;
+  const crisp_error_t err =
+      crisp_tx_template_init(params->external_key_id_flag, CRISP_VERSION_2024, params->cs,
+                             params->key_id_present, params->key_id, &keys, &tx);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_tx_emit_batch(&tx, seqnums, payloads, out_packets, out_sizes, out_status, count);
+  return CRISP_OK;
+}
+
+/** Recomputes CMAC over everything except the ICV and compares it in constant time. */
+static crisp_error_t crisp_rx_verify_icv(const crisp_crypto_keys_t* keys,
+                                         const crisp_cmac_prefix_t* cmac_prefix,
+                                         crisp_const_byte_span_t packet,
+                                         const crisp_message_view_t* view) {
+  if (view->icv.size > (size_t)CRISP_INTERNAL_MAX_ICV_SIZE) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+
+  const crisp_const_byte_span_t cmac_input = {
+      .data = packet.data,
+      .size = packet.size - view->icv.size,
+  };
+  uint8_t expected_icv_storage[CRISP_INTERNAL_MAX_ICV_SIZE] = {0};
+  crisp_mutable_byte_span_t expected_icv_out = {
+      .data = expected_icv_storage,
+      .size = view->icv.size,
+  };
+
+  crisp_error_t err =
+      crisp_crypto_cmac_prefixed(keys, cmac_prefix, cmac_input, expected_icv_out);
+  if (err == CRISP_OK &&
+      !crisp_constant_time_equal(expected_icv_storage, view->icv.data, view->icv.size)) {
+    err = CRISP_ERR_CRYPTO;
+  }
+  crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
+  return err;
+}
+
+/** Checks that an authenticated packet can be opened into `out_plaintext`. */
+static crisp_error_t crisp_rx_check_output(const crisp_crypto_keys_t* keys,
+                                           const crisp_suite_params_t* suite_params,
+                                           const crisp_message_view_t* view,
+                                           crisp_mutable_byte_span_t out_plaintext) {
+  if (out_plaintext.size < view->payload.size) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
+  }
+  if (view->payload.size > 0U && out_plaintext.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (suite_params->encryption_enabled && view->payload.size > 0U && !crisp_keys_can_ctr(keys)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  return CRISP_OK;
+}
+
+/**
+ * Read-only replay probe run before the ICV is verified, so stale and duplicate SeqNums are
+ * dropped without spending a CMAC. Never updates the window: a forged packet cannot move it.
+ */
+static crisp_error_t crisp_rx_probe_replay(const crisp_rx_replay_t* replay, uint64_t seqnum) {
+  bool would_accept = false;
+  crisp_error_t err = CRISP_OK;
+  if (replay->concurrent != NULL) {
+    err = crisp_concurrent_replay_window_check(replay->concurrent, seqnum, &would_accept);
+  } else if (replay->window != NULL) {
+    err = crisp_replay_window_check(replay->window, seqnum, &would_accept);
+  } else {
+    return CRISP_OK;
+  }
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return would_accept ? CRISP_OK : CRISP_ERR_REPLAY;
+}
+
+/** Applies replay check (if a window is configured) for an authenticated SeqNum. */
+static crisp_error_t crisp_rx_check_replay(const crisp_rx_replay_t* replay, uint64_t seqnum) {
+  bool accepted = false;
+  crisp_error_t err = CRISP_OK;
+  if (replay->concurrent != NULL) {
+    err = crisp_concurrent_replay_window_check_and_update(replay->concurrent, seqnum, &accepted);
+  } else if (replay->window != NULL) {
+    err = crisp_replay_window_check_and_update(replay->window, seqnum, &accepted);
+  } else {
+    return CRISP_OK;
+  }
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return accepted ? CRISP_OK : CRISP_ERR_REPLAY;
+}
+
+/** Fills unprotect metadata for an opened packet. */
+static void crisp_rx_fill_result(const crisp_message_view_t* view,
+                                 crisp_mutable_byte_span_t plaintext,
+                                 crisp_unprotect_result_t* out_result) {
+  (void)memset(out_result, 0, sizeof(*out_result));
+  out_result->external_key_id_flag = view->external_key_id_flag;
+  out_result->version = view->version;
+  out_result->cs = view->cs;
+  out_result->key_id_present = view->key_id_present;
+  out_result->key_id = view->key_id;
+  out_result->seqnum = view->seqnum;
+  out_result->plaintext = plaintext;
+}
+
+/** Decrypts (or copies) an accepted payload and fills unprotect metadata. */
+static crisp_error_t crisp_rx_open(const crisp_crypto_keys_t* keys,
+                                   const crisp_suite_params_t* suite_params,
+                                   const crisp_message_view_t* view,
+                                   crisp_mutable_byte_span_t out_plaintext,
+                                   crisp_unprotect_result_t* out_result) {
+  crisp_mutable_byte_span_t plaintext_out = {
+      .data = out_plaintext.data,
+      .size = view->payload.size,
+  };
+
+  if (view->payload.size > 0U) {
+    if (suite_params->encryption_enabled) {
+      const uint32_t iv32 = (uint32_t)(view->seqnum & 0xFFFFFFFFU);
+      const crisp_error_t err = crisp_crypto_ctr_xcrypt(keys, iv32, view->payload, plaintext_out);
+      if (err != CRISP_OK) {
+        return err;
+      }
+    } else if (plaintext_out.data != view->payload.data) {
+      /* In-place unprotect leaves a NULL-suite payload where it is. */
+      (void)memcpy(plaintext_out.data, view->payload.data, view->payload.size);
+    }
+  }
+
+  crisp_rx_fill_result(view, plaintext_out, out_result);
+  return CRISP_OK;
+}
+
+/**
+ * Fused RX path: one pass computes the ICV and decrypts into stack scratch; plaintext reaches
+ * `out_plaintext` only after ICV, output capacity and replay checks succeed.
+ */
+static crisp_error_t crisp_rx_unprotect_fused(const crisp_crypto_keys_t* keys,
+                                              const crisp_cmac_prefix_t* cmac_prefix,
+                                              crisp_const_byte_span_t packet,
+                                              const crisp_suite_params_t* suite_params,
+                                              const crisp_message_view_t* view,
+                                              const crisp_rx_replay_t* replay,
+                                              crisp_mutable_byte_span_t out_plaintext,
+                                              crisp_unprotect_result_t* out_result) {
+  if (view->icv.size > (size_t)CRISP_INTERNAL_MAX_ICV_SIZE) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+
+  uint8_t scratch[CRISP_MAX_MESSAGE_SIZE];
+  uint8_t expected_icv_storage[CRISP_INTERNAL_MAX_ICV_SIZE] = {0};
+  const crisp_const_byte_span_t auth = {
+      .data = packet.data,
+      .size = packet.size - view->icv.size,
+  };
+  crisp_mutable_byte_span_t scratch_out = {
+      .data = scratch,
+      .size = view->payload.size,
+  };
+  crisp_mutable_byte_span_t expected_icv_out = {
+      .data = expected_icv_storage,
+      .size = view->icv.size,
+  };
+
+  const uint32_t iv32 = (uint32_t)(view->seqnum & 0xFFFFFFFFU);
+  crisp_error_t err = crisp_crypto_cmac_then_ctr(keys, cmac_prefix, iv32, auth,
+                                                 (size_t)(view->payload.data - packet.data),
+                                                 scratch_out, expected_icv_out);
+  if (err == CRISP_OK &&
+      !crisp_constant_time_equal(expected_icv_storage, view->icv.data, view->icv.size)) {
+    err = CRISP_ERR_CRYPTO;
+  }
+  if (err == CRISP_OK) {
+    err = crisp_rx_check_output(keys, suite_params, view, out_plaintext);
+  }
+  if (err == CRISP_OK) {
+    err = crisp_rx_check_replay(replay, view->seqnum);
+  }
+  if (err == CRISP_OK) {
+    crisp_mutable_byte_span_t plaintext_out = {
+        .data = out_plaintext.data,
+        .size = view->payload.size,
+    };
+    (void)memcpy(plaintext_out.data, scratch, view->payload.size);
+    crisp_rx_fill_result(view, plaintext_out, out_result);
+  }
+
+  crisp_secure_zero(scratch, view->payload.size);
+  crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
+  return err;
+}
+
+crisp_error_t crisp_rx_unprotect_view(const crisp_crypto_keys_t* keys,
+                                      const crisp_cmac_prefix_t* cmac_prefix,
+                                      crisp_const_byte_span_t packet,
+                                      const crisp_suite_params_t* suite_params,
+                                      const crisp_message_view_t* view,
+                                      const crisp_rx_replay_t* replay,
+                                      crisp_mutable_byte_span_t out_plaintext,
+                                      crisp_unprotect_result_t* out_result) {
+  crisp_error_t err = crisp_rx_probe_replay(replay, view->seqnum);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  if (suite_params->encryption_enabled && view->payload.size > 0U &&
+      crisp_crypto_keys_have_fused(keys)) {
+    return crisp_rx_unprotect_fused(keys, cmac_prefix, packet, suite_params, view, replay,
+                                    out_plaintext, out_result);
+  }
+
+  err = crisp_rx_verify_icv(keys, cmac_prefix, packet, view);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  err = crisp_rx_check_output(keys, suite_params, view, out_plaintext);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  err = crisp_rx_check_replay(replay, view->seqnum);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_rx_open(keys, suite_params, view, out_plaintext, out_result);
+}
+
+crisp_error_t crisp_rx_unprotect_in_place(const crisp_crypto_keys_t* keys,
+                                          const crisp_cmac_prefix_t* cmac_prefix,
+                                          crisp_mutable_byte_span_t packet,
+                                          const crisp_suite_params_t* suite_params,
+                                          const crisp_message_view_t* view,
+                                          const crisp_rx_replay_t* replay,
+                                          crisp_const_byte_span_t* out_plaintext,
+                                          crisp_unprotect_result_t* out_result) {
+  /*
+   * The payload region itself is the output buffer. crisp_rx_unprotect_view() writes it only
+   * after the ICV, replay and capacity checks pass, so a rejected packet stays intact.
+   */
+  const crisp_mutable_byte_span_t payload = {
+      .data = packet.data + (view->payload.data - packet.data),
+      .size = view->payload.size,
+  };
+  const crisp_const_byte_span_t packet_in = {
+      .data = packet.data,
+      .size = packet.size,
+  };
+  const crisp_error_t err = crisp_rx_unprotect_view(keys, cmac_prefix, packet_in, suite_params,
+                                                    view, replay, payload, out_result);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  out_plaintext->data = payload.data;
+  out_plaintext->size = payload.size;
+  return CRISP_OK;
+}
+
+/*
+ * Scattered RX without segmented backend ops: the packet is copied into stack scratch and
+ * takes the contiguous path. `view` keeps its KeyId span in the first segment.
+ */
+static crisp_error_t crisp_rx_unprotect_linear(const crisp_crypto_keys_t* keys,
+                                               const crisp_cmac_prefix_t* cmac_prefix,
+                                               const crisp_const_byte_span_t* packet_iov,
+                                               size_t count,
+                                               size_t packet_size,
+                                               const crisp_suite_params_t* suite_params,
+                                               const crisp_message_view_t* view,
+                                               const crisp_rx_replay_t* replay,
+                                               crisp_mutable_byte_span_t out_plaintext,
+                                               crisp_unprotect_result_t* out_result) {
+  uint8_t scratch[CRISP_MAX_MESSAGE_SIZE];
+  crisp_iov_gather(packet_iov, count, 0U, scratch, packet_size);
+
+  const size_t payload_offset = packet_size - view->icv.size - view->payload.size;
+  crisp_message_view_t linear_view = *view;
+  linear_view.payload.data = scratch + payload_offset;
+  linear_view.icv.data = scratch + payload_offset + view->payload.size;
+  const crisp_const_byte_span_t packet = {
+      .data = scratch,
+      .size = packet_size,
+  };
+  return crisp_rx_unprotect_view(keys, cmac_prefix, packet, suite_params, &linear_view, replay,
+                                 out_plaintext, out_result);
+}
+
+/* ICV of a scattered packet, with the CMAC chained across segment boundaries. */
+static crisp_error_t crisp_rx_verify_icv_iov(const crisp_crypto_keys_t* keys,
+                                             const crisp_cmac_prefix_t* cmac_prefix,
+                                             const crisp_const_byte_span_t* packet_iov,
+                                             size_t count,
+                                             size_t packet_size,
+                                             const crisp_message_view_t* view) {
+  if (view->icv.size > (size_t)CRISP_INTERNAL_MAX_ICV_SIZE) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+  const size_t auth_size = packet_size - view->icv.size;
+  uint8_t received_icv[CRISP_INTERNAL_MAX_ICV_SIZE] = {0};
+  crisp_iov_gather(packet_iov, count, auth_size, received_icv, view->icv.size);
+
+  const crisp_const_byte_span_t head = {
+      .data = packet_iov[0].data,
+      .size = packet_iov[0].size < auth_size ? packet_iov[0].size : auth_size,
+  };
+  crisp_cmac_stream_t stream;
+  crisp_error_t err = crisp_crypto_cmac_stream_init(keys, cmac_prefix, head, &stream);
+  size_t offset = 0U;
+  for (size_t i = 0U; err == CRISP_OK && i < count && offset < auth_size; ++i) {
+    const crisp_const_byte_span_t piece = {
+        .data = packet_iov[i].data,
+        .size = packet_iov[i].size < auth_size - offset ? packet_iov[i].size : auth_size - offset,
+    };
+    err = crisp_crypto_cmac_stream_update(keys, &stream, piece);
+    offset += piece.size;
+  }
+
+  uint8_t expected_icv_storage[CRISP_INTERNAL_MAX_ICV_SIZE] = {0};
+  crisp_mutable_byte_span_t expected_icv_out = {
+      .data = expected_icv_storage,
+      .size = view->icv.size,
+  };
+  if (err == CRISP_OK) {
+    err = crisp_crypto_cmac_stream_final(keys, &stream, expected_icv_out);
+  }
+  if (err == CRISP_OK &&
+      !crisp_constant_time_equal(expected_icv_storage, received_icv, view->icv.size)) {
+    err = CRISP_ERR_CRYPTO;
+  }
+  crisp_secure_zero(expected_icv_storage, sizeof(expected_icv_storage));
+  return err;
+}
+
+/* Decrypts (or copies) the payload of an accepted scattered packet segment by segment. */
+static crisp_error_t crisp_rx_open_iov(const crisp_crypto_keys_t* keys,
+                                       const crisp_suite_params_t* suite_params,
+                                       const crisp_const_byte_span_t* packet_iov,
+                                       size_t count,
+                                       size_t payload_offset,
+                                       const crisp_message_view_t* view,
+                                       crisp_mutable_byte_span_t out_plaintext,
+                                       crisp_unprotect_result_t* out_result) {
+  const uint32_t iv32 = (uint32_t)(view->seqnum & 0xFFFFFFFFU);
+  const size_t payload_size = view->payload.size;
+  size_t skip = payload_offset;
+  size_t done = 0U;
+  for (size_t i = 0U; i < count && done < payload_size; ++i) {
+    if (skip >= packet_iov[i].size) {
+      skip -= packet_iov[i].size;
+      continue;
+    }
+    const size_t available = packet_iov[i].size - skip;
+    const crisp_const_byte_span_t in = {
+        .data = packet_iov[i].data + skip,
+        .size = available < payload_size - done ? available : payload_size - done,
+    };
+    skip = 0U;
+    if (suite_params->encryption_enabled) {
+      crisp_mutable_byte_span_t out = {
+          .data = out_plaintext.data + done,
+          .size = in.size,
+      };
+      const crisp_error_t err = crisp_crypto_ctr_xcrypt_at(keys, iv32, done, in, out);
+      if (err != CRISP_OK) {
+        return err;
+      }
+    } else {
+      (void)memcpy(out_plaintext.data + done, in.data, in.size);
+    }
+    done += in.size;
+  }
+
+  crisp_mutable_byte_span_t plaintext_out = {
+      .data = out_plaintext.data,
+      .size = payload_size,
+  };
+  crisp_rx_fill_result(view, plaintext_out, out_result);
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_rx_unprotect_iov(const crisp_crypto_keys_t* keys,
+                                     const crisp_cmac_prefix_t* cmac_prefix,
+                                     const crisp_const_byte_span_t* packet_iov,
+                                     size_t count,
+                                     size_t packet_size,
+                                     const crisp_suite_params_t* suite_params,
+                                     const crisp_message_view_t* view,
+                                     const crisp_rx_replay_t* replay,
+                                     crisp_mutable_byte_span_t out_plaintext,
+                                     crisp_unprotect_result_t* out_result) {
+  if (!crisp_crypto_keys_have_segmented(keys)) {
+    return crisp_rx_unprotect_linear(keys, cmac_prefix, packet_iov, count, packet_size,
+                                     suite_params, view, replay, out_plaintext, out_result);
+  }
+
+  crisp_error_t err = crisp_rx_probe_replay(replay, view->seqnum);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  err = crisp_rx_verify_icv_iov(keys, cmac_prefix, packet_iov, count, packet_size, view);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  err = crisp_rx_check_output(keys, suite_params, view, out_plaintext);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  err = crisp_rx_check_replay(replay, view->seqnum);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  const size_t payload_offset = packet_size - view->icv.size - view->payload.size;
+  return crisp_rx_open_iov(keys, suite_params, packet_iov, count, payload_offset, view,
+                           out_plaintext, out_result);
+}
+
+/* Validates the per-call unprotect parameters shared by crisp_unprotect() and its view form. */
+static crisp_error_t crisp_unprotect_prepare(const crisp_unprotect_params_t* params,
+                                             crisp_mutable_byte_span_t out_plaintext,
+                                             crisp_crypto_keys_t* out_keys,
+                                             crisp_rx_replay_t* out_replay) {
+  if ((params->kenc.size > 0U && params->kenc.data == NULL) ||
+      (params->kmac.size > 0U && params->kmac.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (out_plaintext.size > 0U && out_plaintext.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  *out_keys = crisp_select_keys(params->keys, params->kenc, params->kmac, params->crypto);
+  if (!crisp_keys_can_cmac(out_keys)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (params->replay_window != NULL && params->concurrent_replay_window != NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  out_replay->window = params->replay_window;
+  out_replay->concurrent = params->concurrent_replay_window;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_unprotect(const crisp_unprotect_params_t* params,
+                              crisp_mutable_byte_span_t out_plaintext,
+                              crisp_unprotect_result_t* out_result) {
+  if (params == NULL || out_result == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (params->packet.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_crypto_keys_t keys;
+  crisp_rx_replay_t replay;
+  crisp_error_t err = crisp_unprotect_prepare(params, out_plaintext, &keys, &replay);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_parsed_message_t message;
+  err = crisp_unprotect_parse(params->packet, &message);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_rx_unprotect_view(&keys, params->cmac_prefix, message.packet,
+                                 &message.suite_params, &message.view, &replay, out_plaintext,
+                                 out_result);
+}
+
+crisp_error_t crisp_unprotect_in_place(const crisp_unprotect_params_t* params,
+                                       crisp_mutable_byte_span_t packet,
+                                       crisp_const_byte_span_t* out_plaintext,
+                                       crisp_unprotect_result_t* out_result) {
+  if (params == NULL || out_plaintext == NULL || out_result == NULL || packet.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_crypto_keys_t keys;
+  crisp_rx_replay_t replay;
+  const crisp_mutable_byte_span_t no_output = {0};
+  crisp_error_t err = crisp_unprotect_prepare(params, no_output, &keys, &replay);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_parsed_message_t message;
+  const crisp_const_byte_span_t packet_in = {
+      .data = packet.data,
+      .size = packet.size,
+  };
+  err = crisp_unprotect_parse(packet_in, &message);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_rx_unprotect_in_place(&keys, params->cmac_prefix, packet, &message.suite_params,
+                                     &message.view, &replay, out_plaintext, out_result);
+}
+
+crisp_error_t crisp_unprotect_iov(const crisp_unprotect_params_t* params,
+                                 const crisp_const_byte_span_t* packet_iov,
+                                 size_t packet_iovcnt,
+                                 crisp_mutable_byte_span_t out_plaintext,
+                                 crisp_unprotect_result_t* out_result) {
+  if (params == NULL || out_result == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_crypto_keys_t keys;
+  crisp_rx_replay_t replay;
+  crisp_error_t err = crisp_unprotect_prepare(params, out_plaintext, &keys, &replay);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_message_view_t view;
+  crisp_suite_params_t suite_params;
+  size_t packet_size = 0U;
+  err = crisp_parse_iov(packet_iov, packet_iovcnt, &view, &suite_params, &packet_size);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_rx_unprotect_iov(&keys, params->cmac_prefix, packet_iov, packet_iovcnt,
+                                packet_size, &suite_params, &view, &replay, out_plaintext,
+                                out_result);
+}
+
+/* Rejects parsed messages whose spans cannot come from crisp_unprotect_parse(). */
+static bool crisp_parsed_message_valid(const crisp_parsed_message_t* message) {
+  return message->packet.data != NULL && message->view.icv.data != NULL &&
+         message->view.icv.size == message->suite_params.icv_size &&
+         message->view.icv.size <= (size_t)CRISP_INTERNAL_MAX_ICV_SIZE &&
+         message->view.icv.data + message->view.icv.size ==
+             message->packet.data + message->packet.size;
+}
+
+crisp_error_t crisp_unprotect_view(const crisp_unprotect_params_t* params,
+                                   const crisp_parsed_message_t* message,
+                                   crisp_mutable_byte_span_t out_plaintext,
+                                   crisp_unprotect_result_t* out_result) {
+  if (params == NULL || message == NULL || out_result == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (!crisp_parsed_message_valid(message)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_crypto_keys_t keys;
+  crisp_rx_replay_t replay;
+  const crisp_error_t err = crisp_unprotect_prepare(params, out_plaintext, &keys, &replay);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_rx_unprotect_view(&keys, params->cmac_prefix, message->packet,
+                                 &message->suite_params, &message->view, &replay, out_plaintext,
+                                 out_result);
+}
+
+/*
+ * Processes one chunk (<= CRISP_UNPROTECT_BATCH_CHUNK packets) of crisp_unprotect_batch().
+ * Packets enter parsed; out_status[i] is CRISP_OK for those still in play.
+ */
+static void crisp_unprotect_batch_chunk(const crisp_crypto_keys_t* keys,
+                                        const crisp_rx_replay_t* replay,
+                                        const crisp_parsed_message_t* messages,
+                                        const crisp_mutable_byte_span_t* out_plaintexts,
+                                        crisp_unprotect_result_t* out_results,
+                                        crisp_error_t* out_status,
+                                        size_t count) {
+  size_t order[CRISP_UNPROTECT_BATCH_CHUNK];
+  size_t accepted_count = 0U;
+  uint8_t expected_icvs[CRISP_UNPROTECT_BATCH_CHUNK][CRISP_INTERNAL_MAX_ICV_SIZE];
+  crisp_magma_cmac_job_t cmac_jobs[CRISP_UNPROTECT_BATCH_CHUNK];
+  crisp_magma_ctr_job_t ctr_jobs[CRISP_UNPROTECT_BATCH_CHUNK];
+  size_t job_packet[CRISP_UNPROTECT_BATCH_CHUNK];
+  size_t job_count = 0U;
+
+  /* Stage 1: drop SeqNums the window already rejects. */
+  for (size_t i = 0U; i < count; ++i) {
+    if (out_status[i] == CRISP_OK &&
+        out_plaintexts[i].size > 0U && out_plaintexts[i].data == NULL) {
+      out_status[i] = CRISP_ERR_INVALID_ARGUMENT;
+    }
+    if (out_status[i] == CRISP_OK) {
+      out_status[i] = crisp_rx_probe_replay(replay, messages[i].view.seqnum);
+    }
+  }
+
+  /* Stage 2: authenticate (one CMAC batch call) and check output capacity. */
+  for (size_t i = 0U; i < count; ++i) {
+    if (out_status[i] != CRISP_OK) {
+      continue;
+    }
+    if (messages[i].view.icv.size > (size_t)CRISP_INTERNAL_MAX_ICV_SIZE) {
+      out_status[i] = CRISP_ERR_OUT_OF_RANGE;
+      continue;
+    }
+    cmac_jobs[job_count].data.data = messages[i].packet.data;
+    cmac_jobs[job_count].data.size = messages[i].packet.size - messages[i].view.icv.size;
+    cmac_jobs[job_count].out_icv.data = expected_icvs[job_count];
+    cmac_jobs[job_count].out_icv.size = messages[i].view.icv.size;
+    job_packet[job_count++] = i;
+  }
+  const crisp_error_t cmac_err = crisp_crypto_cmac_batch(keys, cmac_jobs, job_count);
+  for (size_t k = 0U; k < job_count; ++k) {
+    const size_t i = job_packet[k];
+    out_status[i] = cmac_err;
+    if (out_status[i] == CRISP_OK &&
+        !crisp_constant_time_equal(expected_icvs[k], messages[i].view.icv.data,
+                                   messages[i].view.icv.size)) {
+      out_status[i] = CRISP_ERR_CRYPTO;
+    }
+    if (out_status[i] == CRISP_OK) {
+      out_status[i] = crisp_rx_check_output(keys, &messages[i].suite_params, &messages[i].view,
+                                            out_plaintexts[i]);
+    }
+    if (out_status[i] == CRISP_OK) {
+      order[accepted_count++] = i;
+    }
+  }
+  crisp_secure_zero(expected_icvs, sizeof(expected_icvs));
+
+  /*
+   * Stage 3: replay window in ascending SeqNum order, so reordering inside a burst does not push
+   * older packets out of the window. Insertion sort is stable: the first copy of a duplicate wins.
+   */
+  for (size_t i = 1U; i < accepted_count; ++i) {
+    const size_t current = order[i];
+    size_t j = i;
+    while (j > 0U && messages[order[j - 1U]].view.seqnum > messages[current].view.seqnum) {
+      order[j] = order[j - 1U];
+      --j;
+    }
+    order[j] = current;
+  }
+  for (size_t k = 0U; k < accepted_count; ++k) {
+    const size_t i = order[k];
+    out_status[i] = crisp_rx_check_replay(replay, messages[i].view.seqnum);
+  }
+
+  /* Stage 4: decrypt accepted packets (one CTR batch call) and fill results. */
+  job_count = 0U;
+  for (size_t i = 0U; i < count; ++i) {
+    if (out_status[i] != CRISP_OK || messages[i].view.payload.size == 0U) {
+      continue;
+    }
+    crisp_mutable_byte_span_t plaintext_out = {
+        .data = out_plaintexts[i].data,
+        .size = messages[i].view.payload.size,
+    };
+    if (messages[i].suite_params.encryption_enabled) {
+      ctr_jobs[job_count].iv32 = (uint32_t)(messages[i].view.seqnum & 0xFFFFFFFFU);
+      ctr_jobs[job_count].in = messages[i].view.payload;
+      ctr_jobs[job_count].out = plaintext_out;
+      job_packet[job_count++] = i;
+    } else {
+      (void)memcpy(plaintext_out.data, messages[i].view.payload.data,
+                   messages[i].view.payload.size);
+    }
+  }
+  /*
+   * The window is already committed here; a backend failure is reported per job and its output
+   * zeroed so no partially decrypted payload is left behind.
+   */
+  const crisp_error_t ctr_err = crisp_crypto_ctr_xcrypt_batch(keys, ctr_jobs, job_count);
+  for (size_t k = 0U; k < job_count; ++k) {
+    out_status[job_packet[k]] = ctr_err;
+    if (ctr_err != CRISP_OK) {
+      crisp_secure_zero(ctr_jobs[k].out.data, ctr_jobs[k].out.size);
+    }
+  }
+  for (size_t i = 0U; i < count; ++i) {
+    if (out_status[i] == CRISP_OK) {
+      crisp_mutable_byte_span_t plaintext = {
+          .data = out_plaintexts[i].data,
+          .size = messages[i].view.payload.size,
+      };
+      crisp_rx_fill_result(&messages[i].view, plaintext, &out_results[i]);
+    }
+  }
+}
+
+/* Validates the session-level parameters shared by both batch unprotect entry points. */
+static crisp_error_t crisp_unprotect_batch_prepare(const crisp_unprotect_batch_params_t* params,
+                                                   crisp_crypto_keys_t* out_keys,
+                                                   crisp_rx_replay_t* out_replay) {
+  if ((params->kenc.size > 0U && params->kenc.data == NULL) ||
+      (params->kmac.size > 0U && params->kmac.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  *out_keys = crisp_select_keys(params->keys, params->kenc, params->kmac, params->crypto);
+  if (!crisp_keys_can_cmac(out_keys)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (params->replay_window != NULL && params->concurrent_replay_window != NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  out_replay->window = params->replay_window;
+  out_replay->concurrent = params->concurrent_replay_window;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_unprotect_batch(const crisp_unprotect_batch_params_t* params,
+                                    const crisp_const_byte_span_t* packets,
+                                    const crisp_mutable_byte_span_t* out_plaintexts,
+                                    crisp_unprotect_result_t* out_results,
+                                    crisp_error_t* out_status,
+                                    size_t count) {
+  if (params == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (count > 0U && (packets == NULL || out_plaintexts == NULL || out_results == NULL ||
+                     out_status == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_crypto_keys_t keys;
+  crisp_rx_replay_t replay;
+  const crisp_error_t err = crisp_unprotect_batch_prepare(params, &keys, &replay);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  crisp_parsed_message_t messages[CRISP_UNPROTECT_BATCH_CHUNK];
+  for (size_t offset = 0U; offset < count; offset += CRISP_UNPROTECT_BATCH_CHUNK) {
+    const size_t remaining = count - offset;
+    const size_t chunk =
+        remaining < CRISP_UNPROTECT_BATCH_CHUNK ? remaining : CRISP_UNPROTECT_BATCH_CHUNK;
+    for (size_t i = 0U; i < chunk; ++i) {
+      out_status[offset + i] = packets[offset + i].data == NULL
+                                   ? CRISP_ERR_INVALID_ARGUMENT
+                                   : crisp_unprotect_parse(packets[offset + i], &messages[i]);
+    }
+    crisp_unprotect_batch_chunk(&keys, &replay, messages, out_plaintexts + offset,
+                                out_results + offset, out_status + offset, chunk);
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_unprotect_batch_parsed(const crisp_unprotect_batch_params_t* params,
+                                           const crisp_parsed_message_t* messages,
+                                           const crisp_mutable_byte_span_t* out_plaintexts,
+                                           crisp_unprotect_result_t* out_results,
+                                           crisp_error_t* out_status,
+                                           size_t count) {
+  if (params == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (count > 0U && (messages == NULL || out_plaintexts == NULL || out_results == NULL ||
+                     out_status == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_crypto_keys_t keys;
+  crisp_rx_replay_t replay;
+  const crisp_error_t err = crisp_unprotect_batch_prepare(params, &keys, &replay);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  for (size_t offset = 0U; offset < count; offset += CRISP_UNPROTECT_BATCH_CHUNK) {
+    const size_t remaining = count - offset;
+    const size_t chunk =
+        remaining < CRISP_UNPROTECT_BATCH_CHUNK ? remaining : CRISP_UNPROTECT_BATCH_CHUNK;
+    for (size_t i = 0U; i < chunk; ++i) {
+      out_status[offset + i] = crisp_parsed_message_valid(&messages[offset + i])
+                                   ? CRISP_OK
+                                   : CRISP_ERR_INVALID_ARGUMENT;
+    }
+    crisp_unprotect_batch_chunk(&keys, &replay, messages + offset, out_plaintexts + offset,
+                                out_results + offset, out_status + offset, chunk);
+  }
+  return CRISP_OK;
+}
+
+/* Checks a resolver configuration: callbacks and/or a key table with its reader record. */
+static bool crisp_key_resolver_valid(const crisp_key_resolver_t* resolver) {
+  if (resolver->key_table != NULL && resolver->key_table_reader == NULL) {
+    return false;
+  }
+  return resolver->resolve_keys != NULL || resolver->resolve_prepared_keys != NULL ||
+         resolver->key_table != NULL;
+}
+
+/* Key resolution and unprotect of one parsed packet; arguments are already validated. */
+static crisp_error_t crisp_unprotect_resolve_message(const crisp_parsed_message_t* message,
+                                                     const crisp_key_resolver_t* resolver,
+                                                     const crisp_crypto_iface_t* crypto,
+                                                     crisp_replay_window_t* replay_window,
+                                                     crisp_mutable_byte_span_t out_plaintext,
+                                                     crisp_unprotect_result_t* out_result) {
+  const crisp_message_view_t* view = &message->view;
+  crisp_key_table_t* key_table = resolver->key_table;
+  const bool have_callback =
+      resolver->resolve_keys != NULL || resolver->resolve_prepared_keys != NULL;
+  crisp_error_t err = CRISP_OK;
+  if (!view->key_id_present && !resolver->allow_key_id_unused) {
+    return CRISP_ERR_INVALID_FORMAT;
+  }
+
+  const bool use_key_table = key_table != NULL && view->key_id_present;
+  if (use_key_table) {
+    /* The cached keys stay valid until the read section ends, so unprotect runs inside it. */
+    crisp_key_table_read_begin(key_table, resolver->key_table_reader);
+    const crisp_crypto_keys_t* cached = crisp_key_table_lookup(key_table, view->key_id);
+    if (cached != NULL) {
+      const crisp_unprotect_params_t params = {
+          .crypto = crypto,
+          .replay_window = replay_window,
+          .keys = cached,
+      };
+      err = crisp_unprotect_view(&params, message, out_plaintext, out_result);
+      crisp_key_table_read_end(resolver->key_table_reader);
+      return err;
+    }
+    crisp_key_table_read_end(resolver->key_table_reader);
+    if (crisp_key_table_negative_contains(key_table, view->key_id)) {
+      return CRISP_ERR_INVALID_FORMAT;
+    }
+  }
+  if (!have_callback) {
+    return CRISP_ERR_INVALID_FORMAT;
+  }
+
+  const crisp_key_resolve_request_t req = {
+      .external_key_id_flag = view->external_key_id_flag,
+      .cs = view->cs,
+      .key_id_present = view->key_id_present,
+      .key_id = view->key_id,
+      .seqnum = view->seqnum,
+  };
+  crisp_const_byte_span_t kenc = {0};
+  crisp_const_byte_span_t kmac = {0};
+  const crisp_crypto_keys_t* keys = NULL;
+  if (resolver->resolve_prepared_keys != NULL) {
+    err = resolver->resolve_prepared_keys(resolver->user_ctx, &req, &keys);
+    if (err != CRISP_OK) {
+      if (use_key_table && err == CRISP_ERR_INVALID_FORMAT) {
+        crisp_key_table_negative_record(key_table, resolver->key_table_reader, view->key_id);
+      }
+      return err;
+    }
+    if (keys == NULL) {
+      return CRISP_ERR_INVALID_ARGUMENT;
+    }
+  } else {
+    err = resolver->resolve_keys(resolver->user_ctx, &req, &kenc, &kmac);
+    if (err != CRISP_OK) {
+      if (use_key_table && err == CRISP_ERR_INVALID_FORMAT) {
+        crisp_key_table_negative_record(key_table, resolver->key_table_reader, view->key_id);
+      }
+      return err;
+    }
+    if ((kenc.size > 0U && kenc.data == NULL) || (kmac.size > 0U && kmac.data == NULL)) {
+      return CRISP_ERR_INVALID_ARGUMENT;
+    }
+  }
 
   const crisp_unprotect_params_t params = {
-      .packet = packet,
       .kenc = kenc,
       .kmac = kmac,
       .crypto = crypto,
       .replay_window = replay_window,
+      .keys = keys,
   };
-  return crisp_unprotect(&params, out_plaintext, out_result);
+  return crisp_unprotect_view(&params, message, out_plaintext, out_result);
+}
+
+crisp_error_t crisp_unprotect_resolve(crisp_const_byte_span_t packet,
+                                      const crisp_key_resolver_t* resolver,
+                                      const crisp_crypto_iface_t* crypto,
+                                      crisp_replay_window_t* replay_window,
+                                      crisp_mutable_byte_span_t out_plaintext,
+                                      crisp_unprotect_result_t* out_result) {
+  if (resolver == NULL || crypto == NULL || out_result == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (!crisp_key_resolver_valid(resolver)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_parsed_message_t message;
+  const crisp_error_t err = crisp_unprotect_parse(packet, &message);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  return crisp_unprotect_resolve_message(&message, resolver, crypto, replay_window,
+                                         out_plaintext, out_result);
+}
+
+crisp_error_t crisp_unprotect_resolve_parsed(const crisp_parsed_message_t* message,
+                                             const crisp_key_resolver_t* resolver,
+                                             const crisp_crypto_iface_t* crypto,
+                                             crisp_replay_window_t* replay_window,
+                                             crisp_mutable_byte_span_t out_plaintext,
+                                             crisp_unprotect_result_t* out_result) {
+  if (message == NULL || resolver == NULL || crypto == NULL || out_result == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (!crisp_key_resolver_valid(resolver) || !crisp_parsed_message_valid(message)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  return crisp_unprotect_resolve_message(message, resolver, crypto, replay_window,
+                                         out_plaintext, out_result);
 }
@@ -0,0 +1,164 @@
+#ifndef CRISP_CORE_SRC_MESSAGE_INTERNAL_H_
+#define CRISP_CORE_SRC_MESSAGE_INTERNAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crisp/core/message.h"
+
+/*
+ * TX/RX building blocks shared by the stateless message API (message.c) and the session
+ * API (session.c). Not part of the public interface.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Per-session TX state shared by every packet built with the same parameters. */
+typedef struct crisp_tx_template {
+  crisp_suite_params_t suite_params;
+  uint8_t header[CRISP_MESSAGE_HEADER_PREFIX_SIZE + CRISP_MAX_KEY_ID_SIZE];
+  size_t header_size;
+  crisp_crypto_keys_t keys;
+  /** Optional CMAC midstate over the leading header blocks (NULL when not cached). */
+  const crisp_cmac_prefix_t* cmac_prefix;
+  /** Optional precomputed CTR keystream consumed by single-packet emit (NULL when unused). */
+  crisp_keystream_pool_t* keystream_pool;
+} crisp_tx_template_t;
+
+/** Replay state of one unprotect call; at most one of the windows is set. */
+typedef struct crisp_rx_replay {
+  crisp_replay_window_t* window;
+  crisp_concurrent_replay_window_t* concurrent;
+} crisp_rx_replay_t;
+
+/** Returns true if `keys` can compute a CMAC (prepared Kmac context or raw-key callback). */
+bool crisp_keys_can_cmac(const crisp_crypto_keys_t* keys);
+
+/**
+ * Validates suite and KeyId and encodes the constant header (ExternalKeyIdFlag|Version, CS,
+ * KeyId) into `out_header`, which must hold CRISP_MESSAGE_HEADER_PREFIX_SIZE +
+ * CRISP_MAX_KEY_ID_SIZE bytes.
+ */
+crisp_error_t crisp_encode_header(bool external_key_id_flag,
+                                  uint16_t version,
+                                  uint8_t cs,
+                                  bool key_id_present,
+                                  crisp_const_byte_span_t key_id,
+                                  crisp_suite_params_t* out_suite_params,
+                                  uint8_t* out_header,
+                                  size_t* out_header_size);
+
+/** Emits one packet from a prepared TX template. */
+crisp_error_t crisp_tx_emit(const crisp_tx_template_t* tx,
+                            uint64_t seqnum,
+                            crisp_const_byte_span_t payload,
+                            crisp_mutable_byte_span_t out_packet,
+                            size_t* out_size);
+
+/**
+ * Emits one packet in place around a payload at `payload_offset` in `buffer`; the header goes
+ * into the headroom before it and the ICV into the tailroom after it (see
+ * crisp_protect_in_place()).
+ */
+crisp_error_t crisp_tx_emit_in_place(const crisp_tx_template_t* tx,
+                                     uint64_t seqnum,
+                                     crisp_mutable_byte_span_t buffer,
+                                     size_t payload_offset,
+                                     size_t payload_size,
+                                     crisp_mutable_byte_span_t* out_packet);
+
+/**
+ * Emits one packet from a payload scattered over `payload_iovcnt` segments (see
+ * crisp_protect_iov()).
+ */
+crisp_error_t crisp_tx_emit_iov(const crisp_tx_template_t* tx,
+                                uint64_t seqnum,
+                                const crisp_const_byte_span_t* payload_iov,
+                                size_t payload_iovcnt,
+                                crisp_mutable_byte_span_t out_packet,
+                                size_t* out_size);
+
+/**
+ * Emits `count` packets from a prepared TX template in chunks of CRISP_PROTECT_BATCH_CHUNK,
+ * with one backend CTR and one CMAC batch call per chunk (see crisp_protect_batch()).
+ */
+void crisp_tx_emit_batch(const crisp_tx_template_t* tx,
+                         const uint64_t* seqnums,
+                         const crisp_const_byte_span_t* payloads,
+                         const crisp_mutable_byte_span_t* out_packets,
+                         size_t* out_sizes,
+                         crisp_error_t* out_status,
+                         size_t count);
+
+/**
+ * Parses a packet whose header must equal the pre-encoded `header` byte for byte; only the
+ * SeqNum, payload and ICV boundaries are derived per packet. A different header yields
+ * CRISP_ERR_INVALID_FORMAT.
+ */
+crisp_error_t crisp_parse_with_header(crisp_const_byte_span_t packet,
+                                      const uint8_t* header,
+                                      size_t header_size,
+                                      const crisp_suite_params_t* suite_params,
+                                      crisp_message_view_t* out_message);
+
+/**
+ * Parses a packet scattered over `count` segments whose header (through the SeqNum) lies in
+ * the first one, with crisp_parse_message() checks. The KeyId span points into the first
+ * segment; payload and ICV spans carry sizes only (NULL data). Also returns the packet size.
+ */
+crisp_error_t crisp_parse_iov(const crisp_const_byte_span_t* packet_iov,
+                              size_t count,
+                              crisp_message_view_t* out_message,
+                              crisp_suite_params_t* out_suite_params,
+                              size_t* out_packet_size);
+
+/**
+ * Unprotects a parsed packet: replay probe, ICV check, output capacity, replay update and
+ * decryption, with the crisp_unprotect() error mapping and output contract.
+ */
+crisp_error_t crisp_rx_unprotect_view(const crisp_crypto_keys_t* keys,
+                                      const crisp_cmac_prefix_t* cmac_prefix,
+                                      crisp_const_byte_span_t packet,
+                                      const crisp_suite_params_t* suite_params,
+                                      const crisp_message_view_t* view,
+                                      const crisp_rx_replay_t* replay,
+                                      crisp_mutable_byte_span_t out_plaintext,
+                                      crisp_unprotect_result_t* out_result);
+
+/**
+ * crisp_rx_unprotect_view() that decrypts into the payload region of `packet` (the buffer
+ * `view` was parsed from) and returns the plaintext span there.
+ */
+crisp_error_t crisp_rx_unprotect_in_place(const crisp_crypto_keys_t* keys,
+                                          const crisp_cmac_prefix_t* cmac_prefix,
+                                          crisp_mutable_byte_span_t packet,
+                                          const crisp_suite_params_t* suite_params,
+                                          const crisp_message_view_t* view,
+                                          const crisp_rx_replay_t* replay,
+                                          crisp_const_byte_span_t* out_plaintext,
+                                          crisp_unprotect_result_t* out_result);
+
+/**
+ * crisp_rx_unprotect_view() for a scattered packet parsed by crisp_parse_iov(): CMAC is
+ * chained and the payload decrypted across segments when the keys have segmented backend
+ * ops, otherwise the packet is linearized into stack scratch first.
+ */
+crisp_error_t crisp_rx_unprotect_iov(const crisp_crypto_keys_t* keys,
+                                     const crisp_cmac_prefix_t* cmac_prefix,
+                                     const crisp_const_byte_span_t* packet_iov,
+                                     size_t count,
+                                     size_t packet_size,
+                                     const crisp_suite_params_t* suite_params,
+                                     const crisp_message_view_t* view,
+                                     const crisp_rx_replay_t* replay,
+                                     crisp_mutable_byte_span_t out_plaintext,
+                                     crisp_unprotect_result_t* out_result);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_CORE_SRC_MESSAGE_INTERNAL_H_
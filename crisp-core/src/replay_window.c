@@ -1,41 +1,43 @@
 #include "crisp/core/replay_window.h"
 
-#include <limits.h>
+#include <stdatomic.h>
 #include <string.h>
 
-static bool crisp_get_bit(const crisp_replay_window_t* window, size_t index) {
-  const size_t byte_index = index / 8U;
-  const uint8_t mask = (uint8_t)(1U << (index % 8U));
-  return (window->bits[byte_index] & mask) != 0U;
-}
+enum {
+  CRISP_REPLAY_WORD_BITS = 64,
+};
 
-static void crisp_set_bit(crisp_replay_window_t* window, size_t index) {
-  const size_t byte_index = index / 8U;
-  const uint8_t mask = (uint8_t)(1U << (index % 8U));
-  window->bits[byte_index] = (uint8_t)(window->bits[byte_index] | mask);
+static uint64_t* crisp_replay_ring(crisp_replay_window_t* window) {
+  return window->external_ring != NULL ? window->external_ring : window->ring;
 }
 
-static void crisp_clear_bit(crisp_replay_window_t* window, size_t index) {
-  const size_t byte_index = index / 8U;
-  const uint8_t mask = (uint8_t)(1U << (index % 8U));
-  window->bits[byte_index] = (uint8_t)(window->bits[byte_index] & (uint8_t)(~mask));
+/** Checks that the ring is a power of two with one spare word beyond `size` bits. */
+static bool crisp_replay_window_valid(const crisp_replay_window_t* window) {
+  const size_t max_size = window->external_ring != NULL ? CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE
+                                                        : CRISP_REPLAY_WINDOW_MAX_SIZE;
+  const size_t words = window->ring_words;
+  return window->size >= 1U && window->size <= max_size && words >= 2U &&
+         (words & (words - 1U)) == 0U && (words - 1U) * CRISP_REPLAY_WORD_BITS >= window->size &&
+         (window->external_ring != NULL || words == CRISP_REPLAY_WINDOW_RING_WORDS);
 }
 
-static void crisp_shift_window(crisp_replay_window_t* window, size_t delta) {
-  if (delta >= window->size) {
-    (void)memset(window->bits, 0, sizeof(window->bits));
-    return;
-  }
-
-  for (size_t i = window->size; i > 0U; --i) {
-    const size_t index = i - 1U;
-    const bool value = (index >= delta) ? crisp_get_bit(window, index - delta) : false;
-    if (value) {
-      crisp_set_bit(window, index);
-    } else {
-      crisp_clear_bit(window, index);
+/**
+ * Moves max_seq forward to `seqnum`: words entered by the advance are cleared whole (all of
+ * them at once on a jump past the ring), so cost is bounded by the ring length, not the window.
+ */
+static void crisp_replay_advance(crisp_replay_window_t* window, uint64_t seqnum) {
+  uint64_t* ring = crisp_replay_ring(window);
+  const uint64_t mask = (uint64_t)window->ring_words - 1U;
+  const uint64_t old_word = window->max_seq / CRISP_REPLAY_WORD_BITS;
+  const uint64_t new_word = seqnum / CRISP_REPLAY_WORD_BITS;
+  if (new_word - old_word >= (uint64_t)window->ring_words) {
+    (void)memset(ring, 0, window->ring_words * sizeof(uint64_t));
+  } else {
+    for (uint64_t word = old_word + 1U; word <= new_word; ++word) {
+      ring[(size_t)(word & mask)] = 0U;
     }
   }
+  window->max_seq = seqnum;
 }
 
 crisp_error_t crisp_replay_window_init(crisp_replay_window_t* window, size_t size) {
@@ -48,6 +50,72 @@ crisp_error_t crisp_replay_window_init(crisp_replay_window_t* window, size_t siz
 
   (void)memset(window, 0, sizeof(*window));
   window->size = size;
+  window->ring_words = CRISP_REPLAY_WINDOW_RING_WORDS;
+  return CRISP_OK;
+}
+
+size_t crisp_replay_window_storage_words(size_t size) {
+  if (size < 1U || size > CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE) {
+    return 0U;
+  }
+  const size_t needed = (size + CRISP_REPLAY_WORD_BITS - 1U) / CRISP_REPLAY_WORD_BITS + 1U;
+  size_t words = 1U;
+  while (words < needed) {
+    words <<= 1U;
+  }
+  return words;
+}
+
+crisp_error_t crisp_replay_window_init_with_storage(crisp_replay_window_t* window,
+                                                    size_t size,
+                                                    uint64_t* storage,
+                                                    size_t storage_words) {
+  if (window == NULL || storage == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const size_t ring_words = crisp_replay_window_storage_words(size);
+  if (ring_words == 0U) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+  if (storage_words < ring_words) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
+  }
+
+  (void)memset(window, 0, sizeof(*window));
+  (void)memset(storage, 0, ring_words * sizeof(uint64_t));
+  window->size = size;
+  window->ring_words = ring_words;
+  window->external_ring = storage;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_replay_window_check(const crisp_replay_window_t* window,
+                                        uint64_t seqnum,
+                                        bool* would_accept) {
+  if (window == NULL || would_accept == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (!crisp_replay_window_valid(window)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (seqnum > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+
+  if (!window->initialized || seqnum > window->max_seq) {
+    *would_accept = true;
+    return CRISP_OK;
+  }
+  if (window->max_seq - seqnum >= (uint64_t)window->size) {
+    *would_accept = false;
+    return CRISP_OK;
+  }
+
+  const uint64_t* ring = window->external_ring != NULL ? window->external_ring : window->ring;
+  const uint64_t word =
+      ring[(size_t)((seqnum / CRISP_REPLAY_WORD_BITS) & (window->ring_words - 1U))];
+  const uint64_t mask = (uint64_t)1U << (seqnum % CRISP_REPLAY_WORD_BITS);
+  *would_accept = (word & mask) == 0U;
   return CRISP_OK;
 }
 
@@ -57,53 +125,177 @@ crisp_error_t crisp_replay_window_check_and_update(crisp_replay_window_t* window
   if (window == NULL || accepted == NULL) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
-  if (window->size < 1U || window->size > CRISP_REPLAY_WINDOW_MAX_SIZE) {
+  if (!crisp_replay_window_valid(window)) {
     return CRISP_ERR_INVALID_ARGUMENT;
   }
   if (seqnum > CRISP_SEQNUM_MAX) {
     return CRISP_ERR_OUT_OF_RANGE;
   }
 
+  uint64_t* ring = crisp_replay_ring(window);
   if (!window->initialized) {
-    (void)memset(window->bits, 0, sizeof(window->bits));
+    (void)memset(ring, 0, window->ring_words * sizeof(uint64_t));
     window->max_seq = seqnum;
     window->initialized = true;
-    crisp_set_bit(window, 0U);
-    *accepted = true;
+  } else if (seqnum > window->max_seq) {
+    crisp_replay_advance(window, seqnum);
+  } else if (window->max_seq - seqnum >= (uint64_t)window->size) {
+    *accepted = false;
     return CRISP_OK;
   }
 
-  if (seqnum > window->max_seq) {
-    const uint64_t delta64 = seqnum - window->max_seq;
-    if (delta64 >= (uint64_t)window->size) {
-      (void)memset(window->bits, 0, sizeof(window->bits));
-    } else {
-      const size_t delta = (size_t)delta64;
-      crisp_shift_window(window, delta);
-    }
-    window->max_seq = seqnum;
-    crisp_set_bit(window, 0U);
-    *accepted = true;
+  uint64_t* word = &ring[(size_t)((seqnum / CRISP_REPLAY_WORD_BITS) & (window->ring_words - 1U))];
+  const uint64_t mask = (uint64_t)1U << (seqnum % CRISP_REPLAY_WORD_BITS);
+  if ((*word & mask) != 0U) {
+    *accepted = false;
     return CRISP_OK;
   }
 
-  const uint64_t distance64 = window->max_seq - seqnum;
-  if (distance64 >= (uint64_t)window->size) {
-    *accepted = false;
-    return CRISP_OK;
+  *word |= mask;
+  *accepted = true;
+  return CRISP_OK;
+}
+
+/*
+ * Concurrent window. The public struct keeps plain uint64_t fields so the header stays usable
+ * from C++; they are only ever accessed through these _Atomic views.
+ */
+_Static_assert(sizeof(_Atomic uint64_t) == sizeof(uint64_t) &&
+                   _Alignof(_Atomic uint64_t) == _Alignof(uint64_t),
+               "_Atomic uint64_t must share the layout of uint64_t");
+
+enum {
+  CRISP_CONCURRENT_REPLAY_SLOT_SHIFT = 4,
+  CRISP_CONCURRENT_REPLAY_SLOT_BITS = 16,
+};
+
+static _Atomic uint64_t* crisp_atomic_u64(uint64_t* value) {
+  return (_Atomic uint64_t*)value;
+}
+
+static const _Atomic uint64_t* crisp_atomic_u64_const(const uint64_t* value) {
+  return (const _Atomic uint64_t*)value;
+}
+
+static bool crisp_concurrent_replay_window_valid(const crisp_concurrent_replay_window_t* window) {
+  const size_t slots = window->slot_count;
+  return window->slots != NULL && window->size >= 1U &&
+         window->size <= CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE && slots >= 2U &&
+         (slots & (slots - 1U)) == 0U &&
+         (slots - 1U) * CRISP_CONCURRENT_REPLAY_SLOT_BITS >= window->size;
+}
+
+size_t crisp_concurrent_replay_window_storage_words(size_t size) {
+  if (size < 1U || size > CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE) {
+    return 0U;
   }
-  if (distance64 > (uint64_t)SIZE_MAX) {
-    *accepted = false;
-    return CRISP_OK;
+  const size_t needed =
+      (size + CRISP_CONCURRENT_REPLAY_SLOT_BITS - 1U) / CRISP_CONCURRENT_REPLAY_SLOT_BITS + 1U;
+  size_t words = 1U;
+  while (words < needed) {
+    words <<= 1U;
   }
+  return words;
+}
 
-  const size_t distance = (size_t)distance64;
-  if (crisp_get_bit(window, distance)) {
+crisp_error_t crisp_concurrent_replay_window_init(crisp_concurrent_replay_window_t* window,
+                                                  size_t size,
+                                                  uint64_t* storage,
+                                                  size_t storage_words) {
+  if (window == NULL || storage == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const size_t slot_count = crisp_concurrent_replay_window_storage_words(size);
+  if (slot_count == 0U) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+  if (storage_words < slot_count) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
+  }
+
+  window->size = size;
+  window->slot_count = slot_count;
+  window->slots = storage;
+  atomic_init(crisp_atomic_u64(&window->max_seq_plus1), 0U);
+  for (size_t i = 0U; i < slot_count; ++i) {
+    atomic_init(crisp_atomic_u64(&storage[i]), 0U);
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_concurrent_replay_window_check_and_update(
+    crisp_concurrent_replay_window_t* window,
+    uint64_t seqnum,
+    bool* accepted) {
+  if (window == NULL || accepted == NULL || !crisp_concurrent_replay_window_valid(window)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (seqnum > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+
+  _Atomic uint64_t* max_seq_plus1 = crisp_atomic_u64(&window->max_seq_plus1);
+  const uint64_t observed = atomic_load_explicit(max_seq_plus1, memory_order_acquire);
+  if (observed > seqnum && observed - 1U - seqnum >= (uint64_t)window->size) {
     *accepted = false;
     return CRISP_OK;
   }
 
-  crisp_set_bit(window, distance);
+  /*
+   * Slots are spaced (slot_count - 1) * 16 >= size SeqNums apart, so a slot holding a newer
+   * group means `seqnum` is already out of the window, and an older group is outside it too.
+   */
+  const uint64_t group = seqnum >> CRISP_CONCURRENT_REPLAY_SLOT_SHIFT;
+  const uint64_t bit = (uint64_t)1U << (seqnum & (CRISP_CONCURRENT_REPLAY_SLOT_BITS - 1U));
+  _Atomic uint64_t* slot =
+      crisp_atomic_u64(&window->slots[(size_t)(group & (window->slot_count - 1U))]);
+  uint64_t current = atomic_load_explicit(slot, memory_order_acquire);
+  for (;;) {
+    const uint64_t slot_group = current >> CRISP_CONCURRENT_REPLAY_SLOT_BITS;
+    if (slot_group > group || (slot_group == group && (current & bit) != 0U)) {
+      *accepted = false;
+      return CRISP_OK;
+    }
+    const uint64_t next =
+        slot_group == group ? (current | bit) : ((group << CRISP_CONCURRENT_REPLAY_SLOT_BITS) | bit);
+    if (atomic_compare_exchange_weak_explicit(slot, &current, next, memory_order_acq_rel,
+                                              memory_order_acquire)) {
+      break;
+    }
+  }
+
+  uint64_t max_value = atomic_load_explicit(max_seq_plus1, memory_order_relaxed);
+  while (max_value < seqnum + 1U &&
+         !atomic_compare_exchange_weak_explicit(max_seq_plus1, &max_value, seqnum + 1U,
+                                                memory_order_acq_rel, memory_order_relaxed)) {
+  }
   *accepted = true;
   return CRISP_OK;
 }
+
+crisp_error_t crisp_concurrent_replay_window_check(const crisp_concurrent_replay_window_t* window,
+                                                   uint64_t seqnum,
+                                                   bool* would_accept) {
+  if (window == NULL || would_accept == NULL || !crisp_concurrent_replay_window_valid(window)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (seqnum > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+
+  const uint64_t observed =
+      atomic_load_explicit(crisp_atomic_u64_const(&window->max_seq_plus1), memory_order_acquire);
+  if (observed > seqnum && observed - 1U - seqnum >= (uint64_t)window->size) {
+    *would_accept = false;
+    return CRISP_OK;
+  }
+
+  const uint64_t group = seqnum >> CRISP_CONCURRENT_REPLAY_SLOT_SHIFT;
+  const uint64_t bit = (uint64_t)1U << (seqnum & (CRISP_CONCURRENT_REPLAY_SLOT_BITS - 1U));
+  const uint64_t current = atomic_load_explicit(
+      crisp_atomic_u64_const(&window->slots[(size_t)(group & (window->slot_count - 1U))]),
+      memory_order_acquire);
+  const uint64_t slot_group = current >> CRISP_CONCURRENT_REPLAY_SLOT_BITS;
+  *would_accept = !(slot_group > group || (slot_group == group && (current & bit) != 0U));
+  return CRISP_OK;
+}
@@ -0,0 +1,81 @@
+#include "crisp/core/seqnum_allocator.h"
+
+#include <stdatomic.h>
+
+/*
+ * The public struct keeps a plain uint64_t so the header stays usable from C++; `next` is only
+ * ever accessed through this _Atomic view.
+ */
+_Static_assert(sizeof(_Atomic uint64_t) == sizeof(uint64_t) &&
+                   _Alignof(_Atomic uint64_t) == _Alignof(uint64_t),
+               "_Atomic uint64_t must share the layout of uint64_t");
+
+static _Atomic uint64_t* crisp_seqnum_next(crisp_seqnum_allocator_t* allocator) {
+  return (_Atomic uint64_t*)&allocator->next;
+}
+
+crisp_error_t crisp_seqnum_allocator_init(crisp_seqnum_allocator_t* allocator,
+                                          uint64_t first_seqnum,
+                                          uint64_t rekey_threshold) {
+  if (allocator == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (first_seqnum > CRISP_SEQNUM_MAX || rekey_threshold > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+  atomic_init(crisp_seqnum_next(allocator), first_seqnum);
+  allocator->rekey_threshold = rekey_threshold == 0U ? CRISP_SEQNUM_MAX + 1U : rekey_threshold;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_seqnum_allocator_reserve(crisp_seqnum_allocator_t* allocator,
+                                             uint64_t count,
+                                             crisp_seqnum_block_t* out_block) {
+  if (allocator == NULL || out_block == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  out_block->next = 0U;
+  out_block->end = 0U;
+  out_block->rekey_due = false;
+  if (count == 0U || count > CRISP_SEQNUM_BLOCK_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+
+  _Atomic uint64_t* next = crisp_seqnum_next(allocator);
+  /*
+   * Skipping the fetch-add once exhausted bounds the overshoot past CRISP_SEQNUM_MAX + 1 to one
+   * block per racing thread, so the 64-bit counter can never wrap back into valid SeqNums.
+   */
+  if (atomic_load_explicit(next, memory_order_relaxed) > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+  const uint64_t first = atomic_fetch_add_explicit(next, count, memory_order_relaxed);
+  if (first > CRISP_SEQNUM_MAX) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+
+  const uint64_t end = count > CRISP_SEQNUM_MAX + 1U - first ? CRISP_SEQNUM_MAX + 1U
+                                                               : first + count;
+  out_block->next = first;
+  out_block->end = end;
+  out_block->rekey_due = end > allocator->rekey_threshold;
+  return CRISP_OK;
+}
+
+bool crisp_seqnum_block_take(crisp_seqnum_block_t* block, uint64_t* out_seqnum) {
+  if (block == NULL || out_seqnum == NULL || block->next >= block->end) {
+    return false;
+  }
+  *out_seqnum = block->next;
+  block->next += 1U;
+  return true;
+}
+
+bool crisp_seqnum_allocator_rekey_due(const crisp_seqnum_allocator_t* allocator) {
+  if (allocator == NULL) {
+    return false;
+  }
+  const uint64_t next =
+      atomic_load_explicit((const _Atomic uint64_t*)&allocator->next, memory_order_relaxed);
+  return next > allocator->rekey_threshold;
+}
@@ -0,0 +1,352 @@
+#include "crisp/core/session.h"
+
+#include <string.h>
+
+#include "mem_kernels.h"
+#include "message_internal.h"
+
+crisp_error_t crisp_session_init(crisp_session_t* session, const crisp_session_config_t* config) {
+  if (session == NULL || config == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  (void)memset(session, 0, sizeof(*session));
+  if (config->crypto == NULL || (config->key_id.size > 0U && config->key_id.data == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_error_t err = crisp_seqnum_allocator_init(&session->tx_seqnums, config->tx_seqnum,
+                                                  config->tx_rekey_threshold);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  err = crisp_encode_header(config->external_key_id_flag, CRISP_VERSION_2024, config->cs,
+                            config->key_id_present, config->key_id, &session->suite_params,
+                            session->header, &session->header_size);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  if (config->replay_window_size > 0U) {
+    err = config->replay_window_storage != NULL
+              ? crisp_replay_window_init_with_storage(
+                    &session->replay_window, config->replay_window_size,
+                    config->replay_window_storage, config->replay_window_storage_words)
+              : crisp_replay_window_init(&session->replay_window, config->replay_window_size);
+    if (err != CRISP_OK) {
+      (void)memset(session, 0, sizeof(*session));
+      return err;
+    }
+    session->replay_enabled = true;
+  }
+
+  err = crisp_crypto_keys_init(&session->keys, config->crypto, config->kenc, config->kmac);
+  if (err == CRISP_OK && !crisp_keys_can_cmac(&session->keys)) {
+    err = CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (err == CRISP_OK) {
+    const crisp_const_byte_span_t constant_bytes = {
+        .data = session->header,
+        .size = session->header_size,
+    };
+    err = crisp_cmac_prefix_init(&session->cmac_prefix, &session->keys, constant_bytes);
+  }
+  if (err == CRISP_OK && config->keystream_pool != NULL) {
+    err = crisp_keystream_pool_init(config->keystream_pool, &session->keys,
+                                    config->keystream_pool_storage,
+                                    config->keystream_pool_slot_size, config->tx_seqnum);
+    if (err == CRISP_OK) {
+      session->keystream_pool = config->keystream_pool;
+    }
+  }
+  if (err != CRISP_OK) {
+    crisp_session_clear(session);
+    return err;
+  }
+  return CRISP_OK;
+}
+
+/* Only the header bytes are copied; suite, KeyId and keys were validated at init. */
+static void crisp_session_tx_template(const crisp_session_t* session, crisp_tx_template_t* tx) {
+  tx->suite_params = session->suite_params;
+  (void)memcpy(tx->header, session->header, session->header_size);
+  tx->header_size = session->header_size;
+  tx->keys = session->keys;
+  tx->cmac_prefix = &session->cmac_prefix;
+  tx->keystream_pool = session->keystream_pool;
+}
+
+crisp_error_t crisp_session_protect_seqnum(const crisp_session_t* session,
+                                           uint64_t seqnum,
+                                           crisp_const_byte_span_t payload,
+                                           crisp_mutable_byte_span_t out_packet,
+                                           size_t* out_size) {
+  if (session == NULL || out_size == NULL || session->keys.crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_tx_template_t tx;
+  crisp_session_tx_template(session, &tx);
+  return crisp_tx_emit(&tx, seqnum, payload, out_packet, out_size);
+}
+
+size_t crisp_session_headroom(const crisp_session_t* session) {
+  return session == NULL ? 0U : session->header_size + CRISP_MESSAGE_SEQNUM_SIZE;
+}
+
+crisp_error_t crisp_session_protect_in_place(const crisp_session_t* session,
+                                             uint64_t seqnum,
+                                             crisp_mutable_byte_span_t buffer,
+                                             size_t payload_offset,
+                                             size_t payload_size,
+                                             crisp_mutable_byte_span_t* out_packet) {
+  if (session == NULL || session->keys.crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_tx_template_t tx;
+  crisp_session_tx_template(session, &tx);
+  return crisp_tx_emit_in_place(&tx, seqnum, buffer, payload_offset, payload_size, out_packet);
+}
+
+crisp_error_t crisp_session_protect_iov(const crisp_session_t* session,
+                                        uint64_t seqnum,
+                                        const crisp_const_byte_span_t* payload_iov,
+                                        size_t payload_iovcnt,
+                                        crisp_mutable_byte_span_t out_packet,
+                                        size_t* out_size) {
+  if (session == NULL || session->keys.crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_tx_template_t tx;
+  crisp_session_tx_template(session, &tx);
+  return crisp_tx_emit_iov(&tx, seqnum, payload_iov, payload_iovcnt, out_packet, out_size);
+}
+
+crisp_error_t crisp_session_reserve_seqnums(crisp_session_t* session,
+                                            uint64_t count,
+                                            crisp_seqnum_block_t* out_block) {
+  if (session == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  return crisp_seqnum_allocator_reserve(&session->tx_seqnums, count, out_block);
+}
+
+crisp_error_t crisp_session_protect(crisp_session_t* session,
+                                    crisp_const_byte_span_t payload,
+                                    crisp_mutable_byte_span_t out_packet,
+                                    size_t* out_size,
+                                    uint64_t* out_seqnum) {
+  if (session == NULL || out_size == NULL || session->keys.crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  crisp_seqnum_block_t block;
+  const crisp_error_t err = crisp_seqnum_allocator_reserve(&session->tx_seqnums, 1U, &block);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  if (out_seqnum != NULL) {
+    *out_seqnum = block.next;
+  }
+  return crisp_session_protect_seqnum(session, block.next, payload, out_packet, out_size);
+}
+
+/* Header, SeqNum and ICV bytes around the payload of every packet of this session. */
+static size_t crisp_session_overhead(const crisp_session_t* session) {
+  return session->header_size + CRISP_MESSAGE_SEQNUM_SIZE + session->suite_params.icv_size;
+}
+
+crisp_error_t crisp_session_stream_layout(const crisp_session_t* session,
+                                          size_t payload_size,
+                                          size_t mtu,
+                                          crisp_stream_layout_t* out_layout) {
+  if (session == NULL || out_layout == NULL || session->keys.crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const size_t overhead = crisp_session_overhead(session);
+  const size_t packet_size = mtu < CRISP_MAX_MESSAGE_SIZE ? mtu : CRISP_MAX_MESSAGE_SIZE;
+  if (packet_size <= overhead) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  const size_t segment_size = packet_size - overhead;
+  const size_t packet_count =
+      payload_size / segment_size + (payload_size % segment_size != 0U ? 1U : 0U);
+  if ((uint64_t)packet_count > CRISP_SEQNUM_BLOCK_MAX) {
+    return CRISP_ERR_INVALID_SIZE;
+  }
+  /* At most CRISP_SEQNUM_BLOCK_MAX full packets, so the sum stays far below SIZE_MAX. */
+  out_layout->segment_size = segment_size;
+  out_layout->packet_count = packet_count;
+  out_layout->arena_size = payload_size + packet_count * overhead;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_session_protect_stream(crisp_session_t* session,
+                                           crisp_const_byte_span_t payload,
+                                           size_t mtu,
+                                           crisp_mutable_byte_span_t arena,
+                                           crisp_mutable_byte_span_t* out_packets,
+                                           size_t max_packets,
+                                           size_t* out_count,
+                                           uint64_t* out_first_seqnum) {
+  if (session == NULL || out_count == NULL || (payload.size > 0U && payload.data == NULL) ||
+      (arena.size > 0U && arena.data == NULL) || (max_packets > 0U && out_packets == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  *out_count = 0U;
+  crisp_stream_layout_t layout;
+  crisp_error_t err = crisp_session_stream_layout(session, payload.size, mtu, &layout);
+  if (err != CRISP_OK || layout.packet_count == 0U) {
+    return err;
+  }
+  if (layout.packet_count > max_packets || layout.arena_size > arena.size) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
+  }
+
+  crisp_seqnum_block_t block;
+  err = crisp_seqnum_allocator_reserve(&session->tx_seqnums, (uint64_t)layout.packet_count,
+                                       &block);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  if (block.end - block.next < (uint64_t)layout.packet_count) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+  if (out_first_seqnum != NULL) {
+    *out_first_seqnum = block.next;
+  }
+
+  crisp_tx_template_t tx;
+  crisp_session_tx_template(session, &tx);
+  const size_t overhead = crisp_session_overhead(session);
+  const size_t stride = layout.segment_size + overhead;
+  uint64_t seqnums[CRISP_PROTECT_BATCH_CHUNK];
+  crisp_const_byte_span_t segments[CRISP_PROTECT_BATCH_CHUNK];
+  size_t sizes[CRISP_PROTECT_BATCH_CHUNK];
+  crisp_error_t status[CRISP_PROTECT_BATCH_CHUNK];
+  for (size_t first = 0U; first < layout.packet_count; first += CRISP_PROTECT_BATCH_CHUNK) {
+    const size_t remaining = layout.packet_count - first;
+    const size_t chunk =
+        remaining < CRISP_PROTECT_BATCH_CHUNK ? remaining : CRISP_PROTECT_BATCH_CHUNK;
+    for (size_t i = 0U; i < chunk; ++i) {
+      const size_t index = first + i;
+      const size_t offset = index * layout.segment_size;
+      const size_t left = payload.size - offset;
+      seqnums[i] = block.next + (uint64_t)index;
+      segments[i].data = payload.data + offset;
+      segments[i].size = left < layout.segment_size ? left : layout.segment_size;
+      out_packets[index].data = arena.data + index * stride;
+      out_packets[index].size = segments[i].size + overhead;
+    }
+    crisp_tx_emit_batch(&tx, seqnums, segments, out_packets + first, sizes, status, chunk);
+    for (size_t i = 0U; i < chunk; ++i) {
+      if (status[i] != CRISP_OK) {
+        return status[i];
+      }
+    }
+  }
+  *out_count = layout.packet_count;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_session_unprotect(crisp_session_t* session,
+                                      crisp_const_byte_span_t packet,
+                                      crisp_mutable_byte_span_t out_plaintext,
+                                      crisp_unprotect_result_t* out_result) {
+  if (session == NULL || out_result == NULL || session->keys.crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (out_plaintext.size > 0U && out_plaintext.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_message_view_t view;
+  const crisp_error_t err = crisp_parse_with_header(packet, session->header, session->header_size,
+                                                    &session->suite_params, &view);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  const crisp_rx_replay_t replay = {
+      .window = session->replay_enabled ? &session->replay_window : NULL,
+      .concurrent = NULL,
+  };
+  return crisp_rx_unprotect_view(&session->keys, &session->cmac_prefix, packet,
+                                 &session->suite_params, &view, &replay, out_plaintext,
+                                 out_result);
+}
+
+crisp_error_t crisp_session_unprotect_in_place(crisp_session_t* session,
+                                               crisp_mutable_byte_span_t packet,
+                                               crisp_const_byte_span_t* out_plaintext,
+                                               crisp_unprotect_result_t* out_result) {
+  if (session == NULL || out_plaintext == NULL || out_result == NULL ||
+      session->keys.crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_message_view_t view;
+  const crisp_const_byte_span_t packet_in = {
+      .data = packet.data,
+      .size = packet.size,
+  };
+  const crisp_error_t err = crisp_parse_with_header(packet_in, session->header,
+                                                    session->header_size,
+                                                    &session->suite_params, &view);
+  if (err != CRISP_OK) {
+    return err;
+  }
+
+  const crisp_rx_replay_t replay = {
+      .window = session->replay_enabled ? &session->replay_window : NULL,
+      .concurrent = NULL,
+  };
+  return crisp_rx_unprotect_in_place(&session->keys, &session->cmac_prefix, packet,
+                                     &session->suite_params, &view, &replay, out_plaintext,
+                                     out_result);
+}
+
+crisp_error_t crisp_session_unprotect_iov(crisp_session_t* session,
+                                          const crisp_const_byte_span_t* packet_iov,
+                                          size_t packet_iovcnt,
+                                          crisp_mutable_byte_span_t out_plaintext,
+                                          crisp_unprotect_result_t* out_result) {
+  if (session == NULL || out_result == NULL || session->keys.crypto == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (out_plaintext.size > 0U && out_plaintext.data == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+
+  crisp_message_view_t view;
+  crisp_suite_params_t suite_params;
+  size_t packet_size = 0U;
+  const crisp_error_t err =
+      crisp_parse_iov(packet_iov, packet_iovcnt, &view, &suite_params, &packet_size);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  /* crisp_parse_iov() guarantees the first segment holds the whole parsed header. */
+  const size_t header_size =
+      packet_size - view.payload.size - view.icv.size - CRISP_MESSAGE_SEQNUM_SIZE;
+  if (header_size != session->header_size ||
+      memcmp(packet_iov[0].data, session->header, header_size) != 0) {
+    return CRISP_ERR_INVALID_FORMAT;
+  }
+
+  const crisp_rx_replay_t replay = {
+      .window = session->replay_enabled ? &session->replay_window : NULL,
+      .concurrent = NULL,
+  };
+  return crisp_rx_unprotect_iov(&session->keys, &session->cmac_prefix, packet_iov,
+                                packet_iovcnt, packet_size, &session->suite_params, &view,
+                                &replay, out_plaintext, out_result);
+}
+
+void crisp_session_clear(crisp_session_t* session) {
+  if (session == NULL) {
+    return;
+  }
+  crisp_keystream_pool_clear(session->keystream_pool);
+  crisp_cmac_prefix_clear(&session->cmac_prefix);
+  crisp_crypto_keys_release(&session->keys);
+  crisp_secure_zero(session, sizeof(*session));
+}
@@ -0,0 +1,175 @@
+#ifndef CRISP_DRIVER_UDP_H_
+#define CRISP_DRIVER_UDP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include "crisp/core/session.h"
+#include "crisp/core/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest number of datagrams one backend call may move. */
+#define CRISP_UDP_MAX_BATCH ((size_t)1024U)
+/** Batch size used when crisp_udp_config_t.batch_size is 0. */
+#define CRISP_UDP_DEFAULT_BATCH ((size_t)32U)
+/** Bytes per datagram buffer: any CRISP packet fits. */
+#define CRISP_UDP_BUFFER_SIZE CRISP_MAX_MESSAGE_SIZE
+/** Required alignment of the storage passed to crisp_udp_driver_init(). */
+#define CRISP_UDP_STORAGE_ALIGN ((size_t)64U)
+
+/** Socket I/O backend behind the driver API. */
+typedef enum crisp_udp_backend {
+  /** recvmmsg()/sendmmsg(): one system call per burst. */
+  CRISP_UDP_BACKEND_MMSG = 0,
+  /**
+   * io_uring: multishot receive into a provided buffer ring and fixed-buffer writes from the
+   * registered transmit buffers. crisp_udp_driver_init() returns CRISP_ERR_NOT_SUPPORTED
+   * where the kernel lacks it or a sandbox blocks it.
+   */
+  CRISP_UDP_BACKEND_IO_URING = 1,
+} crisp_udp_backend_t;
+
+/** Parameters of crisp_udp_driver_init(). */
+typedef struct crisp_udp_config {
+  crisp_udp_backend_t backend;
+  /** Address to bind (IPv4 or IPv6); port 0 lets the kernel pick one. */
+  struct sockaddr_storage local_addr;
+  socklen_t local_addr_len;
+  /** Datagrams per backend call, 1..CRISP_UDP_MAX_BATCH; 0 for CRISP_UDP_DEFAULT_BATCH. */
+  size_t batch_size;
+  /** SO_RCVBUF / SO_SNDBUF in bytes; 0 keeps the system default. */
+  int rcvbuf_size;
+  int sndbuf_size;
+  /** RX wait per burst: negative blocks, 0 polls, positive waits up to this many ms. */
+  int rx_timeout_ms;
+} crisp_udp_config_t;
+
+/** Counters of one datapath stage; `ns` is wall time spent inside the stage. */
+typedef struct crisp_udp_stage_stats {
+  uint64_t batches;
+  uint64_t packets;
+  uint64_t ns;
+} crisp_udp_stage_stats_t;
+
+/**
+ * Per-stage instrumentation, updated once per burst. rx_recv includes time blocked waiting
+ * for the first datagram, so compare it with rx_unprotect only under load. With io_uring,
+ * kernel receive work runs in whichever call enters the ring, so when one thread does TX and
+ * RX it shows up in tx_send rather than rx_recv.
+ */
+typedef struct crisp_udp_stats {
+  crisp_udp_stage_stats_t rx_recv;
+  crisp_udp_stage_stats_t rx_unprotect;
+  crisp_udp_stage_stats_t tx_protect;
+  crisp_udp_stage_stats_t tx_send;
+  uint64_t rx_bytes;
+  uint64_t tx_bytes;
+  /** Datagrams that failed unprotect (including truncated ones). */
+  uint64_t rx_rejected;
+  /** Datagrams larger than CRISP_UDP_BUFFER_SIZE, cut by the kernel. */
+  uint64_t rx_truncated;
+  /** Payloads that failed protect and were not sent. */
+  uint64_t tx_rejected;
+} crisp_udp_stats_t;
+
+struct crisp_udp_backend_ops;
+
+/**
+ * A UDP socket moving CRISP packets in bursts. RX unprotects every datagram in place in its
+ * receive buffer; TX protects a burst into the transmit buffers and sends it with one
+ * backend call. Buffers and backend state live in caller storage sized by
+ * crisp_udp_driver_storage_size(). One thread per driver; use one driver per core.
+ */
+typedef struct crisp_udp_driver {
+  int fd;
+  const struct crisp_udp_backend_ops* ops;
+  size_t batch_size;
+  int rx_timeout_ms;
+  /** batch_size transmit buffers of CRISP_UDP_BUFFER_SIZE bytes. */
+  uint8_t* tx_buffers;
+  /** Backend-specific state and receive buffers, after the transmit buffers. */
+  void* backend_state;
+  /** errno of the last failed system call, for CRISP_ERR_IO diagnostics. */
+  int last_errno;
+  /**
+   * errno that left the kernel holding transmit buffers the driver could not reclaim; once
+   * non-zero every burst fails with CRISP_ERR_IO and the driver can only be closed.
+   */
+  int failed_errno;
+  crisp_udp_stats_t stats;
+} crisp_udp_driver_t;
+
+/** Outcome of one received datagram. */
+typedef struct crisp_udp_rx_packet {
+  /** crisp_session_unprotect_in_place() result; other fields are valid only on CRISP_OK. */
+  crisp_error_t status;
+  /** Plaintext inside the driver's receive buffer, valid until the next RX burst. */
+  crisp_const_byte_span_t plaintext;
+  uint64_t seqnum;
+} crisp_udp_rx_packet_t;
+
+/**
+ * Returns the storage crisp_udp_driver_init() needs for `config` (aligned to
+ * CRISP_UDP_STORAGE_ALIGN), or 0 if the batch size or backend is invalid.
+ */
+size_t crisp_udp_driver_storage_size(const crisp_udp_config_t* config);
+
+/**
+ * Creates, configures and binds the socket and lays out buffers in `storage`.
+ * CRISP_ERR_NOT_SUPPORTED if the backend cannot run on this kernel; CRISP_ERR_IO (with
+ * `last_errno`) if a socket call fails. On error nothing needs to be released.
+ */
+crisp_error_t crisp_udp_driver_init(crisp_udp_driver_t* driver,
+                                    const crisp_udp_config_t* config,
+                                    crisp_mutable_byte_span_t storage);
+
+/** Connects the socket: TX goes to `peer` and RX accepts only its datagrams. */
+crisp_error_t crisp_udp_driver_connect(crisp_udp_driver_t* driver,
+                                       const struct sockaddr* peer,
+                                       socklen_t peer_len);
+
+/** Reports the bound address, e.g. the port the kernel picked. */
+crisp_error_t crisp_udp_driver_local_addr(const crisp_udp_driver_t* driver,
+                                          struct sockaddr_storage* out_addr,
+                                          socklen_t* out_len);
+
+/**
+ * Receives up to min(`max_packets`, batch size) datagrams with one backend call and
+ * unprotects each in place with `session`. `*out_count` is the number of datagrams received,
+ * each with its own status; 0 when the wait timed out. CRISP_ERR_IO only when the backend
+ * call fails or the driver has failed (`failed_errno`).
+ */
+crisp_error_t crisp_udp_driver_rx_burst(crisp_udp_driver_t* driver,
+                                        crisp_session_t* session,
+                                        crisp_udp_rx_packet_t* out_packets,
+                                        size_t max_packets,
+                                        size_t* out_count);
+
+/**
+ * Protects `count` payloads with consecutive SeqNums reserved from `session` as one block and
+ * sends them in batch-size bursts to the connected peer. `out_status` (optional) receives the
+ * protect result per payload; failed payloads are skipped but keep their SeqNum.
+ * `*out_sent` counts datagrams accepted by the kernel. CRISP_ERR_OUT_OF_RANGE if the SeqNum
+ * space cannot cover the whole call; CRISP_ERR_IO if a send fails or the driver has failed
+ * (`failed_errno`), in which case nothing is protected. Other threads may protect on `session`
+ * meanwhile unless it has a keystream pool attached.
+ */
+crisp_error_t crisp_udp_driver_tx_burst(crisp_udp_driver_t* driver,
+                                        crisp_session_t* session,
+                                        const crisp_const_byte_span_t* payloads,
+                                        size_t count,
+                                        crisp_error_t* out_status,
+                                        size_t* out_sent);
+
+/** Closes the socket and releases backend resources. Safe on a zeroed driver. */
+void crisp_udp_driver_close(crisp_udp_driver_t* driver);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_DRIVER_UDP_H_
@@ -0,0 +1,54 @@
+#ifndef CRISP_DRIVER_SRC_UDP_BACKEND_H_
+#define CRISP_DRIVER_SRC_UDP_BACKEND_H_
+
+#include <stddef.h>
+
+#include "crisp/driver/udp.h"
+
+/*
+ * Socket I/O backends of the UDP driver. The driver owns the socket, the transmit buffers,
+ * the crypto stages and the instrumentation; a backend only moves datagrams. Not part of
+ * the public interface.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct crisp_udp_backend_ops {
+  /** Bytes of backend state, receive buffers included, for `batch_size` datagrams. */
+  size_t (*state_size)(size_t batch_size);
+  /** Lays out `driver->backend_state` once the socket is bound. */
+  crisp_error_t (*init)(crisp_udp_driver_t* driver);
+  /**
+   * Receives up to `max` datagrams. `out_datagrams[i]` spans datagram i in backend memory that
+   * stays valid and writable until the next call. Truncated datagrams are reported with size
+   * 0 and counted in `driver->stats.rx_truncated`. A timeout yields CRISP_OK and no datagrams.
+   */
+  crisp_error_t (*recv)(crisp_udp_driver_t* driver,
+                        crisp_mutable_byte_span_t* out_datagrams,
+                        size_t max,
+                        size_t* out_count);
+  /** Sends `count` packets to the connected peer, retrying partial sends. */
+  crisp_error_t (*send)(crisp_udp_driver_t* driver,
+                        const crisp_mutable_byte_span_t* packets,
+                        size_t count,
+                        size_t* out_sent);
+  /** Releases resources taken by init (the socket itself is closed by the driver). */
+  void (*release)(crisp_udp_driver_t* driver);
+};
+
+/** Rounds `size` up to CRISP_UDP_STORAGE_ALIGN so storage regions stay aligned. */
+size_t crisp_udp_align(size_t size);
+
+/** Records a failed system call: keeps errno in `driver->last_errno`, returns CRISP_ERR_IO. */
+crisp_error_t crisp_udp_io_error(crisp_udp_driver_t* driver);
+
+const struct crisp_udp_backend_ops* crisp_udp_mmsg_ops(void);
+const struct crisp_udp_backend_ops* crisp_udp_uring_ops(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CRISP_DRIVER_SRC_UDP_BACKEND_H_
@@ -0,0 +1,312 @@
+#include "crisp/driver/udp.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "udp_backend.h"
+
+size_t crisp_udp_align(size_t size) {
+  return (size + CRISP_UDP_STORAGE_ALIGN - 1U) & ~(CRISP_UDP_STORAGE_ALIGN - 1U);
+}
+
+crisp_error_t crisp_udp_io_error(crisp_udp_driver_t* driver) {
+  driver->last_errno = errno;
+  return CRISP_ERR_IO;
+}
+
+static uint64_t crisp_udp_now_ns(void) {
+  struct timespec now;
+  (void)clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void crisp_udp_stage_add(crisp_udp_stage_stats_t* stage,
+                                size_t packets,
+                                uint64_t start_ns,
+                                uint64_t end_ns) {
+  ++stage->batches;
+  stage->packets += packets;
+  stage->ns += end_ns - start_ns;
+}
+
+static const struct crisp_udp_backend_ops* crisp_udp_backend_ops_for(crisp_udp_backend_t backend) {
+  switch (backend) {
+    case CRISP_UDP_BACKEND_MMSG:
+      return crisp_udp_mmsg_ops();
+    case CRISP_UDP_BACKEND_IO_URING:
+      return crisp_udp_uring_ops();
+    default:
+      return NULL;
+  }
+}
+
+static size_t crisp_udp_batch_size(const crisp_udp_config_t* config) {
+  return config->batch_size == 0U ? CRISP_UDP_DEFAULT_BATCH : config->batch_size;
+}
+
+size_t crisp_udp_driver_storage_size(const crisp_udp_config_t* config) {
+  if (config == NULL) {
+    return 0U;
+  }
+  const struct crisp_udp_backend_ops* ops = crisp_udp_backend_ops_for(config->backend);
+  const size_t batch_size = crisp_udp_batch_size(config);
+  if (ops == NULL || batch_size > CRISP_UDP_MAX_BATCH) {
+    return 0U;
+  }
+  return crisp_udp_align(batch_size * CRISP_UDP_BUFFER_SIZE) +
+         crisp_udp_align(ops->state_size(batch_size));
+}
+
+static bool crisp_udp_addr_valid(const struct sockaddr_storage* addr, socklen_t len) {
+  if (addr->ss_family == AF_INET) {
+    return (size_t)len >= sizeof(struct sockaddr_in);
+  }
+  if (addr->ss_family == AF_INET6) {
+    return (size_t)len >= sizeof(struct sockaddr_in6);
+  }
+  return false;
+}
+
+/* Applies the socket options of `config` and binds; the caller closes the socket on error. */
+static crisp_error_t crisp_udp_setup_socket(crisp_udp_driver_t* driver,
+                                            const crisp_udp_config_t* config) {
+  if (config->rcvbuf_size > 0 &&
+      setsockopt(driver->fd, SOL_SOCKET, SO_RCVBUF, &config->rcvbuf_size,
+                 (socklen_t)sizeof(config->rcvbuf_size)) != 0) {
+    return crisp_udp_io_error(driver);
+  }
+  if (config->sndbuf_size > 0 &&
+      setsockopt(driver->fd, SOL_SOCKET, SO_SNDBUF, &config->sndbuf_size,
+                 (socklen_t)sizeof(config->sndbuf_size)) != 0) {
+    return crisp_udp_io_error(driver);
+  }
+  if (config->rx_timeout_ms > 0) {
+    const struct timeval timeout = {
+        .tv_sec = config->rx_timeout_ms / 1000,
+        .tv_usec = (config->rx_timeout_ms % 1000) * 1000,
+    };
+    if (setsockopt(driver->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, (socklen_t)sizeof(timeout)) !=
+        0) {
+      return crisp_udp_io_error(driver);
+    }
+  }
+  if (bind(driver->fd, (const struct sockaddr*)&config->local_addr, config->local_addr_len) !=
+      0) {
+    return crisp_udp_io_error(driver);
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_udp_driver_init(crisp_udp_driver_t* driver,
+                                    const crisp_udp_config_t* config,
+                                    crisp_mutable_byte_span_t storage) {
+  if (driver == NULL || config == NULL || storage.data == NULL ||
+      ((uintptr_t)storage.data % CRISP_UDP_STORAGE_ALIGN) != 0U) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  const size_t needed = crisp_udp_driver_storage_size(config);
+  if (needed == 0U || !crisp_udp_addr_valid(&config->local_addr, config->local_addr_len)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (storage.size < needed) {
+    return CRISP_ERR_BUFFER_TOO_SMALL;
+  }
+
+  (void)memset(driver, 0, sizeof(*driver));
+  driver->fd = socket(config->local_addr.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (driver->fd < 0) {
+    const crisp_error_t err = crisp_udp_io_error(driver);
+    const int saved_errno = driver->last_errno;
+    (void)memset(driver, 0, sizeof(*driver));
+    driver->last_errno = saved_errno;
+    return err;
+  }
+  const struct crisp_udp_backend_ops* ops = crisp_udp_backend_ops_for(config->backend);
+  driver->batch_size = crisp_udp_batch_size(config);
+  driver->rx_timeout_ms = config->rx_timeout_ms;
+  driver->tx_buffers = storage.data;
+  driver->backend_state =
+      storage.data + crisp_udp_align(driver->batch_size * CRISP_UDP_BUFFER_SIZE);
+
+  crisp_error_t err = crisp_udp_setup_socket(driver, config);
+  if (err == CRISP_OK) {
+    err = ops->init(driver);
+  }
+  if (err != CRISP_OK) {
+    const int saved_errno = driver->last_errno;
+    (void)close(driver->fd);
+    (void)memset(driver, 0, sizeof(*driver));
+    driver->last_errno = saved_errno;
+    return err;
+  }
+  driver->ops = ops;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_udp_driver_connect(crisp_udp_driver_t* driver,
+                                       const struct sockaddr* peer,
+                                       socklen_t peer_len) {
+  if (driver == NULL || driver->ops == NULL || peer == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  if (connect(driver->fd, peer, peer_len) != 0) {
+    return crisp_udp_io_error(driver);
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_udp_driver_local_addr(const crisp_udp_driver_t* driver,
+                                          struct sockaddr_storage* out_addr,
+                                          socklen_t* out_len) {
+  if (driver == NULL || driver->ops == NULL || out_addr == NULL || out_len == NULL) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  *out_len = (socklen_t)sizeof(*out_addr);
+  if (getsockname(driver->fd, (struct sockaddr*)out_addr, out_len) != 0) {
+    return CRISP_ERR_IO;
+  }
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_udp_driver_rx_burst(crisp_udp_driver_t* driver,
+                                        crisp_session_t* session,
+                                        crisp_udp_rx_packet_t* out_packets,
+                                        size_t max_packets,
+                                        size_t* out_count) {
+  if (driver == NULL || driver->ops == NULL || session == NULL || out_count == NULL ||
+      (max_packets > 0U && out_packets == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  *out_count = 0U;
+  if (driver->failed_errno != 0) {
+    driver->last_errno = driver->failed_errno;
+    return CRISP_ERR_IO;
+  }
+  const size_t max = max_packets < driver->batch_size ? max_packets : driver->batch_size;
+  if (max == 0U) {
+    return CRISP_OK;
+  }
+
+  crisp_mutable_byte_span_t datagrams[CRISP_UDP_MAX_BATCH];
+  size_t count = 0U;
+  const uint64_t recv_start = crisp_udp_now_ns();
+  const crisp_error_t err = driver->ops->recv(driver, datagrams, max, &count);
+  const uint64_t recv_end = crisp_udp_now_ns();
+  crisp_udp_stage_add(&driver->stats.rx_recv, count, recv_start, recv_end);
+  if (err != CRISP_OK || count == 0U) {
+    return err;
+  }
+
+  for (size_t i = 0U; i < count; ++i) {
+    crisp_udp_rx_packet_t* packet = &out_packets[i];
+    driver->stats.rx_bytes += datagrams[i].size;
+    packet->plaintext.data = NULL;
+    packet->plaintext.size = 0U;
+    packet->seqnum = 0U;
+    if (datagrams[i].size == 0U) {
+      packet->status = CRISP_ERR_INVALID_SIZE;
+    } else {
+      crisp_unprotect_result_t result;
+      packet->status = crisp_session_unprotect_in_place(session, datagrams[i],
+                                                        &packet->plaintext, &result);
+      if (packet->status == CRISP_OK) {
+        packet->seqnum = result.seqnum;
+      }
+    }
+    if (packet->status != CRISP_OK) {
+      ++driver->stats.rx_rejected;
+    }
+  }
+  crisp_udp_stage_add(&driver->stats.rx_unprotect, count, recv_end, crisp_udp_now_ns());
+  *out_count = count;
+  return CRISP_OK;
+}
+
+crisp_error_t crisp_udp_driver_tx_burst(crisp_udp_driver_t* driver,
+                                        crisp_session_t* session,
+                                        const crisp_const_byte_span_t* payloads,
+                                        size_t count,
+                                        crisp_error_t* out_status,
+                                        size_t* out_sent) {
+  if (driver == NULL || driver->ops == NULL || session == NULL || out_sent == NULL ||
+      (count > 0U && payloads == NULL)) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  *out_sent = 0U;
+  if (driver->failed_errno != 0) {
+    driver->last_errno = driver->failed_errno;
+    return CRISP_ERR_IO;
+  }
+  if (count == 0U) {
+    return CRISP_OK;
+  }
+
+  crisp_seqnum_block_t block;
+  crisp_error_t err = crisp_session_reserve_seqnums(session, (uint64_t)count, &block);
+  if (err != CRISP_OK) {
+    return err;
+  }
+  if (block.end - block.next < (uint64_t)count) {
+    return CRISP_ERR_OUT_OF_RANGE;
+  }
+
+  crisp_mutable_byte_span_t packets[CRISP_UDP_MAX_BATCH];
+  for (size_t first = 0U; first < count; first += driver->batch_size) {
+    const size_t remaining = count - first;
+    const size_t chunk = remaining < driver->batch_size ? remaining : driver->batch_size;
+
+    const uint64_t protect_start = crisp_udp_now_ns();
+    size_t ready = 0U;
+    for (size_t i = 0U; i < chunk; ++i) {
+      const crisp_mutable_byte_span_t buffer = {
+          .data = driver->tx_buffers + ready * CRISP_UDP_BUFFER_SIZE,
+          .size = CRISP_UDP_BUFFER_SIZE,
+      };
+      size_t size = 0U;
+      const crisp_error_t status = crisp_session_protect_seqnum(
+          session, block.next + (uint64_t)(first + i), payloads[first + i], buffer, &size);
+      if (out_status != NULL) {
+        out_status[first + i] = status;
+      }
+      if (status == CRISP_OK) {
+        packets[ready].data = buffer.data;
+        packets[ready].size = size;
+        ++ready;
+      } else {
+        ++driver->stats.tx_rejected;
+      }
+    }
+    const uint64_t send_start = crisp_udp_now_ns();
+    crisp_udp_stage_add(&driver->stats.tx_protect, chunk, protect_start, send_start);
+    if (ready == 0U) {
+      continue;
+    }
+
+    size_t sent = 0U;
+    err = driver->ops->send(driver, packets, ready, &sent);
+    crisp_udp_stage_add(&driver->stats.tx_send, sent, send_start, crisp_udp_now_ns());
+    for (size_t k = 0U; k < sent; ++k) {
+      driver->stats.tx_bytes += packets[k].size;
+    }
+    *out_sent += sent;
+    if (err != CRISP_OK) {
+      return err;
+    }
+  }
+  return CRISP_OK;
+}
+
+void crisp_udp_driver_close(crisp_udp_driver_t* driver) {
+  if (driver == NULL || driver->ops == NULL) {
+    return;
+  }
+  driver->ops->release(driver);
+  (void)close(driver->fd);
+  (void)memset(driver, 0, sizeof(*driver));
+}
@@ -0,0 +1,123 @@
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "udp_backend.h"
+
+/* recvmmsg()/sendmmsg() backend: every array is sized for one batch and set up once. */
+typedef struct crisp_udp_mmsg_state {
+  struct mmsghdr* rx_msgs;
+  struct iovec* rx_iov;
+  struct mmsghdr* tx_msgs;
+  struct iovec* tx_iov;
+  uint8_t* rx_buffers;
+} crisp_udp_mmsg_state_t;
+
+static size_t crisp_udp_mmsg_state_size(size_t batch_size) {
+  return crisp_udp_align(sizeof(crisp_udp_mmsg_state_t)) +
+         2U * crisp_udp_align(batch_size * sizeof(struct mmsghdr)) +
+         2U * crisp_udp_align(batch_size * sizeof(struct iovec)) +
+         batch_size * CRISP_UDP_BUFFER_SIZE;
+}
+
+static crisp_error_t crisp_udp_mmsg_init(crisp_udp_driver_t* driver) {
+  const size_t batch_size = driver->batch_size;
+  uint8_t* cursor = (uint8_t*)driver->backend_state;
+  crisp_udp_mmsg_state_t* state = (crisp_udp_mmsg_state_t*)(void*)cursor;
+  cursor += crisp_udp_align(sizeof(*state));
+  state->rx_msgs = (struct mmsghdr*)(void*)cursor;
+  cursor += crisp_udp_align(batch_size * sizeof(struct mmsghdr));
+  state->tx_msgs = (struct mmsghdr*)(void*)cursor;
+  cursor += crisp_udp_align(batch_size * sizeof(struct mmsghdr));
+  state->rx_iov = (struct iovec*)(void*)cursor;
+  cursor += crisp_udp_align(batch_size * sizeof(struct iovec));
+  state->tx_iov = (struct iovec*)(void*)cursor;
+  cursor += crisp_udp_align(batch_size * sizeof(struct iovec));
+  state->rx_buffers = cursor;
+
+  (void)memset(state->rx_msgs, 0, batch_size * sizeof(struct mmsghdr));
+  (void)memset(state->tx_msgs, 0, batch_size * sizeof(struct mmsghdr));
+  for (size_t i = 0U; i < batch_size; ++i) {
+    state->rx_iov[i].iov_base = state->rx_buffers + i * CRISP_UDP_BUFFER_SIZE;
+    state->rx_iov[i].iov_len = CRISP_UDP_BUFFER_SIZE;
+    state->rx_msgs[i].msg_hdr.msg_iov = &state->rx_iov[i];
+    state->rx_msgs[i].msg_hdr.msg_iovlen = 1U;
+    state->tx_msgs[i].msg_hdr.msg_iov = &state->tx_iov[i];
+    state->tx_msgs[i].msg_hdr.msg_iovlen = 1U;
+  }
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_udp_mmsg_recv(crisp_udp_driver_t* driver,
+                                         crisp_mutable_byte_span_t* out_datagrams,
+                                         size_t max,
+                                         size_t* out_count) {
+  crisp_udp_mmsg_state_t* state = (crisp_udp_mmsg_state_t*)driver->backend_state;
+  *out_count = 0U;
+  /* MSG_WAITFORONE: block (up to SO_RCVTIMEO) for the first datagram, then take what is queued. */
+  const int flags = driver->rx_timeout_ms == 0 ? MSG_DONTWAIT : MSG_WAITFORONE;
+  const int received = recvmmsg(driver->fd, state->rx_msgs, (unsigned int)max, flags, NULL);
+  if (received < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+      return CRISP_OK;
+    }
+    return crisp_udp_io_error(driver);
+  }
+
+  const size_t count = (size_t)received;
+  for (size_t i = 0U; i < count; ++i) {
+    struct mmsghdr* msg = &state->rx_msgs[i];
+    out_datagrams[i].data = state->rx_buffers + i * CRISP_UDP_BUFFER_SIZE;
+    out_datagrams[i].size = (size_t)msg->msg_len;
+    if ((msg->msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+      out_datagrams[i].size = 0U;
+      ++driver->stats.rx_truncated;
+    }
+  }
+  *out_count = count;
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_udp_mmsg_send(crisp_udp_driver_t* driver,
+                                         const crisp_mutable_byte_span_t* packets,
+                                         size_t count,
+                                         size_t* out_sent) {
+  crisp_udp_mmsg_state_t* state = (crisp_udp_mmsg_state_t*)driver->backend_state;
+  for (size_t i = 0U; i < count; ++i) {
+    state->tx_iov[i].iov_base = packets[i].data;
+    state->tx_iov[i].iov_len = packets[i].size;
+  }
+
+  size_t sent = 0U;
+  while (sent < count) {
+    const int result =
+        sendmmsg(driver->fd, state->tx_msgs + sent, (unsigned int)(count - sent), 0);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      *out_sent = sent;
+      return crisp_udp_io_error(driver);
+    }
+    sent += (size_t)result;
+  }
+  *out_sent = sent;
+  return CRISP_OK;
+}
+
+static void crisp_udp_mmsg_release(crisp_udp_driver_t* driver) {
+  (void)driver;
+}
+
+const struct crisp_udp_backend_ops* crisp_udp_mmsg_ops(void) {
+  static const struct crisp_udp_backend_ops ops = {
+      .state_size = crisp_udp_mmsg_state_size,
+      .init = crisp_udp_mmsg_init,
+      .recv = crisp_udp_mmsg_recv,
+      .send = crisp_udp_mmsg_send,
+      .release = crisp_udp_mmsg_release,
+  };
+  return &ops;
+}
@@ -0,0 +1,538 @@
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "udp_backend.h"
+
+/*
+ * io_uring backend on the raw system calls (no liburing dependency).
+ * RX: one multishot IORING_OP_RECVMSG takes buffers from a provided buffer ring, so while the
+ * kernel keeps posting completions a burst is read from the CQ without a system call.
+ * TX: IORING_OP_WRITE_FIXED from the transmit buffers, registered once at init; a burst is one
+ * io_uring_enter() that submits and waits.
+ * Both directions share one CQ: RX completions reaped while waiting for TX go to a stash.
+ */
+
+#define CRISP_UDP_URING_BGID 0U
+#define CRISP_UDP_URING_TAG_RX 1U
+#define CRISP_UDP_URING_TAG_TX 2U
+/* Provided buffers per batch: headroom for datagrams queued while a burst is processed. */
+#define CRISP_UDP_URING_BUFFERS_PER_BATCH 4U
+/* Receive slot: io_uring_recvmsg_out, then the payload (no name or control data asked for). */
+#define CRISP_UDP_URING_SLOT_SIZE (sizeof(struct io_uring_recvmsg_out) + CRISP_UDP_BUFFER_SIZE)
+
+typedef struct crisp_udp_uring_completion {
+  int32_t res;
+  uint32_t flags;
+} crisp_udp_uring_completion_t;
+
+typedef struct crisp_udp_uring_state {
+  int ring_fd;
+  /* SQ and CQ rings (one mapping) and the SQE array, shared with the kernel. */
+  void* ring_mem;
+  size_t ring_mem_size;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+  uint32_t* sq_head;
+  uint32_t* sq_tail;
+  uint32_t* sq_flags;
+  uint32_t sq_mask;
+  uint32_t sq_entries;
+  uint32_t sq_pending;
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t cq_mask;
+  struct io_uring_cqe* cqes;
+  /* Provided buffer ring (its own page-aligned mapping) over the `rx_slots` array. */
+  struct io_uring_buf_ring* buf_ring;
+  size_t buf_ring_size;
+  uint32_t buf_count;
+  uint16_t buf_tail;
+  uint8_t* rx_slots;
+  size_t slot_stride;
+  /* The multishot request reads its msghdr once, at prep time. */
+  struct msghdr rx_msg;
+  bool rx_armed;
+  /* Error completion held back so the datagrams before it are delivered first. */
+  int rx_errno;
+  /* RX completions in CQ order that no recv call has consumed yet. */
+  crisp_udp_uring_completion_t* stash;
+  uint32_t stash_mask;
+  uint32_t stash_head;
+  uint32_t stash_tail;
+  /* Buffers handed out by the last recv call, returned to the ring by the next one. */
+  uint16_t* held_bids;
+  size_t held_count;
+  /* TX completions: outstanding SQEs, and successes / first error of the current send. */
+  size_t tx_inflight;
+  size_t tx_ok;
+  int tx_errno;
+} crisp_udp_uring_state_t;
+
+static uint32_t crisp_udp_uring_pow2(size_t value) {
+  uint32_t result = 1U;
+  while ((size_t)result < value) {
+    result <<= 1U;
+  }
+  return result;
+}
+
+static uint32_t crisp_udp_uring_buffer_count(size_t batch_size) {
+  const uint32_t count = crisp_udp_uring_pow2(batch_size * CRISP_UDP_URING_BUFFERS_PER_BATCH);
+  return count < 8U ? 8U : count;
+}
+
+static size_t crisp_udp_uring_state_size(size_t batch_size) {
+  const size_t buf_count = crisp_udp_uring_buffer_count(batch_size);
+  return crisp_udp_align(sizeof(crisp_udp_uring_state_t)) +
+         buf_count * crisp_udp_align(CRISP_UDP_URING_SLOT_SIZE) +
+         crisp_udp_align(2U * buf_count * sizeof(crisp_udp_uring_completion_t)) +
+         crisp_udp_align(batch_size * sizeof(uint16_t));
+}
+
+static int crisp_udp_uring_enter(crisp_udp_uring_state_t* state,
+                                 uint32_t min_complete,
+                                 int timeout_ms) {
+  unsigned int flags = min_complete > 0U ? IORING_ENTER_GETEVENTS : 0U;
+  struct __kernel_timespec timeout;
+  struct io_uring_getevents_arg arg;
+  const void* arg_ptr = NULL;
+  size_t arg_size = 0U;
+  if (min_complete > 0U && timeout_ms > 0) {
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (long long)(timeout_ms % 1000) * 1000000LL;
+    (void)memset(&arg, 0, sizeof(arg));
+    arg.ts = (uint64_t)(uintptr_t)&timeout;
+    arg_ptr = &arg;
+    arg_size = sizeof(arg);
+    flags |= IORING_ENTER_EXT_ARG;
+  }
+  if (state->sq_pending == 0U && min_complete == 0U) {
+    /* Nothing to submit: only run pending task work so completions get posted. */
+    flags |= IORING_ENTER_GETEVENTS;
+  }
+  const long submitted = syscall(__NR_io_uring_enter, state->ring_fd, state->sq_pending,
+                                 min_complete, flags, arg_ptr, arg_size);
+  if (submitted < 0) {
+    return errno;
+  }
+  state->sq_pending -= (uint32_t)submitted;
+  return 0;
+}
+
+static struct io_uring_sqe* crisp_udp_uring_get_sqe(crisp_udp_uring_state_t* state) {
+  const uint32_t tail = *state->sq_tail;
+  const uint32_t head = __atomic_load_n(state->sq_head, __ATOMIC_ACQUIRE);
+  if (tail - head >= state->sq_entries) {
+    return NULL;
+  }
+  struct io_uring_sqe* sqe = &state->sqes[tail & state->sq_mask];
+  (void)memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+static void crisp_udp_uring_commit_sqe(crisp_udp_uring_state_t* state) {
+  __atomic_store_n(state->sq_tail, *state->sq_tail + 1U, __ATOMIC_RELEASE);
+  ++state->sq_pending;
+}
+
+/* Moves every posted CQE out of the CQ: TX ones into the counters, RX ones into the stash. */
+static void crisp_udp_uring_reap(crisp_udp_uring_state_t* state) {
+  uint32_t head = *state->cq_head;
+  const uint32_t tail = __atomic_load_n(state->cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe* cqe = &state->cqes[head & state->cq_mask];
+    if (cqe->user_data == CRISP_UDP_URING_TAG_TX) {
+      --state->tx_inflight;
+      if (cqe->res >= 0) {
+        ++state->tx_ok;
+      } else if (state->tx_errno == 0) {
+        state->tx_errno = -cqe->res;
+      }
+    } else {
+      crisp_udp_uring_completion_t* slot = &state->stash[state->stash_tail & state->stash_mask];
+      slot->res = cqe->res;
+      slot->flags = cqe->flags;
+      ++state->stash_tail;
+    }
+  }
+  __atomic_store_n(state->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void crisp_udp_uring_provide(crisp_udp_uring_state_t* state, uint16_t bid) {
+  struct io_uring_buf* buf = &state->buf_ring->bufs[state->buf_tail & (state->buf_count - 1U)];
+  buf->addr = (uint64_t)(uintptr_t)(state->rx_slots + (size_t)bid * state->slot_stride);
+  buf->len = (uint32_t)CRISP_UDP_URING_SLOT_SIZE;
+  buf->bid = bid;
+  ++state->buf_tail;
+}
+
+static void crisp_udp_uring_publish(crisp_udp_uring_state_t* state) {
+  __atomic_store_n(&state->buf_ring->tail, state->buf_tail, __ATOMIC_RELEASE);
+}
+
+static void crisp_udp_uring_release(crisp_udp_driver_t* driver) {
+  crisp_udp_uring_state_t* state = (crisp_udp_uring_state_t*)driver->backend_state;
+  /* The kernel keeps the registered and provided buffer pages pinned until the ring dies. */
+  if (state->ring_fd >= 0) {
+    (void)close(state->ring_fd);
+  }
+  if (state->buf_ring != NULL) {
+    (void)munmap(state->buf_ring, state->buf_ring_size);
+  }
+  if (state->sqes != NULL) {
+    (void)munmap(state->sqes, state->sqes_size);
+  }
+  if (state->ring_mem != NULL) {
+    (void)munmap(state->ring_mem, state->ring_mem_size);
+  }
+  state->ring_fd = -1;
+  state->buf_ring = NULL;
+  state->sqes = NULL;
+  state->ring_mem = NULL;
+}
+
+/* Setup failures that mean "no usable io_uring here" rather than a broken socket. */
+static crisp_error_t crisp_udp_uring_setup_error(crisp_udp_driver_t* driver) {
+  const int err = errno;
+  driver->last_errno = err;
+  if (err == ENOSYS || err == EPERM || err == EINVAL || err == EOPNOTSUPP) {
+    return CRISP_ERR_NOT_SUPPORTED;
+  }
+  return CRISP_ERR_IO;
+}
+
+static crisp_error_t crisp_udp_uring_map(crisp_udp_uring_state_t* state,
+                                         const struct io_uring_params* params) {
+  const size_t sq_size = params->sq_off.array + params->sq_entries * sizeof(uint32_t);
+  const size_t cq_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+  state->ring_mem_size = sq_size > cq_size ? sq_size : cq_size;
+  void* ring_mem = mmap(NULL, state->ring_mem_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, state->ring_fd, (off_t)IORING_OFF_SQ_RING);
+  if (ring_mem == MAP_FAILED) {
+    return CRISP_ERR_IO;
+  }
+  state->ring_mem = ring_mem;
+  state->sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(NULL, state->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    state->ring_fd, (off_t)IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return CRISP_ERR_IO;
+  }
+  state->sqes = (struct io_uring_sqe*)sqes;
+
+  uint8_t* base = (uint8_t*)ring_mem;
+  state->sq_head = (uint32_t*)(void*)(base + params->sq_off.head);
+  state->sq_tail = (uint32_t*)(void*)(base + params->sq_off.tail);
+  state->sq_flags = (uint32_t*)(void*)(base + params->sq_off.flags);
+  state->sq_mask = *(const uint32_t*)(const void*)(base + params->sq_off.ring_mask);
+  state->sq_entries = params->sq_entries;
+  state->cq_head = (uint32_t*)(void*)(base + params->cq_off.head);
+  state->cq_tail = (uint32_t*)(void*)(base + params->cq_off.tail);
+  state->cq_mask = *(const uint32_t*)(const void*)(base + params->cq_off.ring_mask);
+  state->cqes = (struct io_uring_cqe*)(void*)(base + params->cq_off.cqes);
+  uint32_t* sq_array = (uint32_t*)(void*)(base + params->sq_off.array);
+  for (uint32_t i = 0U; i < params->sq_entries; ++i) {
+    sq_array[i] = i;
+  }
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_udp_uring_register(crisp_udp_driver_t* driver,
+                                              crisp_udp_uring_state_t* state) {
+  const struct iovec tx_region = {
+      .iov_base = driver->tx_buffers,
+      .iov_len = driver->batch_size * CRISP_UDP_BUFFER_SIZE,
+  };
+  if (syscall(__NR_io_uring_register, state->ring_fd, IORING_REGISTER_BUFFERS, &tx_region, 1U) <
+      0) {
+    return crisp_udp_uring_setup_error(driver);
+  }
+
+  /* The buffer ring must be page-aligned, which caller storage does not promise. */
+  state->buf_ring_size = state->buf_count * sizeof(struct io_uring_buf);
+  void* buf_ring = mmap(NULL, state->buf_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  if (buf_ring == MAP_FAILED) {
+    return crisp_udp_io_error(driver);
+  }
+  state->buf_ring = (struct io_uring_buf_ring*)buf_ring;
+  struct io_uring_buf_reg reg;
+  (void)memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = (uint64_t)(uintptr_t)buf_ring;
+  reg.ring_entries = state->buf_count;
+  reg.bgid = CRISP_UDP_URING_BGID;
+  if (syscall(__NR_io_uring_register, state->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1U) < 0) {
+    return crisp_udp_uring_setup_error(driver);
+  }
+  for (uint32_t bid = 0U; bid < state->buf_count; ++bid) {
+    crisp_udp_uring_provide(state, (uint16_t)bid);
+  }
+  crisp_udp_uring_publish(state);
+  return CRISP_OK;
+}
+
+/* Queues the multishot receive; it stays armed while completions carry IORING_CQE_F_MORE. */
+static void crisp_udp_uring_arm_rx(crisp_udp_driver_t* driver, crisp_udp_uring_state_t* state) {
+  struct io_uring_sqe* sqe = crisp_udp_uring_get_sqe(state);
+  if (sqe == NULL) {
+    return;
+  }
+  sqe->opcode = IORING_OP_RECVMSG;
+  sqe->fd = driver->fd;
+  sqe->addr = (uint64_t)(uintptr_t)&state->rx_msg;
+  sqe->len = 1U;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = CRISP_UDP_URING_BGID;
+  sqe->user_data = CRISP_UDP_URING_TAG_RX;
+  crisp_udp_uring_commit_sqe(state);
+  state->rx_armed = true;
+}
+
+/*
+ * Arms the receive at init so a kernel with provided buffer rings but without multishot
+ * IORING_OP_RECVMSG (5.19) is refused here: it fails the request at prep with -EINVAL.
+ */
+static crisp_error_t crisp_udp_uring_start_rx(crisp_udp_driver_t* driver,
+                                              crisp_udp_uring_state_t* state) {
+  crisp_udp_uring_arm_rx(driver, state);
+  const int err = crisp_udp_uring_enter(state, 0U, 0);
+  if (err != 0) {
+    errno = err;
+    return crisp_udp_uring_setup_error(driver);
+  }
+  crisp_udp_uring_reap(state);
+  for (uint32_t i = state->stash_head; i != state->stash_tail; ++i) {
+    if (state->stash[i & state->stash_mask].res == -EINVAL) {
+      driver->last_errno = EINVAL;
+      return CRISP_ERR_NOT_SUPPORTED;
+    }
+  }
+  return CRISP_OK;
+}
+
+static crisp_error_t crisp_udp_uring_init(crisp_udp_driver_t* driver) {
+  const size_t batch_size = driver->batch_size;
+  uint8_t* cursor = (uint8_t*)driver->backend_state;
+  crisp_udp_uring_state_t* state = (crisp_udp_uring_state_t*)(void*)cursor;
+  (void)memset(state, 0, sizeof(*state));
+  state->ring_fd = -1;
+  state->buf_count = crisp_udp_uring_buffer_count(batch_size);
+  state->slot_stride = crisp_udp_align(CRISP_UDP_URING_SLOT_SIZE);
+  cursor += crisp_udp_align(sizeof(*state));
+  state->rx_slots = cursor;
+  cursor += state->buf_count * state->slot_stride;
+  state->stash = (crisp_udp_uring_completion_t*)(void*)cursor;
+  state->stash_mask = 2U * state->buf_count - 1U;
+  cursor += crisp_udp_align(2U * state->buf_count * sizeof(crisp_udp_uring_completion_t));
+  state->held_bids = (uint16_t*)(void*)cursor;
+
+  /* CQ room for every provided buffer plus a TX burst, so the CQ does not overflow. */
+  struct io_uring_params params;
+  (void)memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG;
+  params.cq_entries = 2U * (state->buf_count + (uint32_t)batch_size);
+  const long ring_fd = syscall(__NR_io_uring_setup, (uint32_t)batch_size + 1U, &params);
+  if (ring_fd < 0) {
+    return crisp_udp_uring_setup_error(driver);
+  }
+  state->ring_fd = (int)ring_fd;
+
+  crisp_error_t err = CRISP_OK;
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0U ||
+      (params.features & IORING_FEAT_EXT_ARG) == 0U) {
+    err = CRISP_ERR_NOT_SUPPORTED;
+  }
+  if (err == CRISP_OK && crisp_udp_uring_map(state, &params) != CRISP_OK) {
+    err = crisp_udp_io_error(driver);
+  }
+  if (err == CRISP_OK) {
+    err = crisp_udp_uring_register(driver, state);
+  }
+  if (err == CRISP_OK) {
+    err = crisp_udp_uring_start_rx(driver, state);
+  }
+  if (err != CRISP_OK) {
+    crisp_udp_uring_release(driver);
+  }
+  return err;
+}
+
+/* Turns stashed completions into datagrams; stops early on a held-back error. */
+static size_t crisp_udp_uring_take(crisp_udp_driver_t* driver,
+                                   crisp_udp_uring_state_t* state,
+                                   crisp_mutable_byte_span_t* out_datagrams,
+                                   size_t max) {
+  size_t count = 0U;
+  while (count < max && state->stash_head != state->stash_tail) {
+    const crisp_udp_uring_completion_t completion =
+        state->stash[state->stash_head & state->stash_mask];
+    ++state->stash_head;
+    if ((completion.flags & IORING_CQE_F_MORE) == 0U) {
+      state->rx_armed = false;
+    }
+    if (completion.res < 0) {
+      /* ENOBUFS only ends the multishot request; it is re-armed once buffers return. */
+      if (completion.res != -ENOBUFS) {
+        state->rx_errno = -completion.res;
+        break;
+      }
+      continue;
+    }
+    if ((completion.flags & IORING_CQE_F_BUFFER) == 0U) {
+      continue;
+    }
+    const uint16_t bid = (uint16_t)(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+    state->held_bids[state->held_count++] = bid;
+    uint8_t* slot = state->rx_slots + (size_t)bid * state->slot_stride;
+    const struct io_uring_recvmsg_out* header = (const struct io_uring_recvmsg_out*)(void*)slot;
+    out_datagrams[count].data = slot + sizeof(*header);
+    out_datagrams[count].size = header->payloadlen;
+    if ((header->flags & (uint32_t)MSG_TRUNC) != 0U) {
+      out_datagrams[count].size = 0U;
+      ++driver->stats.rx_truncated;
+    }
+    ++count;
+  }
+  return count;
+}
+
+static crisp_error_t crisp_udp_uring_recv(crisp_udp_driver_t* driver,
+                                          crisp_mutable_byte_span_t* out_datagrams,
+                                          size_t max,
+                                          size_t* out_count) {
+  crisp_udp_uring_state_t* state = (crisp_udp_uring_state_t*)driver->backend_state;
+  *out_count = 0U;
+  for (size_t i = 0U; i < state->held_count; ++i) {
+    crisp_udp_uring_provide(state, state->held_bids[i]);
+  }
+  if (state->held_count > 0U) {
+    crisp_udp_uring_publish(state);
+    state->held_count = 0U;
+  }
+
+  /* Second round only when the request ended (e.g. ENOBUFS) before anything was delivered. */
+  for (int round = 0; round < 2; ++round) {
+    if (state->rx_errno != 0) {
+      errno = state->rx_errno;
+      state->rx_errno = 0;
+      return crisp_udp_io_error(driver);
+    }
+    if (!state->rx_armed) {
+      crisp_udp_uring_arm_rx(driver, state);
+    }
+    crisp_udp_uring_reap(state);
+    if (state->stash_head == state->stash_tail) {
+      const bool wait = driver->rx_timeout_ms != 0;
+      const bool task_work =
+          (__atomic_load_n(state->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_TASKRUN) != 0U;
+      if (wait || task_work || state->sq_pending > 0U) {
+        const int err = crisp_udp_uring_enter(state, wait ? 1U : 0U, driver->rx_timeout_ms);
+        if (err != 0 && err != EINTR && err != ETIME && err != EAGAIN && err != EBUSY) {
+          errno = err;
+          return crisp_udp_io_error(driver);
+        }
+        crisp_udp_uring_reap(state);
+      }
+    }
+    *out_count = crisp_udp_uring_take(driver, state, out_datagrams, max);
+    if (*out_count > 0U || state->rx_armed || state->rx_errno != 0) {
+      break;
+    }
+  }
+  return CRISP_OK;
+}
+
+static bool crisp_udp_uring_registered(const crisp_udp_driver_t* driver,
+                                       const crisp_mutable_byte_span_t* packet) {
+  const uint8_t* begin = driver->tx_buffers;
+  const uint8_t* end = begin + driver->batch_size * CRISP_UDP_BUFFER_SIZE;
+  return packet->data >= begin && packet->size <= (size_t)(end - packet->data);
+}
+
+/*
+ * io_uring_enter() failed with `err` while writes may be queued or in flight. They read the
+ * transmit buffers, so keep reaping until none is left; if the ring cannot even do that, the
+ * driver is marked failed so no later burst rewrites buffers the kernel may still read.
+ */
+static crisp_error_t crisp_udp_uring_send_failed(crisp_udp_driver_t* driver,
+                                                 crisp_udp_uring_state_t* state,
+                                                 int err,
+                                                 size_t* out_sent) {
+  while (state->tx_inflight > 0U) {
+    const int drain_err = crisp_udp_uring_enter(state, (uint32_t)state->tx_inflight, -1);
+    if (drain_err != 0 && drain_err != EINTR && drain_err != EAGAIN && drain_err != EBUSY) {
+      driver->failed_errno = drain_err;
+      break;
+    }
+    crisp_udp_uring_reap(state);
+  }
+  *out_sent = state->tx_ok;
+  errno = err;
+  return crisp_udp_io_error(driver);
+}
+
+static crisp_error_t crisp_udp_uring_send(crisp_udp_driver_t* driver,
+                                          const crisp_mutable_byte_span_t* packets,
+                                          size_t count,
+                                          size_t* out_sent) {
+  crisp_udp_uring_state_t* state = (crisp_udp_uring_state_t*)driver->backend_state;
+  state->tx_ok = 0U;
+  state->tx_errno = 0;
+  for (size_t i = 0U; i < count; ++i) {
+    struct io_uring_sqe* sqe = crisp_udp_uring_get_sqe(state);
+    while (sqe == NULL) {
+      /* SQ full: submit what is queued, wait for a TX completion if any, then retry the slot. */
+      const int err = crisp_udp_uring_enter(state, state->tx_inflight > 0U ? 1U : 0U, -1);
+      if (err != 0 && err != EINTR && err != EAGAIN && err != EBUSY) {
+        return crisp_udp_uring_send_failed(driver, state, err, out_sent);
+      }
+      crisp_udp_uring_reap(state);
+      sqe = crisp_udp_uring_get_sqe(state);
+    }
+    /* A write on a connected UDP socket is one datagram; fixed buffers skip the page walk. */
+    sqe->opcode = crisp_udp_uring_registered(driver, &packets[i]) ? IORING_OP_WRITE_FIXED
+                                                                  : IORING_OP_SEND;
+    sqe->fd = driver->fd;
+    sqe->addr = (uint64_t)(uintptr_t)packets[i].data;
+    sqe->len = (uint32_t)packets[i].size;
+    sqe->buf_index = 0U;
+    sqe->user_data = CRISP_UDP_URING_TAG_TX;
+    crisp_udp_uring_commit_sqe(state);
+    ++state->tx_inflight;
+  }
+
+  while (state->tx_inflight > 0U) {
+    const int err = crisp_udp_uring_enter(state, (uint32_t)state->tx_inflight, -1);
+    if (err != 0 && err != EINTR && err != EAGAIN && err != EBUSY) {
+      return crisp_udp_uring_send_failed(driver, state, err, out_sent);
+    }
+    crisp_udp_uring_reap(state);
+  }
+  *out_sent = state->tx_ok;
+  if (state->tx_errno != 0) {
+    errno = state->tx_errno;
+    return crisp_udp_io_error(driver);
+  }
+  return CRISP_OK;
+}
+
+const struct crisp_udp_backend_ops* crisp_udp_uring_ops(void) {
+  static const struct crisp_udp_backend_ops ops = {
+      .state_size = crisp_udp_uring_state_size,
+      .init = crisp_udp_uring_init,
+      .recv = crisp_udp_uring_recv,
+      .send = crisp_udp_uring_send,
+      .release = crisp_udp_uring_release,
+  };
+  return &ops;
+}
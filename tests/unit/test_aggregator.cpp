@@ -0,0 +1,208 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/aggregator.h"
+}
+
+#include "test_util.h"
+
+namespace {
+
+struct Emitted {
+  std::vector<std::vector<uint8_t>> packets;
+  std::vector<uint64_t> seqnums;
+  crisp_error_t result = CRISP_OK;
+};
+
+crisp_error_t collect(void* user_ctx, crisp_const_byte_span_t packet, uint64_t seqnum) {
+  auto* emitted = static_cast<Emitted*>(user_ctx);
+  emitted->packets.emplace_back(packet.data, packet.data + packet.size);
+  emitted->seqnums.push_back(seqnum);
+  return emitted->result;
+}
+
+struct AggregatorFixture : crisp_test::SessionPair {
+  Emitted emitted;
+  crisp_aggregator_config_t config{};
+
+  AggregatorFixture() : SessionPair(7U, 64U, {0x2AU}) {
+    config.session = &tx;
+    config.emit = collect;
+    config.user_ctx = &emitted;
+  }
+
+  /** Unprotects every emitted packet in place and splits it into messages. */
+  std::vector<std::vector<uint8_t>> receive() {
+    std::vector<std::vector<uint8_t>> messages;
+    for (std::vector<uint8_t>& packet : emitted.packets) {
+      crisp_const_byte_span_t plaintext{};
+      crisp_unprotect_result_t result{};
+      REQUIRE(crisp_session_unprotect_in_place(&rx, {packet.data(), packet.size()}, &plaintext,
+                                               &result) == CRISP_OK);
+      std::array<crisp_const_byte_span_t, CRISP_MAX_MESSAGE_SIZE> split{};
+      size_t count = 0U;
+      REQUIRE(crisp_aggregate_split(plaintext, split.data(), split.size(), &count) == CRISP_OK);
+      REQUIRE(count > 0U);
+      for (size_t i = 0U; i < count; ++i) {
+        // Zero-copy: every message lies inside the decrypted packet.
+        CHECK(split[i].data >= plaintext.data);
+        CHECK(split[i].data + split[i].size <= plaintext.data + plaintext.size);
+        messages.emplace_back(split[i].data, split[i].data + split[i].size);
+      }
+    }
+    return messages;
+  }
+};
+
+}  // namespace
+
+TEST_CASE("Aggregator packs small messages and RX splits them back", "[aggregator]") {
+  AggregatorFixture fixture;
+  fixture.config.max_packet_size = 512U;
+  crisp_aggregator_t aggregator{};
+  REQUIRE(crisp_aggregator_init(&aggregator, &fixture.config) == CRISP_OK);
+  const size_t overhead =
+      crisp_session_headroom(&fixture.tx) + fixture.tx.suite_params.icv_size;
+  CHECK(aggregator.capacity == 512U - overhead);
+
+  std::vector<std::vector<uint8_t>> sent;
+  for (size_t i = 0U; i < 200U; ++i) {
+    const size_t size = i == 50U ? 300U : (i == 51U ? 0U : 20U + (i * 7U) % 41U);
+    std::vector<uint8_t> message(size);
+    for (size_t k = 0U; k < size; ++k) {
+      message[k] = static_cast<uint8_t>(i + k * 31U);
+    }
+    REQUIRE(crisp_aggregator_push(&aggregator, {message.data(), message.size()}, i) ==
+            CRISP_OK);
+    sent.push_back(message);
+  }
+  // No timeout configured: polling never sends, only the threshold and flush do.
+  const size_t before_flush = fixture.emitted.packets.size();
+  REQUIRE(crisp_aggregator_poll(&aggregator, ~0ULL) == CRISP_OK);
+  CHECK(fixture.emitted.packets.size() == before_flush);
+  REQUIRE(crisp_aggregator_flush(&aggregator) == CRISP_OK);
+  CHECK(aggregator.pending_count == 0U);
+  CHECK(crisp_aggregator_flush(&aggregator) == CRISP_OK);
+
+  // About ten messages per packet, every packet within the limit, SeqNums consecutive.
+  REQUIRE(fixture.emitted.packets.size() > 10U);
+  CHECK(fixture.emitted.packets.size() < 30U);
+  for (size_t i = 0U; i < fixture.emitted.packets.size(); ++i) {
+    CHECK(fixture.emitted.packets[i].size() <= 512U);
+    CHECK(fixture.emitted.seqnums[i] == 7U + i);
+  }
+  CHECK(fixture.receive() == sent);
+  crisp_aggregator_clear(&aggregator);
+}
+
+TEST_CASE("Aggregator flushes on threshold and timeout", "[aggregator]") {
+  AggregatorFixture fixture;
+  fixture.config.flush_threshold = 100U;
+  fixture.config.flush_timeout = 10U;
+  crisp_aggregator_t aggregator{};
+  REQUIRE(crisp_aggregator_init(&aggregator, &fixture.config) == CRISP_OK);
+
+  const std::vector<uint8_t> message(40U, 0x11U);
+  REQUIRE(crisp_aggregator_push(&aggregator, {message.data(), message.size()}, 0U) == CRISP_OK);
+  REQUIRE(crisp_aggregator_push(&aggregator, {message.data(), message.size()}, 1U) == CRISP_OK);
+  CHECK(fixture.emitted.packets.empty());
+  // The third frame brings the payload to 123 bytes, past the threshold.
+  REQUIRE(crisp_aggregator_push(&aggregator, {message.data(), message.size()}, 2U) == CRISP_OK);
+  CHECK(fixture.emitted.packets.size() == 1U);
+  CHECK(aggregator.pending_count == 0U);
+
+  REQUIRE(crisp_aggregator_push(&aggregator, {message.data(), message.size()}, 20U) == CRISP_OK);
+  REQUIRE(crisp_aggregator_poll(&aggregator, 29U) == CRISP_OK);
+  CHECK(fixture.emitted.packets.size() == 1U);
+  REQUIRE(crisp_aggregator_poll(&aggregator, 30U) == CRISP_OK);
+  CHECK(fixture.emitted.packets.size() == 2U);
+  REQUIRE(crisp_aggregator_poll(&aggregator, 100U) == CRISP_OK);
+  CHECK(fixture.emitted.packets.size() == 2U);
+
+  // A push after the timeout sends the stale packet before starting a new one.
+  REQUIRE(crisp_aggregator_push(&aggregator, {message.data(), message.size()}, 40U) == CRISP_OK);
+  REQUIRE(crisp_aggregator_push(&aggregator, {message.data(), message.size()}, 55U) == CRISP_OK);
+  CHECK(fixture.emitted.packets.size() == 3U);
+  CHECK(aggregator.pending_count == 1U);
+  CHECK(aggregator.pending_since == 55U);
+  REQUIRE(crisp_aggregator_flush(&aggregator) == CRISP_OK);
+
+  const std::vector<std::vector<uint8_t>> received = fixture.receive();
+  CHECK(received.size() == 6U);
+  crisp_aggregator_clear(&aggregator);
+}
+
+TEST_CASE("Aggregator rejects oversize messages and reports emit errors", "[aggregator]") {
+  AggregatorFixture fixture;
+  fixture.config.max_packet_size = 256U;
+  crisp_aggregator_t aggregator{};
+  REQUIRE(crisp_aggregator_init(&aggregator, &fixture.config) == CRISP_OK);
+
+  const std::vector<uint8_t> fits(aggregator.capacity - 2U, 0x22U);
+  const std::vector<uint8_t> too_big(aggregator.capacity - 1U, 0x33U);
+  CHECK(crisp_aggregator_push(&aggregator, {too_big.data(), too_big.size()}, 0U) ==
+        CRISP_ERR_INVALID_SIZE);
+  CHECK(fixture.emitted.packets.empty());
+  CHECK(crisp_aggregator_push(&aggregator, {nullptr, 1U}, 0U) == CRISP_ERR_INVALID_ARGUMENT);
+  REQUIRE(crisp_aggregator_push(&aggregator, {fits.data(), fits.size()}, 0U) == CRISP_OK);
+  CHECK(fixture.emitted.packets.size() == 1U);
+  CHECK(fixture.emitted.packets[0].size() == 256U);
+
+  // A failing emit drops the packet but keeps its SeqNum consumed.
+  fixture.emitted.result = CRISP_ERR_BUFFER_TOO_SMALL;
+  const std::array<uint8_t, 4> small{1U, 2U, 3U, 4U};
+  REQUIRE(crisp_aggregator_push(&aggregator, {small.data(), small.size()}, 1U) == CRISP_OK);
+  CHECK(crisp_aggregator_flush(&aggregator) == CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(aggregator.pending_count == 0U);
+  CHECK(fixture.emitted.seqnums.back() == 8U);
+  CHECK(fixture.tx.tx_seqnums.next == 9U);
+
+  fixture.config.max_packet_size =
+      crisp_session_headroom(&fixture.tx) + fixture.tx.suite_params.icv_size;
+  CHECK(crisp_aggregator_init(&aggregator, &fixture.config) == CRISP_ERR_INVALID_SIZE);
+  fixture.config.emit = nullptr;
+  CHECK(crisp_aggregator_init(&aggregator, &fixture.config) == CRISP_ERR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("Aggregate split validates the framing", "[aggregator]") {
+  std::array<crisp_const_byte_span_t, 4> messages{};
+  size_t count = 9U;
+
+  const std::vector<uint8_t> valid = {0x02U, 0xAAU, 0xBBU, 0x00U, 0x80U, 0x80U};
+  std::vector<uint8_t> long_frame = valid;
+  long_frame.resize(long_frame.size() + 0x80U, 0xCCU);
+  REQUIRE(crisp_aggregate_split({long_frame.data(), long_frame.size()}, messages.data(),
+                                messages.size(), &count) == CRISP_OK);
+  REQUIRE(count == 3U);
+  CHECK(messages[0].data == long_frame.data() + 1U);
+  CHECK(messages[0].size == 2U);
+  CHECK(messages[1].size == 0U);
+  CHECK(messages[2].data == long_frame.data() + 6U);
+  CHECK(messages[2].size == 0x80U);
+  CHECK(crisp_aggregate_frame_size(0x7FU) == 0x80U);
+  CHECK(crisp_aggregate_frame_size(0x80U) == 0x82U);
+
+  const std::vector<std::vector<uint8_t>> malformed = {
+      {0x03U, 0xAAU, 0xBBU},  // runs past the payload
+      {0x01U, 0xAAU, 0x81U},  // truncated two-byte prefix
+      {0x80U, 0x05U, 0x01U, 0x02U, 0x03U, 0x04U, 0x05U},  // non-canonical length
+  };
+  for (const std::vector<uint8_t>& payload : malformed) {
+    count = 9U;
+    CHECK(crisp_aggregate_split({payload.data(), payload.size()}, messages.data(),
+                                messages.size(), &count) == CRISP_ERR_INVALID_FORMAT);
+    CHECK(count == 0U);
+  }
+
+  const std::vector<uint8_t> many(5U, 0x00U);
+  CHECK(crisp_aggregate_split({many.data(), many.size()}, messages.data(), messages.size(),
+                              &count) == CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(crisp_aggregate_split({nullptr, 0U}, nullptr, 0U, &count) == CRISP_OK);
+  CHECK(count == 0U);
+  CHECK(crisp_aggregate_split({nullptr, 1U}, messages.data(), messages.size(), &count) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+}
@@ -0,0 +1,180 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/classify.h"
+#include "crisp/core/message.h"
+}
+
+namespace {
+
+std::vector<uint8_t> make_packet(std::mt19937& rng) {
+  static const std::vector<uint8_t> key_id_bytes = {0x00U, 0x05U, 0x7FU, 0x80U, 0x80U,
+                                                    0x81U, 0x83U, 0x8FU, 0xFFU};
+  std::vector<uint8_t> packet;
+  packet.push_back(static_cast<uint8_t>((rng() % 2U) != 0U ? 0x80U : 0x00U));
+  packet.push_back(0x00U);
+  packet.push_back(static_cast<uint8_t>(rng() % 6U));
+  const uint8_t first = key_id_bytes[rng() % key_id_bytes.size()];
+  packet.push_back(first);
+  if (first > 0x80U) {
+    for (uint32_t i = 0; i < (first & 0x7FU); ++i) {
+      packet.push_back(static_cast<uint8_t>(rng()));
+    }
+  }
+  const size_t tail = rng() % 4U == 0U ? rng() % 20U : 6U + rng() % 64U;
+  for (size_t i = 0; i < tail; ++i) {
+    packet.push_back(static_cast<uint8_t>(rng()));
+  }
+  // Occasionally corrupt one header byte or pad past the size limit.
+  if (rng() % 8U == 0U) {
+    packet[rng() % packet.size()] = static_cast<uint8_t>(rng());
+  }
+  if (rng() % 64U == 0U) {
+    packet.resize(CRISP_MAX_MESSAGE_SIZE + rng() % 2U);
+  }
+  return packet;
+}
+
+struct Outputs {
+  explicit Outputs(size_t count)
+      : status(count, CRISP_ERR_NOT_SUPPORTED),
+        cs(count, 0xEEU),
+        flags(count, 0xEEU),
+        seqnum(count, ~0ULL),
+        key_id_offset(count, 0xEEEEU),
+        key_id_size(count, 0xEEEEU),
+        payload_offset(count, 0xEEEEU),
+        payload_size(count, 0xEEEEU) {}
+
+  crisp_classify_batch_out_t out() {
+    return {status.data(),        cs.data(),          flags.data(),
+            seqnum.data(),        key_id_offset.data(), key_id_size.data(),
+            payload_offset.data(), payload_size.data()};
+  }
+
+  std::vector<crisp_error_t> status;
+  std::vector<uint8_t> cs;
+  std::vector<uint8_t> flags;
+  std::vector<uint64_t> seqnum;
+  std::vector<uint16_t> key_id_offset;
+  std::vector<uint16_t> key_id_size;
+  std::vector<uint16_t> payload_offset;
+  std::vector<uint16_t> payload_size;
+};
+
+void check_matches_parse(const crisp_const_byte_span_t& packet, Outputs& outputs, size_t i) {
+  crisp_message_view_t view{};
+  const crisp_error_t expected = crisp_parse_message(packet, &view);
+  REQUIRE(outputs.status[i] == expected);
+  if (expected != CRISP_OK) {
+    CHECK(outputs.cs[i] == 0U);
+    CHECK(outputs.flags[i] == 0U);
+    CHECK(outputs.seqnum[i] == 0U);
+    CHECK(outputs.payload_size[i] == 0U);
+    return;
+  }
+  CHECK(outputs.cs[i] == view.cs);
+  CHECK(((outputs.flags[i] & CRISP_CLASSIFY_FLAG_EXTERNAL_KEY_ID) != 0U) ==
+        view.external_key_id_flag);
+  CHECK(((outputs.flags[i] & CRISP_CLASSIFY_FLAG_KEY_ID_PRESENT) != 0U) == view.key_id_present);
+  CHECK(outputs.seqnum[i] == view.seqnum);
+  if (view.key_id_present) {
+    CHECK(packet.data + outputs.key_id_offset[i] == view.key_id.data);
+  } else {
+    CHECK(outputs.key_id_offset[i] == 0U);
+  }
+  CHECK(outputs.key_id_size[i] == view.key_id.size);
+  CHECK(packet.data + outputs.payload_offset[i] == view.payload.data);
+  CHECK(outputs.payload_size[i] == view.payload.size);
+}
+
+}  // namespace
+
+TEST_CASE("Batch classifier matches crisp_parse_message", "[classify]") {
+  std::mt19937 rng(2024U);
+  for (int round = 0; round < 200; ++round) {
+    const size_t count = 1U + rng() % 37U;
+    std::vector<std::vector<uint8_t>> storage;
+    std::vector<crisp_const_byte_span_t> packets;
+    for (size_t i = 0; i < count; ++i) {
+      storage.push_back(make_packet(rng));
+    }
+    for (const std::vector<uint8_t>& packet : storage) {
+      packets.push_back({packet.data(), packet.size()});
+    }
+    if (rng() % 4U == 0U) {
+      packets[rng() % count] = {nullptr, 32U};
+    }
+
+    Outputs outputs(count);
+    const crisp_classify_batch_out_t out = outputs.out();
+    REQUIRE(crisp_classify_batch(packets.data(), count, &out) == CRISP_OK);
+    for (size_t i = 0; i < count; ++i) {
+      check_matches_parse(packets[i], outputs, i);
+    }
+  }
+}
+
+TEST_CASE("Batch classifier covers every status at group boundaries", "[classify]") {
+  // One-byte KeyId, unused KeyId, long KeyId, bad version, bad suite, truncated: each lands in
+  // every lane position of a group.
+  const std::vector<std::vector<uint8_t>> shapes = {
+      {0x00, 0x00, 0x03, 0x11, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0xAA, 0xBB, 0xCC, 0xDD,
+       0x01, 0x02, 0x03, 0x04, 0x05},
+      {0x80, 0x00, 0x02, 0x80, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x02, 0x03, 0x04,
+       0x05, 0x06, 0x07, 0x08},
+      {0x00, 0x00, 0x01, 0x82, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x01, 0x02,
+       0x03, 0x04},
+      {0x01, 0x00, 0x01, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x02, 0x03, 0x04,
+       0x05, 0x06, 0x07, 0x08},
+      {0x00, 0x00, 0x05, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x02, 0x03, 0x04,
+       0x05, 0x06, 0x07, 0x08},
+      {0x00, 0x00, 0x04, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x02, 0x03, 0x04,
+       0x05, 0x06, 0x07},
+  };
+  std::vector<crisp_const_byte_span_t> packets;
+  for (size_t round = 0; round < CRISP_CLASSIFY_GROUP_SIZE + 1U; ++round) {
+    for (const std::vector<uint8_t>& shape : shapes) {
+      packets.push_back({shape.data(), shape.size()});
+    }
+  }
+
+  Outputs outputs(packets.size());
+  const crisp_classify_batch_out_t out = outputs.out();
+  REQUIRE(crisp_classify_batch(packets.data(), packets.size(), &out) == CRISP_OK);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    check_matches_parse(packets[i], outputs, i);
+  }
+  CHECK(outputs.seqnum[0] == 0x01020304ULL);
+  CHECK(outputs.seqnum[1] == CRISP_SEQNUM_MAX);
+  CHECK(outputs.status[3] == CRISP_ERR_INVALID_FORMAT);
+  CHECK(outputs.status[4] == CRISP_ERR_UNSUPPORTED_SUITE);
+  CHECK(outputs.status[5] == CRISP_ERR_INVALID_SIZE);
+}
+
+TEST_CASE("Batch classifier accepts partial outputs and rejects bad arguments", "[classify]") {
+  const std::vector<uint8_t> packet = {0x00, 0x00, 0x01, 0x80, 0x00, 0x00, 0x00, 0x00,
+                                       0x00, 0x07, 0x01, 0x02, 0x03, 0x04};
+  const std::vector<crisp_const_byte_span_t> packets(5U, {packet.data(), packet.size()});
+  std::vector<crisp_error_t> status(packets.size(), CRISP_ERR_NOT_SUPPORTED);
+  std::vector<uint64_t> seqnum(packets.size(), 0U);
+
+  crisp_classify_batch_out_t out{};
+  out.status = status.data();
+  out.seqnum = seqnum.data();
+  REQUIRE(crisp_classify_batch(packets.data(), packets.size(), &out) == CRISP_OK);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    CHECK(status[i] == CRISP_OK);
+    CHECK(seqnum[i] == 7U);
+  }
+
+  CHECK(crisp_classify_batch(packets.data(), 0U, nullptr) == CRISP_OK);
+  CHECK(crisp_classify_batch(nullptr, 1U, &out) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_classify_batch(packets.data(), 1U, nullptr) == CRISP_ERR_INVALID_ARGUMENT);
+  out.status = nullptr;
+  CHECK(crisp_classify_batch(packets.data(), 1U, &out) == CRISP_ERR_INVALID_ARGUMENT);
+}
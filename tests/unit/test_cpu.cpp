@@ -0,0 +1,111 @@
+#include <array>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/cpu.h"
+#include "crisp/core/message.h"
+#include "crisp/crypto/magma_backend.h"
+}
+
+namespace {
+
+std::vector<crisp_cpu_level_t> runnable_levels() {
+  std::vector<crisp_cpu_level_t> levels;
+  for (int level = CRISP_CPU_LEVEL_SCALAR; level <= crisp_cpu_detected_level(); ++level) {
+    levels.push_back(static_cast<crisp_cpu_level_t>(level));
+  }
+  return levels;
+}
+
+}  // namespace
+
+TEST_CASE("CPU level names round-trip", "[cpu]") {
+  for (int level = CRISP_CPU_LEVEL_SCALAR; level <= CRISP_CPU_LEVEL_AVX512; ++level) {
+    const auto typed = static_cast<crisp_cpu_level_t>(level);
+    crisp_cpu_level_t parsed = CRISP_CPU_LEVEL_SCALAR;
+    REQUIRE(crisp_cpu_parse_level(crisp_cpu_level_name(typed), &parsed));
+    CHECK(parsed == typed);
+  }
+  crisp_cpu_level_t parsed = CRISP_CPU_LEVEL_AVX2;
+  CHECK_FALSE(crisp_cpu_parse_level("avx9000", &parsed));
+  CHECK(parsed == CRISP_CPU_LEVEL_AVX2);
+  int out_of_range = CRISP_CPU_LEVEL_AVX512 + 1;
+  CHECK(std::string(crisp_cpu_level_name(static_cast<crisp_cpu_level_t>(out_of_range))) ==
+        "unknown");
+}
+
+TEST_CASE("Forced CPU level caps active level", "[cpu]") {
+  for (const crisp_cpu_level_t level : runnable_levels()) {
+    REQUIRE(crisp_cpu_force_level(level) == CRISP_OK);
+    CHECK(crisp_cpu_active_level() == level);
+  }
+  if (crisp_cpu_detected_level() < CRISP_CPU_LEVEL_AVX512) {
+    CHECK(crisp_cpu_force_level(CRISP_CPU_LEVEL_AVX512) == CRISP_ERR_NOT_SUPPORTED);
+  }
+  int out_of_range = CRISP_CPU_LEVEL_AVX512 + 1;
+  CHECK(crisp_cpu_force_level(static_cast<crisp_cpu_level_t>(out_of_range)) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  crisp_cpu_reset_level();
+  if (std::getenv(CRISP_CPU_LEVEL_ENV) == nullptr) {
+    CHECK(crisp_cpu_active_level() == crisp_cpu_detected_level());
+  }
+}
+
+TEST_CASE("Protect/unprotect agree across forced CPU levels", "[cpu][message]") {
+  std::array<uint8_t, CRISP_MAGMA_KEY_SIZE> kenc{};
+  std::array<uint8_t, CRISP_MAGMA_KEY_SIZE> kmac{};
+  for (size_t i = 0U; i < kenc.size(); ++i) {
+    kenc[i] = static_cast<uint8_t>(i);
+    kmac[i] = static_cast<uint8_t>(0xF0U - i);
+  }
+  std::vector<uint8_t> payload(333U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i * 5U);
+  }
+
+  std::vector<uint8_t> reference;
+  for (const crisp_cpu_level_t level : runnable_levels()) {
+    REQUIRE(crisp_cpu_force_level(level) == CRISP_OK);
+    crisp_crypto_iface_t iface{};
+    crisp_magma_crypto_iface_init(&iface);
+
+    crisp_protect_params_t protect{};
+    protect.cs = CRISP_SUITE_CS1;
+    protect.seqnum = 77U;
+    protect.payload = {payload.data(), payload.size()};
+    protect.kenc = {kenc.data(), kenc.size()};
+    protect.kmac = {kmac.data(), kmac.size()};
+    protect.crypto = &iface;
+    std::vector<uint8_t> packet(512U);
+    size_t written = 0U;
+    REQUIRE(crisp_protect(&protect, {packet.data(), packet.size()}, &written) == CRISP_OK);
+    packet.resize(written);
+    if (reference.empty()) {
+      reference = packet;
+    } else {
+      CHECK(packet == reference);
+    }
+
+    crisp_unprotect_params_t unprotect{};
+    unprotect.packet = {packet.data(), packet.size()};
+    unprotect.kenc = protect.kenc;
+    unprotect.kmac = protect.kmac;
+    unprotect.crypto = &iface;
+    std::vector<uint8_t> out(payload.size());
+    crisp_unprotect_result_t result{};
+    REQUIRE(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) == CRISP_OK);
+    CHECK(out == payload);
+
+    // Each ICV byte position must be covered by the constant-time compare.
+    for (size_t i = packet.size() - 8U; i < packet.size(); ++i) {
+      packet[i] ^= 0x01U;
+      CHECK(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) == CRISP_ERR_CRYPTO);
+      packet[i] ^= 0x01U;
+    }
+  }
+  crisp_cpu_reset_level();
+}
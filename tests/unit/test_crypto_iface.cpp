@@ -0,0 +1,171 @@
+#include <array>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/crypto/dummy_backend.h"
+#include "crisp/crypto/iface.h"
+}
+
+namespace {
+
+struct CountingBackend {
+  crisp_crypto_iface_t inner{};
+  size_t key_inits = 0U;
+  size_t key_releases = 0U;
+  size_t raw_calls = 0U;
+  size_t keyed_calls = 0U;
+};
+
+crisp_error_t counting_cmac(void* user_ctx,
+                            crisp_const_byte_span_t key,
+                            crisp_const_byte_span_t data,
+                            crisp_mutable_byte_span_t out_icv) {
+  auto* backend = static_cast<CountingBackend*>(user_ctx);
+  ++backend->raw_calls;
+  return backend->inner.magma_cmac(backend->inner.user_ctx, key, data, out_icv);
+}
+
+crisp_error_t counting_ctr(void* user_ctx,
+                           crisp_const_byte_span_t key,
+                           uint32_t iv32,
+                           crisp_const_byte_span_t in,
+                           crisp_mutable_byte_span_t out) {
+  auto* backend = static_cast<CountingBackend*>(user_ctx);
+  ++backend->raw_calls;
+  return backend->inner.magma_ctr_xcrypt(backend->inner.user_ctx, key, iv32, in, out);
+}
+
+crisp_error_t counting_key_init(void* user_ctx, crisp_const_byte_span_t key, void** out_key_ctx) {
+  auto* backend = static_cast<CountingBackend*>(user_ctx);
+  ++backend->key_inits;
+  return backend->inner.magma_key_init(backend->inner.user_ctx, key, out_key_ctx);
+}
+
+void counting_key_release(void* user_ctx, void* key_ctx) {
+  auto* backend = static_cast<CountingBackend*>(user_ctx);
+  ++backend->key_releases;
+  backend->inner.magma_key_release(backend->inner.user_ctx, key_ctx);
+}
+
+crisp_error_t counting_cmac_keyed(void* user_ctx,
+                                  const void* key_ctx,
+                                  crisp_const_byte_span_t data,
+                                  crisp_mutable_byte_span_t out_icv) {
+  auto* backend = static_cast<CountingBackend*>(user_ctx);
+  ++backend->keyed_calls;
+  return backend->inner.magma_cmac_keyed(backend->inner.user_ctx, key_ctx, data, out_icv);
+}
+
+crisp_error_t counting_ctr_keyed(void* user_ctx,
+                                 const void* key_ctx,
+                                 uint32_t iv32,
+                                 crisp_const_byte_span_t in,
+                                 crisp_mutable_byte_span_t out) {
+  auto* backend = static_cast<CountingBackend*>(user_ctx);
+  ++backend->keyed_calls;
+  return backend->inner.magma_ctr_xcrypt_keyed(backend->inner.user_ctx, key_ctx, iv32, in, out);
+}
+
+crisp_crypto_iface_t make_counting_iface(CountingBackend* backend, bool keyed) {
+  crisp_crypto_iface_t iface{};
+  iface.user_ctx = backend;
+  iface.magma_cmac = counting_cmac;
+  iface.magma_ctr_xcrypt = counting_ctr;
+  if (keyed) {
+    iface.magma_key_init = counting_key_init;
+    iface.magma_key_release = counting_key_release;
+    iface.magma_cmac_keyed = counting_cmac_keyed;
+    iface.magma_ctr_xcrypt_keyed = counting_ctr_keyed;
+  }
+  return iface;
+}
+
+}  // namespace
+
+TEST_CASE("Prepared keys produce the same output as raw-key callbacks", "[crypto]") {
+  crisp_dummy_crypto_state_t state{0x0102030405060708ULL};
+  CountingBackend backend{};
+  crisp_dummy_crypto_iface_init(&backend.inner, &state);
+  const crisp_crypto_iface_t iface = make_counting_iface(&backend, true);
+  REQUIRE(crisp_crypto_iface_has_keyed_api(&iface));
+
+  std::array<uint8_t, 32> kenc{};
+  std::array<uint8_t, 32> kmac{};
+  kenc.fill(0x11U);
+  kmac.fill(0x22U);
+  const std::array<uint8_t, 13> data{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13};
+
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kenc.data(), kenc.size()},
+                                 {kmac.data(), kmac.size()}) == CRISP_OK);
+  CHECK(backend.key_inits == 2U);
+  CHECK(keys.kenc_ctx != nullptr);
+  CHECK(keys.kmac_ctx != nullptr);
+  CHECK(keys.kenc.data == nullptr);
+  CHECK(keys.kmac.data == nullptr);
+
+  std::array<uint8_t, 8> keyed_icv{};
+  std::array<uint8_t, 8> raw_icv{};
+  std::array<uint8_t, 13> keyed_ct{};
+  std::array<uint8_t, 13> raw_ct{};
+  for (int round = 0; round < 3; ++round) {
+    REQUIRE(crisp_crypto_cmac(&keys, {data.data(), data.size()}, {keyed_icv.data(), keyed_icv.size()}) ==
+            CRISP_OK);
+    REQUIRE(crisp_crypto_ctr_xcrypt(&keys, 0xAABBCCDDU, {data.data(), data.size()},
+                                    {keyed_ct.data(), keyed_ct.size()}) == CRISP_OK);
+  }
+  CHECK(backend.key_inits == 2U);
+  CHECK(backend.keyed_calls == 6U);
+  CHECK(backend.raw_calls == 0U);
+
+  REQUIRE(iface.magma_cmac(iface.user_ctx, {kmac.data(), kmac.size()}, {data.data(), data.size()},
+                           {raw_icv.data(), raw_icv.size()}) == CRISP_OK);
+  REQUIRE(iface.magma_ctr_xcrypt(iface.user_ctx, {kenc.data(), kenc.size()}, 0xAABBCCDDU,
+                                 {data.data(), data.size()}, {raw_ct.data(), raw_ct.size()}) == CRISP_OK);
+  CHECK(keyed_icv == raw_icv);
+  CHECK(keyed_ct == raw_ct);
+
+  crisp_crypto_keys_release(&keys);
+  CHECK(backend.key_releases == 2U);
+  CHECK(keys.crypto == nullptr);
+  crisp_crypto_keys_release(&keys);
+  CHECK(backend.key_releases == 2U);
+}
+
+TEST_CASE("Prepared keys fall back to raw callbacks without keyed API", "[crypto]") {
+  crisp_dummy_crypto_state_t state{0x0A0B0C0D0E0F0001ULL};
+  CountingBackend backend{};
+  crisp_dummy_crypto_iface_init(&backend.inner, &state);
+  const crisp_crypto_iface_t iface = make_counting_iface(&backend, false);
+  CHECK_FALSE(crisp_crypto_iface_has_keyed_api(&iface));
+
+  std::array<uint8_t, 32> kenc{};
+  std::array<uint8_t, 32> kmac{};
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kenc.data(), kenc.size()},
+                                 {kmac.data(), kmac.size()}) == CRISP_OK);
+  CHECK(keys.kenc_ctx == nullptr);
+  CHECK(keys.kmac.data == kmac.data());
+
+  std::array<uint8_t, 4> icv{};
+  REQUIRE(crisp_crypto_cmac(&keys, {kenc.data(), kenc.size()}, {icv.data(), icv.size()}) == CRISP_OK);
+  CHECK(backend.raw_calls == 1U);
+  crisp_crypto_keys_release(&keys);
+}
+
+TEST_CASE("Prepared keys reject invalid arguments", "[crypto]") {
+  crisp_dummy_crypto_state_t state{};
+  crisp_crypto_iface_t iface{};
+  crisp_dummy_crypto_iface_init(&iface, &state);
+
+  crisp_crypto_keys_t keys{};
+  CHECK(crisp_crypto_keys_init(nullptr, &iface, {}, {}) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_crypto_keys_init(&keys, nullptr, {}, {}) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_crypto_keys_init(&keys, &iface, {nullptr, 4U}, {}) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(keys.crypto == nullptr);
+
+  std::array<uint8_t, 4> icv{};
+  CHECK(crisp_crypto_cmac(nullptr, {}, {icv.data(), icv.size()}) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_crypto_cmac(&keys, {}, {icv.data(), icv.size()}) == CRISP_ERR_INVALID_ARGUMENT);
+}
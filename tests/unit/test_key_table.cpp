@@ -0,0 +1,409 @@
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/key_table.h"
+#include "crisp/core/message.h"
+#include "crisp/crypto/dummy_backend.h"
+}
+
+namespace {
+
+struct alignas(CRISP_KEY_TABLE_STORAGE_ALIGN) StorageLine {
+  uint8_t bytes[CRISP_KEY_TABLE_STORAGE_ALIGN];
+};
+
+struct TableFixture {
+  std::vector<crisp_key_table_reader_t> readers;
+  std::vector<StorageLine> storage;
+  crisp_key_table_t table{};
+
+  TableFixture(size_t capacity, size_t negative_cache_slots, size_t reader_count)
+      : readers(reader_count) {
+    crisp_key_table_config_t config{};
+    config.capacity = capacity;
+    config.negative_cache_slots = negative_cache_slots;
+    config.seed = 0x5EEDF00DCAFEBEEFULL;
+    config.readers = readers.data();
+    config.reader_count = readers.size();
+    const size_t size = crisp_key_table_storage_size(&config);
+    REQUIRE(size > 0U);
+    storage.resize((size + sizeof(StorageLine) - 1U) / sizeof(StorageLine));
+    REQUIRE(crisp_key_table_init(&table, &config, storage.data(), size) == CRISP_OK);
+  }
+};
+
+std::vector<uint8_t> make_key_id(uint32_t index, size_t size) {
+  std::vector<uint8_t> key_id(size);
+  for (size_t i = 0U; i < size; ++i) {
+    key_id[i] = static_cast<uint8_t>((index >> ((i % 4U) * 8U)) + i);
+  }
+  return key_id;
+}
+
+crisp_const_byte_span_t span_of(const std::vector<uint8_t>& bytes) {
+  return {bytes.data(), bytes.size()};
+}
+
+struct CountingResolverState {
+  const crisp_crypto_keys_t* keys = nullptr;
+  int calls = 0;
+};
+
+crisp_error_t counting_resolve_prepared_keys(void* user_ctx,
+                                             const crisp_key_resolve_request_t* req,
+                                             const crisp_crypto_keys_t** out_keys) {
+  if (user_ctx == nullptr || req == nullptr || out_keys == nullptr) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  auto* state = static_cast<CountingResolverState*>(user_ctx);
+  state->calls += 1;
+  if (state->keys == nullptr) {
+    return CRISP_ERR_INVALID_FORMAT;
+  }
+  *out_keys = state->keys;
+  return CRISP_OK;
+}
+
+/** Control plane racing the slow path: the KeyId is inserted while the callback runs. */
+struct RacingInsertState {
+  crisp_key_table_t* table = nullptr;
+  const crisp_crypto_keys_t* keys = nullptr;
+};
+
+crisp_error_t racing_insert_resolve_prepared_keys(void* user_ctx,
+                                                  const crisp_key_resolve_request_t* req,
+                                                  const crisp_crypto_keys_t** out_keys) {
+  if (user_ctx == nullptr || req == nullptr || out_keys == nullptr) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  auto* state = static_cast<RacingInsertState*>(user_ctx);
+  if (crisp_key_table_insert(state->table, req->key_id, state->keys) != CRISP_OK) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  // The callback's answer predates the insert.
+  return CRISP_ERR_INVALID_FORMAT;
+}
+
+}  // namespace
+
+TEST_CASE("key table validates configuration and storage", "[key_table]") {
+  crisp_key_table_reader_t reader{};
+  crisp_key_table_config_t config{};
+  config.capacity = 0U;
+  CHECK(crisp_key_table_storage_size(nullptr) == 0U);
+  CHECK(crisp_key_table_storage_size(&config) == 0U);
+  config.capacity = 10U;
+  config.reader_count = 1U;
+  CHECK(crisp_key_table_storage_size(&config) == 0U);
+  config.readers = &reader;
+  const size_t size = crisp_key_table_storage_size(&config);
+  REQUIRE(size > 0U);
+
+  std::vector<StorageLine> storage(size / sizeof(StorageLine) + 2U);
+  crisp_key_table_t table{};
+  CHECK(crisp_key_table_init(&table, &config, storage.data(), size - 1U) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(crisp_key_table_init(&table, &config, storage[0].bytes + 1, size) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_key_table_init(&table, nullptr, storage.data(), size) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  REQUIRE(crisp_key_table_init(&table, &config, storage.data(), size) == CRISP_OK);
+  CHECK(crisp_key_table_lookup(&table, {nullptr, 0U}) == nullptr);
+}
+
+TEST_CASE("key table maps KeyIds of every size", "[key_table]") {
+  TableFixture fixture(1000U, 0U, 1U);
+  crisp_key_table_t* table = &fixture.table;
+
+  std::vector<std::vector<uint8_t>> key_ids;
+  std::vector<int> values(1000U);
+  for (uint32_t i = 0U; i < 1000U; ++i) {
+    key_ids.push_back(make_key_id(i, 4U + i % (CRISP_MAX_KEY_ID_SIZE - 3U)));
+  }
+  // Equal prefixes of different lengths are distinct KeyIds.
+  key_ids[0] = std::vector<uint8_t>(key_ids[129].begin(), key_ids[129].begin() + 1);
+  key_ids[1] = std::vector<uint8_t>(key_ids[129].begin(), key_ids[129].begin() + 2);
+  for (size_t i = 0U; i < key_ids.size(); ++i) {
+    REQUIRE(crisp_key_table_insert(table, span_of(key_ids[i]), &values[i]) == CRISP_OK);
+  }
+  CHECK(table->live == 1000U);
+  CHECK(crisp_key_table_insert(table, span_of(key_ids[7]), &values[0]) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+
+  crisp_key_table_read_begin(table, &fixture.readers[0]);
+  for (size_t i = 0U; i < key_ids.size(); ++i) {
+    CHECK(crisp_key_table_lookup(table, span_of(key_ids[i])) == &values[i]);
+  }
+  const std::vector<uint8_t> absent = make_key_id(5000U, 9U);
+  CHECK(crisp_key_table_lookup(table, span_of(absent)) == nullptr);
+  crisp_key_table_read_end(&fixture.readers[0]);
+
+  const void* removed = nullptr;
+  uint64_t retire_epoch = 0U;
+  REQUIRE(crisp_key_table_remove(table, span_of(key_ids[3]), &removed, &retire_epoch) ==
+          CRISP_OK);
+  CHECK(removed == &values[3]);
+  CHECK(retire_epoch > 1U);
+  CHECK(crisp_key_table_lookup(table, span_of(key_ids[3])) == nullptr);
+  CHECK(crisp_key_table_lookup(table, span_of(key_ids[4])) == &values[4]);
+  CHECK(crisp_key_table_remove(table, span_of(key_ids[3]), nullptr, nullptr) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  REQUIRE(crisp_key_table_insert(table, span_of(key_ids[3]), &values[0]) == CRISP_OK);
+  CHECK(crisp_key_table_lookup(table, span_of(key_ids[3])) == &values[0]);
+}
+
+TEST_CASE("key table reuses tombstones only after the grace period", "[key_table]") {
+  // 14 KeyIds fill a single group to its 7/8 load limit.
+  TableFixture fixture(14U, 0U, 2U);
+  crisp_key_table_t* table = &fixture.table;
+  std::array<int, 15> values{};
+  for (uint32_t i = 0U; i < 14U; ++i) {
+    REQUIRE(crisp_key_table_insert(table, span_of(make_key_id(i, 4U)), &values[i]) == CRISP_OK);
+  }
+  const std::vector<uint8_t> extra = make_key_id(14U, 4U);
+  CHECK(crisp_key_table_insert(table, span_of(extra), &values[14]) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+
+  // A reader that entered before the removal may still hold the removed entry.
+  crisp_key_table_read_begin(table, &fixture.readers[0]);
+  uint64_t retire_epoch = 0U;
+  REQUIRE(crisp_key_table_remove(table, span_of(make_key_id(5U, 4U)), nullptr, &retire_epoch) ==
+          CRISP_OK);
+  CHECK_FALSE(crisp_key_table_grace_elapsed(table, retire_epoch));
+  CHECK(crisp_key_table_insert(table, span_of(extra), &values[14]) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+
+  // Readers entering after the removal do not hold it back.
+  crisp_key_table_read_begin(table, &fixture.readers[1]);
+  crisp_key_table_read_end(&fixture.readers[0]);
+  CHECK(crisp_key_table_grace_elapsed(table, retire_epoch));
+  REQUIRE(crisp_key_table_insert(table, span_of(extra), &values[14]) == CRISP_OK);
+  CHECK(crisp_key_table_lookup(table, span_of(extra)) == &values[14]);
+  crisp_key_table_read_end(&fixture.readers[1]);
+  CHECK(table->live == 14U);
+}
+
+TEST_CASE("key table negative cache records unknown KeyIds", "[key_table]") {
+  TableFixture fixture(16U, 64U, 1U);
+  crisp_key_table_t* table = &fixture.table;
+  const std::vector<uint8_t> garbage = make_key_id(77U, 12U);
+  int value = 0;
+
+  CHECK_FALSE(crisp_key_table_negative_contains(table, span_of(garbage)));
+  crisp_key_table_negative_insert(table, span_of(garbage));
+  CHECK(crisp_key_table_negative_contains(table, span_of(garbage)));
+  crisp_key_table_negative_clear(table);
+  CHECK_FALSE(crisp_key_table_negative_contains(table, span_of(garbage)));
+
+  // Inserting a KeyId forgets that it was unknown.
+  crisp_key_table_negative_insert(table, span_of(garbage));
+  REQUIRE(crisp_key_table_insert(table, span_of(garbage), &value) == CRISP_OK);
+  CHECK_FALSE(crisp_key_table_negative_contains(table, span_of(garbage)));
+
+  TableFixture without_cache(16U, 0U, 1U);
+  crisp_key_table_negative_insert(&without_cache.table, span_of(garbage));
+  CHECK_FALSE(crisp_key_table_negative_contains(&without_cache.table, span_of(garbage)));
+}
+
+TEST_CASE("unprotect resolve serves cached keys and drops known-unknown KeyIds",
+          "[key_table][message]") {
+  crisp_dummy_crypto_state_t state{0x1020304050607080ULL};
+  crisp_crypto_iface_t iface{};
+  crisp_dummy_crypto_iface_init(&iface, &state);
+  std::array<uint8_t, 16> kenc{};
+  std::array<uint8_t, 16> kmac{};
+  kenc.fill(0x3AU);
+  kmac.fill(0x4AU);
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kenc.data(), kenc.size()},
+                                 {kmac.data(), kmac.size()}) == CRISP_OK);
+
+  const std::array<uint8_t, 3> payload{0xDEU, 0xADU, 0x01U};
+  auto make_packet = [&](uint8_t key_id_byte, std::array<uint8_t, 64>& packet) {
+    const std::array<uint8_t, 1> key_id{key_id_byte};
+    crisp_protect_params_t protect{};
+    protect.cs = CRISP_SUITE_CS1;
+    protect.key_id_present = true;
+    protect.seqnum = 5U;
+    protect.key_id = {key_id.data(), key_id.size()};
+    protect.payload = {payload.data(), payload.size()};
+    protect.keys = &keys;
+    size_t written = 0U;
+    REQUIRE(crisp_protect(&protect, {packet.data(), packet.size()}, &written) == CRISP_OK);
+    return crisp_const_byte_span_t{packet.data(), written};
+  };
+  std::array<uint8_t, 64> known_buffer{};
+  std::array<uint8_t, 64> unknown_buffer{};
+  const crisp_const_byte_span_t known = make_packet(0x07U, known_buffer);
+  const crisp_const_byte_span_t unknown = make_packet(0x09U, unknown_buffer);
+
+  TableFixture fixture(16U, 64U, 1U);
+  const std::array<uint8_t, 1> known_key_id{0x07U};
+  REQUIRE(crisp_key_table_insert(&fixture.table, {known_key_id.data(), known_key_id.size()},
+                                 &keys) == CRISP_OK);
+
+  CountingResolverState resolver_state{};
+  crisp_key_resolver_t resolver{};
+  resolver.user_ctx = &resolver_state;
+  resolver.resolve_prepared_keys = counting_resolve_prepared_keys;
+  resolver.key_table = &fixture.table;
+
+  std::array<uint8_t, 8> out{};
+  crisp_unprotect_result_t result{};
+  CHECK(crisp_unprotect_resolve(known, &resolver, &iface, nullptr, {out.data(), out.size()},
+                                &result) == CRISP_ERR_INVALID_ARGUMENT);
+  resolver.key_table_reader = &fixture.readers[0];
+
+  REQUIRE(crisp_unprotect_resolve(known, &resolver, &iface, nullptr, {out.data(), out.size()},
+                                  &result) == CRISP_OK);
+  CHECK(resolver_state.calls == 0);
+  REQUIRE(result.plaintext.size == payload.size());
+  CHECK(out[0] == 0xDEU);
+  CHECK(fixture.readers[0].epoch == 0U);
+
+  // The first miss reaches the resolver; its rejection keeps later copies away from it.
+  CHECK(crisp_unprotect_resolve(unknown, &resolver, &iface, nullptr, {out.data(), out.size()},
+                                &result) == CRISP_ERR_INVALID_FORMAT);
+  CHECK(resolver_state.calls == 1);
+  CHECK(crisp_unprotect_resolve(unknown, &resolver, &iface, nullptr, {out.data(), out.size()},
+                                &result) == CRISP_ERR_INVALID_FORMAT);
+  CHECK(resolver_state.calls == 1);
+
+  // Without callbacks the table alone decides.
+  crisp_key_resolver_t table_only{};
+  table_only.key_table = &fixture.table;
+  table_only.key_table_reader = &fixture.readers[0];
+  CHECK(crisp_unprotect_resolve(known, &table_only, &iface, nullptr, {out.data(), out.size()},
+                                &result) == CRISP_OK);
+  crisp_key_table_negative_clear(&fixture.table);
+  CHECK(crisp_unprotect_resolve(unknown, &table_only, &iface, nullptr, {out.data(), out.size()},
+                                &result) == CRISP_ERR_INVALID_FORMAT);
+
+  crisp_crypto_keys_release(&keys);
+}
+
+TEST_CASE("unprotect resolve does not cache a KeyId inserted during the callback",
+          "[key_table][message]") {
+  crisp_dummy_crypto_state_t state{0x1020304050607080ULL};
+  crisp_crypto_iface_t iface{};
+  crisp_dummy_crypto_iface_init(&iface, &state);
+  std::array<uint8_t, 16> kenc{};
+  std::array<uint8_t, 16> kmac{};
+  kenc.fill(0x5BU);
+  kmac.fill(0x6BU);
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kenc.data(), kenc.size()},
+                                 {kmac.data(), kmac.size()}) == CRISP_OK);
+
+  const std::array<uint8_t, 2> key_id{0x81U, 0x0CU};
+  const std::array<uint8_t, 4> payload{0x01U, 0x02U, 0x03U, 0x04U};
+  std::array<uint8_t, 64> first{};
+  std::array<uint8_t, 64> second{};
+  size_t first_size = 0U;
+  size_t second_size = 0U;
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.key_id_present = true;
+  protect.key_id = {key_id.data(), key_id.size()};
+  protect.payload = {payload.data(), payload.size()};
+  protect.keys = &keys;
+  protect.seqnum = 1U;
+  REQUIRE(crisp_protect(&protect, {first.data(), first.size()}, &first_size) == CRISP_OK);
+  protect.seqnum = 2U;
+  REQUIRE(crisp_protect(&protect, {second.data(), second.size()}, &second_size) == CRISP_OK);
+
+  TableFixture fixture(16U, 64U, 1U);
+  RacingInsertState racing{&fixture.table, &keys};
+  crisp_key_resolver_t resolver{};
+  resolver.user_ctx = &racing;
+  resolver.resolve_prepared_keys = racing_insert_resolve_prepared_keys;
+  resolver.key_table = &fixture.table;
+  resolver.key_table_reader = &fixture.readers[0];
+
+  std::array<uint8_t, 8> out{};
+  crisp_unprotect_result_t result{};
+  CHECK(crisp_unprotect_resolve({first.data(), first_size}, &resolver, &iface, nullptr,
+                                {out.data(), out.size()}, &result) == CRISP_ERR_INVALID_FORMAT);
+  // The rejection was recorded after the insert cleared the cache; the recheck took it back.
+  CHECK_FALSE(crisp_key_table_negative_contains(&fixture.table, {key_id.data(), key_id.size()}));
+  CHECK(fixture.readers[0].epoch == 0U);
+  REQUIRE(crisp_unprotect_resolve({second.data(), second_size}, &resolver, &iface, nullptr,
+                                  {out.data(), out.size()}, &result) == CRISP_OK);
+  CHECK(result.seqnum == 2U);
+  CHECK(out[3] == 0x04U);
+
+  // A KeyId still unknown after the callback stays recorded.
+  const std::array<uint8_t, 2> other{0x81U, 0x0DU};
+  crisp_key_table_negative_record(&fixture.table, &fixture.readers[0],
+                                  {other.data(), other.size()});
+  CHECK(crisp_key_table_negative_contains(&fixture.table, {other.data(), other.size()}));
+
+  crisp_crypto_keys_release(&keys);
+}
+
+TEST_CASE("key table readers run lock-free against a churning writer", "[key_table]") {
+  constexpr uint32_t kStable = 64U;
+  constexpr uint32_t kChurn = 64U;
+  constexpr size_t kReaders = 3U;
+  TableFixture fixture(kStable + kChurn, 0U, kReaders);
+  crisp_key_table_t* table = &fixture.table;
+
+  std::vector<std::vector<uint8_t>> stable_ids;
+  std::vector<uint32_t> stable_values(kStable);
+  for (uint32_t i = 0U; i < kStable; ++i) {
+    stable_ids.push_back(make_key_id(i, 1U + i % 40U));
+    stable_values[i] = i;
+    REQUIRE(crisp_key_table_insert(table, span_of(stable_ids.back()), &stable_values[i]) ==
+            CRISP_OK);
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> failures{0U};
+  std::vector<std::thread> readers;
+  for (size_t r = 0U; r < kReaders; ++r) {
+    readers.emplace_back([&, r] {
+      crisp_key_table_reader_t* reader = &fixture.readers[r];
+      while (!stop.load(std::memory_order_relaxed)) {
+        crisp_key_table_read_begin(table, reader);
+        for (uint32_t i = 0U; i < kStable; ++i) {
+          const void* value = crisp_key_table_lookup(table, span_of(stable_ids[i]));
+          if (value != &stable_values[i]) {
+            failures.fetch_add(1U, std::memory_order_relaxed);
+          }
+        }
+        crisp_key_table_read_end(reader);
+      }
+    });
+  }
+
+  // Churning KeyIds map to themselves, so a reader never sees a value of another KeyId.
+  std::vector<std::vector<uint8_t>> churn_ids;
+  for (uint32_t i = 0U; i < kChurn; ++i) {
+    churn_ids.push_back(make_key_id(1000U + i, 48U));
+  }
+  for (int round = 0; round < 200; ++round) {
+    for (uint32_t i = 0U; i < kChurn; ++i) {
+      crisp_error_t err = CRISP_ERR_BUFFER_TOO_SMALL;
+      while (err == CRISP_ERR_BUFFER_TOO_SMALL) {
+        err = crisp_key_table_insert(table, span_of(churn_ids[i]), &churn_ids[i]);
+      }
+      REQUIRE(err == CRISP_OK);
+    }
+    for (uint32_t i = 0U; i < kChurn; ++i) {
+      REQUIRE(crisp_key_table_remove(table, span_of(churn_ids[i]), nullptr, nullptr) ==
+              CRISP_OK);
+    }
+  }
+  stop.store(true, std::memory_order_relaxed);
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  CHECK(failures.load() == 0U);
+  CHECK(table->live == kStable);
+}
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/keystream_pool.h"
+#include "crisp/core/message.h"
+}
+
+#include "test_util.h"
+
+namespace {
+
+using crisp_test::make_key;
+
+struct PreparedKeys {
+  crisp_crypto_iface_t iface{};
+  std::array<uint8_t, 32> kenc = make_key(0x10U, 3U);
+  std::array<uint8_t, 32> kmac = make_key(0x70U, 3U);
+  crisp_crypto_keys_t keys{};
+
+  PreparedKeys() {
+    crisp_magma_crypto_iface_init(&iface);
+    REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kenc.data(), kenc.size()},
+                                   {kmac.data(), kmac.size()}) == CRISP_OK);
+  }
+  ~PreparedKeys() { crisp_crypto_keys_release(&keys); }
+  PreparedKeys(const PreparedKeys&) = delete;
+  PreparedKeys& operator=(const PreparedKeys&) = delete;
+};
+
+}  // namespace
+
+TEST_CASE("keystream pool validates init arguments", "[keystream_pool]") {
+  PreparedKeys prepared;
+  crisp_keystream_pool_t pool{};
+  std::vector<uint8_t> storage(256U);
+
+  CHECK(crisp_keystream_pool_init(nullptr, &prepared.keys, {storage.data(), storage.size()}, 64U,
+                                  0U) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_keystream_pool_init(&pool, &prepared.keys, {storage.data(), 32U}, 64U, 0U) ==
+        CRISP_ERR_INVALID_SIZE);
+  CHECK(crisp_keystream_pool_init(&pool, &prepared.keys, {storage.data(), storage.size()}, 0U,
+                                  0U) == CRISP_ERR_INVALID_SIZE);
+  CHECK(crisp_keystream_pool_init(&pool, &prepared.keys, {storage.data(), storage.size()}, 64U,
+                                  CRISP_SEQNUM_MAX + 1U) == CRISP_ERR_OUT_OF_RANGE);
+
+  // Raw-key bindings have no Kenc context to generate under.
+  crisp_crypto_keys_t raw{};
+  raw.crypto = &prepared.iface;
+  raw.kenc = {prepared.kenc.data(), prepared.kenc.size()};
+  CHECK(crisp_keystream_pool_init(&pool, &raw, {storage.data(), storage.size()}, 64U, 0U) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+
+  std::vector<uint8_t> large(100U * 16U);
+  REQUIRE(crisp_keystream_pool_init(&pool, &prepared.keys, {large.data(), large.size()}, 16U,
+                                    0U) == CRISP_OK);
+  CHECK(pool.slot_count == CRISP_KEYSTREAM_POOL_MAX_SLOTS);
+  crisp_keystream_pool_clear(&pool);
+}
+
+TEST_CASE("protect with pooled keystream matches regular CTR", "[keystream_pool]") {
+  PreparedKeys prepared;
+  constexpr size_t kSlotSize = 48U;
+  std::vector<uint8_t> storage(kSlotSize * 4U);
+  crisp_keystream_pool_t pool{};
+  REQUIRE(crisp_keystream_pool_init(&pool, &prepared.keys, {storage.data(), storage.size()},
+                                    kSlotSize, 100U) == CRISP_OK);
+
+  size_t filled = 0U;
+  REQUIRE(crisp_keystream_pool_refill(&pool, 3U, &filled) == CRISP_OK);
+  CHECK(filled == 3U);
+  REQUIRE(crisp_keystream_pool_refill(&pool, 16U, &filled) == CRISP_OK);
+  CHECK(filled == 1U);
+  REQUIRE(crisp_keystream_pool_refill(&pool, 16U, &filled) == CRISP_OK);
+  CHECK(filled == 0U);
+
+  std::vector<uint8_t> payload(kSlotSize + 8U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i ^ 0x5AU);
+  }
+  const std::array<uint8_t, 2> key_id{0x81U, 0x07U};
+
+  // 100 is skipped (its slot is zeroized), 101/103 hit, 102 is too large and misses.
+  const std::array<uint64_t, 3> seqnums{101U, 102U, 103U};
+  const std::array<size_t, 3> sizes{kSlotSize, kSlotSize + 8U, 5U};
+  for (size_t n = 0U; n < seqnums.size(); ++n) {
+    crisp_protect_params_t params{};
+    params.cs = CRISP_SUITE_CS3;
+    params.key_id_present = true;
+    params.key_id = {key_id.data(), key_id.size()};
+    params.seqnum = seqnums[n];
+    params.payload = {payload.data(), sizes[n]};
+    params.keys = &prepared.keys;
+
+    std::array<uint8_t, 128> expected{};
+    std::array<uint8_t, 128> pooled{};
+    size_t expected_size = 0U;
+    size_t pooled_size = 0U;
+    REQUIRE(crisp_protect(&params, {expected.data(), expected.size()}, &expected_size) ==
+            CRISP_OK);
+    params.keystream_pool = &pool;
+    REQUIRE(crisp_protect(&params, {pooled.data(), pooled.size()}, &pooled_size) == CRISP_OK);
+    REQUIRE(pooled_size == expected_size);
+    CHECK(pooled == expected);
+  }
+
+  // Everything up to 103 was consumed or skipped, and every slot is zero again.
+  CHECK(pool.filled == 0U);
+  CHECK(pool.first_seqnum == 104U);
+  CHECK(std::all_of(storage.begin(), storage.end(), [](uint8_t b) { return b == 0U; }));
+
+  crisp_keystream_pool_clear(&pool);
+}
+
+TEST_CASE("keystream pool restarts after the sender jumps ahead", "[keystream_pool]") {
+  PreparedKeys prepared;
+  std::vector<uint8_t> storage(64U);
+  crisp_keystream_pool_t pool{};
+  REQUIRE(crisp_keystream_pool_init(&pool, &prepared.keys, {storage.data(), storage.size()}, 16U,
+                                    0U) == CRISP_OK);
+  REQUIRE(crisp_keystream_pool_refill(&pool, 4U, nullptr) == CRISP_OK);
+
+  std::array<uint8_t, 16> in{};
+  std::array<uint8_t, 16> out{};
+  CHECK_FALSE(crisp_keystream_pool_xcrypt(&pool, &prepared.keys, 1000U, {in.data(), in.size()},
+                                          {out.data(), out.size()}));
+  CHECK(pool.filled == 0U);
+  CHECK(pool.first_seqnum == 1001U);
+  CHECK(std::all_of(storage.begin(), storage.end(), [](uint8_t b) { return b == 0U; }));
+
+  // Keystream for 1001 equals CTR over zeros with IV32 = 1001.
+  REQUIRE(crisp_keystream_pool_refill(&pool, 1U, nullptr) == CRISP_OK);
+  std::array<uint8_t, 16> expected{};
+  REQUIRE(crisp_crypto_ctr_xcrypt(&prepared.keys, 1001U, {in.data(), in.size()},
+                                  {expected.data(), expected.size()}) == CRISP_OK);
+  REQUIRE(crisp_keystream_pool_xcrypt(&pool, &prepared.keys, 1001U, {in.data(), in.size()},
+                                      {out.data(), out.size()}));
+  CHECK(out == expected);
+
+  // Pools only serve the keys they were filled under.
+  PreparedKeys other;
+  REQUIRE(crisp_keystream_pool_refill(&pool, 1U, nullptr) == CRISP_OK);
+  CHECK_FALSE(crisp_keystream_pool_xcrypt(&pool, &other.keys, 1002U, {in.data(), in.size()},
+                                          {out.data(), out.size()}));
+  CHECK(pool.filled == 1U);
+
+  crisp_keystream_pool_reset(&pool, 5U);
+  CHECK(pool.filled == 0U);
+  CHECK(pool.first_seqnum == 5U);
+  CHECK(std::all_of(storage.begin(), storage.end(), [](uint8_t b) { return b == 0U; }));
+  crisp_keystream_pool_clear(&pool);
+}
+
+TEST_CASE("keystream pool drops slots after keys are re-initialized in place",
+          "[keystream_pool]") {
+  PreparedKeys prepared;
+  std::vector<uint8_t> storage(64U);
+  crisp_keystream_pool_t pool{};
+  REQUIRE(crisp_keystream_pool_init(&pool, &prepared.keys, {storage.data(), storage.size()}, 16U,
+                                    0U) == CRISP_OK);
+  REQUIRE(crisp_keystream_pool_refill(&pool, 4U, nullptr) == CRISP_OK);
+
+  // Rekey into the same struct: the pool's pointer is unchanged, the Kenc is not.
+  const std::array<uint8_t, 32> new_kenc = make_key(0x33U, 3U);
+  crisp_crypto_keys_release(&prepared.keys);
+  REQUIRE(crisp_crypto_keys_init(&prepared.keys, &prepared.iface,
+                                 {new_kenc.data(), new_kenc.size()},
+                                 {prepared.kmac.data(), prepared.kmac.size()}) == CRISP_OK);
+
+  std::array<uint8_t, 16> in{};
+  std::array<uint8_t, 16> out{};
+  CHECK_FALSE(crisp_keystream_pool_xcrypt(&pool, &prepared.keys, 0U, {in.data(), in.size()},
+                                          {out.data(), out.size()}));
+  CHECK(pool.filled == 0U);
+  CHECK(std::all_of(storage.begin(), storage.end(), [](uint8_t b) { return b == 0U; }));
+
+  // Slots generated after the rekey use the new Kenc.
+  REQUIRE(crisp_keystream_pool_refill(&pool, 1U, nullptr) == CRISP_OK);
+  std::array<uint8_t, 16> expected{};
+  REQUIRE(crisp_crypto_ctr_xcrypt(&prepared.keys, 4U, {in.data(), in.size()},
+                                  {expected.data(), expected.size()}) == CRISP_OK);
+  REQUIRE(crisp_keystream_pool_xcrypt(&pool, &prepared.keys, 4U, {in.data(), in.size()},
+                                      {out.data(), out.size()}));
+  CHECK(out == expected);
+
+  // A refill notices the rekey too, before it tops up the ring.
+  REQUIRE(crisp_keystream_pool_refill(&pool, 2U, nullptr) == CRISP_OK);
+  crisp_crypto_keys_release(&prepared.keys);
+  REQUIRE(crisp_crypto_keys_init(&prepared.keys, &prepared.iface,
+                                 {prepared.kenc.data(), prepared.kenc.size()},
+                                 {prepared.kmac.data(), prepared.kmac.size()}) == CRISP_OK);
+  size_t filled = 0U;
+  REQUIRE(crisp_keystream_pool_refill(&pool, 4U, &filled) == CRISP_OK);
+  CHECK(filled == 4U);
+  CHECK(pool.first_seqnum == 7U);
+  REQUIRE(crisp_crypto_ctr_xcrypt(&prepared.keys, 7U, {in.data(), in.size()},
+                                  {expected.data(), expected.size()}) == CRISP_OK);
+  REQUIRE(crisp_keystream_pool_xcrypt(&pool, &prepared.keys, 7U, {in.data(), in.size()},
+                                      {out.data(), out.size()}));
+  CHECK(out == expected);
+  crisp_keystream_pool_clear(&pool);
+}
@@ -0,0 +1,724 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/message.h"
+#include "crisp/crypto/magma_backend.h"
+}
+
+namespace {
+
+// GOST R 34.12-2015 / GOST R 34.13-2015 (Magma) example key and plaintext.
+constexpr std::array<uint8_t, 32> kGostKey{
+    0xFFU, 0xEEU, 0xDDU, 0xCCU, 0xBBU, 0xAAU, 0x99U, 0x88U, 0x77U, 0x66U, 0x55U,
+    0x44U, 0x33U, 0x22U, 0x11U, 0x00U, 0xF0U, 0xF1U, 0xF2U, 0xF3U, 0xF4U, 0xF5U,
+    0xF6U, 0xF7U, 0xF8U, 0xF9U, 0xFAU, 0xFBU, 0xFCU, 0xFDU, 0xFEU, 0xFFU};
+
+constexpr std::array<uint8_t, 32> kGostPlaintext{
+    0x92U, 0xDEU, 0xF0U, 0x6BU, 0x3CU, 0x13U, 0x0AU, 0x59U, 0xDBU, 0x54U, 0xC7U,
+    0x04U, 0xF8U, 0x18U, 0x9DU, 0x20U, 0x4AU, 0x98U, 0xFBU, 0x2EU, 0x67U, 0xA8U,
+    0x02U, 0x4CU, 0x89U, 0x12U, 0x40U, 0x9BU, 0x17U, 0xB5U, 0x7EU, 0x41U};
+
+// GOST R 34.13-2015 A.2.2: CTR with IV = 12345678.
+constexpr std::array<uint8_t, 32> kGostCtrCiphertext{
+    0x4EU, 0x98U, 0x11U, 0x0CU, 0x97U, 0xB7U, 0xB9U, 0x3CU, 0x3EU, 0x25U, 0x0DU,
+    0x93U, 0xD6U, 0xE8U, 0x5DU, 0x69U, 0x13U, 0x6DU, 0x86U, 0x88U, 0x07U, 0xB2U,
+    0xDBU, 0xEFU, 0x56U, 0x8EU, 0xB6U, 0x80U, 0xABU, 0x52U, 0xA1U, 0x2DU};
+
+// GOST R 34.13-2015 A.2.6: MAC (s = 32 in the standard; full 64-bit tag listed here).
+constexpr std::array<uint8_t, 8> kGostCmac{0x15U, 0x4EU, 0x72U, 0x10U, 0x20U, 0x30U, 0xC5U, 0xBBU};
+
+crisp_crypto_iface_t make_magma_iface() {
+  crisp_crypto_iface_t iface{};
+  crisp_magma_crypto_iface_init(&iface);
+  return iface;
+}
+
+/** Splits `size` bytes into random segments (empty and 1-byte ones included). */
+std::vector<crisp_const_byte_span_t> split_random(const uint8_t* data,
+                                                  size_t size,
+                                                  size_t first_min,
+                                                  std::mt19937& rng) {
+  std::vector<crisp_const_byte_span_t> segments;
+  size_t offset = 0U;
+  while (offset < size || segments.empty()) {
+    size_t take = rng() % 5U == 0U ? 0U : 1U + rng() % 13U;
+    if (segments.empty()) {
+      take = std::max(take, first_min);
+    }
+    take = std::min(take, size - offset);
+    segments.push_back({data + offset, take});
+    offset += take;
+  }
+  return segments;
+}
+
+}  // namespace
+
+TEST_CASE("Magma CTR matches GOST R 34.13-2015 vector", "[magma]") {
+  const crisp_crypto_iface_t iface = make_magma_iface();
+  std::array<uint8_t, 32> out{};
+
+  REQUIRE(iface.magma_ctr_xcrypt(iface.user_ctx, {kGostKey.data(), kGostKey.size()}, 0x12345678U,
+                                 {kGostPlaintext.data(), kGostPlaintext.size()},
+                                 {out.data(), out.size()}) == CRISP_OK);
+  CHECK(out == kGostCtrCiphertext);
+
+  SECTION("partial final block uses keystream prefix") {
+    std::array<uint8_t, 29> partial{};
+    REQUIRE(iface.magma_ctr_xcrypt(iface.user_ctx, {kGostKey.data(), kGostKey.size()}, 0x12345678U,
+                                   {kGostPlaintext.data(), partial.size()},
+                                   {partial.data(), partial.size()}) == CRISP_OK);
+    for (size_t i = 0U; i < partial.size(); ++i) {
+      CHECK(partial[i] == kGostCtrCiphertext[i]);
+    }
+  }
+
+  SECTION("in-place decrypt restores plaintext") {
+    std::array<uint8_t, 32> buffer = kGostCtrCiphertext;
+    REQUIRE(iface.magma_ctr_xcrypt(iface.user_ctx, {kGostKey.data(), kGostKey.size()}, 0x12345678U,
+                                   {buffer.data(), buffer.size()}, {buffer.data(), buffer.size()}) ==
+            CRISP_OK);
+    CHECK(buffer == kGostPlaintext);
+  }
+}
+
+TEST_CASE("Magma CMAC matches GOST R 34.13-2015 vector", "[magma]") {
+  const crisp_crypto_iface_t iface = make_magma_iface();
+
+  std::array<uint8_t, 8> mac8{};
+  REQUIRE(iface.magma_cmac(iface.user_ctx, {kGostKey.data(), kGostKey.size()},
+                           {kGostPlaintext.data(), kGostPlaintext.size()},
+                           {mac8.data(), mac8.size()}) == CRISP_OK);
+  CHECK(mac8 == kGostCmac);
+
+  std::array<uint8_t, 4> mac4{};
+  REQUIRE(iface.magma_cmac(iface.user_ctx, {kGostKey.data(), kGostKey.size()},
+                           {kGostPlaintext.data(), kGostPlaintext.size()},
+                           {mac4.data(), mac4.size()}) == CRISP_OK);
+  for (size_t i = 0U; i < mac4.size(); ++i) {
+    CHECK(mac4[i] == kGostCmac[i]);
+  }
+}
+
+TEST_CASE("Magma keyed contexts match raw-key callbacks", "[magma]") {
+  const crisp_crypto_iface_t iface = make_magma_iface();
+  REQUIRE(crisp_crypto_iface_has_keyed_api(&iface));
+
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kGostKey.data(), kGostKey.size()},
+                                 {kGostKey.data(), kGostKey.size()}) == CRISP_OK);
+
+  std::array<uint8_t, 32> ct{};
+  REQUIRE(crisp_crypto_ctr_xcrypt(&keys, 0x12345678U, {kGostPlaintext.data(), kGostPlaintext.size()},
+                                  {ct.data(), ct.size()}) == CRISP_OK);
+  CHECK(ct == kGostCtrCiphertext);
+
+  // Lengths around the block boundary exercise the K1 (full) and K2 (padded) paths.
+  for (size_t len = 0U; len <= kGostPlaintext.size(); ++len) {
+    std::array<uint8_t, 8> keyed{};
+    std::array<uint8_t, 8> raw{};
+    REQUIRE(crisp_crypto_cmac(&keys, {kGostPlaintext.data(), len}, {keyed.data(), keyed.size()}) ==
+            CRISP_OK);
+    REQUIRE(iface.magma_cmac(iface.user_ctx, {kGostKey.data(), kGostKey.size()},
+                             {kGostPlaintext.data(), len}, {raw.data(), raw.size()}) == CRISP_OK);
+    CHECK(keyed == raw);
+  }
+
+  crisp_crypto_keys_release(&keys);
+}
+
+TEST_CASE("Magma backend rejects invalid key and output sizes", "[magma]") {
+  const crisp_crypto_iface_t iface = make_magma_iface();
+  const std::array<uint8_t, 16> short_key{};
+  std::array<uint8_t, 8> out{};
+
+  CHECK(iface.magma_cmac(iface.user_ctx, {short_key.data(), short_key.size()},
+                         {kGostPlaintext.data(), kGostPlaintext.size()}, {out.data(), out.size()}) ==
+        CRISP_ERR_INVALID_SIZE);
+  CHECK(iface.magma_cmac(iface.user_ctx, {kGostKey.data(), kGostKey.size()},
+                         {kGostPlaintext.data(), kGostPlaintext.size()}, {out.data(), 0U}) ==
+        CRISP_ERR_INVALID_SIZE);
+  CHECK(iface.magma_ctr_xcrypt(iface.user_ctx, {kGostKey.data(), kGostKey.size()}, 0U,
+                               {kGostPlaintext.data(), 8U}, {out.data(), 7U}) == CRISP_ERR_INVALID_SIZE);
+
+  void* ctx = nullptr;
+  CHECK(iface.magma_key_init(iface.user_ctx, {short_key.data(), short_key.size()}, &ctx) ==
+        CRISP_ERR_INVALID_SIZE);
+  CHECK(ctx == nullptr);
+}
+
+TEST_CASE("Magma backend protect/unprotect roundtrip for all suites", "[magma][message]") {
+  const crisp_crypto_iface_t iface = make_magma_iface();
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kGostKey.data(), kGostKey.size()},
+                                 {kGostPlaintext.data(), kGostPlaintext.size()}) == CRISP_OK);
+
+  std::vector<uint8_t> payload(777U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i * 31U);
+  }
+  const std::array<uint8_t, 2> key_id{0x81U, 0x99U};
+
+  for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1), static_cast<uint8_t>(CRISP_SUITE_CS2),
+                           static_cast<uint8_t>(CRISP_SUITE_CS3), static_cast<uint8_t>(CRISP_SUITE_CS4)}) {
+    crisp_protect_params_t protect{};
+    protect.cs = cs;
+    protect.key_id_present = true;
+    protect.key_id = {key_id.data(), key_id.size()};
+    protect.seqnum = 0x0000DEADBEEFULL;
+    protect.payload = {payload.data(), payload.size()};
+    protect.keys = &keys;
+
+    std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> packet{};
+    size_t written = 0U;
+    REQUIRE(crisp_protect(&protect, {packet.data(), packet.size()}, &written) == CRISP_OK);
+
+    crisp_unprotect_params_t unprotect{};
+    unprotect.packet = {packet.data(), written};
+    unprotect.keys = &keys;
+    std::vector<uint8_t> out(payload.size());
+    crisp_unprotect_result_t result{};
+    REQUIRE(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) == CRISP_OK);
+    CHECK(out == payload);
+
+    packet[written / 2U] ^= 0x10U;
+    CHECK(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) == CRISP_ERR_CRYPTO);
+  }
+
+  crisp_crypto_keys_release(&keys);
+}
+
+TEST_CASE("Magma multi-buffer engines match single-packet results lane by lane", "[magma][batch]") {
+  // 37 jobs: more than two full AVX-512 rounds, lengths around block boundaries and one long
+  // job that keeps a lane busy while the others are refilled.
+  constexpr size_t kJobs = 37U;
+  std::vector<std::vector<uint8_t>> inputs(kJobs);
+  for (size_t j = 0U; j < kJobs; ++j) {
+    const size_t len = j == 5U ? 1500U : (j * 7U) % 41U;
+    inputs[j].resize(len);
+    for (size_t i = 0U; i < len; ++i) {
+      inputs[j][i] = static_cast<uint8_t>(i * 13U + j);
+    }
+  }
+
+  for (const crisp_magma_engine_t engine : {CRISP_MAGMA_ENGINE_SCALAR, CRISP_MAGMA_ENGINE_AVX2,
+                                            CRISP_MAGMA_ENGINE_AVX512}) {
+    if (!crisp_magma_engine_supported(engine)) {
+      continue;
+    }
+    crisp_crypto_iface_t iface{};
+    REQUIRE(crisp_magma_crypto_iface_init_engine(&iface, engine) == CRISP_OK);
+    REQUIRE(iface.magma_cmac_batch != nullptr);
+    REQUIRE(iface.magma_ctr_xcrypt_batch != nullptr);
+
+    crisp_crypto_keys_t keys{};
+    REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kGostKey.data(), kGostKey.size()},
+                                   {kGostKey.data(), kGostKey.size()}) == CRISP_OK);
+
+    std::vector<std::array<uint8_t, 8>> icvs(kJobs);
+    std::vector<std::vector<uint8_t>> ciphertexts(kJobs);
+    std::vector<crisp_magma_cmac_job_t> cmac_jobs(kJobs);
+    std::vector<crisp_magma_ctr_job_t> ctr_jobs(kJobs);
+    for (size_t j = 0U; j < kJobs; ++j) {
+      ciphertexts[j] = inputs[j];  // even jobs run in place, odd ones out of place
+      cmac_jobs[j] = {{inputs[j].data(), inputs[j].size()}, {icvs[j].data(), 1U + j % 8U}};
+      ctr_jobs[j] = {static_cast<uint32_t>(0x9E3779B9U * j),
+                     {(j % 2U == 0U ? ciphertexts[j] : inputs[j]).data(), inputs[j].size()},
+                     {ciphertexts[j].data(), ciphertexts[j].size()}};
+    }
+    REQUIRE(crisp_crypto_cmac_batch(&keys, cmac_jobs.data(), kJobs) == CRISP_OK);
+    REQUIRE(crisp_crypto_ctr_xcrypt_batch(&keys, ctr_jobs.data(), kJobs) == CRISP_OK);
+
+    for (size_t j = 0U; j < kJobs; ++j) {
+      std::array<uint8_t, 8> expected_icv{};
+      REQUIRE(iface.magma_cmac(iface.user_ctx, {kGostKey.data(), kGostKey.size()},
+                               {inputs[j].data(), inputs[j].size()},
+                               {expected_icv.data(), 1U + j % 8U}) == CRISP_OK);
+      CHECK(icvs[j] == expected_icv);
+
+      std::vector<uint8_t> expected_ct(inputs[j].size());
+      REQUIRE(iface.magma_ctr_xcrypt(iface.user_ctx, {kGostKey.data(), kGostKey.size()},
+                                     ctr_jobs[j].iv32, {inputs[j].data(), inputs[j].size()},
+                                     {expected_ct.data(), expected_ct.size()}) == CRISP_OK);
+      CHECK(ciphertexts[j] == expected_ct);
+    }
+
+    std::array<uint8_t, 8> bad_icv{};
+    const crisp_magma_cmac_job_t bad_job{{inputs[1].data(), inputs[1].size()},
+                                         {bad_icv.data(), 9U}};
+    CHECK(crisp_crypto_cmac_batch(&keys, &bad_job, 1U) == CRISP_ERR_INVALID_SIZE);
+
+    crisp_crypto_keys_release(&keys);
+  }
+}
+
+TEST_CASE("Magma batch protect is identical across engines", "[magma][batch][message]") {
+  constexpr size_t kPackets = 70U;  // spans two CRISP_PROTECT_BATCH_CHUNK chunks
+  std::vector<std::vector<uint8_t>> payloads(kPackets);
+  std::vector<crisp_const_byte_span_t> payload_spans(kPackets);
+  std::vector<uint64_t> seqnums(kPackets);
+  for (size_t i = 0U; i < kPackets; ++i) {
+    payloads[i].assign((i * 29U) % 300U, static_cast<uint8_t>(i));
+    payload_spans[i] = {payloads[i].data(), payloads[i].size()};
+    seqnums[i] = 1000U + i;
+  }
+
+  std::vector<std::vector<uint8_t>> reference;
+  for (const crisp_magma_engine_t engine : {CRISP_MAGMA_ENGINE_SCALAR, CRISP_MAGMA_ENGINE_AVX2,
+                                            CRISP_MAGMA_ENGINE_AVX512}) {
+    if (!crisp_magma_engine_supported(engine)) {
+      continue;
+    }
+    crisp_crypto_iface_t iface{};
+    REQUIRE(crisp_magma_crypto_iface_init_engine(&iface, engine) == CRISP_OK);
+    crisp_crypto_keys_t keys{};
+    REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kGostKey.data(), kGostKey.size()},
+                                   {kGostPlaintext.data(), kGostPlaintext.size()}) == CRISP_OK);
+
+    crisp_protect_batch_params_t params{};
+    params.cs = CRISP_SUITE_CS1;
+    params.keys = &keys;
+    std::vector<std::vector<uint8_t>> packets(kPackets, std::vector<uint8_t>(400U));
+    std::vector<crisp_mutable_byte_span_t> packet_spans(kPackets);
+    for (size_t i = 0U; i < kPackets; ++i) {
+      packet_spans[i] = {packets[i].data(), packets[i].size()};
+    }
+    std::vector<size_t> sizes(kPackets);
+    std::vector<crisp_error_t> status(kPackets);
+    REQUIRE(crisp_protect_batch(&params, seqnums.data(), payload_spans.data(), packet_spans.data(),
+                                sizes.data(), status.data(), kPackets) == CRISP_OK);
+    for (size_t i = 0U; i < kPackets; ++i) {
+      REQUIRE(status[i] == CRISP_OK);
+      packets[i].resize(sizes[i]);
+    }
+
+    // Batch output must also match the single-packet path.
+    for (size_t i = 0U; i < kPackets; i += 9U) {
+      crisp_protect_params_t single{};
+      single.cs = CRISP_SUITE_CS1;
+      single.seqnum = seqnums[i];
+      single.payload = payload_spans[i];
+      single.keys = &keys;
+      std::vector<uint8_t> packet(400U);
+      size_t written = 0U;
+      REQUIRE(crisp_protect(&single, {packet.data(), packet.size()}, &written) == CRISP_OK);
+      packet.resize(written);
+      CHECK(packet == packets[i]);
+    }
+
+    if (reference.empty()) {
+      reference = packets;
+    } else {
+      CHECK(packets == reference);
+    }
+    crisp_crypto_keys_release(&keys);
+  }
+  CHECK_FALSE(reference.empty());
+}
+
+TEST_CASE("Magma fused CTR+CMAC matches separate passes", "[magma][fused]") {
+  crisp_crypto_iface_t fused_iface = make_magma_iface();
+  REQUIRE(fused_iface.magma_ctr_then_cmac != nullptr);
+  REQUIRE(fused_iface.magma_cmac_then_ctr != nullptr);
+  crisp_crypto_iface_t split_iface = fused_iface;
+  split_iface.magma_ctr_then_cmac = nullptr;
+  split_iface.magma_cmac_then_ctr = nullptr;
+
+  crisp_crypto_keys_t fused{};
+  crisp_crypto_keys_t split{};
+  REQUIRE(crisp_crypto_keys_init(&fused, &fused_iface, {kGostKey.data(), kGostKey.size()},
+                                 {kGostPlaintext.data(), kGostPlaintext.size()}) == CRISP_OK);
+  REQUIRE(crisp_crypto_keys_init(&split, &split_iface, {kGostKey.data(), kGostKey.size()},
+                                 {kGostPlaintext.data(), kGostPlaintext.size()}) == CRISP_OK);
+  REQUIRE(crisp_crypto_keys_have_fused(&fused));
+  REQUIRE_FALSE(crisp_crypto_keys_have_fused(&split));
+
+  // KeyId encodings move the payload to offsets 10, 11 and 13 (not block aligned).
+  const std::array<uint8_t, 1> key_id_short{0x05U};
+  const std::array<uint8_t, 2> key_id_2{0x81U, 0x42U};
+  const std::array<uint8_t, 4> key_id_4{0x83U, 0x01U, 0x02U, 0x03U};
+  const std::array<crisp_const_byte_span_t, 3> key_ids{{{key_id_short.data(), key_id_short.size()},
+                                                         {key_id_2.data(), key_id_2.size()},
+                                                         {key_id_4.data(), key_id_4.size()}}};
+
+  std::vector<uint8_t> payload(70U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(0xA0U + i);
+  }
+
+  for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1), static_cast<uint8_t>(CRISP_SUITE_CS3)}) {
+    for (const crisp_const_byte_span_t key_id : key_ids) {
+      for (size_t len = 0U; len <= payload.size(); len += 3U) {
+        crisp_protect_params_t protect{};
+        protect.cs = cs;
+        protect.key_id_present = true;
+        protect.key_id = key_id;
+        protect.seqnum = 0x00000102030405ULL + len;
+        protect.payload = {payload.data(), len};
+
+        std::array<uint8_t, 128> fused_packet{};
+        std::array<uint8_t, 128> split_packet{};
+        size_t fused_size = 0U;
+        size_t split_size = 0U;
+        protect.keys = &fused;
+        REQUIRE(crisp_protect(&protect, {fused_packet.data(), fused_packet.size()}, &fused_size) ==
+                CRISP_OK);
+        protect.keys = &split;
+        REQUIRE(crisp_protect(&protect, {split_packet.data(), split_packet.size()}, &split_size) ==
+                CRISP_OK);
+        REQUIRE(fused_size == split_size);
+        CHECK(fused_packet == split_packet);
+
+        crisp_unprotect_params_t unprotect{};
+        unprotect.packet = {fused_packet.data(), fused_size};
+        unprotect.keys = &fused;
+        std::vector<uint8_t> out(len + 1U, 0xEEU);
+        crisp_unprotect_result_t result{};
+        REQUIRE(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) == CRISP_OK);
+        CHECK(std::equal(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(len),
+                         payload.begin()));
+        CHECK(result.plaintext.size == len);
+
+        // Failed verification must leave the caller buffer untouched.
+        fused_packet[fused_size - 1U] ^= 0x01U;
+        std::fill(out.begin(), out.end(), static_cast<uint8_t>(0xEEU));
+        CHECK(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) == CRISP_ERR_CRYPTO);
+        CHECK(std::all_of(out.begin(), out.end(), [](uint8_t b) { return b == 0xEEU; }));
+      }
+    }
+  }
+
+  crisp_crypto_keys_release(&fused);
+  crisp_crypto_keys_release(&split);
+}
+
+TEST_CASE("Magma CMAC header prefix cache keeps ICVs bit-identical", "[magma][cmac_prefix]") {
+  crisp_crypto_iface_t fused_iface = make_magma_iface();
+  REQUIRE(fused_iface.magma_cmac_absorb != nullptr);
+  REQUIRE(fused_iface.magma_cmac_resume != nullptr);
+  crisp_crypto_iface_t split_iface = fused_iface;
+  split_iface.magma_ctr_then_cmac = nullptr;
+  split_iface.magma_cmac_then_ctr = nullptr;
+
+  // 128-byte KeyId: header is 131 bytes, the largest cacheable prefix (16 blocks).
+  std::array<uint8_t, 128> key_id_long{};
+  key_id_long[0] = 0xFFU;
+  for (size_t i = 1U; i < key_id_long.size(); ++i) {
+    key_id_long[i] = static_cast<uint8_t>(i * 7U);
+  }
+  const std::array<uint8_t, 9> key_id_9{0x88U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U};
+  const std::array<crisp_const_byte_span_t, 2> key_ids{
+      {{key_id_9.data(), key_id_9.size()}, {key_id_long.data(), key_id_long.size()}}};
+
+  std::vector<uint8_t> payload(40U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(0x30U + i);
+  }
+
+  for (crisp_crypto_iface_t* iface : {&fused_iface, &split_iface}) {
+    crisp_crypto_keys_t keys{};
+    REQUIRE(crisp_crypto_keys_init(&keys, iface, {kGostKey.data(), kGostKey.size()},
+                                   {kGostPlaintext.data(), kGostPlaintext.size()}) == CRISP_OK);
+
+    for (const uint8_t cs :
+         {static_cast<uint8_t>(CRISP_SUITE_CS1), static_cast<uint8_t>(CRISP_SUITE_CS2)}) {
+      for (const crisp_const_byte_span_t key_id : key_ids) {
+        crisp_cmac_prefix_t prefix{};
+        REQUIRE(crisp_session_cmac_prefix_init(&prefix, &keys, false, cs, true, key_id) ==
+                CRISP_OK);
+        CHECK(prefix.size == ((3U + key_id.size) / 8U) * 8U);
+
+        for (size_t len = 0U; len <= payload.size(); len += 5U) {
+          crisp_protect_params_t protect{};
+          protect.cs = cs;
+          protect.key_id_present = true;
+          protect.key_id = key_id;
+          protect.seqnum = 0x000000A0B0C0ULL + len;
+          protect.payload = {payload.data(), len};
+          protect.keys = &keys;
+
+          std::array<uint8_t, 256> plain_packet{};
+          std::array<uint8_t, 256> cached_packet{};
+          size_t plain_size = 0U;
+          size_t cached_size = 0U;
+          REQUIRE(crisp_protect(&protect, {plain_packet.data(), plain_packet.size()},
+                                &plain_size) == CRISP_OK);
+          protect.cmac_prefix = &prefix;
+          REQUIRE(crisp_protect(&protect, {cached_packet.data(), cached_packet.size()},
+                                &cached_size) == CRISP_OK);
+          REQUIRE(cached_size == plain_size);
+          CHECK(cached_packet == plain_packet);
+
+          crisp_unprotect_params_t unprotect{};
+          unprotect.packet = {cached_packet.data(), cached_size};
+          unprotect.keys = &keys;
+          unprotect.cmac_prefix = &prefix;
+          std::vector<uint8_t> out(len + 1U);
+          crisp_unprotect_result_t result{};
+          REQUIRE(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) == CRISP_OK);
+          CHECK(std::equal(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(len),
+                           payload.begin()));
+
+          cached_packet[cached_size - 1U] ^= 0x01U;
+          CHECK(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) ==
+                CRISP_ERR_CRYPTO);
+        }
+      }
+    }
+
+    {
+      // A header that does not match the cache (ExternalKeyIdFlag set) takes the full CMAC.
+      crisp_cmac_prefix_t prefix{};
+      REQUIRE(crisp_session_cmac_prefix_init(&prefix, &keys, false, CRISP_SUITE_CS1, true,
+                                             key_ids[1]) == CRISP_OK);
+      REQUIRE(prefix.size > 0U);
+
+      crisp_protect_params_t protect{};
+      protect.cs = CRISP_SUITE_CS1;
+      protect.key_id_present = true;
+      protect.key_id = key_ids[1];
+      protect.external_key_id_flag = true;
+      protect.seqnum = 7U;
+      protect.payload = {payload.data(), payload.size()};
+      protect.keys = &keys;
+
+      std::array<uint8_t, 256> plain_packet{};
+      std::array<uint8_t, 256> cached_packet{};
+      size_t plain_size = 0U;
+      size_t cached_size = 0U;
+      REQUIRE(crisp_protect(&protect, {plain_packet.data(), plain_packet.size()}, &plain_size) ==
+              CRISP_OK);
+      protect.cmac_prefix = &prefix;
+      REQUIRE(crisp_protect(&protect, {cached_packet.data(), cached_packet.size()},
+                            &cached_size) == CRISP_OK);
+      CHECK(cached_packet == plain_packet);
+    }
+
+    crisp_crypto_keys_release(&keys);
+  }
+}
+
+TEST_CASE("Magma CMAC prefix is ignored once its keys are replaced", "[magma][cmac_prefix]") {
+  const crisp_crypto_iface_t iface = make_magma_iface();
+  std::array<uint8_t, 32> other_kmac = kGostKey;
+  other_kmac[0] ^= 0x5AU;
+  std::vector<uint8_t> data(40U);
+  for (size_t i = 0U; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(0x3DU * i + 7U);
+  }
+
+  crisp_crypto_keys_t old_keys{};
+  REQUIRE(crisp_crypto_keys_init(&old_keys, &iface, {kGostKey.data(), kGostKey.size()},
+                                 {kGostKey.data(), kGostKey.size()}) == CRISP_OK);
+  crisp_cmac_prefix_t prefix{};
+  REQUIRE(crisp_cmac_prefix_init(&prefix, &old_keys, {data.data(), 16U}) == CRISP_OK);
+  REQUIRE(prefix.size == 16U);
+  crisp_crypto_keys_release(&old_keys);
+
+  crisp_crypto_keys_t new_keys{};
+  REQUIRE(crisp_crypto_keys_init(&new_keys, &iface, {kGostKey.data(), kGostKey.size()},
+                                 {other_kmac.data(), other_kmac.size()}) == CRISP_OK);
+  CHECK(new_keys.generation != prefix.generation);
+  // The allocator may hand the released Kmac context address to the new keys; force that case.
+  prefix.kmac_ctx = new_keys.kmac_ctx;
+
+  std::array<uint8_t, 8> expected{};
+  std::array<uint8_t, 8> icv{};
+  REQUIRE(crisp_crypto_cmac(&new_keys, {data.data(), data.size()},
+                            {expected.data(), expected.size()}) == CRISP_OK);
+  REQUIRE(crisp_crypto_cmac_prefixed(&new_keys, &prefix, {data.data(), data.size()},
+                                     {icv.data(), icv.size()}) == CRISP_OK);
+  CHECK(icv == expected);
+  crisp_crypto_keys_release(&new_keys);
+}
+
+TEST_CASE("Magma segmented CMAC and offset CTR match contiguous ops", "[magma][iov]") {
+  const crisp_crypto_iface_t iface = make_magma_iface();
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kGostKey.data(), kGostKey.size()},
+                                 {kGostPlaintext.data(), kGostPlaintext.size()}) == CRISP_OK);
+  REQUIRE(crisp_crypto_keys_have_segmented(&keys));
+
+  std::vector<uint8_t> data(100U);
+  for (size_t i = 0U; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(0x5BU * i + 1U);
+  }
+  crisp_cmac_prefix_t prefix{};
+  REQUIRE(crisp_cmac_prefix_init(&prefix, &keys, {data.data(), 24U}) == CRISP_OK);
+  REQUIRE(prefix.size == 24U);
+
+  std::mt19937 rng(21U);
+  for (size_t len = 0U; len <= data.size(); ++len) {
+    const std::vector<crisp_const_byte_span_t> segments = split_random(data.data(), len, 0U, rng);
+
+    std::array<uint8_t, 8> expected{};
+    REQUIRE(crisp_crypto_cmac(&keys, {data.data(), len}, {expected.data(), expected.size()}) ==
+            CRISP_OK);
+    for (const crisp_cmac_prefix_t* cache : {static_cast<const crisp_cmac_prefix_t*>(nullptr),
+                                             static_cast<const crisp_cmac_prefix_t*>(&prefix)}) {
+      crisp_cmac_stream_t stream{};
+      REQUIRE(crisp_crypto_cmac_stream_init(&keys, cache, {data.data(), len}, &stream) ==
+              CRISP_OK);
+      for (const crisp_const_byte_span_t& segment : segments) {
+        REQUIRE(crisp_crypto_cmac_stream_update(&keys, &stream, segment) == CRISP_OK);
+      }
+      std::array<uint8_t, 8> icv{};
+      REQUIRE(crisp_crypto_cmac_stream_final(&keys, &stream, {icv.data(), icv.size()}) ==
+              CRISP_OK);
+      CHECK(icv == expected);
+    }
+
+    std::vector<uint8_t> contiguous(len);
+    REQUIRE(crisp_crypto_ctr_xcrypt(&keys, 0x12345678U, {data.data(), len},
+                                    {contiguous.data(), len}) == CRISP_OK);
+    std::vector<uint8_t> pieces(len);
+    size_t offset = 0U;
+    for (const crisp_const_byte_span_t& segment : segments) {
+      REQUIRE(crisp_crypto_ctr_xcrypt_at(&keys, 0x12345678U, offset, segment,
+                                         {pieces.data() + offset, segment.size}) == CRISP_OK);
+      offset += segment.size;
+    }
+    CHECK(pieces == contiguous);
+  }
+
+  // The offset form reproduces the GOST vector from any starting byte, in place.
+  for (size_t start = 0U; start < kGostPlaintext.size(); ++start) {
+    std::vector<uint8_t> tail(kGostPlaintext.begin() + static_cast<std::ptrdiff_t>(start),
+                              kGostPlaintext.end());
+    REQUIRE(crisp_crypto_ctr_xcrypt_at(&keys, 0x12345678U, start, {tail.data(), tail.size()},
+                                       {tail.data(), tail.size()}) == CRISP_OK);
+    CHECK(std::equal(tail.begin(), tail.end(),
+                     kGostCtrCiphertext.begin() + static_cast<std::ptrdiff_t>(start)));
+  }
+  crisp_crypto_keys_release(&keys);
+}
+
+TEST_CASE("Magma scattered protect/unprotect matches contiguous packets",
+          "[magma][iov][message]") {
+  crisp_crypto_iface_t segmented_iface = make_magma_iface();
+  crisp_crypto_iface_t linear_iface = segmented_iface;
+  linear_iface.magma_cmac_update = nullptr;
+  linear_iface.magma_cmac_final = nullptr;
+  linear_iface.magma_ctr_xcrypt_at = nullptr;
+
+  const std::array<uint8_t, 1> key_id_short{0x05U};
+  const std::array<uint8_t, 9> key_id_9{0x88U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U};
+  const std::array<crisp_const_byte_span_t, 2> key_ids{
+      {{key_id_short.data(), key_id_short.size()}, {key_id_9.data(), key_id_9.size()}}};
+  std::vector<uint8_t> payload(90U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(0x11U * i + 3U);
+  }
+
+  std::mt19937 rng(2026U);
+  for (crisp_crypto_iface_t* iface : {&segmented_iface, &linear_iface}) {
+    crisp_crypto_keys_t keys{};
+    REQUIRE(crisp_crypto_keys_init(&keys, iface, {kGostKey.data(), kGostKey.size()},
+                                   {kGostPlaintext.data(), kGostPlaintext.size()}) == CRISP_OK);
+    CHECK(crisp_crypto_keys_have_segmented(&keys) == (iface == &segmented_iface));
+
+    for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1),
+                             static_cast<uint8_t>(CRISP_SUITE_CS2),
+                             static_cast<uint8_t>(CRISP_SUITE_CS3),
+                             static_cast<uint8_t>(CRISP_SUITE_CS4)}) {
+      for (const crisp_const_byte_span_t key_id : key_ids) {
+        crisp_cmac_prefix_t prefix{};
+        REQUIRE(crisp_session_cmac_prefix_init(&prefix, &keys, false, cs, true, key_id) ==
+                CRISP_OK);
+        for (size_t len = 0U; len <= payload.size(); len += 7U) {
+          crisp_protect_params_t protect{};
+          protect.cs = cs;
+          protect.key_id_present = true;
+          protect.key_id = key_id;
+          protect.seqnum = 0x0000ABCDEF00ULL + len;
+          protect.payload = {payload.data(), len};
+          protect.keys = &keys;
+          std::array<uint8_t, 128> expected{};
+          size_t expected_size = 0U;
+          REQUIRE(crisp_protect(&protect, {expected.data(), expected.size()}, &expected_size) ==
+                  CRISP_OK);
+
+          const std::vector<crisp_const_byte_span_t> payload_iov =
+              split_random(payload.data(), len, 0U, rng);
+          protect.payload = {};
+          std::array<uint8_t, 128> packet{};
+          size_t packet_size = 0U;
+          REQUIRE(crisp_protect_iov(&protect, payload_iov.data(), payload_iov.size(),
+                                    {packet.data(), packet.size()}, &packet_size) == CRISP_OK);
+          REQUIRE(packet_size == expected_size);
+          CHECK(packet == expected);
+
+          const size_t header_size = 3U + key_id.size + 6U;
+          const std::vector<crisp_const_byte_span_t> packet_iov =
+              split_random(packet.data(), packet_size, header_size, rng);
+          crisp_unprotect_params_t unprotect{};
+          unprotect.keys = &keys;
+          unprotect.cmac_prefix = (len % 2U) == 0U ? &prefix : nullptr;
+          std::vector<uint8_t> out(len + 1U, 0xEEU);
+          crisp_unprotect_result_t result{};
+          REQUIRE(crisp_unprotect_iov(&unprotect, packet_iov.data(), packet_iov.size(),
+                                      {out.data(), out.size()}, &result) == CRISP_OK);
+          REQUIRE(result.plaintext.size == len);
+          CHECK(std::equal(payload.begin(), payload.begin() + static_cast<std::ptrdiff_t>(len),
+                           out.begin()));
+          CHECK(out[len] == 0xEEU);
+          CHECK(result.seqnum == protect.seqnum);
+          CHECK(result.key_id.data == packet.data() + 3U);
+
+          // A forged ICV byte (possibly in its own segment) leaves the output untouched.
+          packet[packet_size - 1U] ^= 0x01U;
+          std::fill(out.begin(), out.end(), static_cast<uint8_t>(0xEEU));
+          CHECK(crisp_unprotect_iov(&unprotect, packet_iov.data(), packet_iov.size(),
+                                    {out.data(), out.size()}, &result) == CRISP_ERR_CRYPTO);
+          CHECK(std::all_of(out.begin(), out.end(), [](uint8_t b) { return b == 0xEEU; }));
+        }
+      }
+    }
+    crisp_crypto_keys_release(&keys);
+  }
+}
+
+TEST_CASE("Scattered unprotect requires the header in the first segment", "[magma][iov]") {
+  const crisp_crypto_iface_t iface = make_magma_iface();
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kGostKey.data(), kGostKey.size()},
+                                 {kGostPlaintext.data(), kGostPlaintext.size()}) == CRISP_OK);
+  const std::vector<uint8_t> payload(32U, 0x42U);
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.seqnum = 5U;
+  protect.payload = {payload.data(), payload.size()};
+  protect.keys = &keys;
+  std::array<uint8_t, 64> packet{};
+  size_t packet_size = 0U;
+  REQUIRE(crisp_protect(&protect, {packet.data(), packet.size()}, &packet_size) == CRISP_OK);
+
+  crisp_unprotect_params_t unprotect{};
+  unprotect.keys = &keys;
+  std::array<uint8_t, 64> out{};
+  crisp_unprotect_result_t result{};
+  // Unused KeyId: the header through the SeqNum is 10 bytes.
+  const std::array<crisp_const_byte_span_t, 2> split_header{
+      {{packet.data(), 9U}, {packet.data() + 9U, packet_size - 9U}}};
+  CHECK(crisp_unprotect_iov(&unprotect, split_header.data(), split_header.size(),
+                            {out.data(), out.size()}, &result) == CRISP_ERR_INVALID_ARGUMENT);
+  const std::array<crisp_const_byte_span_t, 2> split_payload{
+      {{packet.data(), 10U}, {packet.data() + 10U, packet_size - 10U}}};
+  CHECK(crisp_unprotect_iov(&unprotect, split_payload.data(), split_payload.size(),
+                            {out.data(), out.size()}, &result) == CRISP_OK);
+  const std::array<crisp_const_byte_span_t, 2> truncated{
+      {{packet.data(), 4U}, {packet.data() + 4U, 6U}}};
+  CHECK(crisp_unprotect_iov(&unprotect, truncated.data(), truncated.size(),
+                            {out.data(), out.size()}, &result) == CRISP_ERR_INVALID_SIZE);
+  CHECK(crisp_unprotect_iov(&unprotect, nullptr, 1U, {out.data(), out.size()}, &result) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_unprotect_iov(&unprotect, split_payload.data(), 0U, {out.data(), out.size()},
+                            &result) == CRISP_ERR_INVALID_ARGUMENT);
+  crisp_crypto_keys_release(&keys);
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <vector>
 
@@ -504,6 +505,159 @@ TEST_CASE("Unprotect rejects replayed sequence number", "[message]") {
   CHECK(result.seqnum == 101U);
 }
 
+namespace {
+
+struct CmacCounter {
+  crisp_crypto_iface_t inner{};
+  size_t cmac_calls = 0U;
+};
+
+crisp_error_t counting_cmac(void* user_ctx,
+                            crisp_const_byte_span_t key,
+                            crisp_const_byte_span_t data,
+                            crisp_mutable_byte_span_t out_icv) {
+  auto* counter = static_cast<CmacCounter*>(user_ctx);
+  ++counter->cmac_calls;
+  return counter->inner.magma_cmac(counter->inner.user_ctx, key, data, out_icv);
+}
+
+crisp_error_t forwarding_ctr(void* user_ctx,
+                             crisp_const_byte_span_t key,
+                             uint32_t iv32,
+                             crisp_const_byte_span_t in,
+                             crisp_mutable_byte_span_t out) {
+  auto* counter = static_cast<CmacCounter*>(user_ctx);
+  return counter->inner.magma_ctr_xcrypt(counter->inner.user_ctx, key, iv32, in, out);
+}
+
+}  // namespace
+
+TEST_CASE("Replayed packets are rejected before the ICV is computed", "[message]") {
+  crisp_dummy_crypto_state_t state{0x0F1E2D3C4B5A6978ULL};
+  CmacCounter counter{};
+  crisp_dummy_crypto_iface_init(&counter.inner, &state);
+  crisp_crypto_iface_t iface{};
+  iface.user_ctx = &counter;
+  iface.magma_cmac = counting_cmac;
+  iface.magma_ctr_xcrypt = forwarding_ctr;
+  const auto kenc = make_key_material(0x53U);
+  const auto kmac = make_key_material(0x63U);
+  const std::array<uint8_t, 4> payload{0x01U, 0x02U, 0x03U, 0x04U};
+
+  crisp_replay_window_t replay{};
+  REQUIRE(crisp_replay_window_init(&replay, 16U) == CRISP_OK);
+
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.payload = {payload.data(), payload.size()};
+  protect.kenc = {kenc.data(), kenc.size()};
+  protect.kmac = {kmac.data(), kmac.size()};
+  protect.crypto = &iface;
+
+  std::array<uint8_t, 32> plaintext_out{};
+  crisp_unprotect_params_t unprotect{};
+  unprotect.kenc = {kenc.data(), kenc.size()};
+  unprotect.kmac = {kmac.data(), kmac.size()};
+  unprotect.crypto = &iface;
+  unprotect.replay_window = &replay;
+  crisp_unprotect_result_t result{};
+
+  std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> fresh{};
+  std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> stale{};
+  size_t fresh_size = 0U;
+  size_t stale_size = 0U;
+  protect.seqnum = 500U;
+  REQUIRE(crisp_protect(&protect, {fresh.data(), fresh.size()}, &fresh_size) == CRISP_OK);
+  protect.seqnum = 400U;
+  REQUIRE(crisp_protect(&protect, {stale.data(), stale.size()}, &stale_size) == CRISP_OK);
+
+  unprotect.packet = {fresh.data(), fresh_size};
+  REQUIRE(crisp_unprotect(&unprotect, {plaintext_out.data(), plaintext_out.size()}, &result) ==
+          CRISP_OK);
+
+  // Duplicate (even with a forged ICV) and too-old SeqNums cost no CMAC.
+  counter.cmac_calls = 0U;
+  CHECK(crisp_unprotect(&unprotect, {plaintext_out.data(), plaintext_out.size()}, &result) ==
+        CRISP_ERR_REPLAY);
+  fresh[fresh_size - 1U] ^= 0x01U;
+  CHECK(crisp_unprotect(&unprotect, {plaintext_out.data(), plaintext_out.size()}, &result) ==
+        CRISP_ERR_REPLAY);
+  unprotect.packet = {stale.data(), stale_size};
+  CHECK(crisp_unprotect(&unprotect, {plaintext_out.data(), plaintext_out.size()}, &result) ==
+        CRISP_ERR_REPLAY);
+  CHECK(counter.cmac_calls == 0U);
+
+  // Batch path probes too: only the fresh packet reaches the CMAC stage.
+  std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> next{};
+  size_t next_size = 0U;
+  protect.seqnum = 501U;
+  REQUIRE(crisp_protect(&protect, {next.data(), next.size()}, &next_size) == CRISP_OK);
+  crisp_unprotect_batch_params_t batch{};
+  batch.kenc = unprotect.kenc;
+  batch.kmac = unprotect.kmac;
+  batch.crypto = &iface;
+  batch.replay_window = &replay;
+  const std::array<crisp_const_byte_span_t, 2> packets{{{stale.data(), stale_size},
+                                                        {next.data(), next_size}}};
+  std::array<uint8_t, 32> plaintext2{};
+  const std::array<crisp_mutable_byte_span_t, 2> outs{{{plaintext_out.data(), plaintext_out.size()},
+                                                       {plaintext2.data(), plaintext2.size()}}};
+  std::array<crisp_unprotect_result_t, 2> results{};
+  std::array<crisp_error_t, 2> status{};
+  counter.cmac_calls = 0U;
+  REQUIRE(crisp_unprotect_batch(&batch, packets.data(), outs.data(), results.data(), status.data(),
+                                2U) == CRISP_OK);
+  CHECK(status[0] == CRISP_ERR_REPLAY);
+  CHECK(status[1] == CRISP_OK);
+  CHECK(counter.cmac_calls == 1U);
+}
+
+TEST_CASE("Unprotect rejects replay through a concurrent window", "[message]") {
+  crisp_dummy_crypto_state_t state{0x5566778899AABBCCULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x52U);
+  const auto kmac = make_key_material(0x62U);
+  const std::array<uint8_t, 3> payload{0x0AU, 0x0BU, 0x0CU};
+
+  std::array<uint64_t, 8> storage{};
+  crisp_concurrent_replay_window_t concurrent{};
+  REQUIRE(crisp_concurrent_replay_window_init(&concurrent, 64U, storage.data(), storage.size()) ==
+          CRISP_OK);
+
+  std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> packet{};
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS2;
+  protect.seqnum = 200U;
+  protect.payload = {payload.data(), payload.size()};
+  protect.kenc = {kenc.data(), kenc.size()};
+  protect.kmac = {kmac.data(), kmac.size()};
+  protect.crypto = &iface;
+
+  size_t written = 0U;
+  REQUIRE(crisp_protect(&protect, {packet.data(), packet.size()}, &written) == CRISP_OK);
+
+  std::array<uint8_t, 32> plaintext_out{};
+  crisp_unprotect_params_t unprotect{};
+  unprotect.packet = {packet.data(), written};
+  unprotect.kenc = {kenc.data(), kenc.size()};
+  unprotect.kmac = {kmac.data(), kmac.size()};
+  unprotect.crypto = &iface;
+  unprotect.concurrent_replay_window = &concurrent;
+
+  crisp_unprotect_result_t result{};
+  REQUIRE(crisp_unprotect(&unprotect, {plaintext_out.data(), plaintext_out.size()}, &result) ==
+          CRISP_OK);
+  CHECK(crisp_unprotect(&unprotect, {plaintext_out.data(), plaintext_out.size()}, &result) ==
+        CRISP_ERR_REPLAY);
+
+  // Both window kinds at once are ambiguous.
+  crisp_replay_window_t replay{};
+  REQUIRE(crisp_replay_window_init(&replay, 32U) == CRISP_OK);
+  unprotect.replay_window = &replay;
+  CHECK(crisp_unprotect(&unprotect, {plaintext_out.data(), plaintext_out.size()}, &result) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+}
+
 TEST_CASE("ICV mismatch does not update replay window", "[message]") {
   crisp_dummy_crypto_state_t state{0xCAFEBABE12344321ULL};
   const crisp_crypto_iface_t iface = make_dummy_iface(&state);
@@ -717,3 +871,820 @@ TEST_CASE("Parse rejects packet larger than 2048", "[message]") {
   crisp_message_view_t parsed{};
   CHECK(crisp_parse_message({oversized.data(), oversized.size()}, &parsed) == CRISP_ERR_INVALID_SIZE);
 }
+
+TEST_CASE("Protect batch matches single-packet protect", "[message][batch]") {
+  crisp_dummy_crypto_state_t state{0x0F1E2D3C4B5A6978ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x12U);
+  const auto kmac = make_key_material(0x34U);
+  const std::array<uint8_t, 3> key_id{0x82U, 0x01U, 0x02U};
+
+  constexpr size_t kCount = 5U;
+  std::array<std::vector<uint8_t>, kCount> payloads{};
+  std::array<uint64_t, kCount> seqnums{};
+  std::array<crisp_const_byte_span_t, kCount> payload_spans{};
+  for (size_t i = 0U; i < kCount; ++i) {
+    payloads[i].assign(i * 7U, static_cast<uint8_t>(0x40U + i));
+    seqnums[i] = 0x0000AABB0000ULL + i;
+    payload_spans[i] = {payloads[i].data(), payloads[i].size()};
+  }
+
+  for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1), static_cast<uint8_t>(CRISP_SUITE_CS4)}) {
+    crisp_protect_batch_params_t batch{};
+    batch.external_key_id_flag = true;
+    batch.cs = cs;
+    batch.key_id_present = true;
+    batch.key_id = {key_id.data(), key_id.size()};
+    batch.kenc = {kenc.data(), kenc.size()};
+    batch.kmac = {kmac.data(), kmac.size()};
+    batch.crypto = &iface;
+
+    std::array<std::array<uint8_t, 128>, kCount> packets{};
+    std::array<crisp_mutable_byte_span_t, kCount> packet_spans{};
+    for (size_t i = 0U; i < kCount; ++i) {
+      packet_spans[i] = {packets[i].data(), packets[i].size()};
+    }
+    std::array<size_t, kCount> sizes{};
+    std::array<crisp_error_t, kCount> status{};
+    REQUIRE(crisp_protect_batch(&batch, seqnums.data(), payload_spans.data(), packet_spans.data(),
+                                sizes.data(), status.data(), kCount) == CRISP_OK);
+
+    for (size_t i = 0U; i < kCount; ++i) {
+      REQUIRE(status[i] == CRISP_OK);
+
+      crisp_protect_params_t single{};
+      single.external_key_id_flag = batch.external_key_id_flag;
+      single.cs = cs;
+      single.key_id_present = true;
+      single.seqnum = seqnums[i];
+      single.key_id = batch.key_id;
+      single.payload = payload_spans[i];
+      single.kenc = batch.kenc;
+      single.kmac = batch.kmac;
+      single.crypto = &iface;
+
+      std::array<uint8_t, 128> expected{};
+      size_t expected_size = 0U;
+      REQUIRE(crisp_protect(&single, {expected.data(), expected.size()}, &expected_size) == CRISP_OK);
+      REQUIRE(sizes[i] == expected_size);
+      for (size_t j = 0U; j < expected_size; ++j) {
+        CHECK(packets[i][j] == expected[j]);
+      }
+    }
+  }
+}
+
+TEST_CASE("Protect batch reports per-packet status", "[message][batch]") {
+  crisp_dummy_crypto_state_t state{0x5555AAAA5555AAAAULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x01U);
+  const auto kmac = make_key_material(0x02U);
+  const std::array<uint8_t, 16> payload{};
+
+  crisp_protect_batch_params_t batch{};
+  batch.cs = CRISP_SUITE_CS2;
+  batch.key_id_present = false;
+  batch.kenc = {kenc.data(), kenc.size()};
+  batch.kmac = {kmac.data(), kmac.size()};
+  batch.crypto = &iface;
+
+  std::array<uint8_t, 64> ok_packet{};
+  std::array<uint8_t, 8> small_packet{};
+  small_packet.fill(0xC3U);
+  const std::array<uint64_t, 3> seqnums{1U, CRISP_SEQNUM_MAX + 1ULL, 2U};
+  const std::array<crisp_const_byte_span_t, 3> payloads{
+      crisp_const_byte_span_t{payload.data(), payload.size()},
+      crisp_const_byte_span_t{payload.data(), payload.size()},
+      crisp_const_byte_span_t{payload.data(), payload.size()}};
+  const std::array<crisp_mutable_byte_span_t, 3> out_packets{
+      crisp_mutable_byte_span_t{ok_packet.data(), ok_packet.size()},
+      crisp_mutable_byte_span_t{ok_packet.data(), ok_packet.size()},
+      crisp_mutable_byte_span_t{small_packet.data(), small_packet.size()}};
+  std::array<size_t, 3> sizes{};
+  std::array<crisp_error_t, 3> status{};
+
+  REQUIRE(crisp_protect_batch(&batch, seqnums.data(), payloads.data(), out_packets.data(),
+                              sizes.data(), status.data(), seqnums.size()) == CRISP_OK);
+  CHECK(status[0] == CRISP_OK);
+  CHECK(sizes[0] == CRISP_MESSAGE_HEADER_PREFIX_SIZE + 1U + CRISP_MESSAGE_SEQNUM_SIZE +
+                        payload.size() + 4U);
+  CHECK(status[1] == CRISP_ERR_OUT_OF_RANGE);
+  CHECK(sizes[1] == 0U);
+  CHECK(status[2] == CRISP_ERR_BUFFER_TOO_SMALL);
+  for (uint8_t byte : small_packet) {
+    CHECK(byte == 0xC3U);
+  }
+
+  status.fill(CRISP_OK);
+  batch.cs = 9U;
+  CHECK(crisp_protect_batch(&batch, seqnums.data(), payloads.data(), out_packets.data(),
+                            sizes.data(), status.data(), seqnums.size()) ==
+        CRISP_ERR_UNSUPPORTED_SUITE);
+  CHECK(status[1] == CRISP_OK);
+}
+
+TEST_CASE("Unprotect batch stages replay in SeqNum order with per-packet verdicts",
+          "[message][batch]") {
+  crisp_dummy_crypto_state_t state{0x7777000011112222ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x61U);
+  const auto kmac = make_key_material(0x71U);
+  const std::array<uint8_t, 1> key_id{0x05U};
+
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.key_id_present = true;
+  protect.key_id = {key_id.data(), key_id.size()};
+  protect.kenc = {kenc.data(), kenc.size()};
+  protect.kmac = {kmac.data(), kmac.size()};
+  protect.crypto = &iface;
+
+  // Arrival order 20, 17, 16, 17 (duplicate), 30 (tampered ICV).
+  const std::array<uint64_t, 5> seqnums{20U, 17U, 16U, 17U, 30U};
+  std::array<std::vector<uint8_t>, 5> packets{};
+  std::array<crisp_const_byte_span_t, 5> packet_spans{};
+  for (size_t i = 0U; i < seqnums.size(); ++i) {
+    const std::array<uint8_t, 6> payload{static_cast<uint8_t>(i), 0x11U, 0x22U, 0x33U, 0x44U, 0x55U};
+    protect.seqnum = seqnums[i];
+    protect.payload = {payload.data(), payload.size()};
+    packets[i].resize(CRISP_MAX_MESSAGE_SIZE);
+    size_t written = 0U;
+    REQUIRE(crisp_protect(&protect, {packets[i].data(), packets[i].size()}, &written) == CRISP_OK);
+    packets[i].resize(written);
+  }
+  packets[4].back() ^= 0x01U;
+  for (size_t i = 0U; i < packets.size(); ++i) {
+    packet_spans[i] = {packets[i].data(), packets[i].size()};
+  }
+
+  crisp_replay_window_t replay{};
+  REQUIRE(crisp_replay_window_init(&replay, 4U) == CRISP_OK);
+
+  crisp_unprotect_batch_params_t batch{};
+  batch.kenc = {kenc.data(), kenc.size()};
+  batch.kmac = {kmac.data(), kmac.size()};
+  batch.crypto = &iface;
+  batch.replay_window = &replay;
+
+  std::array<std::array<uint8_t, 16>, 5> plaintexts{};
+  std::array<crisp_mutable_byte_span_t, 5> plaintext_spans{};
+  for (size_t i = 0U; i < plaintexts.size(); ++i) {
+    plaintexts[i].fill(0xEEU);
+    plaintext_spans[i] = {plaintexts[i].data(), plaintexts[i].size()};
+  }
+  std::array<crisp_unprotect_result_t, 5> results{};
+  std::array<crisp_error_t, 5> status{};
+
+  REQUIRE(crisp_unprotect_batch(&batch, packet_spans.data(), plaintext_spans.data(), results.data(),
+                                status.data(), packets.size()) == CRISP_OK);
+
+  // Sequential processing would reject 16 (20 - 16 >= window size); the batch sorts first.
+  CHECK(status[0] == CRISP_OK);
+  CHECK(status[1] == CRISP_OK);
+  CHECK(status[2] == CRISP_OK);
+  CHECK(status[3] == CRISP_ERR_REPLAY);
+  CHECK(status[4] == CRISP_ERR_CRYPTO);
+
+  for (size_t i = 0U; i < 3U; ++i) {
+    CHECK(results[i].seqnum == seqnums[i]);
+    REQUIRE(results[i].plaintext.size == 6U);
+    CHECK(plaintexts[i][0] == static_cast<uint8_t>(i));
+    CHECK(plaintexts[i][5] == 0x55U);
+  }
+  for (size_t i = 3U; i < 5U; ++i) {
+    for (uint8_t byte : plaintexts[i]) {
+      CHECK(byte == 0xEEU);
+    }
+  }
+
+  // The tampered packet must not have advanced the window.
+  packets[4].back() ^= 0x01U;
+  crisp_unprotect_params_t single{};
+  single.packet = {packets[4].data(), packets[4].size()};
+  single.kenc = batch.kenc;
+  single.kmac = batch.kmac;
+  single.crypto = &iface;
+  single.replay_window = &replay;
+  crisp_unprotect_result_t result{};
+  CHECK(crisp_unprotect(&single, plaintext_spans[4], &result) == CRISP_OK);
+}
+
+namespace {
+
+crisp_error_t failing_ctr(void*,
+                          crisp_const_byte_span_t,
+                          uint32_t,
+                          crisp_const_byte_span_t,
+                          crisp_mutable_byte_span_t out) {
+  std::fill(out.data, out.data + out.size, 0xCCU);
+  return CRISP_ERR_NOT_SUPPORTED;
+}
+
+}  // namespace
+
+TEST_CASE("Unprotect batch zeroes payloads when the CTR backend fails after the window commit",
+          "[message][batch]") {
+  crisp_dummy_crypto_state_t state{0x0BADC0DE0BADC0DEULL};
+  const crisp_crypto_iface_t good = make_dummy_iface(&state);
+  CmacCounter counter{};
+  counter.inner = good;
+  crisp_crypto_iface_t broken{};
+  broken.user_ctx = &counter;
+  broken.magma_cmac = counting_cmac;
+  broken.magma_ctr_xcrypt = failing_ctr;
+  const auto kenc = make_key_material(0x31U);
+  const auto kmac = make_key_material(0x41U);
+  const std::array<uint8_t, 5> payload{0x10U, 0x20U, 0x30U, 0x40U, 0x50U};
+
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.payload = {payload.data(), payload.size()};
+  protect.kenc = {kenc.data(), kenc.size()};
+  protect.kmac = {kmac.data(), kmac.size()};
+  protect.crypto = &good;
+  std::array<std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE>, 2> packets{};
+  std::array<crisp_const_byte_span_t, 2> packet_spans{};
+  for (size_t i = 0U; i < packets.size(); ++i) {
+    protect.seqnum = 7U + i;
+    size_t written = 0U;
+    REQUIRE(crisp_protect(&protect, {packets[i].data(), packets[i].size()}, &written) ==
+            CRISP_OK);
+    packet_spans[i] = {packets[i].data(), written};
+  }
+  packets[1][packet_spans[1].size - 1U] ^= 0x01U;
+
+  crisp_replay_window_t replay{};
+  REQUIRE(crisp_replay_window_init(&replay, 16U) == CRISP_OK);
+  crisp_unprotect_batch_params_t batch{};
+  batch.kenc = protect.kenc;
+  batch.kmac = protect.kmac;
+  batch.crypto = &broken;
+  batch.replay_window = &replay;
+  std::array<std::array<uint8_t, 8>, 2> plaintexts{};
+  std::array<crisp_mutable_byte_span_t, 2> plaintext_spans{};
+  for (size_t i = 0U; i < plaintexts.size(); ++i) {
+    plaintexts[i].fill(0xEEU);
+    plaintext_spans[i] = {plaintexts[i].data(), plaintexts[i].size()};
+  }
+  std::array<crisp_unprotect_result_t, 2> results{};
+  std::array<crisp_error_t, 2> status{};
+  REQUIRE(crisp_unprotect_batch(&batch, packet_spans.data(), plaintext_spans.data(),
+                                results.data(), status.data(), 2U) == CRISP_OK);
+
+  // The authenticated packet carries the backend error, its payload bytes are zeroed and the
+  // rest of the buffer is untouched; the forged one is rejected before stage 4.
+  CHECK(status[0] == CRISP_ERR_NOT_SUPPORTED);
+  CHECK(status[1] == CRISP_ERR_CRYPTO);
+  for (size_t j = 0U; j < plaintexts[0].size(); ++j) {
+    CHECK(plaintexts[0][j] == (j < payload.size() ? 0x00U : 0xEEU));
+  }
+  for (uint8_t byte : plaintexts[1]) {
+    CHECK(byte == 0xEEU);
+  }
+
+  // Stage 3 already consumed SeqNum 7; the forged SeqNum 8 is still open.
+  crisp_unprotect_params_t single{};
+  single.kenc = batch.kenc;
+  single.kmac = batch.kmac;
+  single.crypto = &good;
+  single.replay_window = &replay;
+  crisp_unprotect_result_t result{};
+  single.packet = packet_spans[0];
+  CHECK(crisp_unprotect(&single, plaintext_spans[0], &result) == CRISP_ERR_REPLAY);
+  packets[1][packet_spans[1].size - 1U] ^= 0x01U;
+  single.packet = packet_spans[1];
+  CHECK(crisp_unprotect(&single, plaintext_spans[1], &result) == CRISP_OK);
+}
+
+TEST_CASE("Unprotect batch rejects invalid shared parameters", "[message][batch]") {
+  crisp_unprotect_batch_params_t batch{};
+  std::array<crisp_error_t, 1> status{CRISP_OK};
+  const std::array<crisp_const_byte_span_t, 1> packets{};
+  const std::array<crisp_mutable_byte_span_t, 1> plaintexts{};
+  std::array<crisp_unprotect_result_t, 1> results{};
+
+  CHECK(crisp_unprotect_batch(&batch, packets.data(), plaintexts.data(), results.data(),
+                              status.data(), 1U) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(status[0] == CRISP_OK);
+  CHECK(crisp_unprotect_batch(nullptr, nullptr, nullptr, nullptr, nullptr, 0U) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("Protect/unprotect with prepared keys matches raw-key path", "[message][keys]") {
+  crisp_dummy_crypto_state_t state{0x2468ACE013579BDFULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x0AU);
+  const auto kmac = make_key_material(0x1AU);
+  const std::array<uint8_t, 1> key_id{0x33U};
+  const std::array<uint8_t, 11> payload{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kenc.data(), kenc.size()},
+                                 {kmac.data(), kmac.size()}) == CRISP_OK);
+  REQUIRE(keys.kenc_ctx != nullptr);
+
+  crisp_protect_params_t raw{};
+  raw.cs = CRISP_SUITE_CS3;
+  raw.key_id_present = true;
+  raw.seqnum = 0x123456U;
+  raw.key_id = {key_id.data(), key_id.size()};
+  raw.payload = {payload.data(), payload.size()};
+  raw.kenc = {kenc.data(), kenc.size()};
+  raw.kmac = {kmac.data(), kmac.size()};
+  raw.crypto = &iface;
+
+  crisp_protect_params_t prepared = raw;
+  prepared.kenc = {};
+  prepared.kmac = {};
+  prepared.crypto = nullptr;
+  prepared.keys = &keys;
+
+  std::array<uint8_t, 64> raw_packet{};
+  std::array<uint8_t, 64> prepared_packet{};
+  size_t raw_size = 0U;
+  size_t prepared_size = 0U;
+  REQUIRE(crisp_protect(&raw, {raw_packet.data(), raw_packet.size()}, &raw_size) == CRISP_OK);
+  REQUIRE(crisp_protect(&prepared, {prepared_packet.data(), prepared_packet.size()}, &prepared_size) ==
+          CRISP_OK);
+  REQUIRE(raw_size == prepared_size);
+  CHECK(raw_packet == prepared_packet);
+
+  crisp_unprotect_params_t unprotect{};
+  unprotect.packet = {raw_packet.data(), raw_size};
+  unprotect.keys = &keys;
+  std::array<uint8_t, 16> out{};
+  crisp_unprotect_result_t result{};
+  REQUIRE(crisp_unprotect(&unprotect, {out.data(), out.size()}, &result) == CRISP_OK);
+  REQUIRE(result.plaintext.size == payload.size());
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    CHECK(out[i] == payload[i]);
+  }
+
+  crisp_crypto_keys_release(&keys);
+}
+
+namespace {
+
+struct PreparedResolverState {
+  const crisp_crypto_keys_t* keys = nullptr;
+  bool called = false;
+};
+
+crisp_error_t test_resolve_prepared_keys(void* user_ctx,
+                                         const crisp_key_resolve_request_t* req,
+                                         const crisp_crypto_keys_t** out_keys) {
+  if (user_ctx == nullptr || req == nullptr || out_keys == nullptr) {
+    return CRISP_ERR_INVALID_ARGUMENT;
+  }
+  auto* state = static_cast<PreparedResolverState*>(user_ctx);
+  state->called = true;
+  *out_keys = state->keys;
+  return CRISP_OK;
+}
+
+}  // namespace
+
+TEST_CASE("Unprotect resolve uses prepared keys from resolver", "[message][keys]") {
+  crisp_dummy_crypto_state_t state{0x1020304050607080ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x3AU);
+  const auto kmac = make_key_material(0x4AU);
+  const std::array<uint8_t, 1> key_id{0x07U};
+  const std::array<uint8_t, 3> payload{0xDEU, 0xADU, 0x01U};
+
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &iface, {kenc.data(), kenc.size()},
+                                 {kmac.data(), kmac.size()}) == CRISP_OK);
+
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.key_id_present = true;
+  protect.seqnum = 5U;
+  protect.key_id = {key_id.data(), key_id.size()};
+  protect.payload = {payload.data(), payload.size()};
+  protect.keys = &keys;
+
+  std::array<uint8_t, 64> packet{};
+  size_t written = 0U;
+  REQUIRE(crisp_protect(&protect, {packet.data(), packet.size()}, &written) == CRISP_OK);
+
+  PreparedResolverState resolver_state{};
+  resolver_state.keys = &keys;
+  crisp_key_resolver_t resolver{};
+  resolver.user_ctx = &resolver_state;
+  resolver.resolve_prepared_keys = test_resolve_prepared_keys;
+
+  std::array<uint8_t, 8> out{};
+  crisp_unprotect_result_t result{};
+  REQUIRE(crisp_unprotect_resolve({packet.data(), written}, &resolver, &iface, nullptr,
+                                  {out.data(), out.size()}, &result) == CRISP_OK);
+  CHECK(resolver_state.called);
+  REQUIRE(result.plaintext.size == payload.size());
+  CHECK(out[0] == 0xDEU);
+  CHECK(out[2] == 0x01U);
+
+  crisp_crypto_keys_release(&keys);
+}
+
+TEST_CASE("Staged unprotect parses once and matches crisp_unprotect", "[message][staged]") {
+  crisp_dummy_crypto_state_t state{0x0F0E0D0C0B0A0908ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x15U);
+  const auto kmac = make_key_material(0x25U);
+  const std::array<uint8_t, 3> key_id{0x82U, 0x33U, 0x44U};
+
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS3;
+  protect.key_id_present = true;
+  protect.key_id = {key_id.data(), key_id.size()};
+  protect.kenc = {kenc.data(), kenc.size()};
+  protect.kmac = {kmac.data(), kmac.size()};
+  protect.crypto = &iface;
+
+  std::array<std::vector<uint8_t>, 3> packets{};
+  std::array<crisp_parsed_message_t, 3> messages{};
+  for (size_t i = 0U; i < packets.size(); ++i) {
+    const std::array<uint8_t, 5> payload{static_cast<uint8_t>(i), 0x01U, 0x02U, 0x03U, 0x04U};
+    protect.seqnum = 100U + i;
+    protect.payload = {payload.data(), payload.size()};
+    packets[i].resize(64U);
+    size_t written = 0U;
+    REQUIRE(crisp_protect(&protect, {packets[i].data(), packets[i].size()}, &written) == CRISP_OK);
+    packets[i].resize(written);
+    REQUIRE(crisp_unprotect_parse({packets[i].data(), packets[i].size()}, &messages[i]) ==
+            CRISP_OK);
+  }
+  CHECK(messages[0].view.seqnum == 100U);
+  CHECK(messages[0].suite_params.icv_size == 8U);
+  CHECK(messages[0].view.key_id.size == key_id.size());
+
+  crisp_replay_window_t replay{};
+  REQUIRE(crisp_replay_window_init(&replay, 16U) == CRISP_OK);
+  crisp_unprotect_params_t params{};
+  params.kenc = protect.kenc;
+  params.kmac = protect.kmac;
+  params.crypto = &iface;
+  params.replay_window = &replay;
+
+  std::array<uint8_t, 16> out{};
+  crisp_unprotect_result_t result{};
+  REQUIRE(crisp_unprotect_view(&params, &messages[0], {out.data(), out.size()}, &result) ==
+          CRISP_OK);
+  CHECK(result.seqnum == 100U);
+  REQUIRE(result.plaintext.size == 5U);
+  CHECK(out[4] == 0x04U);
+  CHECK(crisp_unprotect_view(&params, &messages[0], {out.data(), out.size()}, &result) ==
+        CRISP_ERR_REPLAY);
+
+  // A message that did not come from crisp_unprotect_parse() is rejected up front.
+  crisp_parsed_message_t forged = messages[1];
+  forged.suite_params.icv_size = 4U;
+  CHECK(crisp_unprotect_view(&params, &forged, {out.data(), out.size()}, &result) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  const crisp_parsed_message_t empty{};
+  CHECK(crisp_unprotect_view(&params, &empty, {out.data(), out.size()}, &result) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+
+  // The batch stage takes the parsed messages as they are.
+  crisp_unprotect_batch_params_t batch{};
+  batch.kenc = params.kenc;
+  batch.kmac = params.kmac;
+  batch.crypto = &iface;
+  batch.replay_window = &replay;
+  std::array<std::array<uint8_t, 16>, 3> plaintexts{};
+  std::array<crisp_mutable_byte_span_t, 3> plaintext_spans{};
+  for (size_t i = 0U; i < plaintexts.size(); ++i) {
+    plaintext_spans[i] = {plaintexts[i].data(), plaintexts[i].size()};
+  }
+  std::array<crisp_unprotect_result_t, 3> results{};
+  std::array<crisp_error_t, 3> status{};
+  REQUIRE(crisp_unprotect_batch_parsed(&batch, messages.data(), plaintext_spans.data(),
+                                       results.data(), status.data(), messages.size()) ==
+          CRISP_OK);
+  CHECK(status[0] == CRISP_ERR_REPLAY);
+  CHECK(status[1] == CRISP_OK);
+  CHECK(status[2] == CRISP_OK);
+  CHECK(results[2].seqnum == 102U);
+  CHECK(plaintexts[2][0] == 2U);
+}
+
+TEST_CASE("Unprotect resolve on a parsed message shares its view with the resolver",
+          "[message][staged]") {
+  crisp_dummy_crypto_state_t state{0x1111222233334444ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x35U);
+  const auto kmac = make_key_material(0x45U);
+  const std::array<uint8_t, 1> key_id{0x09U};
+  const std::array<uint8_t, 2> payload{0xCAU, 0xFEU};
+
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.key_id_present = true;
+  protect.seqnum = 12U;
+  protect.key_id = {key_id.data(), key_id.size()};
+  protect.payload = {payload.data(), payload.size()};
+  protect.kenc = {kenc.data(), kenc.size()};
+  protect.kmac = {kmac.data(), kmac.size()};
+  protect.crypto = &iface;
+  std::array<uint8_t, 64> packet{};
+  size_t written = 0U;
+  REQUIRE(crisp_protect(&protect, {packet.data(), packet.size()}, &written) == CRISP_OK);
+
+  crisp_parsed_message_t message{};
+  REQUIRE(crisp_unprotect_parse({packet.data(), written}, &message) == CRISP_OK);
+
+  TestResolverState resolver_state{};
+  resolver_state.kenc = protect.kenc;
+  resolver_state.kmac = protect.kmac;
+  crisp_key_resolver_t resolver{};
+  resolver.user_ctx = &resolver_state;
+  resolver.resolve_keys = test_resolve_keys;
+
+  std::array<uint8_t, 8> out{};
+  crisp_unprotect_result_t result{};
+  CHECK(crisp_unprotect_resolve_parsed(nullptr, &resolver, &iface, nullptr,
+                                       {out.data(), out.size()}, &result) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  REQUIRE(crisp_unprotect_resolve_parsed(&message, &resolver, &iface, nullptr,
+                                         {out.data(), out.size()}, &result) == CRISP_OK);
+  REQUIRE(resolver_state.called);
+  CHECK(resolver_state.seqnum == 12U);
+  REQUIRE(resolver_state.key_id.size() == 1U);
+  CHECK(resolver_state.key_id[0] == 0x09U);
+  REQUIRE(result.plaintext.size == payload.size());
+  CHECK(out[1] == 0xFEU);
+}
+
+TEST_CASE("In-place protect matches crisp_protect without copying the payload",
+          "[message][in_place]") {
+  crisp_dummy_crypto_state_t state{0x0F1E2D3C4B5A6978ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x12U);
+  const auto kmac = make_key_material(0x34U);
+  const std::array<uint8_t, 3> key_id{0x82U, 0x01U, 0x02U};
+  std::vector<uint8_t> payload(45U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(0x30U + i);
+  }
+
+  for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1),
+                           static_cast<uint8_t>(CRISP_SUITE_CS2),
+                           static_cast<uint8_t>(CRISP_SUITE_CS3),
+                           static_cast<uint8_t>(CRISP_SUITE_CS4)}) {
+    for (const bool key_id_present : {true, false}) {
+      crisp_protect_params_t params{};
+      params.external_key_id_flag = true;
+      params.cs = cs;
+      params.key_id_present = key_id_present;
+      params.seqnum = 0x0000123456789AULL;
+      if (key_id_present) {
+        params.key_id = {key_id.data(), key_id.size()};
+      }
+      params.payload = {payload.data(), payload.size()};
+      params.kenc = {kenc.data(), kenc.size()};
+      params.kmac = {kmac.data(), kmac.size()};
+      params.crypto = &iface;
+
+      std::array<uint8_t, 128> expected{};
+      size_t expected_size = 0U;
+      REQUIRE(crisp_protect(&params, {expected.data(), expected.size()}, &expected_size) ==
+              CRISP_OK);
+
+      // Extra headroom is allowed; the packet then starts part way into the buffer.
+      const size_t headroom = 3U + (key_id_present ? key_id.size() : 1U) + 6U;
+      const size_t payload_offset = headroom + 5U;
+      std::vector<uint8_t> buffer(payload_offset + payload.size() + CRISP_PROTECT_MAX_TAILROOM,
+                                  0xEEU);
+      std::copy(payload.begin(), payload.end(),
+                buffer.begin() + static_cast<std::ptrdiff_t>(payload_offset));
+      params.payload = {};
+      crisp_mutable_byte_span_t packet{};
+      REQUIRE(crisp_protect_in_place(&params, {buffer.data(), buffer.size()}, payload_offset,
+                                     payload.size(), &packet) == CRISP_OK);
+      CHECK(packet.data == buffer.data() + 5U);
+      REQUIRE(packet.size == expected_size);
+      CHECK(std::equal(packet.data, packet.data + packet.size, expected.begin()));
+      CHECK(buffer[4] == 0xEEU);
+    }
+  }
+}
+
+TEST_CASE("In-place protect rejects short headroom or tailroom without writing",
+          "[message][in_place]") {
+  crisp_dummy_crypto_state_t state{0x0F1E2D3C4B5A6978ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x12U);
+  const auto kmac = make_key_material(0x34U);
+
+  crisp_protect_params_t params{};
+  params.cs = CRISP_SUITE_CS3;
+  params.seqnum = 7U;
+  params.kenc = {kenc.data(), kenc.size()};
+  params.kmac = {kmac.data(), kmac.size()};
+  params.crypto = &iface;
+
+  // Unused KeyId: 10 bytes of headroom, 8 bytes of ICV.
+  std::vector<uint8_t> buffer(10U + 16U + 8U, 0x5AU);
+  const std::vector<uint8_t> before = buffer;
+  crisp_mutable_byte_span_t packet{};
+  CHECK(crisp_protect_in_place(&params, {buffer.data(), buffer.size()}, 9U, 16U, &packet) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(crisp_protect_in_place(&params, {buffer.data(), buffer.size() - 1U}, 10U, 16U,
+                               &packet) == CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(crisp_protect_in_place(&params, {buffer.data(), buffer.size()}, 10U, 25U, &packet) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_protect_in_place(&params, {buffer.data(), buffer.size()}, 10U, 16U, nullptr) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_protect_in_place(&params, {nullptr, buffer.size()}, 10U, 16U, &packet) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(buffer == before);
+
+  REQUIRE(crisp_protect_in_place(&params, {buffer.data(), buffer.size()}, 10U, 16U, &packet) ==
+          CRISP_OK);
+  CHECK(packet.data == buffer.data());
+  CHECK(packet.size == buffer.size());
+
+  crisp_message_view_t view{};
+  REQUIRE(crisp_parse_message({packet.data, packet.size}, &view) == CRISP_OK);
+  CHECK(view.seqnum == 7U);
+  CHECK(view.payload.data == buffer.data() + 10U);
+}
+
+TEST_CASE("In-place unprotect decrypts inside the packet and matches crisp_unprotect",
+          "[message][in_place]") {
+  crisp_dummy_crypto_state_t state{0x0F1E2D3C4B5A6978ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x12U);
+  const auto kmac = make_key_material(0x34U);
+  const std::array<uint8_t, 1> key_id{0x2AU};
+  std::vector<uint8_t> payload(29U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(0x90U + i);
+  }
+
+  for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1),
+                           static_cast<uint8_t>(CRISP_SUITE_CS2),
+                           static_cast<uint8_t>(CRISP_SUITE_CS3),
+                           static_cast<uint8_t>(CRISP_SUITE_CS4)}) {
+    crisp_protect_params_t protect{};
+    protect.cs = cs;
+    protect.key_id_present = true;
+    protect.key_id = {key_id.data(), key_id.size()};
+    protect.seqnum = 0x0000000100000005ULL;
+    protect.payload = {payload.data(), payload.size()};
+    protect.kenc = {kenc.data(), kenc.size()};
+    protect.kmac = {kmac.data(), kmac.size()};
+    protect.crypto = &iface;
+    std::array<uint8_t, 64> wire{};
+    size_t wire_size = 0U;
+    REQUIRE(crisp_protect(&protect, {wire.data(), wire.size()}, &wire_size) == CRISP_OK);
+
+    crisp_unprotect_params_t unprotect{};
+    unprotect.packet = {wire.data(), wire_size};
+    unprotect.kenc = protect.kenc;
+    unprotect.kmac = protect.kmac;
+    unprotect.crypto = &iface;
+    std::array<uint8_t, 64> copied{};
+    crisp_unprotect_result_t expected{};
+    REQUIRE(crisp_unprotect(&unprotect, {copied.data(), copied.size()}, &expected) == CRISP_OK);
+
+    std::vector<uint8_t> packet(wire.begin(),
+                                wire.begin() + static_cast<std::ptrdiff_t>(wire_size));
+    unprotect.packet = {};
+    crisp_const_byte_span_t plaintext{};
+    crisp_unprotect_result_t result{};
+    REQUIRE(crisp_unprotect_in_place(&unprotect, {packet.data(), packet.size()}, &plaintext,
+                                     &result) == CRISP_OK);
+    CHECK(plaintext.data == packet.data() + 3U + 1U + 6U);
+    REQUIRE(plaintext.size == payload.size());
+    CHECK(std::equal(payload.begin(), payload.end(), plaintext.data));
+    CHECK(result.plaintext.data == packet.data() + 3U + 1U + 6U);
+    CHECK(result.seqnum == expected.seqnum);
+    CHECK(result.cs == expected.cs);
+    // Header, SeqNum and ICV bytes around the payload are left as they were on the wire.
+    CHECK(std::equal(packet.begin(), packet.begin() + 10, wire.begin()));
+    CHECK(std::equal(packet.end() - static_cast<std::ptrdiff_t>(cs <= 2U ? 4U : 8U), packet.end(),
+                     wire.begin() + static_cast<std::ptrdiff_t>(wire_size) -
+                         static_cast<std::ptrdiff_t>(cs <= 2U ? 4U : 8U)));
+  }
+}
+
+TEST_CASE("In-place unprotect leaves rejected packets unmodified", "[message][in_place]") {
+  crisp_dummy_crypto_state_t state{0x0F1E2D3C4B5A6978ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x12U);
+  const auto kmac = make_key_material(0x34U);
+  const std::vector<uint8_t> payload(40U, 0x77U);
+
+  crisp_protect_params_t protect{};
+  protect.cs = CRISP_SUITE_CS1;
+  protect.seqnum = 9U;
+  protect.payload = {payload.data(), payload.size()};
+  protect.kenc = {kenc.data(), kenc.size()};
+  protect.kmac = {kmac.data(), kmac.size()};
+  protect.crypto = &iface;
+  std::array<uint8_t, 64> wire{};
+  size_t wire_size = 0U;
+  REQUIRE(crisp_protect(&protect, {wire.data(), wire.size()}, &wire_size) == CRISP_OK);
+  const std::vector<uint8_t> original(wire.begin(),
+                                      wire.begin() + static_cast<std::ptrdiff_t>(wire_size));
+
+  crisp_replay_window_t replay{};
+  REQUIRE(crisp_replay_window_init(&replay, 32U) == CRISP_OK);
+  crisp_unprotect_params_t unprotect{};
+  unprotect.kenc = protect.kenc;
+  unprotect.kmac = protect.kmac;
+  unprotect.crypto = &iface;
+  unprotect.replay_window = &replay;
+  crisp_const_byte_span_t plaintext{};
+  crisp_unprotect_result_t result{};
+
+  std::vector<uint8_t> forged = original;
+  forged.back() ^= 0x01U;
+  const std::vector<uint8_t> forged_before = forged;
+  CHECK(crisp_unprotect_in_place(&unprotect, {forged.data(), forged.size()}, &plaintext,
+                                 &result) == CRISP_ERR_CRYPTO);
+  CHECK(forged == forged_before);
+
+  std::vector<uint8_t> packet = original;
+  REQUIRE(crisp_unprotect_in_place(&unprotect, {packet.data(), packet.size()}, &plaintext,
+                                   &result) == CRISP_OK);
+  CHECK(std::equal(payload.begin(), payload.end(), plaintext.data));
+
+  std::vector<uint8_t> replayed = original;
+  CHECK(crisp_unprotect_in_place(&unprotect, {replayed.data(), replayed.size()}, &plaintext,
+                                 &result) == CRISP_ERR_REPLAY);
+  CHECK(replayed == original);
+
+  CHECK(crisp_unprotect_in_place(&unprotect, {nullptr, 0U}, &plaintext, &result) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_unprotect_in_place(&unprotect, {replayed.data(), replayed.size()}, nullptr,
+                                 &result) == CRISP_ERR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("Scattered protect/unprotect match contiguous calls", "[message][iov]") {
+  crisp_dummy_crypto_state_t state{0x0F1E2D3C4B5A6978ULL};
+  const crisp_crypto_iface_t iface = make_dummy_iface(&state);
+  const auto kenc = make_key_material(0x12U);
+  const auto kmac = make_key_material(0x34U);
+  std::vector<uint8_t> payload(37U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(0x61U + i);
+  }
+
+  for (const uint8_t cs : {static_cast<uint8_t>(CRISP_SUITE_CS1),
+                           static_cast<uint8_t>(CRISP_SUITE_CS4)}) {
+    crisp_protect_params_t protect{};
+    protect.cs = cs;
+    protect.seqnum = 0x0000000200000011ULL;
+    protect.payload = {payload.data(), payload.size()};
+    protect.kenc = {kenc.data(), kenc.size()};
+    protect.kmac = {kmac.data(), kmac.size()};
+    protect.crypto = &iface;
+    std::array<uint8_t, 64> expected{};
+    size_t expected_size = 0U;
+    REQUIRE(crisp_protect(&protect, {expected.data(), expected.size()}, &expected_size) ==
+            CRISP_OK);
+
+    // An inner header, an empty segment and an odd-sized fragment.
+    const std::array<crisp_const_byte_span_t, 4> payload_iov{{{payload.data(), 5U},
+                                                               {payload.data() + 5U, 0U},
+                                                               {payload.data() + 5U, 11U},
+                                                               {payload.data() + 16U, 21U}}};
+    protect.payload = {};
+    std::array<uint8_t, 64> packet{};
+    size_t packet_size = 0U;
+    REQUIRE(crisp_protect_iov(&protect, payload_iov.data(), payload_iov.size(),
+                              {packet.data(), packet.size()}, &packet_size) == CRISP_OK);
+    REQUIRE(packet_size == expected_size);
+    CHECK(packet == expected);
+    CHECK(crisp_protect_iov(&protect, payload_iov.data(), payload_iov.size(),
+                            {packet.data(), packet_size - 1U}, &packet_size) ==
+          CRISP_ERR_BUFFER_TOO_SMALL);
+    CHECK(crisp_protect_iov(&protect, nullptr, 1U, {packet.data(), packet.size()},
+                            &packet_size) == CRISP_ERR_INVALID_ARGUMENT);
+
+    // The dummy backend has no segmented ops, so unprotect linearizes; ICV split mid-way.
+    const std::array<crisp_const_byte_span_t, 3> packet_iov{
+        {{expected.data(), 12U},
+         {expected.data() + 12U, expected_size - 14U},
+         {expected.data() + expected_size - 2U, 2U}}};
+    crisp_unprotect_params_t unprotect{};
+    unprotect.kenc = protect.kenc;
+    unprotect.kmac = protect.kmac;
+    unprotect.crypto = &iface;
+    std::array<uint8_t, 64> out{};
+    crisp_unprotect_result_t result{};
+    REQUIRE(crisp_unprotect_iov(&unprotect, packet_iov.data(), packet_iov.size(),
+                                {out.data(), out.size()}, &result) == CRISP_OK);
+    REQUIRE(result.plaintext.size == payload.size());
+    CHECK(std::equal(payload.begin(), payload.end(), out.begin()));
+    CHECK(result.seqnum == protect.seqnum);
+
+    expected[expected_size - 1U] ^= 0x01U;
+    std::fill(out.begin(), out.end(), static_cast<uint8_t>(0xEEU));
+    CHECK(crisp_unprotect_iov(&unprotect, packet_iov.data(), packet_iov.size(),
+                              {out.data(), out.size()}, &result) == CRISP_ERR_CRYPTO);
+    CHECK(std::all_of(out.begin(), out.end(), [](uint8_t b) { return b == 0xEEU; }));
+  }
+}
@@ -1,3 +1,11 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 extern "C" {
@@ -44,6 +52,31 @@ TEST_CASE("Replay window check/update behavior", "[replay]") {
   CHECK_FALSE(accepted);
 }
 
+TEST_CASE("Replay window probe does not update the window", "[replay]") {
+  crisp_replay_window_t window{};
+  REQUIRE(crisp_replay_window_init(&window, 8U) == CRISP_OK);
+
+  bool would_accept = false;
+  REQUIRE(crisp_replay_window_check(&window, 100U, &would_accept) == CRISP_OK);
+  CHECK(would_accept);
+  CHECK_FALSE(window.initialized);
+
+  bool accepted = false;
+  REQUIRE(crisp_replay_window_check_and_update(&window, 100U, &accepted) == CRISP_OK);
+  REQUIRE(crisp_replay_window_check(&window, 120U, &would_accept) == CRISP_OK);
+  CHECK(would_accept);
+  CHECK(window.max_seq == 100U);
+
+  REQUIRE(crisp_replay_window_check(&window, 100U, &would_accept) == CRISP_OK);
+  CHECK_FALSE(would_accept);
+  REQUIRE(crisp_replay_window_check(&window, 92U, &would_accept) == CRISP_OK);
+  CHECK_FALSE(would_accept);
+  REQUIRE(crisp_replay_window_check(&window, 93U, &would_accept) == CRISP_OK);
+  CHECK(would_accept);
+  REQUIRE(crisp_replay_window_check_and_update(&window, 93U, &accepted) == CRISP_OK);
+  CHECK(accepted);
+}
+
 TEST_CASE("Replay window validates SeqNum range", "[replay]") {
   crisp_replay_window_t window{};
   REQUIRE(crisp_replay_window_init(&window, 32U) == CRISP_OK);
@@ -52,3 +85,195 @@ TEST_CASE("Replay window validates SeqNum range", "[replay]") {
   CHECK(crisp_replay_window_check_and_update(&window, CRISP_SEQNUM_MAX + 1ULL, &accepted) ==
         CRISP_ERR_OUT_OF_RANGE);
 }
+
+namespace {
+
+/**
+ * Drives `check` (SeqNum -> accepted) with random in-order/reordered/jump traffic and compares
+ * it with a set-based model of a `size`-entry window.
+ */
+template <typename Check>
+void check_against_model(Check&& check, size_t size, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  // Reference: accept if newer than max, or within the window and not seen before.
+  std::set<uint64_t> seen;
+  uint64_t max_seq = 0U;
+  bool any = false;
+  uint64_t cursor = 1000U;
+  for (size_t i = 0U; i < 20000U; ++i) {
+    const uint64_t roll = rng() % 100U;
+    uint64_t seqnum = cursor;
+    if (roll < 60U) {
+      seqnum = ++cursor;
+    } else if (roll < 90U) {
+      seqnum = cursor - (rng() % (size + 70U)) % cursor;
+    } else if (roll < 97U) {
+      cursor += 1U + rng() % 300U;
+      seqnum = cursor;
+    } else {
+      cursor += 1U + rng() % (4U * size + 5000U);
+      seqnum = cursor;
+    }
+
+    bool expected = false;
+    if (!any || seqnum > max_seq) {
+      expected = true;
+    } else if (max_seq - seqnum < size) {
+      expected = seen.count(seqnum) == 0U;
+    }
+    if (expected) {
+      seen.insert(seqnum);
+      if (!any || seqnum > max_seq) {
+        max_seq = seqnum;
+      }
+      any = true;
+    }
+
+    REQUIRE(check(seqnum) == expected);
+  }
+}
+
+/** Single-threaded driver for the model check; the read-only probe must agree with it. */
+auto window_check(crisp_replay_window_t* window) {
+  return [window](uint64_t seqnum) {
+    bool would_accept = false;
+    REQUIRE(crisp_replay_window_check(window, seqnum, &would_accept) == CRISP_OK);
+    bool accepted = false;
+    REQUIRE(crisp_replay_window_check_and_update(window, seqnum, &accepted) == CRISP_OK);
+    REQUIRE(would_accept == accepted);
+    return accepted;
+  };
+}
+
+}  // namespace
+
+TEST_CASE("Replay window matches a reference model", "[replay]") {
+  for (const size_t size : {size_t{1}, size_t{63}, size_t{64}, size_t{65}, size_t{200}, size_t{256}}) {
+    crisp_replay_window_t window{};
+    REQUIRE(crisp_replay_window_init(&window, size) == CRISP_OK);
+    check_against_model(window_check(&window), size, 0xC0FFEEU + size);
+  }
+}
+
+TEST_CASE("Large replay windows use caller storage", "[replay]") {
+  CHECK(crisp_replay_window_storage_words(0U) == 0U);
+  CHECK(crisp_replay_window_storage_words(64U) == 2U);
+  CHECK(crisp_replay_window_storage_words(4096U) == 128U);
+  CHECK(crisp_replay_window_storage_words(CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE) == 2048U);
+  CHECK(crisp_replay_window_storage_words(CRISP_REPLAY_WINDOW_MAX_LARGE_SIZE + 1U) == 0U);
+
+  crisp_replay_window_t window{};
+  std::vector<uint64_t> storage(2048U);
+  CHECK(crisp_replay_window_init_with_storage(&window, 4096U, nullptr, 128U) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_replay_window_init_with_storage(&window, 4096U, storage.data(), 127U) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(crisp_replay_window_init_with_storage(&window, 0U, storage.data(), storage.size()) ==
+        CRISP_ERR_OUT_OF_RANGE);
+
+  for (const size_t size : {size_t{100}, size_t{4096}, size_t{5000}, size_t{65536}}) {
+    REQUIRE(crisp_replay_window_init_with_storage(&window, size, storage.data(), storage.size()) ==
+            CRISP_OK);
+    check_against_model(window_check(&window), size, 0xBADC0DEU + size);
+  }
+
+  // Oldest in-window SeqNum of a full-size window is still tracked.
+  REQUIRE(crisp_replay_window_init_with_storage(&window, 65536U, storage.data(), storage.size()) ==
+          CRISP_OK);
+  bool accepted = false;
+  REQUIRE(crisp_replay_window_check_and_update(&window, 100000U, &accepted) == CRISP_OK);
+  REQUIRE(crisp_replay_window_check_and_update(&window, 100000U - 65535U, &accepted) == CRISP_OK);
+  CHECK(accepted);
+  REQUIRE(crisp_replay_window_check_and_update(&window, 100000U - 65535U, &accepted) == CRISP_OK);
+  CHECK_FALSE(accepted);
+  REQUIRE(crisp_replay_window_check_and_update(&window, 100000U - 65536U, &accepted) == CRISP_OK);
+  CHECK_FALSE(accepted);
+}
+
+TEST_CASE("Concurrent replay window matches the model single-threaded", "[replay][concurrent]") {
+  CHECK(crisp_concurrent_replay_window_storage_words(0U) == 0U);
+  CHECK(crisp_concurrent_replay_window_storage_words(256U) == 32U);
+  CHECK(crisp_concurrent_replay_window_storage_words(4096U) == 512U);
+
+  std::vector<uint64_t> storage(8192U);
+  crisp_concurrent_replay_window_t window{};
+  CHECK(crisp_concurrent_replay_window_init(&window, 256U, storage.data(), 31U) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+  for (const size_t size : {size_t{1}, size_t{16}, size_t{64}, size_t{256}, size_t{4096}, size_t{65536}}) {
+    REQUIRE(crisp_concurrent_replay_window_init(&window, size, storage.data(), storage.size()) ==
+            CRISP_OK);
+    check_against_model(
+        [&window](uint64_t seqnum) {
+          bool would_accept = false;
+          REQUIRE(crisp_concurrent_replay_window_check(&window, seqnum, &would_accept) ==
+                  CRISP_OK);
+          bool accepted = false;
+          REQUIRE(crisp_concurrent_replay_window_check_and_update(&window, seqnum, &accepted) ==
+                  CRISP_OK);
+          REQUIRE(would_accept == accepted);
+          return accepted;
+        },
+        size, 0x5EEDU + size);
+  }
+
+  bool accepted = false;
+  CHECK(crisp_concurrent_replay_window_check_and_update(&window, CRISP_SEQNUM_MAX + 1U,
+                                                         &accepted) == CRISP_ERR_OUT_OF_RANGE);
+  CHECK(crisp_concurrent_replay_window_check(&window, CRISP_SEQNUM_MAX + 1U, &accepted) ==
+        CRISP_ERR_OUT_OF_RANGE);
+}
+
+TEST_CASE("Concurrent replay window accepts each SeqNum once across threads",
+          "[replay][concurrent]") {
+  constexpr size_t kThreads = 8U;
+  constexpr size_t kWindow = 1024U;
+  constexpr uint64_t kSeqnums = 200000U;
+  std::vector<uint64_t> storage(crisp_concurrent_replay_window_storage_words(kWindow));
+  crisp_concurrent_replay_window_t window{};
+  REQUIRE(crisp_concurrent_replay_window_init(&window, kWindow, storage.data(), storage.size()) ==
+          CRISP_OK);
+
+  // Every thread submits every SeqNum, locally shuffled within a quarter window, so each one
+  // races against up to kThreads - 1 duplicates and against concurrent advances.
+  std::vector<std::atomic<uint32_t>> accepts(kSeqnums);
+  std::atomic<bool> errors{false};
+  std::vector<std::thread> threads;
+  for (size_t t = 0U; t < kThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937_64 rng(t + 1U);
+      std::vector<uint64_t> order(kSeqnums);
+      for (uint64_t i = 0U; i < kSeqnums; ++i) {
+        order[i] = i;
+      }
+      for (size_t start = 0U; start < order.size(); start += kWindow / 4U) {
+        const size_t end = std::min(order.size(), start + kWindow / 4U);
+        std::shuffle(order.begin() + static_cast<std::ptrdiff_t>(start),
+                     order.begin() + static_cast<std::ptrdiff_t>(end), rng);
+      }
+      for (const uint64_t seqnum : order) {
+        bool accepted = false;
+        if (crisp_concurrent_replay_window_check_and_update(&window, seqnum, &accepted) !=
+            CRISP_OK) {
+          errors = true;
+        }
+        if (accepted) {
+          accepts[seqnum].fetch_add(1U);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  CHECK_FALSE(errors.load());
+  size_t accepted_total = 0U;
+  size_t duplicates = 0U;
+  for (const auto& count : accepts) {
+    accepted_total += count.load();
+    duplicates += count.load() > 1U ? 1U : 0U;
+  }
+  CHECK(duplicates == 0U);
+  // Skew between threads is far below the window, so nearly every SeqNum gets through once.
+  CHECK(accepted_total > kSeqnums * 9U / 10U);
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/seqnum_allocator.h"
+}
+
+TEST_CASE("SeqNum allocator hands out consecutive blocks", "[seqnum]") {
+  crisp_seqnum_allocator_t allocator{};
+  CHECK(crisp_seqnum_allocator_init(nullptr, 0U, 0U) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_seqnum_allocator_init(&allocator, CRISP_SEQNUM_MAX + 1U, 0U) ==
+        CRISP_ERR_OUT_OF_RANGE);
+  REQUIRE(crisp_seqnum_allocator_init(&allocator, 10U, 0U) == CRISP_OK);
+
+  crisp_seqnum_block_t block{};
+  CHECK(crisp_seqnum_allocator_reserve(&allocator, 0U, &block) == CRISP_ERR_OUT_OF_RANGE);
+  CHECK(crisp_seqnum_allocator_reserve(&allocator, CRISP_SEQNUM_BLOCK_MAX + 1U, &block) ==
+        CRISP_ERR_OUT_OF_RANGE);
+
+  REQUIRE(crisp_seqnum_allocator_reserve(&allocator, 4U, &block) == CRISP_OK);
+  CHECK(block.next == 10U);
+  CHECK(block.end == 14U);
+  CHECK_FALSE(block.rekey_due);
+
+  uint64_t seqnum = 0U;
+  for (uint64_t expected = 10U; expected < 14U; ++expected) {
+    REQUIRE(crisp_seqnum_block_take(&block, &seqnum));
+    CHECK(seqnum == expected);
+  }
+  CHECK_FALSE(crisp_seqnum_block_take(&block, &seqnum));
+
+  REQUIRE(crisp_seqnum_allocator_reserve(&allocator, 1U, &block) == CRISP_OK);
+  CHECK(block.next == 14U);
+  CHECK_FALSE(crisp_seqnum_allocator_rekey_due(&allocator));
+}
+
+TEST_CASE("SeqNum allocator reports rekey threshold and exhaustion", "[seqnum]") {
+  crisp_seqnum_allocator_t allocator{};
+  REQUIRE(crisp_seqnum_allocator_init(&allocator, 90U, 100U) == CRISP_OK);
+
+  crisp_seqnum_block_t block{};
+  REQUIRE(crisp_seqnum_allocator_reserve(&allocator, 10U, &block) == CRISP_OK);
+  CHECK_FALSE(block.rekey_due);
+  CHECK_FALSE(crisp_seqnum_allocator_rekey_due(&allocator));
+  REQUIRE(crisp_seqnum_allocator_reserve(&allocator, 1U, &block) == CRISP_OK);
+  CHECK(block.next == 100U);
+  CHECK(block.rekey_due);
+  CHECK(crisp_seqnum_allocator_rekey_due(&allocator));
+
+  // The last block is cut at CRISP_SEQNUM_MAX; afterwards every reservation fails.
+  REQUIRE(crisp_seqnum_allocator_init(&allocator, CRISP_SEQNUM_MAX - 2U, 0U) == CRISP_OK);
+  REQUIRE(crisp_seqnum_allocator_reserve(&allocator, 8U, &block) == CRISP_OK);
+  CHECK(block.next == CRISP_SEQNUM_MAX - 2U);
+  CHECK(block.end == CRISP_SEQNUM_MAX + 1U);
+  CHECK_FALSE(block.rekey_due);
+  CHECK(crisp_seqnum_allocator_reserve(&allocator, 1U, &block) == CRISP_ERR_OUT_OF_RANGE);
+  CHECK(block.next == block.end);
+  CHECK(crisp_seqnum_allocator_reserve(&allocator, 1U, &block) == CRISP_ERR_OUT_OF_RANGE);
+}
+
+TEST_CASE("SeqNum allocator never hands out a SeqNum twice across threads", "[seqnum][concurrent]") {
+  crisp_seqnum_allocator_t allocator{};
+  REQUIRE(crisp_seqnum_allocator_init(&allocator, 0U, 0U) == CRISP_OK);
+
+  constexpr size_t kThreads = 8U;
+  constexpr size_t kPerThread = 20000U;
+  std::vector<std::vector<uint64_t>> taken(kThreads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0U; t < kThreads; ++t) {
+    threads.emplace_back([&allocator, &taken, t] {
+      crisp_seqnum_block_t block{};
+      uint64_t seqnum = 0U;
+      const uint64_t block_size = 1U + t * 7U;
+      while (taken[t].size() < kPerThread) {
+        if (!crisp_seqnum_block_take(&block, &seqnum)) {
+          if (crisp_seqnum_allocator_reserve(&allocator, block_size, &block) != CRISP_OK) {
+            return;
+          }
+          continue;
+        }
+        taken[t].push_back(seqnum);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<uint64_t> all;
+  for (const auto& per_thread : taken) {
+    REQUIRE(per_thread.size() == kPerThread);
+    all.insert(all.end(), per_thread.begin(), per_thread.end());
+  }
+  std::sort(all.begin(), all.end());
+  CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+  // Unused tails of the last blocks are the only gaps.
+  CHECK(all.back() < allocator.next);
+  CHECK(allocator.next - all.size() < kThreads * (1U + (kThreads - 1U) * 7U));
+}
@@ -0,0 +1,530 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/session.h"
+}
+
+#include "test_util.h"
+
+namespace {
+
+using crisp_test::make_key;
+
+struct SessionFixture {
+  crisp_crypto_iface_t iface{};
+  std::array<uint8_t, 32> kenc = make_key(0x21U, 5U);
+  std::array<uint8_t, 32> kmac = make_key(0x93U, 5U);
+  std::array<uint8_t, 3> key_id{0x82U, 0x11U, 0x22U};
+  crisp_session_config_t config{};
+
+  SessionFixture() {
+    crisp_magma_crypto_iface_init(&iface);
+    config.cs = CRISP_SUITE_CS1;
+    config.key_id_present = true;
+    config.key_id = {key_id.data(), key_id.size()};
+    config.kenc = {kenc.data(), kenc.size()};
+    config.kmac = {kmac.data(), kmac.size()};
+    config.crypto = &iface;
+    config.tx_seqnum = 40U;
+    config.replay_window_size = 64U;
+  }
+};
+
+}  // namespace
+
+TEST_CASE("session keeps TX and RX state on separate cache lines", "[session]") {
+  STATIC_REQUIRE(alignof(crisp_session_t) >= CRISP_CACHE_LINE_SIZE);
+  STATIC_REQUIRE(offsetof(crisp_session_t, tx_seqnums) % CRISP_CACHE_LINE_SIZE == 0U);
+  STATIC_REQUIRE(offsetof(crisp_session_t, replay_window) % CRISP_CACHE_LINE_SIZE == 0U);
+  STATIC_REQUIRE(offsetof(crisp_session_t, replay_window) >=
+                 offsetof(crisp_session_t, tx_seqnums) + sizeof(crisp_seqnum_allocator_t));
+}
+
+TEST_CASE("session protect matches crisp_protect and advances the SeqNum", "[session]") {
+  SessionFixture fixture;
+  crisp_session_t session{};
+  REQUIRE(crisp_session_init(&session, &fixture.config) == CRISP_OK);
+
+  crisp_crypto_keys_t keys{};
+  REQUIRE(crisp_crypto_keys_init(&keys, &fixture.iface, fixture.config.kenc,
+                                 fixture.config.kmac) == CRISP_OK);
+
+  std::vector<uint8_t> payload(37U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i * 7U);
+  }
+  for (uint64_t expected_seqnum = 40U; expected_seqnum < 43U; ++expected_seqnum) {
+    std::array<uint8_t, 128> from_session{};
+    size_t session_size = 0U;
+    uint64_t seqnum = 0U;
+    REQUIRE(crisp_session_protect(&session, {payload.data(), payload.size()},
+                                  {from_session.data(), from_session.size()}, &session_size,
+                                  &seqnum) == CRISP_OK);
+    CHECK(seqnum == expected_seqnum);
+
+    crisp_protect_params_t params{};
+    params.cs = fixture.config.cs;
+    params.key_id_present = true;
+    params.key_id = fixture.config.key_id;
+    params.seqnum = expected_seqnum;
+    params.payload = {payload.data(), payload.size()};
+    params.keys = &keys;
+    std::array<uint8_t, 128> expected{};
+    size_t expected_size = 0U;
+    REQUIRE(crisp_protect(&params, {expected.data(), expected.size()}, &expected_size) ==
+            CRISP_OK);
+    REQUIRE(session_size == expected_size);
+    CHECK(from_session == expected);
+  }
+  CHECK(session.tx_seqnums.next == 43U);
+
+  // A failed protect still consumes its SeqNum: SeqNums are never handed out twice.
+  std::array<uint8_t, 8> tiny{};
+  size_t size = 0U;
+  CHECK(crisp_session_protect(&session, {payload.data(), payload.size()},
+                              {tiny.data(), tiny.size()}, &size, nullptr) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(session.tx_seqnums.next == 44U);
+
+  REQUIRE(crisp_seqnum_allocator_init(&session.tx_seqnums, CRISP_SEQNUM_MAX, 0U) == CRISP_OK);
+  std::array<uint8_t, 128> last{};
+  uint64_t seqnum = 0U;
+  CHECK(crisp_session_protect(&session, {payload.data(), payload.size()},
+                              {last.data(), last.size()}, &size, &seqnum) == CRISP_OK);
+  CHECK(seqnum == CRISP_SEQNUM_MAX);
+  std::array<uint8_t, 128> packet{};
+  CHECK(crisp_session_protect(&session, {payload.data(), payload.size()},
+                              {packet.data(), packet.size()}, &size, nullptr) ==
+        CRISP_ERR_OUT_OF_RANGE);
+
+  crisp_crypto_keys_release(&keys);
+  crisp_session_clear(&session);
+}
+
+TEST_CASE("session in-place protect matches protect_seqnum", "[session][in_place]") {
+  SessionFixture fixture;
+  crisp_session_t session{};
+  REQUIRE(crisp_session_init(&session, &fixture.config) == CRISP_OK);
+  // Prefix, 3-byte KeyId, SeqNum.
+  REQUIRE(crisp_session_headroom(&session) == 12U);
+
+  std::vector<uint8_t> payload(61U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i * 3U);
+  }
+  std::array<uint8_t, 128> expected{};
+  size_t expected_size = 0U;
+  REQUIRE(crisp_session_protect_seqnum(&session, 77U, {payload.data(), payload.size()},
+                                       {expected.data(), expected.size()},
+                                       &expected_size) == CRISP_OK);
+
+  std::array<uint8_t, CRISP_PROTECT_MAX_HEADROOM + 64U + CRISP_PROTECT_MAX_TAILROOM> buffer{};
+  std::copy(payload.begin(), payload.end(), buffer.begin() + CRISP_PROTECT_MAX_HEADROOM);
+  crisp_mutable_byte_span_t packet{};
+  REQUIRE(crisp_session_protect_in_place(&session, 77U, {buffer.data(), buffer.size()},
+                                         CRISP_PROTECT_MAX_HEADROOM, payload.size(),
+                                         &packet) == CRISP_OK);
+  CHECK(packet.data == buffer.data() + CRISP_PROTECT_MAX_HEADROOM - 12U);
+  REQUIRE(packet.size == expected_size);
+  CHECK(std::equal(packet.data, packet.data + packet.size, expected.begin()));
+
+  std::array<uint8_t, 128> plaintext{};
+  crisp_unprotect_result_t result{};
+  REQUIRE(crisp_session_unprotect(&session, {packet.data, packet.size},
+                                  {plaintext.data(), plaintext.size()}, &result) == CRISP_OK);
+  CHECK(std::equal(payload.begin(), payload.end(), plaintext.begin()));
+
+  CHECK(crisp_session_protect_in_place(&session, 78U, {buffer.data(), buffer.size()}, 11U, 8U,
+                                       &packet) == CRISP_ERR_BUFFER_TOO_SMALL);
+  crisp_session_clear(&session);
+}
+
+TEST_CASE("session protect consumes a keystream pool from the config", "[session][keystream]") {
+  SessionFixture fixture;
+  crisp_session_t plain{};
+  REQUIRE(crisp_session_init(&plain, &fixture.config) == CRISP_OK);
+
+  constexpr size_t kSlotSize = 64U;
+  std::vector<uint8_t> storage(kSlotSize * 4U);
+  crisp_keystream_pool_t pool{};
+  crisp_session_config_t config = fixture.config;
+  config.keystream_pool = &pool;
+  config.keystream_pool_storage = {storage.data(), storage.size()};
+  config.keystream_pool_slot_size = kSlotSize;
+  crisp_session_t pooled{};
+  REQUIRE(crisp_session_init(&pooled, &config) == CRISP_OK);
+  REQUIRE(pooled.keystream_pool == &pool);
+  CHECK(pool.keys == &pooled.keys);
+  CHECK(pool.first_seqnum == config.tx_seqnum);
+  REQUIRE(crisp_keystream_pool_refill(&pool, 4U, nullptr) == CRISP_OK);
+  REQUIRE(pool.filled == 4U);
+
+  std::vector<uint8_t> payload(45U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(0xC3U ^ i);
+  }
+  // Pool hits (SeqNum 40 via protect, 41 via protect_seqnum) give the regular packets.
+  std::array<uint8_t, 128> expected{};
+  std::array<uint8_t, 128> packet{};
+  size_t expected_size = 0U;
+  size_t size = 0U;
+  uint64_t seqnum = 0U;
+  REQUIRE(crisp_session_protect(&pooled, {payload.data(), payload.size()},
+                                {packet.data(), packet.size()}, &size, &seqnum) == CRISP_OK);
+  REQUIRE(seqnum == 40U);
+  REQUIRE(crisp_session_protect_seqnum(&plain, 40U, {payload.data(), payload.size()},
+                                       {expected.data(), expected.size()},
+                                       &expected_size) == CRISP_OK);
+  CHECK(size == expected_size);
+  CHECK(packet == expected);
+  CHECK(pool.filled == 3U);
+
+  REQUIRE(crisp_session_protect_seqnum(&pooled, 41U, {payload.data(), payload.size()},
+                                       {packet.data(), packet.size()}, &size) == CRISP_OK);
+  REQUIRE(crisp_session_protect_seqnum(&plain, 41U, {payload.data(), payload.size()},
+                                       {expected.data(), expected.size()},
+                                       &expected_size) == CRISP_OK);
+  CHECK(packet == expected);
+  CHECK(pool.filled == 2U);
+
+  // The in-place path XORs the pooled keystream over the payload where it lies.
+  std::array<uint8_t, CRISP_PROTECT_MAX_HEADROOM + 64U + CRISP_PROTECT_MAX_TAILROOM> buffer{};
+  std::copy(payload.begin(), payload.end(), buffer.begin() + CRISP_PROTECT_MAX_HEADROOM);
+  crisp_mutable_byte_span_t in_place{};
+  REQUIRE(crisp_session_protect_in_place(&pooled, 42U, {buffer.data(), buffer.size()},
+                                         CRISP_PROTECT_MAX_HEADROOM, payload.size(),
+                                         &in_place) == CRISP_OK);
+  CHECK(pool.filled == 1U);
+  REQUIRE(crisp_session_protect_seqnum(&plain, 42U, {payload.data(), payload.size()},
+                                       {expected.data(), expected.size()},
+                                       &expected_size) == CRISP_OK);
+  REQUIRE(in_place.size == expected_size);
+  CHECK(std::equal(in_place.data, in_place.data + in_place.size, expected.begin()));
+
+  std::array<uint8_t, 128> plaintext{};
+  crisp_unprotect_result_t result{};
+  REQUIRE(crisp_session_unprotect(&plain, {packet.data(), size},
+                                  {plaintext.data(), plaintext.size()}, &result) == CRISP_OK);
+  CHECK(std::equal(payload.begin(), payload.end(), plaintext.begin()));
+
+  // Clearing the session clears the pool it built before the keys go away.
+  crisp_session_clear(&pooled);
+  CHECK(pool.keys == nullptr);
+  CHECK(std::all_of(storage.begin(), storage.end(), [](uint8_t b) { return b == 0U; }));
+  crisp_session_clear(&plain);
+
+  // Pool errors fail init and leave nothing to clear.
+  config.keystream_pool_slot_size = storage.size() + 1U;
+  CHECK(crisp_session_init(&pooled, &config) == CRISP_ERR_INVALID_SIZE);
+  CHECK(pooled.keys.crypto == nullptr);
+  CHECK(pooled.keystream_pool == nullptr);
+}
+
+TEST_CASE("session in-place unprotect decrypts inside the packet", "[session][in_place]") {
+  SessionFixture fixture;
+  crisp_session_t tx{};
+  crisp_session_t rx{};
+  REQUIRE(crisp_session_init(&tx, &fixture.config) == CRISP_OK);
+  REQUIRE(crisp_session_init(&rx, &fixture.config) == CRISP_OK);
+
+  const std::vector<uint8_t> payload(100U, 0x3CU);
+  std::array<uint8_t, 128> wire{};
+  size_t wire_size = 0U;
+  REQUIRE(crisp_session_protect_seqnum(&tx, 41U, {payload.data(), payload.size()},
+                                       {wire.data(), wire.size()}, &wire_size) == CRISP_OK);
+  const std::vector<uint8_t> original(wire.begin(),
+                                      wire.begin() + static_cast<std::ptrdiff_t>(wire_size));
+
+  std::vector<uint8_t> forged = original;
+  forged[20] ^= 0x80U;
+  const std::vector<uint8_t> forged_before = forged;
+  crisp_const_byte_span_t plaintext{};
+  crisp_unprotect_result_t result{};
+  CHECK(crisp_session_unprotect_in_place(&rx, {forged.data(), forged.size()}, &plaintext,
+                                         &result) == CRISP_ERR_CRYPTO);
+  CHECK(forged == forged_before);
+
+  std::vector<uint8_t> packet = original;
+  REQUIRE(crisp_session_unprotect_in_place(&rx, {packet.data(), packet.size()}, &plaintext,
+                                           &result) == CRISP_OK);
+  CHECK(plaintext.data == packet.data() + crisp_session_headroom(&rx));
+  REQUIRE(plaintext.size == payload.size());
+  CHECK(std::equal(payload.begin(), payload.end(), plaintext.data));
+  CHECK(result.seqnum == 41U);
+
+  std::vector<uint8_t> replayed = original;
+  CHECK(crisp_session_unprotect_in_place(&rx, {replayed.data(), replayed.size()}, &plaintext,
+                                         &result) == CRISP_ERR_REPLAY);
+  CHECK(replayed == original);
+
+  crisp_session_clear(&tx);
+  crisp_session_clear(&rx);
+}
+
+TEST_CASE("session scattered protect/unprotect round-trips", "[session][iov]") {
+  SessionFixture fixture;
+  crisp_session_t tx{};
+  crisp_session_t rx{};
+  REQUIRE(crisp_session_init(&tx, &fixture.config) == CRISP_OK);
+  REQUIRE(crisp_session_init(&rx, &fixture.config) == CRISP_OK);
+
+  std::vector<uint8_t> payload(61U);
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i * 3U);
+  }
+  std::array<uint8_t, 128> expected{};
+  size_t expected_size = 0U;
+  REQUIRE(crisp_session_protect_seqnum(&tx, 41U, {payload.data(), payload.size()},
+                                       {expected.data(), expected.size()},
+                                       &expected_size) == CRISP_OK);
+
+  const std::array<crisp_const_byte_span_t, 3> payload_iov{{{payload.data(), 20U},
+                                                             {payload.data() + 20U, 3U},
+                                                             {payload.data() + 23U, 38U}}};
+  std::array<uint8_t, 128> packet{};
+  size_t packet_size = 0U;
+  REQUIRE(crisp_session_protect_iov(&tx, 41U, payload_iov.data(), payload_iov.size(),
+                                    {packet.data(), packet.size()}, &packet_size) == CRISP_OK);
+  REQUIRE(packet_size == expected_size);
+  CHECK(packet == expected);
+
+  // Header plus one payload byte, then the rest split inside a CMAC block and the ICV.
+  const size_t headroom = crisp_session_headroom(&rx);
+  const std::array<crisp_const_byte_span_t, 3> packet_iov{
+      {{packet.data(), headroom + 1U},
+       {packet.data() + headroom + 1U, packet_size - headroom - 4U},
+       {packet.data() + packet_size - 3U, 3U}}};
+  std::array<uint8_t, 64> out{};
+  crisp_unprotect_result_t result{};
+  REQUIRE(crisp_session_unprotect_iov(&rx, packet_iov.data(), packet_iov.size(),
+                                      {out.data(), out.size()}, &result) == CRISP_OK);
+  REQUIRE(result.plaintext.size == payload.size());
+  CHECK(std::equal(payload.begin(), payload.end(), out.begin()));
+  CHECK(result.seqnum == 41U);
+  CHECK(crisp_session_unprotect_iov(&rx, packet_iov.data(), packet_iov.size(),
+                                    {out.data(), out.size()}, &result) == CRISP_ERR_REPLAY);
+
+  // A valid packet of another KeyId is not this session's.
+  crisp_session_config_t other_config = fixture.config;
+  const std::array<uint8_t, 1> other_key_id{0x07U};
+  other_config.key_id = {other_key_id.data(), other_key_id.size()};
+  crisp_session_t other{};
+  REQUIRE(crisp_session_init(&other, &other_config) == CRISP_OK);
+  REQUIRE(crisp_session_protect_iov(&other, 42U, payload_iov.data(), payload_iov.size(),
+                                    {packet.data(), packet.size()}, &packet_size) == CRISP_OK);
+  const std::array<crisp_const_byte_span_t, 1> other_iov{{{packet.data(), packet_size}}};
+  CHECK(crisp_session_unprotect_iov(&rx, other_iov.data(), other_iov.size(),
+                                    {out.data(), out.size()}, &result) ==
+        CRISP_ERR_INVALID_FORMAT);
+
+  crisp_session_clear(&tx);
+  crisp_session_clear(&rx);
+  crisp_session_clear(&other);
+}
+
+TEST_CASE("session stream protect splits a large payload into consecutive packets",
+          "[session][stream]") {
+  for (const uint8_t cs : {CRISP_SUITE_CS1, CRISP_SUITE_CS2, CRISP_SUITE_CS3, CRISP_SUITE_CS4}) {
+    SessionFixture fixture;
+    fixture.config.cs = cs;
+    fixture.config.replay_window_size = 256U;
+    crisp_session_t tx{};
+    crisp_session_t rx{};
+    REQUIRE(crisp_session_init(&tx, &fixture.config) == CRISP_OK);
+    REQUIRE(crisp_session_init(&rx, &fixture.config) == CRISP_OK);
+    const size_t overhead = crisp_session_headroom(&tx) + tx.suite_params.icv_size;
+
+    // 150 KB spans more than one batch chunk; the MTU above CRISP_MAX_MESSAGE_SIZE is clamped.
+    std::vector<uint8_t> payload(150001U);
+    for (size_t i = 0U; i < payload.size(); ++i) {
+      payload[i] = static_cast<uint8_t>(i * 13U + (i >> 8U));
+    }
+    for (const size_t mtu : {size_t{1400U}, size_t{9000U}}) {
+      crisp_stream_layout_t layout{};
+      REQUIRE(crisp_session_stream_layout(&tx, payload.size(), mtu, &layout) == CRISP_OK);
+      const size_t packet_size = std::min(mtu, CRISP_MAX_MESSAGE_SIZE);
+      CHECK(layout.segment_size == packet_size - overhead);
+      CHECK(layout.packet_count == (payload.size() + layout.segment_size - 1U) /
+                                       layout.segment_size);
+      CHECK(layout.arena_size == payload.size() + layout.packet_count * overhead);
+      REQUIRE(layout.packet_count > CRISP_PROTECT_BATCH_CHUNK);
+
+      std::vector<uint8_t> arena(layout.arena_size);
+      std::vector<crisp_mutable_byte_span_t> packets(layout.packet_count);
+      size_t count = 0U;
+      uint64_t first_seqnum = 0U;
+      const uint64_t expected_first = tx.tx_seqnums.next;
+      REQUIRE(crisp_session_protect_stream(&tx, {payload.data(), payload.size()}, mtu,
+                                           {arena.data(), arena.size()}, packets.data(),
+                                           packets.size(), &count, &first_seqnum) == CRISP_OK);
+      REQUIRE(count == layout.packet_count);
+      CHECK(first_seqnum == expected_first);
+      CHECK(tx.tx_seqnums.next == expected_first + count);
+
+      std::vector<uint8_t> reassembled;
+      const uint8_t* next = arena.data();
+      for (size_t i = 0U; i < count; ++i) {
+        // Back to back in the arena, every packet full-size but the last.
+        CHECK(packets[i].data == next);
+        next += packets[i].size;
+        if (i + 1U < count) {
+          CHECK(packets[i].size == packet_size);
+        }
+        const size_t offset = i * layout.segment_size;
+        const size_t segment = std::min(layout.segment_size, payload.size() - offset);
+        std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> expected{};
+        size_t expected_size = 0U;
+        REQUIRE(crisp_session_protect_seqnum(&tx, first_seqnum + i,
+                                             {payload.data() + offset, segment},
+                                             {expected.data(), expected.size()},
+                                             &expected_size) == CRISP_OK);
+        REQUIRE(packets[i].size == expected_size);
+        CHECK(std::equal(expected.begin(), expected.begin() + static_cast<ptrdiff_t>(expected_size),
+                         packets[i].data));
+
+        std::array<uint8_t, CRISP_MAX_MESSAGE_SIZE> plaintext{};
+        crisp_unprotect_result_t result{};
+        REQUIRE(crisp_session_unprotect(&rx, {packets[i].data, packets[i].size},
+                                        {plaintext.data(), plaintext.size()},
+                                        &result) == CRISP_OK);
+        CHECK(result.seqnum == first_seqnum + i);
+        reassembled.insert(reassembled.end(), plaintext.begin(),
+                           plaintext.begin() + static_cast<ptrdiff_t>(result.plaintext.size));
+      }
+      CHECK(next == arena.data() + arena.size());
+      CHECK(reassembled == payload);
+    }
+    crisp_session_clear(&tx);
+    crisp_session_clear(&rx);
+  }
+}
+
+TEST_CASE("session stream protect checks capacity before reserving SeqNums",
+          "[session][stream]") {
+  SessionFixture fixture;
+  crisp_session_t session{};
+  REQUIRE(crisp_session_init(&session, &fixture.config) == CRISP_OK);
+  const size_t overhead = crisp_session_headroom(&session) + session.suite_params.icv_size;
+
+  std::vector<uint8_t> payload(1000U, 0x5AU);
+  crisp_stream_layout_t layout{};
+  REQUIRE(crisp_session_stream_layout(&session, payload.size(), 256U, &layout) == CRISP_OK);
+  std::vector<uint8_t> arena(layout.arena_size);
+  std::vector<crisp_mutable_byte_span_t> packets(layout.packet_count);
+  size_t count = 7U;
+
+  CHECK(crisp_session_protect_stream(&session, {payload.data(), payload.size()}, 256U,
+                                     {arena.data(), arena.size() - 1U}, packets.data(),
+                                     packets.size(), &count, nullptr) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(count == 0U);
+  CHECK(crisp_session_protect_stream(&session, {payload.data(), payload.size()}, 256U,
+                                     {arena.data(), arena.size()}, packets.data(),
+                                     packets.size() - 1U, &count, nullptr) ==
+        CRISP_ERR_BUFFER_TOO_SMALL);
+  CHECK(crisp_session_protect_stream(&session, {payload.data(), payload.size()}, overhead,
+                                     {arena.data(), arena.size()}, packets.data(),
+                                     packets.size(), &count, nullptr) == CRISP_ERR_INVALID_SIZE);
+  CHECK(crisp_session_stream_layout(&session, 1U, overhead + 1U, &layout) == CRISP_OK);
+  CHECK(crisp_session_stream_layout(&session, (CRISP_SEQNUM_BLOCK_MAX + 1U), overhead + 1U,
+                                    &layout) == CRISP_ERR_INVALID_SIZE);
+  CHECK(crisp_session_protect_stream(&session, {nullptr, 0U}, 256U, {nullptr, 0U}, nullptr, 0U,
+                                     &count, nullptr) == CRISP_OK);
+  CHECK(count == 0U);
+  CHECK(crisp_session_protect_stream(&session, {nullptr, 1U}, 256U, {arena.data(), arena.size()},
+                                     packets.data(), packets.size(), &count,
+                                     nullptr) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(session.tx_seqnums.next == 40U);
+
+  // A stream that would run past the end of the SeqNum space consumes what is left.
+  REQUIRE(crisp_seqnum_allocator_init(&session.tx_seqnums, CRISP_SEQNUM_MAX - 1U, 0U) ==
+          CRISP_OK);
+  CHECK(crisp_session_protect_stream(&session, {payload.data(), payload.size()}, 256U,
+                                     {arena.data(), arena.size()}, packets.data(),
+                                     packets.size(), &count, nullptr) == CRISP_ERR_OUT_OF_RANGE);
+  CHECK(count == 0U);
+
+  crisp_session_clear(&session);
+}
+
+TEST_CASE("session unprotect round-trips and enforces the session header", "[session]") {
+  SessionFixture fixture;
+  crisp_session_t tx{};
+  crisp_session_t rx{};
+  REQUIRE(crisp_session_init(&tx, &fixture.config) == CRISP_OK);
+  REQUIRE(crisp_session_init(&rx, &fixture.config) == CRISP_OK);
+
+  const std::array<uint8_t, 5> payload{0x10U, 0x20U, 0x30U, 0x40U, 0x50U};
+  std::array<uint8_t, 128> packet{};
+  size_t size = 0U;
+  REQUIRE(crisp_session_protect(&tx, {payload.data(), payload.size()},
+                                {packet.data(), packet.size()}, &size, nullptr) == CRISP_OK);
+
+  std::array<uint8_t, 16> plaintext{};
+  crisp_unprotect_result_t result{};
+  REQUIRE(crisp_session_unprotect(&rx, {packet.data(), size}, {plaintext.data(), plaintext.size()},
+                                  &result) == CRISP_OK);
+  CHECK(result.seqnum == 40U);
+  CHECK(result.cs == CRISP_SUITE_CS1);
+  CHECK(result.key_id_present);
+  CHECK(result.key_id.size == fixture.key_id.size());
+  REQUIRE(result.plaintext.size == payload.size());
+  for (size_t i = 0U; i < payload.size(); ++i) {
+    CHECK(plaintext[i] == payload[i]);
+  }
+
+  CHECK(crisp_session_unprotect(&rx, {packet.data(), size}, {plaintext.data(), plaintext.size()},
+                                &result) == CRISP_ERR_REPLAY);
+
+  // Same keys under another KeyId are not this session's packets.
+  crisp_session_config_t other_config = fixture.config;
+  const std::array<uint8_t, 1> other_key_id{0x05U};
+  other_config.key_id = {other_key_id.data(), other_key_id.size()};
+  crisp_session_t other{};
+  REQUIRE(crisp_session_init(&other, &other_config) == CRISP_OK);
+  REQUIRE(crisp_session_protect(&other, {payload.data(), payload.size()},
+                                {packet.data(), packet.size()}, &size, nullptr) == CRISP_OK);
+  plaintext.fill(0xEEU);
+  CHECK(crisp_session_unprotect(&rx, {packet.data(), size}, {plaintext.data(), plaintext.size()},
+                                &result) == CRISP_ERR_INVALID_FORMAT);
+  for (uint8_t byte : plaintext) {
+    CHECK(byte == 0xEEU);
+  }
+
+  crisp_session_clear(&other);
+  crisp_session_clear(&rx);
+  crisp_session_clear(&tx);
+}
+
+TEST_CASE("session init validates its configuration", "[session]") {
+  SessionFixture fixture;
+  crisp_session_t session{};
+  CHECK(crisp_session_init(nullptr, &fixture.config) == CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_session_init(&session, nullptr) == CRISP_ERR_INVALID_ARGUMENT);
+
+  crisp_session_config_t config = fixture.config;
+  config.tx_seqnum = CRISP_SEQNUM_MAX + 1U;
+  CHECK(crisp_session_init(&session, &config) == CRISP_ERR_OUT_OF_RANGE);
+
+  config = fixture.config;
+  config.cs = 0x7FU;
+  CHECK(crisp_session_init(&session, &config) == CRISP_ERR_UNSUPPORTED_SUITE);
+
+  config = fixture.config;
+  config.replay_window_size = CRISP_REPLAY_WINDOW_MAX_SIZE + 1U;
+  CHECK(crisp_session_init(&session, &config) == CRISP_ERR_OUT_OF_RANGE);
+
+  std::vector<uint64_t> storage(crisp_replay_window_storage_words(4096U));
+  config.replay_window_size = 4096U;
+  config.replay_window_storage = storage.data();
+  config.replay_window_storage_words = storage.size();
+  REQUIRE(crisp_session_init(&session, &config) == CRISP_OK);
+  CHECK(session.replay_window.size == 4096U);
+  crisp_session_clear(&session);
+  CHECK(session.keys.crypto == nullptr);
+}
@@ -0,0 +1,379 @@
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/driver/udp.h"
+}
+
+#include "test_util.h"
+
+namespace {
+
+struct alignas(CRISP_UDP_STORAGE_ALIGN) StorageLine {
+  uint8_t bytes[CRISP_UDP_STORAGE_ALIGN];
+};
+
+crisp_udp_config_t loopback_config(size_t batch_size,
+                                   crisp_udp_backend_t backend = CRISP_UDP_BACKEND_MMSG) {
+  crisp_udp_config_t config{};
+  config.backend = backend;
+  auto* addr = reinterpret_cast<sockaddr_in*>(&config.local_addr);
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  config.local_addr_len = sizeof(sockaddr_in);
+  config.batch_size = batch_size;
+  config.rcvbuf_size = 1 << 20;
+  config.sndbuf_size = 1 << 20;
+  config.rx_timeout_ms = 1000;
+  return config;
+}
+
+/** A driver with its storage, bound to an ephemeral loopback port. */
+struct Endpoint {
+  explicit Endpoint(const crisp_udp_config_t& config)
+      : storage(crisp_udp_driver_storage_size(&config) / sizeof(StorageLine) + 1U) {
+    REQUIRE(crisp_udp_driver_init(&driver, &config,
+                                  {reinterpret_cast<uint8_t*>(storage.data()),
+                                   storage.size() * sizeof(StorageLine)}) == CRISP_OK);
+    REQUIRE(crisp_udp_driver_local_addr(&driver, &addr, &addr_len) == CRISP_OK);
+  }
+  ~Endpoint() { crisp_udp_driver_close(&driver); }
+  Endpoint(const Endpoint&) = delete;
+  Endpoint& operator=(const Endpoint&) = delete;
+
+  void connect(const Endpoint& peer) {
+    REQUIRE(crisp_udp_driver_connect(&driver, reinterpret_cast<const sockaddr*>(&peer.addr),
+                                     peer.addr_len) == CRISP_OK);
+  }
+
+  std::vector<StorageLine> storage;
+  crisp_udp_driver_t driver{};
+  sockaddr_storage addr{};
+  socklen_t addr_len = 0;
+};
+
+/** False when the kernel or a sandbox rules the backend out (CRISP_ERR_NOT_SUPPORTED). */
+bool backend_available(crisp_udp_backend_t backend) {
+  const crisp_udp_config_t config = loopback_config(1U, backend);
+  std::vector<StorageLine> storage(crisp_udp_driver_storage_size(&config) / sizeof(StorageLine) +
+                                   1U);
+  crisp_udp_driver_t driver{};
+  const crisp_error_t err = crisp_udp_driver_init(
+      &driver, &config,
+      {reinterpret_cast<uint8_t*>(storage.data()), storage.size() * sizeof(StorageLine)});
+  crisp_udp_driver_close(&driver);
+  if (err == CRISP_ERR_NOT_SUPPORTED) {
+    WARN("UDP backend " << backend << " unavailable here (errno " << driver.last_errno << ")");
+    return false;
+  }
+  REQUIRE(err == CRISP_OK);
+  return true;
+}
+
+/** Receives bursts until `expected` datagrams arrived or a wait times out. */
+std::vector<crisp_udp_rx_packet_t> receive(Endpoint& endpoint,
+                                           crisp_session_t* session,
+                                           size_t expected,
+                                           std::vector<std::vector<uint8_t>>* plaintexts) {
+  std::vector<crisp_udp_rx_packet_t> received;
+  std::vector<crisp_udp_rx_packet_t> burst(CRISP_UDP_MAX_BATCH);
+  while (received.size() < expected) {
+    size_t count = 0U;
+    REQUIRE(crisp_udp_driver_rx_burst(&endpoint.driver, session, burst.data(), burst.size(),
+                                      &count) == CRISP_OK);
+    if (count == 0U) {
+      break;
+    }
+    for (size_t i = 0U; i < count; ++i) {
+      received.push_back(burst[i]);
+      if (plaintexts != nullptr && burst[i].status == CRISP_OK) {
+        plaintexts->emplace_back(burst[i].plaintext.data,
+                                 burst[i].plaintext.data + burst[i].plaintext.size);
+      }
+    }
+  }
+  return received;
+}
+
+void check_round_trip(crisp_udp_backend_t backend) {
+  const crisp_udp_config_t config = loopback_config(16U, backend);
+  Endpoint sender(config);
+  Endpoint receiver(config);
+  sender.connect(receiver);
+  receiver.connect(sender);
+  crisp_test::SessionPair sessions;
+
+  std::vector<std::vector<uint8_t>> payloads(100U);
+  std::vector<crisp_const_byte_span_t> spans;
+  for (size_t i = 0U; i < payloads.size(); ++i) {
+    payloads[i].resize(1U + (i * 37U) % 1400U);
+    for (size_t k = 0U; k < payloads[i].size(); ++k) {
+      payloads[i][k] = static_cast<uint8_t>(i ^ (k * 7U));
+    }
+    spans.push_back({payloads[i].data(), payloads[i].size()});
+  }
+  // One payload too large for a packet: skipped, its SeqNum consumed.
+  const std::vector<uint8_t> oversize(CRISP_MAX_MESSAGE_SIZE, 0x55U);
+  spans.insert(spans.begin() + 40, {oversize.data(), oversize.size()});
+
+  std::vector<crisp_error_t> status(spans.size(), CRISP_ERR_NOT_SUPPORTED);
+  size_t sent = 0U;
+  REQUIRE(crisp_udp_driver_tx_burst(&sender.driver, &sessions.tx, spans.data(), spans.size(),
+                                    status.data(), &sent) == CRISP_OK);
+  CHECK(sent == payloads.size());
+  CHECK(status[40] == CRISP_ERR_INVALID_SIZE);
+  CHECK(sessions.tx.tx_seqnums.next == 1U + spans.size());
+
+  std::vector<std::vector<uint8_t>> plaintexts;
+  const std::vector<crisp_udp_rx_packet_t> received =
+      receive(receiver, &sessions.rx, payloads.size(), &plaintexts);
+  REQUIRE(received.size() == payloads.size());
+  for (size_t i = 0U; i < received.size(); ++i) {
+    CHECK(received[i].status == CRISP_OK);
+    CHECK(received[i].seqnum == 1U + i + (i >= 40U ? 1U : 0U));
+  }
+  CHECK(plaintexts == payloads);
+
+  // Stage instrumentation: 7 TX bursts of up to 16 payloads, RX packets all accounted for.
+  const crisp_udp_stats_t& tx_stats = sender.driver.stats;
+  CHECK(tx_stats.tx_protect.batches == 7U);
+  CHECK(tx_stats.tx_protect.packets == spans.size());
+  CHECK(tx_stats.tx_send.packets == payloads.size());
+  CHECK(tx_stats.tx_rejected == 1U);
+  CHECK(tx_stats.tx_protect.ns > 0U);
+  CHECK(tx_stats.tx_send.ns > 0U);
+  const crisp_udp_stats_t& rx_stats = receiver.driver.stats;
+  CHECK(rx_stats.rx_recv.packets == payloads.size());
+  CHECK(rx_stats.rx_unprotect.packets == payloads.size());
+  CHECK(rx_stats.rx_bytes == tx_stats.tx_bytes);
+  CHECK(rx_stats.rx_rejected == 0U);
+}
+
+void check_rejects(crisp_udp_backend_t backend) {
+  const crisp_udp_config_t config = loopback_config(8U, backend);
+  Endpoint sender(config);
+  Endpoint receiver(config);
+  sender.connect(receiver);
+  receiver.connect(sender);
+  crisp_test::SessionPair sessions;
+
+  const std::array<uint8_t, 24> payload{};
+  const crisp_const_byte_span_t span{payload.data(), payload.size()};
+  size_t sent = 0U;
+  REQUIRE(crisp_udp_driver_tx_burst(&sender.driver, &sessions.tx, &span, 1U, nullptr, &sent) ==
+          CRISP_OK);
+  // Raw datagrams on the same socket: garbage, an oversize one and a replay of the first.
+  const std::array<uint8_t, 16> garbage{0x00U, 0x00U, 0x01U, 0x80U};
+  REQUIRE(send(sender.driver.fd, garbage.data(), garbage.size(), 0) ==
+          static_cast<ssize_t>(garbage.size()));
+  const std::vector<uint8_t> oversize(CRISP_UDP_BUFFER_SIZE + 100U, 0x77U);
+  REQUIRE(send(sender.driver.fd, oversize.data(), oversize.size(), 0) ==
+          static_cast<ssize_t>(oversize.size()));
+  std::vector<uint8_t> first_packet(sender.driver.tx_buffers,
+                                    sender.driver.tx_buffers + sender.driver.stats.tx_bytes);
+  REQUIRE(send(sender.driver.fd, first_packet.data(), first_packet.size(), 0) ==
+          static_cast<ssize_t>(first_packet.size()));
+
+  const std::vector<crisp_udp_rx_packet_t> received = receive(receiver, &sessions.rx, 4U, nullptr);
+  REQUIRE(received.size() == 4U);
+  CHECK(received[0].status == CRISP_OK);
+  CHECK(received[0].plaintext.size == payload.size());
+  CHECK(received[1].status == CRISP_ERR_CRYPTO);
+  CHECK(received[2].status == CRISP_ERR_INVALID_SIZE);
+  CHECK(received[3].status == CRISP_ERR_REPLAY);
+  CHECK(receiver.driver.stats.rx_truncated == 1U);
+  CHECK(receiver.driver.stats.rx_rejected == 3U);
+
+  // Nothing queued: the burst times out with no datagrams.
+  std::array<crisp_udp_rx_packet_t, 4> burst{};
+  size_t count = 9U;
+  REQUIRE(crisp_udp_driver_rx_burst(&receiver.driver, &sessions.rx, burst.data(), burst.size(),
+                                    &count) == CRISP_OK);
+  CHECK(count == 0U);
+}
+
+}  // namespace
+
+TEST_CASE("UDP driver moves protected bursts over loopback", "[udp]") {
+  check_round_trip(CRISP_UDP_BACKEND_MMSG);
+}
+
+TEST_CASE("UDP driver reports bad, replayed and truncated datagrams", "[udp]") {
+  check_rejects(CRISP_UDP_BACKEND_MMSG);
+}
+
+TEST_CASE("UDP io_uring backend moves protected bursts over loopback", "[udp][io_uring]") {
+  if (backend_available(CRISP_UDP_BACKEND_IO_URING)) {
+    check_round_trip(CRISP_UDP_BACKEND_IO_URING);
+  }
+}
+
+TEST_CASE("UDP io_uring backend reports bad, replayed and truncated datagrams",
+          "[udp][io_uring]") {
+  if (backend_available(CRISP_UDP_BACKEND_IO_URING)) {
+    check_rejects(CRISP_UDP_BACKEND_IO_URING);
+  }
+}
+
+TEST_CASE("UDP io_uring backend recycles provided buffers across many bursts",
+          "[udp][io_uring]") {
+  if (!backend_available(CRISP_UDP_BACKEND_IO_URING)) {
+    return;
+  }
+  // Batch 4 gives a 16-buffer ring: 40 bursts of 4 only work if buffers come back.
+  const crisp_udp_config_t config = loopback_config(4U, CRISP_UDP_BACKEND_IO_URING);
+  Endpoint sender(config);
+  Endpoint receiver(config);
+  sender.connect(receiver);
+  receiver.connect(sender);
+  crisp_test::SessionPair sessions;
+
+  const std::array<uint8_t, 100> payload{};
+  const std::array<crisp_const_byte_span_t, 4> spans{{{payload.data(), payload.size()},
+                                                      {payload.data(), payload.size()},
+                                                      {payload.data(), payload.size()},
+                                                      {payload.data(), payload.size()}}};
+  size_t delivered = 0U;
+  for (size_t burst = 0U; burst < 40U; ++burst) {
+    size_t sent = 0U;
+    REQUIRE(crisp_udp_driver_tx_burst(&sender.driver, &sessions.tx, spans.data(), spans.size(),
+                                      nullptr, &sent) == CRISP_OK);
+    REQUIRE(sent == spans.size());
+    const std::vector<crisp_udp_rx_packet_t> received =
+        receive(receiver, &sessions.rx, sent, nullptr);
+    for (const crisp_udp_rx_packet_t& packet : received) {
+      CHECK(packet.status == CRISP_OK);
+      CHECK(packet.seqnum == 1U + delivered);
+      ++delivered;
+    }
+  }
+  CHECK(delivered == 160U);
+
+  // A backlog larger than the ring ends the multishot receive (ENOBUFS); it is re-armed.
+  for (size_t burst = 0U; burst < 6U; ++burst) {
+    size_t sent = 0U;
+    REQUIRE(crisp_udp_driver_tx_burst(&sender.driver, &sessions.tx, spans.data(), spans.size(),
+                                      nullptr, &sent) == CRISP_OK);
+  }
+  const std::vector<crisp_udp_rx_packet_t> backlog = receive(receiver, &sessions.rx, 24U, nullptr);
+  REQUIRE(backlog.size() == 24U);
+  for (size_t i = 0U; i < backlog.size(); ++i) {
+    CHECK(backlog[i].status == CRISP_OK);
+    CHECK(backlog[i].seqnum == 161U + i);
+  }
+}
+
+/** The descriptors of this process that are io_uring instances. */
+std::vector<int> io_uring_fds() {
+  std::vector<int> fds;
+  DIR* dir = opendir("/proc/self/fd");
+  REQUIRE(dir != nullptr);
+  while (const dirent* entry = readdir(dir)) {
+    const std::string path = std::string("/proc/self/fd/") + entry->d_name;
+    std::array<char, 64> target{};
+    const ssize_t length = readlink(path.c_str(), target.data(), target.size() - 1U);
+    if (length > 0 && std::string(target.data()) == "anon_inode:[io_uring]") {
+      fds.push_back(std::stoi(entry->d_name));
+    }
+  }
+  closedir(dir);
+  return fds;
+}
+
+TEST_CASE("UDP io_uring backend fails for good when the ring cannot be entered",
+          "[udp][io_uring]") {
+  if (!backend_available(CRISP_UDP_BACKEND_IO_URING)) {
+    return;
+  }
+  const crisp_udp_config_t config = loopback_config(4U, CRISP_UDP_BACKEND_IO_URING);
+  Endpoint sender(config);
+  Endpoint receiver(loopback_config(4U));
+  sender.connect(receiver);
+  crisp_test::SessionPair sessions;
+
+  // Replace the ring descriptor with /dev/null: every io_uring_enter() now fails with
+  // EOPNOTSUPP, while the mapped ring keeps the queued writes alive.
+  const std::vector<int> rings = io_uring_fds();
+  REQUIRE(rings.size() == 1U);
+  const int null_fd = open("/dev/null", O_RDWR | O_CLOEXEC);
+  REQUIRE(null_fd >= 0);
+  REQUIRE(dup2(null_fd, rings[0]) == rings[0]);
+  close(null_fd);
+
+  const std::array<uint8_t, 100> payload{};
+  const std::array<crisp_const_byte_span_t, 2> spans{
+      {{payload.data(), payload.size()}, {payload.data(), payload.size()}}};
+  size_t sent = 1U;
+  CHECK(crisp_udp_driver_tx_burst(&sender.driver, &sessions.tx, spans.data(), spans.size(),
+                                  nullptr, &sent) == CRISP_ERR_IO);
+  CHECK(sent == 0U);
+  CHECK(sender.driver.failed_errno == EOPNOTSUPP);
+  CHECK(sender.driver.last_errno == EOPNOTSUPP);
+
+  // The kernel may still own the transmit buffers: later bursts fail before touching them.
+  const uint64_t next_seqnum = sessions.tx.tx_seqnums.next;
+  const std::vector<uint8_t> tx_buffers(sender.driver.tx_buffers,
+                                        sender.driver.tx_buffers + 2U * CRISP_UDP_BUFFER_SIZE);
+  std::array<uint8_t, 100> other_payload{};
+  other_payload.fill(0x77U);
+  const std::array<crisp_const_byte_span_t, 1> other{
+      {{other_payload.data(), other_payload.size()}}};
+  sender.driver.last_errno = 0;
+  CHECK(crisp_udp_driver_tx_burst(&sender.driver, &sessions.tx, other.data(), other.size(),
+                                  nullptr, &sent) == CRISP_ERR_IO);
+  CHECK(sent == 0U);
+  CHECK(sender.driver.last_errno == EOPNOTSUPP);
+  CHECK(sessions.tx.tx_seqnums.next == next_seqnum);
+  CHECK(std::memcmp(tx_buffers.data(), sender.driver.tx_buffers, tx_buffers.size()) == 0);
+
+  std::array<crisp_udp_rx_packet_t, 4> packets{};
+  size_t count = 1U;
+  CHECK(crisp_udp_driver_rx_burst(&sender.driver, &sessions.rx, packets.data(), packets.size(),
+                                  &count) == CRISP_ERR_IO);
+  CHECK(count == 0U);
+}
+
+TEST_CASE("UDP driver validates its configuration", "[udp]") {
+  crisp_udp_config_t config = loopback_config(0U);
+  const size_t default_size = crisp_udp_driver_storage_size(&config);
+  CHECK(default_size >= 2U * CRISP_UDP_DEFAULT_BATCH * CRISP_UDP_BUFFER_SIZE);
+  config.batch_size = CRISP_UDP_MAX_BATCH + 1U;
+  CHECK(crisp_udp_driver_storage_size(&config) == 0U);
+
+  config.batch_size = 4U;
+  std::vector<StorageLine> storage(crisp_udp_driver_storage_size(&config) / sizeof(StorageLine) +
+                                   2U);
+  auto* bytes = reinterpret_cast<uint8_t*>(storage.data());
+  const size_t size = storage.size() * sizeof(StorageLine);
+  crisp_udp_driver_t driver{};
+  CHECK(crisp_udp_driver_init(&driver, &config, {bytes + 8, size - 8U}) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+  CHECK(crisp_udp_driver_init(&driver, &config, {bytes, 64U}) == CRISP_ERR_BUFFER_TOO_SMALL);
+  crisp_udp_config_t no_family = config;
+  no_family.local_addr.ss_family = AF_UNSPEC;
+  CHECK(crisp_udp_driver_init(&driver, &no_family, {bytes, size}) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+
+  // Binding a port that is already taken fails with the errno kept.
+  Endpoint taken(config);
+  crisp_udp_config_t same_port = config;
+  std::memcpy(&same_port.local_addr, &taken.addr, sizeof(taken.addr));
+  CHECK(crisp_udp_driver_init(&driver, &same_port, {bytes, size}) == CRISP_ERR_IO);
+  CHECK(driver.last_errno == EADDRINUSE);
+  crisp_udp_driver_close(&driver);
+
+  size_t count = 0U;
+  CHECK(crisp_udp_driver_tx_burst(&driver, nullptr, nullptr, 0U, nullptr, &count) ==
+        CRISP_ERR_INVALID_ARGUMENT);
+}
@@ -0,0 +1,67 @@
+#ifndef CRISP_TESTS_UNIT_TEST_UTIL_H_
+#define CRISP_TESTS_UNIT_TEST_UTIL_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "crisp/core/session.h"
+#include "crisp/crypto/magma_backend.h"
+}
+
+namespace crisp_test {
+
+/** 32-byte Magma key whose byte i is `seed + i * step`. */
+inline std::array<uint8_t, 32> make_key(uint8_t seed, uint8_t step = 1U) {
+  std::array<uint8_t, 32> key{};
+  for (size_t i = 0U; i < key.size(); ++i) {
+    key[i] = static_cast<uint8_t>(seed + i * step);
+  }
+  return key;
+}
+
+/**
+ * TX and RX sessions of one CS1 association over the Magma backend. The KeyId is present
+ * only when `key_id` is non-empty.
+ */
+struct SessionPair {
+  explicit SessionPair(uint64_t tx_seqnum = 1U,
+                       size_t replay_window_size = 256U,
+                       std::vector<uint8_t> session_key_id = {})
+      : key_id(std::move(session_key_id)) {
+    crisp_magma_crypto_iface_init(&iface);
+    config.cs = CRISP_SUITE_CS1;
+    config.key_id_present = !key_id.empty();
+    config.key_id = {key_id.data(), key_id.size()};
+    config.kenc = {kenc.data(), kenc.size()};
+    config.kmac = {kmac.data(), kmac.size()};
+    config.crypto = &iface;
+    config.tx_seqnum = tx_seqnum;
+    config.replay_window_size = replay_window_size;
+    REQUIRE(crisp_session_init(&tx, &config) == CRISP_OK);
+    REQUIRE(crisp_session_init(&rx, &config) == CRISP_OK);
+  }
+  ~SessionPair() {
+    crisp_session_clear(&tx);
+    crisp_session_clear(&rx);
+  }
+  SessionPair(const SessionPair&) = delete;
+  SessionPair& operator=(const SessionPair&) = delete;
+
+  crisp_crypto_iface_t iface{};
+  std::array<uint8_t, 32> kenc = make_key(0x10U, 1U);
+  std::array<uint8_t, 32> kmac = make_key(0xA0U, 3U);
+  std::vector<uint8_t> key_id;
+  crisp_session_config_t config{};
+  crisp_session_t tx{};
+  crisp_session_t rx{};
+};
+
+}  // namespace crisp_test
+
+#endif  // CRISP_TESTS_UNIT_TEST_UTIL_H_